@@ -18,6 +18,7 @@ public class MergeAssist : ModuleRules
 		PrivateIncludePaths.AddRange(
 			new string[] {
 				// ... add other private include paths required here ...
+				"MergeAssist/Private",
 			}
 			);
 			
@@ -41,6 +42,7 @@ public class MergeAssist : ModuleRules
 			    "Engine",
 			    "GraphEditor",
 			    "InputCore",
+			    "Json",
 			    "Kismet",
 			    "Merge",
 			    "Slate",
@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BatchMergeHelper.h"
+#include "BlueprintMergeHelper.h"
+#include "GraphMergeHelper.h"
+#include "MergeAssistSettings.h"
+
+#include "Engine/Blueprint.h"
+#include "Async/ParallelFor.h"
+#include "Misc/PackageName.h"
+#include "UObject/UObjectGlobals.h"
+#include "Dom/JsonObject.h"
+
+bool BatchMergeHelper::ParseMergeList(const FString& MergeList, TArray<TSharedPtr<FBatchMergeEntry>>& OutEntries, FString& OutError)
+{
+	TArray<FString> Lines;
+	MergeList.ParseIntoArrayLines(Lines);
+
+	for (int32 LineIndex = 0; LineIndex < Lines.Num(); ++LineIndex)
+	{
+		const FString Line = Lines[LineIndex].TrimStartAndEnd();
+		if (Line.IsEmpty() || Line.StartsWith(TEXT("#"))) continue;
+
+		TArray<FString> Paths;
+		Line.ParseIntoArray(Paths, TEXT(";"), false);
+
+		if (Paths.Num() != 4)
+		{
+			OutError = FString::Printf(TEXT("Line %d: expected 'Remote;Base;Local;Target' but got '%s'"), LineIndex + 1, *Line);
+			return false;
+		}
+
+		TSharedPtr<FBatchMergeEntry> Entry = MakeShareable(new FBatchMergeEntry());
+		Entry->RemotePath = Paths[0].TrimStartAndEnd();
+		Entry->BasePath = Paths[1].TrimStartAndEnd();
+		Entry->LocalPath = Paths[2].TrimStartAndEnd();
+		Entry->TargetPath = Paths[3].TrimStartAndEnd();
+		OutEntries.Add(Entry);
+	}
+
+	return true;
+}
+
+BatchMergeHelper::BatchMergeHelper(const TArray<TSharedPtr<FBatchMergeEntry>>& InEntries)
+	: Entries(InEntries)
+{
+}
+
+void BatchMergeHelper::LoadAll()
+{
+	check(IsInGameThread());
+
+	// Request all the packages in the project up front, so they are streamed in concurrently
+	// by the async loader. Package files outside the project are loaded one by one afterwards
+	for (const auto& Entry : Entries)
+	{
+		for (const FString* Path : { &Entry->RemotePath, &Entry->BasePath, &Entry->LocalPath, &Entry->TargetPath })
+		{
+			if (FPackageName::IsValidLongPackageName(*Path)) LoadPackageAsync(*Path);
+		}
+	}
+
+	FlushAsyncLoading();
+
+	for (const auto& Entry : Entries)
+	{
+		UBlueprint* RemoteBP = BlueprintMergeHelper::LoadBlueprint(Entry->RemotePath);
+		UBlueprint* BaseBP = BlueprintMergeHelper::LoadBlueprint(Entry->BasePath);
+		UBlueprint* LocalBP = BlueprintMergeHelper::LoadBlueprint(Entry->LocalPath);
+		UBlueprint* TargetBP = FPackageName::IsValidLongPackageName(Entry->TargetPath) ? BlueprintMergeHelper::LoadBlueprint(Entry->TargetPath) : nullptr;
+
+		if (!RemoteBP || !BaseBP || !LocalBP || !TargetBP)
+		{
+			const FString& MissingPath = !RemoteBP ? Entry->RemotePath : !BaseBP ? Entry->BasePath : !LocalBP ? Entry->LocalPath : Entry->TargetPath;
+
+			Entry->Status = EBatchMergeStatus::Failed;
+			Entry->Error = FString::Printf(TEXT("Failed to load blueprint '%s'"), *MissingPath);
+			continue;
+		}
+
+		Entry->Data = FBlueprintMergeData(
+			LocalBP,
+			BaseBP,   FRevisionInfo::InvalidRevision(),
+			RemoteBP, FRevisionInfo::InvalidRevision(),
+			TargetBP
+		);
+	}
+}
+
+void BatchMergeHelper::DiffAll()
+{
+	check(IsInGameThread());
+
+	// The settings are read while diffing, make sure they are loaded before any of the tasks start
+	GetDefault<UMergeAssistSettings>();
+
+	struct FGraphDiffTask
+	{
+		FBatchMergeEntry* Entry;
+		FName GraphName;
+		TUniquePtr<FGraphMergeSnapshotDiffs> Diffs;
+	};
+
+	// Snapshots of all the graphs are captured up front, this is the only step which reads the blueprints
+	TArray<FGraphDiffTask> Tasks;
+	for (const auto& Entry : Entries)
+	{
+		if (Entry->Status == EBatchMergeStatus::Failed) continue;
+
+		const FBlueprintGraphIndex RemoteGraphs(Entry->Data.BlueprintRemote);
+		const FBlueprintGraphIndex BaseGraphs(Entry->Data.BlueprintBase);
+		const FBlueprintGraphIndex LocalGraphs(Entry->Data.BlueprintLocal);
+
+		Entry->Diffs = MakeShareable(new FBlueprintMergeDiffs());
+
+		for (auto GraphName : BlueprintMergeHelper::EnumerateGraphNames(Entry->Data))
+		{
+			Tasks.Add(FGraphDiffTask{ Entry.Get(), GraphName, MakeUnique<FGraphMergeSnapshotDiffs>(
+				RemoteGraphs.Find(GraphName),
+				BaseGraphs.Find(GraphName),
+				LocalGraphs.Find(GraphName)) });
+		}
+	}
+
+	// Each graph is diffed by a single task, the tasks only read from the snapshots, so they are
+	// independent of each other even when entries share source blueprints
+	ParallelFor(Tasks.Num(), [&Tasks](int32 Index)
+	{
+		Tasks[Index].Diffs->Diff();
+	});
+
+	// Converting the diffs back to the graphs is done on the game thread again
+	for (auto& Task : Tasks)
+	{
+		Task.Entry->Diffs->Add(Task.GraphName, Task.Diffs->Finish());
+	}
+
+	for (const auto& Entry : Entries)
+	{
+		if (!Entry->Diffs) continue;
+
+		Entry->NumChanges = Entry->Diffs->NumChanges;
+		Entry->NumConflicts = Entry->Diffs->NumConflicts;
+		Entry->Status = Entry->NumConflicts ? EBatchMergeStatus::NeedsAttention : EBatchMergeStatus::Diffed;
+	}
+}
+
+void BatchMergeHelper::MergeAll(bool bOnlyWithoutConflicts, bool bSave)
+{
+	check(IsInGameThread());
+
+	for (const auto& Entry : Entries)
+	{
+		if (!Entry->Diffs) continue;
+		if (bOnlyWithoutConflicts && Entry->NumConflicts) continue;
+
+		// The merge helper takes ownership of the diffs
+		BlueprintMergeHelper Merge(Entry->Data, Entry->Diffs);
+		Entry->Diffs.Reset();
+
+		Entry->NumFailed = Merge.ApplyNonConflictingChanges();
+
+		// Conflicts which are resolved by the auto resolve rules no longer need attention
+		Merge.ApplyAutoResolveRules();
+		Entry->NumConflicts = Merge.GetConflictCounts().NumUnresolvedGroups;
+		Entry->Report = Merge.CreateReport();
+
+		FString TargetFilename;
+		if (bSave && !BlueprintMergeHelper::SaveBlueprint(Entry->Data.BlueprintTarget, TargetFilename))
+		{
+			Entry->Status = EBatchMergeStatus::Failed;
+			Entry->Error = FString::Printf(TEXT("Failed to save target blueprint '%s'"), *Entry->TargetPath);
+			continue;
+		}
+
+		Entry->Status = (Entry->NumConflicts || Entry->NumFailed)
+			? EBatchMergeStatus::NeedsAttention
+			: EBatchMergeStatus::AutoMerged;
+	}
+}
+
+int32 BatchMergeHelper::NumWithStatus(EBatchMergeStatus Status) const
+{
+	return Entries.FilterByPredicate([Status](const TSharedPtr<FBatchMergeEntry>& Entry)
+	{
+		return Entry->Status == Status;
+	}).Num();
+}
+
+void BatchMergeHelper::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	// Keep the loaded blueprints alive for as long as we might still merge them
+	for (const auto& Entry : Entries)
+	{
+		Collector.AddReferencedObject(Entry->Data.BlueprintRemote);
+		Collector.AddReferencedObject(Entry->Data.BlueprintBase);
+		Collector.AddReferencedObject(Entry->Data.BlueprintLocal);
+		Collector.AddReferencedObject(Entry->Data.BlueprintTarget);
+	}
+}
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/GCObject.h"
+#include "BlueprintMergeData.h"
+
+struct FBlueprintMergeDiffs;
+class FJsonObject;
+
+enum struct EBatchMergeStatus
+{
+	Pending = 0,
+	Failed,
+	Diffed,
+	AutoMerged,
+	NeedsAttention
+};
+
+struct FBatchMergeEntry
+{
+	FString RemotePath;
+	FString BasePath;
+	FString LocalPath;
+	FString TargetPath;
+
+	FBlueprintMergeData Data;
+
+	// Diffs generated by DiffAll, these are consumed once the entry is merged
+	TSharedPtr<FBlueprintMergeDiffs> Diffs;
+
+	int32 NumChanges = 0;
+	int32 NumConflicts = 0;
+	int32 NumFailed = 0;
+
+	EBatchMergeStatus Status = EBatchMergeStatus::Pending;
+	FString Error;
+
+	TSharedPtr<FJsonObject> Report;
+};
+
+// Merges a list of blueprints in one go. Loading and diffing the blueprints is done
+// concurrently, while everything that touches the blueprints themselves is done on
+// the game thread
+class BatchMergeHelper : public FGCObject
+{
+public:
+	// Parses a merge list, every line contains the Remote;Base;Local;Target paths of
+	// a single merge. Empty lines and lines starting with a # are ignored
+	static bool ParseMergeList(const FString& MergeList, TArray<TSharedPtr<FBatchMergeEntry>>& OutEntries, FString& OutError);
+
+	BatchMergeHelper(const TArray<TSharedPtr<FBatchMergeEntry>>& Entries);
+
+	// Loads all the blueprints, must be called from the game thread
+	void LoadAll();
+
+	// Diffs all the loaded blueprints across the worker threads, must be called from the game thread.
+	// Only snapshots of the graphs are diffed on the worker threads, see FGraphMergeSnapshotDiffs
+	void DiffAll();
+
+	// Applies the non conflicting changes to each of the targets, must be called from the game thread
+	void MergeAll(bool bOnlyWithoutConflicts, bool bSave);
+
+	int32 NumWithStatus(EBatchMergeStatus Status) const;
+
+	/** FGCObject interface */
+	void AddReferencedObjects(FReferenceCollector& Collector) override;
+
+public:
+	TArray<TSharedPtr<FBatchMergeEntry>> Entries;
+};
@@ -0,0 +1,612 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BlueprintMergeHelper.h"
+#include "GraphMergeHelper.h"
+#include "MergeAssist.h"
+#include "MergeAssistSettings.h"
+
+#include "Engine/Blueprint.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraph/EdGraphNode.h"
+#include "EdGraph/EdGraphPin.h"
+#include "BlueprintEditorUtils.h"
+#include "HAL/FileManager.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
+#include "UObject/UObjectHash.h"
+#include "Kismet2/KismetEditorUtilities.h"
+#include "Async/ParallelFor.h"
+#include "Containers/Ticker.h"
+#include "ScopedTransaction.h"
+#include "Dom/JsonObject.h"
+
+#define LOCTEXT_NAMESPACE "BlueprintMergeHelper"
+
+void FBlueprintMergeDiffs::Add(FName GraphName, FGraphMergeDiffs&& Diffs)
+{
+	for (const auto& Change : Diffs.ChangeList)
+	{
+		NumChanges++;
+		if (Change->bHasConflicts) NumConflicts++;
+	}
+
+	GraphDiffs.Add(GraphName, MoveTemp(Diffs));
+}
+
+void FBlueprintGraphIndex::Build(const UBlueprint* Blueprint)
+{
+	Graphs.Reset();
+	if (!Blueprint) return;
+
+	TArray<UEdGraph*> AllGraphs;
+	Blueprint->GetAllGraphs(AllGraphs);
+
+	// Keep the first graph when names are duplicated, same as a linear search would
+	for (UEdGraph* Graph : AllGraphs)
+	{
+		if (Graph && !Graphs.Contains(Graph->GetFName())) Graphs.Add(Graph->GetFName(), Graph);
+	}
+}
+
+// Adds a graph which does not exist in the target blueprint yet, to the same list of graphs as the source graph.
+// The graph is created empty, its merge helper fills it and decides whether it is part of the target blueprint.
+// Returns false for nested graphs, these are added together with the node they belong to
+static bool AddTargetGraph(UBlueprint* TargetBlueprint, UEdGraph* SourceGraph)
+{
+	TArray<UEdGraph*>* TargetGraphs = FindMatchingGraphList(TargetBlueprint, SourceGraph);
+	if (!TargetGraphs) return false;
+
+	TargetGraphs->Add(FBlueprintEditorUtils::CreateNewGraph(TargetBlueprint, SourceGraph->GetFName(), SourceGraph->GetClass(), SourceGraph->Schema));
+	return true;
+}
+
+BlueprintMergeHelper::BlueprintMergeHelper(const FBlueprintMergeData& InData, TSharedPtr<FBlueprintMergeDiffs> PrecomputedDiffs, bool bDeferDiffs)
+	: Data(InData)
+	, GraphNames(EnumerateGraphNames(InData))
+	, RemoteGraphs(InData.BlueprintRemote)
+	, BaseGraphs(InData.BlueprintBase)
+	, LocalGraphs(InData.BlueprintLocal)
+	, TargetGraphs(InData.BlueprintTarget)
+{
+	check(Data.BlueprintTarget != nullptr);
+
+	// All the graphs are diffed up front, so they can be diffed in parallel
+	if (!PrecomputedDiffs && !bDeferDiffs) PrecomputedDiffs = GenerateDiffs(Data);
+
+	// Make sure each of the graphs exists in the target blueprint, as the same kind of graph
+	bool bCreatedTargetGraphs = false;
+	for (auto GraphName : GraphNames)
+	{
+		if (TargetGraphs.Find(GraphName)) continue;
+
+		UEdGraph* RemoteGraph = RemoteGraphs.Find(GraphName);
+		UEdGraph* BaseGraph = BaseGraphs.Find(GraphName);
+		UEdGraph* LocalGraph = LocalGraphs.Find(GraphName);
+
+		UEdGraph* SourceGraph = BaseGraph ? BaseGraph : (RemoteGraph ? RemoteGraph : LocalGraph);
+		if (AddTargetGraph(Data.BlueprintTarget, SourceGraph)) bCreatedTargetGraphs = true;
+	}
+
+	if (bCreatedTargetGraphs) TargetGraphs.Build(Data.BlueprintTarget);
+
+	// Create merge helpers for each of the graphs
+	for (auto GraphName : GraphNames)
+	{
+		UEdGraph* RemoteGraph = RemoteGraphs.Find(GraphName);
+		UEdGraph* BaseGraph = BaseGraphs.Find(GraphName);
+		UEdGraph* LocalGraph = LocalGraphs.Find(GraphName);
+
+		// Nested graphs are created when the graph they are nested in is cloned, which replaces any
+		// nested graphs the target graph had before. Their parent always comes first in the graph names
+		if (BaseGraph && !Cast<UBlueprint>(BaseGraph->GetOuter())) TargetGraphs.Build(Data.BlueprintTarget);
+
+		UEdGraph* TargetGraph = TargetGraphs.Find(GraphName);
+		if (!TargetGraph)
+		{
+			UE_LOG(LogMergeAssist, Warning, TEXT("Graph '%s' does not exist in the target blueprint, and is not merged"), *GraphName.ToString());
+			continue;
+		}
+
+		FGraphMergeDiffs* GraphDiffs = PrecomputedDiffs ? PrecomputedDiffs->GraphDiffs.Find(GraphName) : nullptr;
+
+		if (bDeferDiffs && !GraphDiffs)
+		{
+			GraphMergeHelpers.Push(TSharedPtr<GraphMergeHelper>(new GraphMergeHelper(RemoteGraph, BaseGraph, LocalGraph, TargetGraph, FGraphMergeDiffs::Deferred())));
+			PendingGraphNames.Add(GraphName);
+			continue;
+		}
+
+		GraphMergeHelpers.Push(TSharedPtr<GraphMergeHelper>(GraphDiffs
+			? new GraphMergeHelper(RemoteGraph, BaseGraph, LocalGraph, TargetGraph, MoveTemp(*GraphDiffs))
+			: new GraphMergeHelper(RemoteGraph, BaseGraph, LocalGraph, TargetGraph)
+		));
+	}
+
+	for (const auto& MergeHelper : GraphMergeHelpers)
+	{
+		MergeHelper->OnChangeListUpdated.AddRaw(this, &BlueprintMergeHelper::OnGraphChangeListUpdated);
+
+		UEdGraph* const Graphs[] = { MergeHelper->GetRemoteGraph(), MergeHelper->GetBaseGraph(), MergeHelper->GetLocalGraph(), MergeHelper->GetTargetGraph() };
+		for (UEdGraph* Graph : Graphs)
+		{
+			if (Graph) GraphMergeHelpersByGraph.Add(Graph, MergeHelper.Get());
+		}
+	}
+
+	ObjectModifiedHandle = FCoreUObjectDelegates::OnObjectModified.AddRaw(this, &BlueprintMergeHelper::OnObjectModified);
+	TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &BlueprintMergeHelper::Tick));
+
+	if (!PendingGraphNames.Num()) DetectNodeMoves();
+}
+
+BlueprintMergeHelper::~BlueprintMergeHelper()
+{
+	FCoreUObjectDelegates::OnObjectModified.Remove(ObjectModifiedHandle);
+	FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+
+	// The merge view can keep the graph merge helpers alive for longer
+	for (const auto& MergeHelper : GraphMergeHelpers)
+	{
+		MergeHelper->OnChangeListUpdated.RemoveAll(this);
+	}
+}
+
+void BlueprintMergeHelper::OnObjectModified(UObject* Object)
+{
+	// This is called for every object which is modified in the editor
+	UEdGraphNode* Node = Cast<UEdGraphNode>(Object);
+	UEdGraph* Graph = Node ? Node->GetGraph() : nullptr;
+
+	GraphMergeHelper* const* MergeHelper = Graph ? GraphMergeHelpersByGraph.Find(Graph) : nullptr;
+	if (MergeHelper) (*MergeHelper)->AddEditedNode(Graph, Node);
+}
+
+bool BlueprintMergeHelper::Tick(float DeltaTime)
+{
+	// Helpers without any edits return right away
+	for (const auto& MergeHelper : GraphMergeHelpers)
+	{
+		MergeHelper->FlushGraphEdits();
+	}
+	return true;
+}
+
+TSharedPtr<GraphMergeHelper> BlueprintMergeHelper::SetGraphDiffs(FName GraphName, FGraphMergeDiffs&& Diffs)
+{
+	if (!PendingGraphNames.Remove(GraphName)) return nullptr;
+
+	TSharedPtr<GraphMergeHelper> MergeHelper = FindGraphMergeHelper(GraphName);
+	if (MergeHelper) MergeHelper->SetDiffs(MoveTemp(Diffs));
+
+	// Nodes can only be matched between graphs once every graph is diffed
+	if (!PendingGraphNames.Num()) DetectNodeMoves();
+
+	return MergeHelper;
+}
+
+TSharedPtr<FBlueprintMergeDiffs> BlueprintMergeHelper::GenerateDiffs(const FBlueprintMergeData& Data)
+{
+	TSharedPtr<FBlueprintMergeDiffs> Diffs = MakeShareable(new FBlueprintMergeDiffs());
+	GenerateDiffs(Data, EnumerateGraphNames(Data), *Diffs);
+	return Diffs;
+}
+
+void BlueprintMergeHelper::GenerateDiffs(const FBlueprintMergeData& Data, const TArray<FName>& GraphNames, FBlueprintMergeDiffs& OutDiffs)
+{
+	check(IsInGameThread());
+
+	// The settings are read while diffing, make sure they are loaded before any of the tasks start
+	GetDefault<UMergeAssistSettings>();
+
+	const FBlueprintGraphIndex RemoteGraphs(Data.BlueprintRemote);
+	const FBlueprintGraphIndex BaseGraphs(Data.BlueprintBase);
+	const FBlueprintGraphIndex LocalGraphs(Data.BlueprintLocal);
+
+	// Snapshots of all the graphs are captured up front, this is the only step which reads the blueprints
+	TArray<TUniquePtr<FGraphMergeSnapshotDiffs>> GraphDiffs;
+	for (auto GraphName : GraphNames)
+	{
+		GraphDiffs.Add(MakeUnique<FGraphMergeSnapshotDiffs>(
+			RemoteGraphs.Find(GraphName),
+			BaseGraphs.Find(GraphName),
+			LocalGraphs.Find(GraphName)));
+	}
+
+	ParallelFor(GraphDiffs.Num(), [&GraphDiffs](int32 Index)
+	{
+		GraphDiffs[Index]->Diff();
+	});
+
+	for (int32 Index = 0; Index < GraphNames.Num(); ++Index)
+	{
+		OutDiffs.Add(GraphNames[Index], GraphDiffs[Index]->Finish());
+	}
+}
+
+TArray<FName> BlueprintMergeHelper::EnumerateGraphNames(const FBlueprintMergeData& Data)
+{
+	check(Data.BlueprintRemote != nullptr);
+	check(Data.BlueprintBase != nullptr);
+	check(Data.BlueprintLocal != nullptr);
+
+	// GetAllGraphs returns the event, function, macro and delegate graphs, and the graphs of implemented
+	// interfaces, each followed by the collapsed graphs and composite graphs nested in them
+	TArray<FName> Names;
+
+	const FBlueprintGraphIndex BaseGraphs(Data.BlueprintBase);
+
+	const auto Enumerate = [&Names, &BaseGraphs](const UBlueprint* Blueprint)
+	{
+		TArray<UEdGraph*> AllGraphs;
+		Blueprint->GetAllGraphs(AllGraphs);
+
+		for (auto Graph : AllGraphs)
+		{
+			if (!Graph) continue;
+
+			// Nested graphs which were added by the remote or local blueprint are part of the node they belong to
+			const bool bIsNested = !Cast<UBlueprint>(Graph->GetOuter());
+			if (bIsNested && !BaseGraphs.Find(Graph->GetFName())) continue;
+
+			Names.AddUnique(Graph->GetFName());
+		}
+	};
+
+	Enumerate(Data.BlueprintRemote);
+	Enumerate(Data.BlueprintBase);
+	Enumerate(Data.BlueprintLocal);
+
+	return Names;
+}
+
+int32 BlueprintMergeHelper::ApplyNonConflictingChanges()
+{
+	check(!HasPendingDiffs());
+
+	// The changes of every graph are undone in one go
+	const FScopedTransaction Transaction(LOCTEXT("ApplyNonConflictingChanges", "Apply Non Conflicting Changes"), !IsRunningCommandlet());
+
+	int32 NumFailed = 0;
+	for (const auto& MergeHelper : GraphMergeHelpers)
+	{
+		NumFailed += MergeHelper->ApplyNonConflictingChanges();
+	}
+
+	return NumFailed;
+}
+
+int32 BlueprintMergeHelper::ApplyAutoResolveRules()
+{
+	check(!HasPendingDiffs());
+
+	const TArray<FMergeAutoResolveRule>& Rules = GetDefault<UMergeAssistProjectSettings>()->AutoResolveRules;
+	const FScopedTransaction Transaction(LOCTEXT("AutoResolve", "Auto Resolve Conflicts"), !IsRunningCommandlet());
+
+	int32 NumResolved = 0;
+	for (const auto& MergeHelper : GraphMergeHelpers)
+	{
+		NumResolved += MergeHelper->ApplyAutoResolveRules(Rules);
+	}
+
+	return NumResolved;
+}
+
+int32 BlueprintMergeHelper::NumChanges() const
+{
+	int32 Num = 0;
+	for (const auto& MergeHelper : GraphMergeHelpers)
+	{
+		Num += MergeHelper->ChangeList.Num();
+	}
+	return Num;
+}
+
+int32 BlueprintMergeHelper::NumConflicts() const
+{
+	int32 Num = 0;
+	for (const auto& MergeHelper : GraphMergeHelpers)
+	{
+		for (const auto& Change : MergeHelper->ChangeList)
+		{
+			if (Change->bHasConflicts) ++Num;
+		}
+	}
+	return Num;
+}
+
+FMergeConflictCounts BlueprintMergeHelper::GetConflictCounts() const
+{
+	FMergeConflictCounts Counts;
+	for (const auto& MergeHelper : GraphMergeHelpers)
+	{
+		const FMergeConflictCounts& GraphCounts = MergeHelper->GetConflictCounts();
+		Counts.NumConflicts += GraphCounts.NumConflicts;
+		Counts.NumGroups += GraphCounts.NumGroups;
+		Counts.NumUnresolvedGroups += GraphCounts.NumUnresolvedGroups;
+	}
+	return Counts;
+}
+
+TSharedRef<FJsonObject> BlueprintMergeHelper::CreateReport() const
+{
+	TArray<TSharedPtr<FJsonValue>> Graphs;
+
+	for (const auto& MergeHelper : GraphMergeHelpers)
+	{
+		TArray<TSharedPtr<FJsonValue>> Conflicts;
+		TArray<TSharedPtr<FJsonValue>> Failed;
+		int32 NumGroups = 0;
+
+		for (const auto& Change : MergeHelper->ChangeList)
+		{
+			if (Change->bHasConflicts)
+			{
+				// Every conflict of a conflict group is reported, together with the index of its group
+				const int32 Group = NumGroups++;
+				const TArray<TSharedPtr<MergeGraphChange>> GroupConflicts = Change->SubChanges.Num() ? Change->SubChanges : TArray<TSharedPtr<MergeGraphChange>>{ Change };
+
+				for (const auto& GroupConflict : GroupConflicts)
+				{
+					const TSharedRef<FJsonObject> Conflict = MakeShareable(new FJsonObject());
+					Conflict->SetStringField(TEXT("remote"), GroupConflict->RemoteDiff.DisplayString.ToString());
+					Conflict->SetStringField(TEXT("local"), GroupConflict->LocalDiff.DisplayString.ToString());
+					Conflict->SetNumberField(TEXT("group"), Group);
+					Conflicts.Add(MakeShareable(new FJsonValueObject(Conflict)));
+				}
+			}
+			else if (Change->MergeState == EMergeState::Base)
+			{
+				// Non conflicting changes which are still in the base state failed to apply
+				Failed.Add(MakeShareable(new FJsonValueString(Change->Label.ToString())));
+			}
+		}
+
+		const TSharedRef<FJsonObject> Graph = MakeShareable(new FJsonObject());
+		Graph->SetStringField(TEXT("name"), MergeHelper->GraphName.ToString());
+		Graph->SetNumberField(TEXT("changes"), MergeHelper->ChangeList.Num());
+		Graph->SetArrayField(TEXT("conflicts"), Conflicts);
+		Graph->SetArrayField(TEXT("failed"), Failed);
+		Graphs.Add(MakeShareable(new FJsonValueObject(Graph)));
+	}
+
+	TArray<TSharedPtr<FJsonValue>> Moves;
+	for (const FMergeNodeMove& NodeMove : NodeMoves)
+	{
+		const TSharedRef<FJsonObject> Move = MakeShareable(new FJsonObject());
+		Move->SetStringField(TEXT("node"), NodeMove.NodeGuid.ToString());
+		Move->SetStringField(TEXT("from"), NodeMove.FromGraph.ToString());
+		Move->SetStringField(TEXT("to"), NodeMove.ToGraph.ToString());
+		Move->SetStringField(TEXT("side"), NodeMove.bRemote ? TEXT("remote") : TEXT("local"));
+		Moves.Add(MakeShareable(new FJsonValueObject(Move)));
+	}
+
+	const TSharedRef<FJsonObject> Report = MakeShareable(new FJsonObject());
+	Report->SetStringField(TEXT("target"), Data.BlueprintTarget->GetPathName());
+	Report->SetNumberField(TEXT("changes"), NumChanges());
+	Report->SetNumberField(TEXT("conflicts"), NumConflicts());
+	Report->SetArrayField(TEXT("graphs"), Graphs);
+	Report->SetArrayField(TEXT("moves"), Moves);
+	return Report;
+}
+
+// The moves of one side, by the guid of the removed node and by the guid of the added node
+struct FMergeNodeMoveLookup
+{
+	TMap<FGuid, const FMergeNodeMove*> ByRemovedNode;
+	TMap<FGuid, const FMergeNodeMove*> ByAddedNode;
+};
+
+static const FMergeNodeMove* FindNodeMove(const FMergeDiffResult& Diff, const FMergeNodeMoveLookup& Moves)
+{
+	if (Diff.Type == EMergeDiffType::NODE_REMOVED && Diff.NodeOld) return Moves.ByRemovedNode.FindRef(Diff.NodeOld->NodeGuid);
+	if (Diff.Type == EMergeDiffType::NODE_ADDED && Diff.NodeNew) return Moves.ByAddedNode.FindRef(Diff.NodeNew->NodeGuid);
+	return nullptr;
+}
+
+// Everything which is kept when a node is copied and pasted: its class and comment, and the name, direction and
+// default value of every pin. These are the same fields the graph snapshots compare nodes and pins by
+static FString GetNodeSignature(const UEdGraphNode* Node)
+{
+	FString Signature = Node->GetClass()->GetPathName() + TEXT("|") + Node->NodeComment;
+	for (const UEdGraphPin* Pin : Node->Pins)
+	{
+		if (!Pin) continue;
+
+		Signature += FString::Printf(TEXT("|%s:%d=%s;%s;%s"),
+			*Pin->PinName.ToString(),
+			static_cast<int32>(Pin->Direction),
+			*Pin->DefaultValue,
+			*Pin->DefaultTextValue.ToString(),
+			Pin->DefaultObject ? *Pin->DefaultObject->GetPathName() : TEXT(""));
+	}
+	return Signature;
+}
+
+// Adds the graph a node was moved to or from to the label of the change, and of its sub changes.
+// Returns true if any label was changed
+static bool LabelNodeMoves(MergeGraphChange& Change, const FMergeNodeMoveLookup& RemoteMoves, const FMergeNodeMoveLookup& LocalMoves)
+{
+	bool bLabeled = false;
+	for (const auto& SubChange : Change.SubChanges)
+	{
+		bLabeled |= LabelNodeMoves(*SubChange, RemoteMoves, LocalMoves);
+	}
+
+	const bool bIsRemoteChange = Change.RemoteDiff.Type != EMergeDiffType::NO_DIFFERENCE;
+	const FMergeDiffResult& Diff = bIsRemoteChange ? Change.RemoteDiff : Change.LocalDiff;
+	const FMergeNodeMove* Move = FindNodeMove(Diff, bIsRemoteChange ? RemoteMoves : LocalMoves);
+	if (!Move || Change.bIsLabeledAsMove) return bLabeled;
+
+	Change.Label = Diff.Type == EMergeDiffType::NODE_REMOVED
+		? FText::Format(LOCTEXT("NodeMovedTo", "{0} (moved to '{1}')"), Change.Label, FText::FromName(Move->ToGraph))
+		: FText::Format(LOCTEXT("NodeMovedFrom", "{0} (moved from '{1}')"), Change.Label, FText::FromName(Move->FromGraph));
+	Change.bIsLabeledAsMove = true;
+	return true;
+}
+
+void BlueprintMergeHelper::DetectNodeMoves()
+{
+	// Labeling the moves broadcasts the change list update of the graphs again
+	if (bIsDetectingNodeMoves) return;
+	TGuardValue<bool> DetectingNodeMoves(bIsDetectingNodeMoves, true);
+
+	NodeMoves.Reset();
+	for (const auto& MergeHelper : GraphMergeHelpers)
+	{
+		LabeledChangeListRevisions.Add(MergeHelper.Get(), MergeHelper->GetChangeListRevision());
+	}
+
+	struct FChangedNode
+	{
+		const UEdGraphNode* Node;
+		FName Graph;
+	};
+
+	// Nodes keep their guid when they are moved to another graph, so a node removed from one graph and added
+	// to another by the same side is the same node. Nodes removed and added within a single graph are matched by the diff
+	for (const bool bRemote : { true, false })
+	{
+		TMap<FGuid, FChangedNode> Removed;
+		TMap<FGuid, FChangedNode> Added;
+
+		for (const auto& MergeHelper : GraphMergeHelpers)
+		{
+			const FSourceGraphDiffs& Diffs = bRemote ? MergeHelper->GetRemoteDifferences() : MergeHelper->GetLocalDifferences();
+			for (const FMergeDiffResult& Diff : Diffs.Diffs)
+			{
+				if (Diff.Type == EMergeDiffType::NODE_REMOVED && Diff.NodeOld) Removed.Add(Diff.NodeOld->NodeGuid, FChangedNode{ Diff.NodeOld, MergeHelper->GraphName });
+				else if (Diff.Type == EMergeDiffType::NODE_ADDED && Diff.NodeNew) Added.Add(Diff.NodeNew->NodeGuid, FChangedNode{ Diff.NodeNew, MergeHelper->GraphName });
+			}
+		}
+
+		for (auto It = Removed.CreateIterator(); It; ++It)
+		{
+			const FChangedNode* AddedNode = Added.Find(It.Key());
+			if (!AddedNode) continue;
+
+			if (AddedNode->Graph != It.Value().Graph)
+			{
+				NodeMoves.Add(FMergeNodeMove{ It.Key(), It.Key(), It.Value().Graph, AddedNode->Graph, bRemote });
+			}
+
+			Added.Remove(It.Key());
+			It.RemoveCurrent();
+		}
+
+		// The remaining nodes are matched by their signature, but only when it identifies a single removed and a single
+		// added node, nodes which are copied more than once can not be told apart
+		TMap<FString, TArray<FGuid>> RemovedBySignature;
+		TMap<FString, TArray<FGuid>> AddedBySignature;
+		for (const auto& Pair : Removed) RemovedBySignature.FindOrAdd(GetNodeSignature(Pair.Value.Node)).Add(Pair.Key);
+		for (const auto& Pair : Added) AddedBySignature.FindOrAdd(GetNodeSignature(Pair.Value.Node)).Add(Pair.Key);
+
+		for (const auto& Pair : RemovedBySignature)
+		{
+			const TArray<FGuid>* AddedGuids = AddedBySignature.Find(Pair.Key);
+			if (Pair.Value.Num() != 1 || !AddedGuids || AddedGuids->Num() != 1) continue;
+
+			const FChangedNode& RemovedNode = Removed[Pair.Value[0]];
+			const FChangedNode& AddedNode = Added[(*AddedGuids)[0]];
+			if (AddedNode.Graph != RemovedNode.Graph)
+			{
+				NodeMoves.Add(FMergeNodeMove{ Pair.Value[0], (*AddedGuids)[0], RemovedNode.Graph, AddedNode.Graph, bRemote });
+			}
+		}
+	}
+
+	if (!NodeMoves.Num()) return;
+
+	FMergeNodeMoveLookup RemoteMoves;
+	FMergeNodeMoveLookup LocalMoves;
+	for (const FMergeNodeMove& Move : NodeMoves)
+	{
+		FMergeNodeMoveLookup& Moves = Move.bRemote ? RemoteMoves : LocalMoves;
+		Moves.ByRemovedNode.Add(Move.NodeGuid, &Move);
+		Moves.ByAddedNode.Add(Move.NewNodeGuid, &Move);
+	}
+
+	for (const auto& MergeHelper : GraphMergeHelpers)
+	{
+		bool bLabeled = false;
+		for (const auto& Change : MergeHelper->ChangeList)
+		{
+			bLabeled |= LabelNodeMoves(*Change, RemoteMoves, LocalMoves);
+		}
+
+		if (bLabeled) MergeHelper->OnChangeListUpdated.Broadcast();
+	}
+}
+
+void BlueprintMergeHelper::OnGraphChangeListUpdated()
+{
+	if (PendingGraphNames.Num()) return;
+
+	// Applying changes also updates the change list, but only generating the changes again can change the moves.
+	// Changes which were already labeled keep their label, so this only labels the changes which were generated again
+	for (const auto& MergeHelper : GraphMergeHelpers)
+	{
+		if (LabeledChangeListRevisions.FindRef(MergeHelper.Get()) != MergeHelper->GetChangeListRevision())
+		{
+			DetectNodeMoves();
+			return;
+		}
+	}
+}
+
+TSharedPtr<GraphMergeHelper> BlueprintMergeHelper::FindGraphMergeHelper(FName GraphName) const
+{
+	for (const auto& MergeHelper : GraphMergeHelpers)
+	{
+		if (MergeHelper->GraphName == GraphName) return MergeHelper;
+	}
+	return nullptr;
+}
+
+UEdGraph* BlueprintMergeHelper::FindTargetGraph(FName GraphName) const
+{
+	const TSharedPtr<GraphMergeHelper> MergeHelper = FindGraphMergeHelper(GraphName);
+	return MergeHelper ? MergeHelper->GetTargetGraph() : TargetGraphs.Find(GraphName);
+}
+
+UBlueprint* BlueprintMergeHelper::LoadBlueprint(const FString& Path)
+{
+	// Assets in the project are loaded by their package name
+	if (FPackageName::IsValidLongPackageName(Path))
+	{
+		const FString ObjectPath = Path + TEXT(".") + FPackageName::GetShortName(Path);
+		return LoadObject<UBlueprint>(nullptr, *ObjectPath);
+	}
+
+	if (!FPaths::FileExists(Path)) return nullptr;
+
+	// Files outside of the project (e.g. the temporary files git passes to a merge driver)
+	// do not have to have a package extension, so copy them to the diff directory first
+	const FString TempFile = FPaths::CreateTempFilename(*FPaths::DiffDir(), TEXT("MergeAssist-"), *FPackageName::GetAssetPackageExtension());
+	if (IFileManager::Get().Copy(*TempFile, *Path) != COPY_OK) return nullptr;
+
+	UPackage* Package = LoadPackage(nullptr, *TempFile, LOAD_ForDiff | LOAD_DisableCompileOnLoad);
+	if (!Package) return nullptr;
+
+	UBlueprint* Blueprint = nullptr;
+	ForEachObjectWithOuter(Package, [&Blueprint](UObject* Object)
+	{
+		if (!Blueprint) Blueprint = Cast<UBlueprint>(Object);
+	}, false);
+
+	return Blueprint;
+}
+
+bool BlueprintMergeHelper::SaveBlueprint(UBlueprint* Blueprint, FString& OutFilename)
+{
+	// Compile the blueprint first, to make sure the generated class reflects the merged graphs
+	FKismetEditorUtilities::CompileBlueprint(Blueprint);
+
+	UPackage* Package = Blueprint->GetOutermost();
+	OutFilename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+
+	return UPackage::SavePackage(Package, nullptr, RF_Standalone, *OutFilename, GError, nullptr, false, true, SAVE_NoError);
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,157 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BlueprintMergeData.h"
+#include "GraphMergeHelper.h"
+
+class UBlueprint;
+class UEdGraph;
+class FJsonObject;
+
+// The diffs for all the graphs of a blueprint merge, see FGraphMergeDiffs
+struct FBlueprintMergeDiffs
+{
+	void Add(FName GraphName, FGraphMergeDiffs&& Diffs);
+
+	TMap<FName, FGraphMergeDiffs> GraphDiffs;
+
+	int32 NumChanges = 0;
+	int32 NumConflicts = 0;
+};
+
+// Lookup of the graphs of a blueprint by name, this includes nested graphs
+struct FBlueprintGraphIndex
+{
+	FBlueprintGraphIndex() = default;
+	explicit FBlueprintGraphIndex(const UBlueprint* Blueprint) { Build(Blueprint); }
+
+	// Needs to be called again when graphs are added to or removed from the blueprint
+	void Build(const UBlueprint* Blueprint);
+
+	UEdGraph* Find(FName GraphName) const
+	{
+		UEdGraph* const* Graph = Graphs.Find(GraphName);
+		return Graph ? *Graph : nullptr;
+	}
+
+private:
+	TMap<FName, UEdGraph*> Graphs;
+};
+
+// A node which was removed from one graph and added to another by the same side, e.g. cut from one function and
+// pasted into another. The node is matched by its guid, which is kept when a node is moved between graphs. Pasting
+// a node gives it a new guid, so nodes which are not matched by their guid are matched by their class, pins and defaults
+struct FMergeNodeMove
+{
+	// Guid of the removed node, and of the added node, these are only different when the node was matched by its pins
+	FGuid NodeGuid;
+	FGuid NewNodeGuid;
+	FName FromGraph;
+	FName ToGraph;
+	bool bRemote;
+};
+
+// Owns the GraphMergeHelper for every graph of a single blueprint merge.
+// This contains no UI code, so it is shared between the merge UI and the
+// merge commandlet
+class BlueprintMergeHelper
+{
+public:
+	// When diffs are passed in, they are used instead of diffing the graphs again. When the diffs are
+	// deferred the graphs start out without changes, until their diffs are passed to SetGraphDiffs
+	BlueprintMergeHelper(const FBlueprintMergeData& Data, TSharedPtr<FBlueprintMergeDiffs> PrecomputedDiffs = nullptr, bool bDeferDiffs = false);
+	~BlueprintMergeHelper();
+
+	// Applies all the changes which do not conflict with each other
+	// returns the number of changes which could not be applied
+	int32 ApplyNonConflictingChanges();
+
+	// Resolves the changes of every graph using the auto resolve rules of the project settings,
+	// returns the number of changes which were resolved
+	int32 ApplyAutoResolveRules();
+
+	// The bulk actions above need the changes of every graph, so they can only be used once no diffs are pending
+	bool HasPendingDiffs() const { return PendingGraphNames.Num() != 0; }
+
+	// Conflict groups count as a single change and conflict, since they are resolved together
+	int32 NumChanges() const;
+	int32 NumConflicts() const;
+
+	// Sum of the conflict counts of all graphs
+	FMergeConflictCounts GetConflictCounts() const;
+
+	TSharedPtr<GraphMergeHelper> FindGraphMergeHelper(FName GraphName) const;
+
+	// Sets the diffs of a graph when they were deferred, returns the merge helper of the graph
+	TSharedPtr<GraphMergeHelper> SetGraphDiffs(FName GraphName, FGraphMergeDiffs&& Diffs);
+	bool IsDiffPending(FName GraphName) const { return PendingGraphNames.Contains(GraphName); }
+
+	UEdGraph* FindRemoteGraph(FName GraphName) const { return RemoteGraphs.Find(GraphName); }
+	UEdGraph* FindBaseGraph(FName GraphName) const { return BaseGraphs.Find(GraphName); }
+	UEdGraph* FindLocalGraph(FName GraphName) const { return LocalGraphs.Find(GraphName); }
+
+	// Graphs which were added by the remote or local blueprint are only part of the target blueprint
+	// once their change is applied, their merge helper always knows the target graph
+	UEdGraph* FindTargetGraph(FName GraphName) const;
+
+	// Nodes moved between graphs, these are found once the diffs of every graph are set
+	const TArray<FMergeNodeMove>& GetNodeMoves() const { return NodeMoves; }
+
+	// Creates a machine readable report of the conflicts, and changes which failed to apply
+	TSharedRef<FJsonObject> CreateReport() const;
+
+	// Diffs all the graphs in the remote and local blueprints against the base blueprint. Snapshots of the graphs
+	// are captured on the game thread, after which the graphs are diffed in parallel. This never touches the target
+	// blueprint, but has to be called on the game thread
+	static TSharedPtr<FBlueprintMergeDiffs> GenerateDiffs(const FBlueprintMergeData& Data);
+	static void GenerateDiffs(const FBlueprintMergeData& Data, const TArray<FName>& GraphNames, FBlueprintMergeDiffs& OutDiffs);
+
+	// Names of the event, function, macro and delegate graphs, followed by the graphs nested in them. Nested
+	// graphs are only included when they exist in the base blueprint, new ones are added with the node they belong to
+	static TArray<FName> EnumerateGraphNames(const FBlueprintMergeData& Data);
+
+	// Loads a blueprint from either a package name, or a package file outside of the project
+	static UBlueprint* LoadBlueprint(const FString& Path);
+	static bool SaveBlueprint(UBlueprint* Blueprint, FString& OutFilename);
+
+public:
+	const FBlueprintMergeData Data;
+
+	// Names of all the graphs which exist in either the remote, base or local blueprint
+	TArray<FName> GraphNames;
+	TArray<TSharedPtr<GraphMergeHelper>> GraphMergeHelpers;
+
+private:
+	// The source blueprints are never modified during a merge, so their indices are only built
+	// once. The target index is rebuilt when graphs are added to the target blueprint
+	FBlueprintGraphIndex RemoteGraphs;
+	FBlueprintGraphIndex BaseGraphs;
+	FBlueprintGraphIndex LocalGraphs;
+	FBlueprintGraphIndex TargetGraphs;
+
+	// Graphs whose diffs were deferred, and have not been set yet
+	TSet<FName> PendingGraphNames;
+
+	// Matches the nodes removed from one graph with the nodes added to another, and marks their changes as a move
+	void DetectNodeMoves();
+
+	// Editing the source graphs generates the changes of a graph again, which can also change the moves
+	void OnGraphChangeListUpdated();
+
+	// Modified nodes are passed to the merge helper of their graph, and the edits of every graph are flushed
+	// on the next tick. This is done here, so there is one subscription for the whole blueprint instead of one per graph
+	void OnObjectModified(UObject* Object);
+	bool Tick(float DeltaTime);
+
+	TMap<const UEdGraph*, GraphMergeHelper*> GraphMergeHelpersByGraph;
+	FDelegateHandle ObjectModifiedHandle;
+	FDelegateHandle TickerHandle;
+
+	TArray<FMergeNodeMove> NodeMoves;
+	bool bIsDetectingNodeMoves = false;
+
+	// Change list revision of each graph when the moves were last detected
+	TMap<const GraphMergeHelper*, uint32> LabeledChangeListRevisions;
+};
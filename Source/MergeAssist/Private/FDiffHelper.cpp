@@ -1,25 +1,28 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "FDiffHelper.h"
+#include "MergeAssistStats.h"
+#include "NodeSpatialIndex.h"
 #include "EdGraph/EdGraph.h"
 #include "EdGraph/EdGraphNode.h"
 #include "EdGraph/EdGraphPin.h"
+#include "HAL/PlatformTime.h"
 
 #define LOCTEXT_NAMESPACE "DiffHelper"
 
-static void DiffR_NodeRemoved(FMergeDiffResults& Results, UEdGraphNode* NodeRemoved);
-static void DiffR_NodeAdded(FMergeDiffResults& Results, UEdGraphNode* NodeAdded);
+static void DiffR_NodeRemoved(FMergeDiffSink& Results, UEdGraphNode* NodeRemoved);
+static void DiffR_NodeAdded(FMergeDiffSink& Results, UEdGraphNode* NodeAdded);
 
-static void DiffR_PinRemoved(FMergeDiffResults& Results, UEdGraphPin* OldPin);
-static void DiffR_PinAdded(FMergeDiffResults& Results, UEdGraphPin* NewPin);
+static void DiffR_PinRemoved(FMergeDiffSink& Results, UEdGraphPin* OldPin);
+static void DiffR_PinAdded(FMergeDiffSink& Results, UEdGraphPin* NewPin);
 
-static void DiffR_LinkRemoved(FMergeDiffResults& Results, const FLinkMatch& LinkMatch);
-static void DiffR_LinkAdded(FMergeDiffResults& Results, const FLinkMatch& LinkMatch);
+static void DiffR_LinkRemoved(FMergeDiffSink& Results, const FLinkMatch& LinkMatch);
+static void DiffR_LinkAdded(FMergeDiffSink& Results, const FLinkMatch& LinkMatch);
 
-static void DiffR_PinDefaultChanged(FMergeDiffResults& Results, UEdGraphPin* OldPin, UEdGraphPin* NewPin);
+static void DiffR_PinDefaultChanged(FMergeDiffSink& Results, UEdGraphPin* OldPin, UEdGraphPin* NewPin);
 
-static void DiffR_NodeMoved(FMergeDiffResults& Results, UEdGraphNode* OldNode, UEdGraphNode* NewNode);
-static void DiffR_NodeCommentChanged(FMergeDiffResults& Results, UEdGraphNode* OldNode, UEdGraphNode* NewNode);
+static void DiffR_NodeMoved(FMergeDiffSink& Results, UEdGraphNode* OldNode, UEdGraphNode* NewNode);
+static void DiffR_NodeCommentChanged(FMergeDiffSink& Results, UEdGraphNode* OldNode, UEdGraphNode* NewNode);
 
 template<class MatchType, class ItemType, typename Predicate>
 TArray<MatchType> FindItemMatchesByPredicate(
@@ -64,7 +67,7 @@ TArray<MatchType> FindItemMatchesByPredicate(
 void FDiffHelper::DiffGraphs(
 	UEdGraph* OldGraph, 
 	UEdGraph* NewGraph,
-	FMergeDiffResults& DiffsOut,
+	FMergeDiffSink& DiffsOut,
 	ENodeMatchStrategy MatchStrategy,
 	TArray<FNodeMatch>* NodeMatchesOut,
 	TArray<UEdGraphNode*>* UnmatchedOldNodesOut,
@@ -72,6 +75,9 @@ void FDiffHelper::DiffGraphs(
 {
 	// Ensure that both graphs exist
 	if (!OldGraph || !NewGraph) return;
+
+	MERGEASSIST_COUNT(Nodes, OldGraph->Nodes.Num() + NewGraph->Nodes.Num());
+	const int32 NumDiffsBefore = DiffsOut.NumFound();
 	
 	// To start, we mark all nodes at unmatched
 	TArray<UEdGraphNode*> UnmatchedOldNodes;
@@ -85,6 +91,7 @@ void FDiffHelper::DiffGraphs(
 	// Diff all the matched nodes
 	for (auto Match : NodeMatches)
 	{
+		if (DiffsOut.IsDone()) break;
 		DiffNodes(Match.OldNode, Match.NewNode, DiffsOut);
 	}
 
@@ -92,14 +99,18 @@ void FDiffHelper::DiffGraphs(
 	// this is to generate NODE_ADDED and NODE_REMOVED diffs	
 	for (auto* UnmatchedOldNode : UnmatchedOldNodes)
 	{
+		if (DiffsOut.IsDone()) break;
 		DiffNodes(UnmatchedOldNode, nullptr, DiffsOut);	
 	}
 
 	for (auto* UnmatchedNewNode : UnmatchedNewNodes)
 	{
+		if (DiffsOut.IsDone()) break;
 		DiffNodes(nullptr, UnmatchedNewNode, DiffsOut);
 	}
 
+	MERGEASSIST_COUNT(Diffs, DiffsOut.NumFound() - NumDiffsBefore);
+
 	// Output the output values if they are requested
 	if (NodeMatchesOut)       *NodeMatchesOut       = NodeMatches;
 	if (UnmatchedOldNodesOut) *UnmatchedOldNodesOut = UnmatchedOldNodes;
@@ -109,11 +120,13 @@ void FDiffHelper::DiffGraphs(
 void FDiffHelper::DiffNodes(
 	UEdGraphNode* OldNode, 
 	UEdGraphNode* NewNode, 
-	FMergeDiffResults& DiffsOut)
+	FMergeDiffSink& DiffsOut)
 {
 	// Ensure that at least one of the nodes is passed in
 	if (!OldNode && !NewNode) return;
 
+	MERGEASSIST_SCOPE(DiffNodes, DiffNodes);
+
 	if (NewNode == nullptr)
 	{
 		DiffR_NodeRemoved(DiffsOut, OldNode);
@@ -136,6 +149,8 @@ void FDiffHelper::DiffNodes(
 		DiffR_NodeMoved(DiffsOut, OldNode, NewNode);
 	}
 
+	if (DiffsOut.IsDone()) return;
+
 	{
 		TArray<UEdGraphPin*> UnmatchedOldPins;
 		TArray<UEdGraphPin*> UnmatchedNewPins;
@@ -159,6 +174,7 @@ void FDiffHelper::DiffNodes(
 
 		for (auto PinMatch : PinMatches)
 		{
+			if (DiffsOut.IsDone()) break;
 			DiffPins(PinMatch.OldPin, PinMatch.NewPin, DiffsOut);
 		}
 	}
@@ -177,7 +193,7 @@ void FDiffHelper::DiffNodes(
 void FDiffHelper::DiffPins(
 	UEdGraphPin* OldPin, 
 	UEdGraphPin* NewPin,
-	FMergeDiffResults& DiffsOut)
+	FMergeDiffSink& DiffsOut)
 {
 	// Ensure that at least one pin is passed in
 	if (!OldPin && !NewPin) return;
@@ -208,6 +224,8 @@ void FDiffHelper::DiffPins(
 		DiffR_PinDefaultChanged(DiffsOut, OldPin, NewPin);
 	}
 
+	if (DiffsOut.IsDone()) return;
+
 	{
 		TArray<FGraphLink> UnmatchedOldLinks;
 		TArray<FGraphLink> UnmatchedNewLinks;
@@ -233,6 +251,7 @@ void FDiffHelper::DiffPins(
 		
 		for (auto LinkMatch : LinkMatches)
 		{
+			if (DiffsOut.IsDone()) break;
 			DiffLinks(LinkMatch.OldLink, LinkMatch.NewLink, DiffsOut);
 		}
 	}
@@ -241,7 +260,7 @@ void FDiffHelper::DiffPins(
 void FDiffHelper::DiffLinks(
 	const FGraphLink& OldLink,
 	const FGraphLink& NewLink, 
-	FMergeDiffResults& DiffsOut)
+	FMergeDiffSink& DiffsOut)
 {
 	// ensure that at least one target got passed in
 	if (!OldLink.TargetPin && !NewLink.TargetPin) return;
@@ -294,6 +313,11 @@ TArray<FNodeMatch> FDiffHelper::FindNodeMatches(
 		NodeMatches.Append(FindExactNodeMatches(UnmatchedOldNodes, UnmatchedNewNodes));
 	}
 
+	if (IsFlagSet(MatchStrategy, ENodeMatchStrategy::PROPAGATE))
+	{
+		NodeMatches.Append(FindPropagatedNodeMatches(NodeMatches, UnmatchedOldNodes, UnmatchedNewNodes));
+	}
+
 	if (IsFlagSet(MatchStrategy, ENodeMatchStrategy::APPROXIMATE))
 	{
 		NodeMatches.Append(FindApproximateNodeMatches(UnmatchedOldNodes, UnmatchedNewNodes));
@@ -321,6 +345,8 @@ TArray<FPinMatch> FDiffHelper::FindPinMatches(
 	auto UnmatchedOldPins = OldNode->Pins.FilterByPredicate(IsVisiblePredicate);
 	auto UnmatchedNewPins = NewNode->Pins.FilterByPredicate(IsVisiblePredicate);
 
+	MERGEASSIST_COUNT(Pins, UnmatchedOldPins.Num() + UnmatchedNewPins.Num());
+
 	auto PinMatches = FindItemMatchesByPredicate<FPinMatch>(UnmatchedOldPins, UnmatchedNewPins, 
 		[](	UEdGraphPin* OldPin, UEdGraphPin* NewPin)
 		{
@@ -353,6 +379,8 @@ TArray<FLinkMatch> FDiffHelper::FindLinkMatches(
 	auto UnmatchedOldLinks = GetAllGraphLinks(OldPin);
 	auto UnmatchedNewLinks = GetAllGraphLinks(NewPin);
 
+	MERGEASSIST_COUNT(Links, UnmatchedOldLinks.Num() + UnmatchedNewLinks.Num());
+
 	auto LinkMatches = FindItemMatchesByPredicate<FLinkMatch>(UnmatchedOldLinks, UnmatchedNewLinks,
 		[](const FGraphLink& OldLink, const FGraphLink& NewLink)
 		{
@@ -372,15 +400,109 @@ TArray<FLinkMatch> FDiffHelper::FindLinkMatches(
 
 TArray<FNodeMatch> FDiffHelper::FindExactNodeMatches(TArray<UEdGraphNode*>& UnmatchedOldNodes, TArray<UEdGraphNode*>& UnmatchedNewNodes)
 {
-	return FindItemMatchesByPredicate<FNodeMatch>(UnmatchedOldNodes, UnmatchedNewNodes, 
-		[](	UEdGraphNode* OldNode, UEdGraphNode* NewNode)
+	MERGEASSIST_SCOPE(FindExactNodeMatches, Matching);
+
+	int32 NumCandidatePairs = 0;
+	auto Matches = FindItemMatchesByPredicate<FNodeMatch>(UnmatchedOldNodes, UnmatchedNewNodes, 
+		[&NumCandidatePairs](UEdGraphNode* OldNode, UEdGraphNode* NewNode)
 		{
+			++NumCandidatePairs;
 			return OldNode && NewNode && IsExactNodeMatch(OldNode, NewNode);
 		});
+
+	MERGEASSIST_COUNT(CandidatePairs, NumCandidatePairs);
+	return Matches;
+}
+
+TArray<FNodeMatch> FDiffHelper::FindPropagatedNodeMatches(const TArray<FNodeMatch>& SeedMatches, TArray<UEdGraphNode*>& UnmatchedOldNodes, TArray<UEdGraphNode*>& UnmatchedNewNodes)
+{
+	MERGEASSIST_SCOPE(PropagateNodeMatches, Matching);
+
+	TSet<UEdGraphNode*> OldUnmatched(UnmatchedOldNodes);
+	TSet<UEdGraphNode*> NewUnmatched(UnmatchedNewNodes);
+
+	TArray<FNodeMatch> Matches;
+
+	const auto IsOldNodeUnmatched = [&OldUnmatched](UEdGraphNode* Node) { return OldUnmatched.Contains(Node); };
+	const auto IsNewNodeUnmatched = [&NewUnmatched](UEdGraphNode* Node) { return NewUnmatched.Contains(Node); };
+	const auto AddMatch = [&](UEdGraphNode* OldNode, UEdGraphNode* NewNode)
+	{
+		OldUnmatched.Remove(OldNode);
+		NewUnmatched.Remove(NewNode);
+		Matches.Add(FNodeMatch{ OldNode, NewNode });
+	};
+
+	// The matches are the worklist, every match found is propagated to its own neighbours in turn.
+	// Each match is visited once, so this is linear in the number of links of the matched nodes
+	for (int32 i = 0; i < SeedMatches.Num() + Matches.Num(); ++i)
+	{
+		const FNodeMatch Match = i < SeedMatches.Num() ? SeedMatches[i] : Matches[i - SeedMatches.Num()];
+		PropagateNodeMatch(Match, IsOldNodeUnmatched, IsNewNodeUnmatched, AddMatch);
+	}
+
+	// Remove all nodes we managed to match from the unmatched nodes, keeping their order
+	UnmatchedOldNodes.RemoveAll([&OldUnmatched](UEdGraphNode* Node) { return !OldUnmatched.Contains(Node); });
+	UnmatchedNewNodes.RemoveAll([&NewUnmatched](UEdGraphNode* Node) { return !NewUnmatched.Contains(Node); });
+
+	return Matches;
+}
+
+void FDiffHelper::PropagateNodeMatch(
+	const FNodeMatch& Match,
+	TFunctionRef<bool(UEdGraphNode*)> IsOldNodeUnmatched,
+	TFunctionRef<bool(UEdGraphNode*)> IsNewNodeUnmatched,
+	TFunctionRef<void(UEdGraphNode*, UEdGraphNode*)> AddMatch)
+{
+	if (!Match.IsValid()) return;
+
+	// Returns the only candidate which is linked through the same pin of a node of the same type, or null
+	const auto FindUniqueTarget = [](UEdGraphPin* Target, const TArray<UEdGraphPin*>& Candidates, TFunctionRef<bool(UEdGraphNode*)> IsUnmatched)
+	{
+		UEdGraphNode* TargetNode = Target->GetOwningNode();
+		const FText TargetTitle = TargetNode->GetNodeTitle(ENodeTitleType::FullTitle);
+
+		UEdGraphPin* UniqueCandidate = nullptr;
+		for (UEdGraphPin* Candidate : Candidates)
+		{
+			UEdGraphNode* CandidateNode = Candidate ? Candidate->GetOwningNode() : nullptr;
+			if (!CandidateNode || !IsUnmatched(CandidateNode)) continue;
+
+			const bool bIsSameTarget = Candidate->Direction == Target->Direction
+				&& Candidate->PinName == Target->PinName
+				&& CandidateNode->GetClass() == TargetNode->GetClass()
+				&& CandidateNode->GetNodeTitle(ENodeTitleType::FullTitle).EqualTo(TargetTitle);
+
+			if (!bIsSameTarget) continue;
+			if (UniqueCandidate) return static_cast<UEdGraphPin*>(nullptr);
+
+			UniqueCandidate = Candidate;
+		}
+
+		return UniqueCandidate;
+	};
+
+	for (const FPinMatch& PinMatch : FindPinMatches(Match.OldNode, Match.NewNode))
+	{
+		for (UEdGraphPin* OldTarget : PinMatch.OldPin->LinkedTo)
+		{
+			UEdGraphNode* OldNeighbour = OldTarget ? OldTarget->GetOwningNode() : nullptr;
+			if (!OldNeighbour || !IsOldNodeUnmatched(OldNeighbour)) continue;
+
+			UEdGraphPin* NewTarget = FindUniqueTarget(OldTarget, PinMatch.NewPin->LinkedTo, IsNewNodeUnmatched);
+			if (!NewTarget) continue;
+
+			// The match needs to be unique both ways, otherwise two identical neighbours would be told apart by their order
+			if (FindUniqueTarget(NewTarget, PinMatch.OldPin->LinkedTo, IsOldNodeUnmatched) != OldTarget) continue;
+
+			AddMatch(OldNeighbour, NewTarget->GetOwningNode());
+		}
+	}
 }
 
 TArray<FNodeMatch> FDiffHelper::FindApproximateNodeMatches(TArray<UEdGraphNode*>& UnmatchedOldNodes, TArray<UEdGraphNode*>& UnmatchedNewNodes)
 {
+	MERGEASSIST_SCOPE(FindApproximateNodeMatches, Matching);
+
 	const auto CompareNodeType = [](UEdGraphNode& NodeA, UEdGraphNode& NodeB)
 	{
 		const auto TitleA = NodeA.GetNodeTitle(ENodeTitleType::FullTitle);
@@ -456,22 +578,46 @@ TArray<FNodeMatch> FDiffHelper::FindApproximateNodeMatchesBetweenNodesOfTheSameT
 		int32 DiffCount;
 	};
 
-	// Generate all potential matches, and assign them a weight based on the number of diffs
-	TArray<PotentialNodeMatch> PotentialMatches;
+	// Large sets of nodes are only paired with the nodes closest to them
+	TArray<int32> OldPositionsX;
+	TArray<int32> OldPositionsY;
+	TArray<int32> NewPositionsX;
+	TArray<int32> NewPositionsY;
+
 	for (auto OldNode : UnmatchedOldNodesOfType)
 	{
-		for (auto NewNode : UnmatchedNewNodesOfType)
-		{
-			FMergeDiffResults Results = FMergeDiffResults();
-			DiffNodes(OldNode, NewNode, Results);
-
-			PotentialMatches.Add(
-				PotentialNodeMatch
-				{
-					OldNode, NewNode, Results.NumFound()
-				}
-			);
-		}
+		OldPositionsX.Add(OldNode->NodePosX);
+		OldPositionsY.Add(OldNode->NodePosY);
+	}
+
+	for (auto NewNode : UnmatchedNewNodesOfType)
+	{
+		NewPositionsX.Add(NewNode->NodePosX);
+		NewPositionsY.Add(NewNode->NodePosY);
+	}
+
+	TArray<TPair<int32, int32>> CandidatePairs;
+	FNodeSpatialIndex::FindCandidatePairs(OldPositionsX, OldPositionsY, NewPositionsX, NewPositionsY, CandidatePairs);
+
+	MERGEASSIST_COUNT(CandidatePairs, CandidatePairs.Num());
+
+	// Generate the potential matches, and assign them a weight based on the number of diffs
+	TArray<PotentialNodeMatch> PotentialMatches;
+	PotentialMatches.Reserve(CandidatePairs.Num());
+	for (const auto& Pair : CandidatePairs)
+	{
+		auto OldNode = UnmatchedOldNodesOfType[Pair.Key];
+		auto NewNode = UnmatchedNewNodesOfType[Pair.Value];
+
+		FMergeDiffCounter Results;
+		DiffNodes(OldNode, NewNode, Results);
+
+		PotentialMatches.Add(
+			PotentialNodeMatch
+			{
+				OldNode, NewNode, Results.NumFound()
+			}
+		);
 	}
 
 	// Sort the potential matches based on the lowest DiffCount, this ensures 
@@ -513,6 +659,310 @@ bool FDiffHelper::WeakNodeMatch(UEdGraphNode* OldNode, UEdGraphNode* NewNode)
 	return OldNode->GetClass() == NewNode->GetClass() && TitleA.EqualTo(TitleB);
 }
 
+FIncrementalGraphDiff::FIncrementalGraphDiff(UEdGraph* InOldGraph, UEdGraph* InNewGraph, ENodeMatchStrategy InMatchStrategy)
+	: OldGraph(InOldGraph)
+	, NewGraph(InNewGraph)
+	, MatchStrategy(InMatchStrategy)
+	, Phase(EPhase::Done)
+{
+	// Ensure that both graphs exist
+	if (!OldGraph || !NewGraph) return;
+
+	MERGEASSIST_COUNT(Nodes, OldGraph->Nodes.Num() + NewGraph->Nodes.Num());
+
+	OldMatched.Init(false, OldGraph->Nodes.Num());
+	NewMatched.Init(false, NewGraph->Nodes.Num());
+
+	for (int32 i = 0; i < OldGraph->Nodes.Num(); ++i)
+	{
+		if (OldGraph->Nodes[i]) OldNodeIndices.Add(OldGraph->Nodes[i], i);
+	}
+
+	for (int32 i = 0; i < NewGraph->Nodes.Num(); ++i)
+	{
+		UEdGraphNode* NewNode = NewGraph->Nodes[i];
+		if (!NewNode) continue;
+
+		NewNodeIndices.Add(NewNode, i);
+		NewNodesByGuid.Add(NewNode->NodeGuid, i);
+		NewNodesByName.Add(NewNode->GetFName(), i);
+	}
+
+	BeginPhase(EPhase::ExactMatching);
+}
+
+bool FIncrementalGraphDiff::Step(double Deadline)
+{
+	bHasProgressed = false;
+
+	do
+	{
+		switch (Phase)
+		{
+		case EPhase::ExactMatching:       StepExactMatching(Deadline); break;
+		case EPhase::PropagateMatching:   StepPropagateMatching(Deadline); break;
+		case EPhase::GatherNodeTypes:     StepGatherNodeTypes(Deadline); break;
+		case EPhase::ApproximateMatching: StepApproximateMatching(Deadline); break;
+		case EPhase::DiffMatchedNodes:    StepDiffMatchedNodes(Deadline); break;
+		case EPhase::DiffUnmatchedNodes:  StepDiffUnmatchedNodes(Deadline); break;
+		default: break;
+		}
+	}
+	while (Phase != EPhase::Done && FPlatformTime::Seconds() < Deadline);
+
+	return IsDone();
+}
+
+bool FIncrementalGraphDiff::HasTimeLeft(double Deadline)
+{
+	// Always process at least one node or bucket per step, so a too small budget still makes progress
+	if (!bHasProgressed)
+	{
+		bHasProgressed = true;
+		return true;
+	}
+
+	return FPlatformTime::Seconds() < Deadline;
+}
+
+void FIncrementalGraphDiff::BeginPhase(EPhase NextPhase)
+{
+	NodeIndex = 0;
+	BucketIndex = 0;
+
+	// Skip the matching phases which are not part of the strategy
+	if (NextPhase == EPhase::ExactMatching && !IsFlagSet(MatchStrategy, ENodeMatchStrategy::EXACT))
+	{
+		NextPhase = EPhase::PropagateMatching;
+	}
+
+	if (NextPhase == EPhase::PropagateMatching && !IsFlagSet(MatchStrategy, ENodeMatchStrategy::PROPAGATE))
+	{
+		NextPhase = EPhase::GatherNodeTypes;
+	}
+
+	if (NextPhase == EPhase::GatherNodeTypes && !IsFlagSet(MatchStrategy, ENodeMatchStrategy::APPROXIMATE))
+	{
+		NextPhase = EPhase::DiffMatchedNodes;
+	}
+
+	// Once matching is done, the unmatched nodes are known
+	if (NextPhase == EPhase::DiffMatchedNodes)
+	{
+		for (int32 i = 0; i < OldGraph->Nodes.Num(); ++i)
+		{
+			if (!OldMatched[i]) UnmatchedOldNodes.Add(OldGraph->Nodes[i]);
+		}
+
+		for (int32 i = 0; i < NewGraph->Nodes.Num(); ++i)
+		{
+			if (!NewMatched[i]) UnmatchedNewNodes.Add(NewGraph->Nodes[i]);
+		}
+
+		// The buckets are no longer needed
+		Buckets.Empty();
+		BucketIndices.Empty();
+	}
+
+	if (NextPhase == EPhase::Done)
+	{
+		MERGEASSIST_COUNT(Diffs, Diffs.Num());
+	}
+
+	Phase = NextPhase;
+}
+
+void FIncrementalGraphDiff::AddMatch(int32 OldIndex, int32 NewIndex)
+{
+	OldMatched[OldIndex] = true;
+	NewMatched[NewIndex] = true;
+
+	NodeMatches.Add(FNodeMatch{ OldGraph->Nodes[OldIndex], NewGraph->Nodes[NewIndex] });
+}
+
+void FIncrementalGraphDiff::StepExactMatching(double Deadline)
+{
+	MERGEASSIST_SCOPE(FindExactNodeMatches, Matching);
+
+	TArray<int32> Candidates;
+	int32 NumCandidatePairs = 0;
+
+	for (; NodeIndex < OldGraph->Nodes.Num() && HasTimeLeft(Deadline); ++NodeIndex)
+	{
+		UEdGraphNode* OldNode = OldGraph->Nodes[NodeIndex];
+		if (!OldNode) continue;
+
+		// Only nodes with the same guid, or the same name can be exact matches
+		Candidates.Reset();
+		NewNodesByGuid.MultiFind(OldNode->NodeGuid, Candidates);
+		NewNodesByName.MultiFind(OldNode->GetFName(), Candidates);
+
+		// Like FindExactNodeMatches we match the first unmatched node in the new graph
+		int32 BestIndex = INDEX_NONE;
+		for (int32 Candidate : Candidates)
+		{
+			if (NewMatched[Candidate] || (BestIndex != INDEX_NONE && Candidate >= BestIndex)) continue;
+
+			++NumCandidatePairs;
+			if (IsExactNodeMatch(OldNode, NewGraph->Nodes[Candidate])) BestIndex = Candidate;
+		}
+
+		if (BestIndex != INDEX_NONE) AddMatch(NodeIndex, BestIndex);
+	}
+
+	MERGEASSIST_COUNT(CandidatePairs, NumCandidatePairs);
+
+	if (NodeIndex == OldGraph->Nodes.Num()) BeginPhase(EPhase::PropagateMatching);
+}
+
+void FIncrementalGraphDiff::StepPropagateMatching(double Deadline)
+{
+	MERGEASSIST_SCOPE(PropagateNodeMatches, Matching);
+
+	const auto IsOldNodeUnmatched = [this](UEdGraphNode* Node)
+	{
+		const int32* Index = OldNodeIndices.Find(Node);
+		return Index && !OldMatched[*Index];
+	};
+
+	const auto IsNewNodeUnmatched = [this](UEdGraphNode* Node)
+	{
+		const int32* Index = NewNodeIndices.Find(Node);
+		return Index && !NewMatched[*Index];
+	};
+
+	const auto AddNodeMatch = [this](UEdGraphNode* OldNode, UEdGraphNode* NewNode)
+	{
+		AddMatch(OldNodeIndices.FindChecked(OldNode), NewNodeIndices.FindChecked(NewNode));
+	};
+
+	// Same as FDiffHelper::FindPropagatedNodeMatches, the matches found so far are the worklist
+	for (; NodeIndex < NodeMatches.Num() && HasTimeLeft(Deadline); ++NodeIndex)
+	{
+		const FNodeMatch Match = NodeMatches[NodeIndex];
+		FDiffHelper::PropagateNodeMatch(Match, IsOldNodeUnmatched, IsNewNodeUnmatched, AddNodeMatch);
+	}
+
+	if (NodeIndex == NodeMatches.Num()) BeginPhase(EPhase::GatherNodeTypes);
+}
+
+void FIncrementalGraphDiff::StepGatherNodeTypes(double Deadline)
+{
+	MERGEASSIST_SCOPE(FindApproximateNodeMatches, Matching);
+
+	// Bucket the unmatched nodes of both graphs by their type, the old nodes come first
+	const int32 NumNodes = OldGraph->Nodes.Num() + NewGraph->Nodes.Num();
+	for (; NodeIndex < NumNodes && HasTimeLeft(Deadline); ++NodeIndex)
+	{
+		const bool bIsOldNode = NodeIndex < OldGraph->Nodes.Num();
+		const int32 Index = bIsOldNode ? NodeIndex : NodeIndex - OldGraph->Nodes.Num();
+
+		UEdGraphNode* Node = bIsOldNode ? OldGraph->Nodes[Index] : NewGraph->Nodes[Index];
+		if (!Node || (bIsOldNode ? OldMatched[Index] : NewMatched[Index])) continue;
+
+		const FNodeTypeKey Key = { Node->GetClass(), Node->GetNodeTitle(ENodeTitleType::FullTitle).ToString() };
+
+		int32* ExistingBucket = BucketIndices.Find(Key);
+		const int32 Bucket = ExistingBucket ? *ExistingBucket : BucketIndices.Add(Key, Buckets.AddDefaulted());
+
+		if (bIsOldNode) Buckets[Bucket].OldNodes.Add(Node);
+		else Buckets[Bucket].NewNodes.Add(Node);
+	}
+
+	if (NodeIndex == NumNodes) BeginPhase(EPhase::ApproximateMatching);
+}
+
+void FIncrementalGraphDiff::StepApproximateMatching(double Deadline)
+{
+	MERGEASSIST_SCOPE(FindApproximateNodeMatches, Matching);
+
+	for (; BucketIndex < Buckets.Num() && HasTimeLeft(Deadline); ++BucketIndex)
+	{
+		FNodeTypeBucket& Bucket = Buckets[BucketIndex];
+		if (!Bucket.OldNodes.Num() || !Bucket.NewNodes.Num()) continue;
+
+		for (const FNodeMatch& Match : FDiffHelper::FindApproximateNodeMatchesBetweenNodesOfTheSameType(Bucket.OldNodes, Bucket.NewNodes))
+		{
+			AddMatch(OldNodeIndices.FindChecked(Match.OldNode), NewNodeIndices.FindChecked(Match.NewNode));
+		}
+	}
+
+	if (BucketIndex == Buckets.Num()) BeginPhase(EPhase::DiffMatchedNodes);
+}
+
+void FIncrementalGraphDiff::StepDiffMatchedNodes(double Deadline)
+{
+	FMergeDiffCollector DiffsOut(Diffs);
+
+	for (; NodeIndex < NodeMatches.Num() && HasTimeLeft(Deadline); ++NodeIndex)
+	{
+		FDiffHelper::DiffNodes(NodeMatches[NodeIndex].OldNode, NodeMatches[NodeIndex].NewNode, DiffsOut);
+	}
+
+	if (NodeIndex == NodeMatches.Num()) BeginPhase(EPhase::DiffUnmatchedNodes);
+}
+
+void FIncrementalGraphDiff::StepDiffUnmatchedNodes(double Deadline)
+{
+	FMergeDiffCollector DiffsOut(Diffs);
+
+	// The unmatched nodes generate the NODE_REMOVED and NODE_ADDED diffs, the old nodes come first
+	const int32 NumNodes = UnmatchedOldNodes.Num() + UnmatchedNewNodes.Num();
+	for (; NodeIndex < NumNodes && HasTimeLeft(Deadline); ++NodeIndex)
+	{
+		if (NodeIndex < UnmatchedOldNodes.Num())
+		{
+			FDiffHelper::DiffNodes(UnmatchedOldNodes[NodeIndex], nullptr, DiffsOut);
+		}
+		else
+		{
+			FDiffHelper::DiffNodes(nullptr, UnmatchedNewNodes[NodeIndex - UnmatchedOldNodes.Num()], DiffsOut);
+		}
+	}
+
+	if (NodeIndex == NumNodes) BeginPhase(EPhase::Done);
+}
+
+FText FDiffHelper::FormatDisplayString(EMergeDiffType Type, const FText& A, const FText& B, const FText& C)
+{
+	switch (Type)
+	{
+	case EMergeDiffType::NODE_REMOVED:      return FText::FormatOrdered(LOCTEXT("DDS_NodeRemoved", "Removed Node '{0}'"), A);
+	case EMergeDiffType::NODE_ADDED:        return FText::FormatOrdered(LOCTEXT("DDS_NodeAdded", "Added Node '{0}'"), A);
+	case EMergeDiffType::PIN_REMOVED:       return FText::FormatOrdered(LOCTEXT("DDS_PinRemoved", "Removed Pin '{0}' from '{1}'"), A, B);
+	case EMergeDiffType::PIN_ADDED:         return FText::FormatOrdered(LOCTEXT("DDS_PinAdded", "Added Pin '{0}' to '{1}'"), A, B);
+	case EMergeDiffType::PIN_DEFAULT_VALUE: return FText::FormatOrdered(LOCTEXT("DDS_PinDefaultChanged", "Pin Default '{0}' ['{1}' -> '{2}']"), A, B, C);
+	case EMergeDiffType::LINK_REMOVED:      return FText::FormatOrdered(LOCTEXT("DDS_LinkRemoved", "Removed Link from '{0}' to {1}"), A, B);
+	case EMergeDiffType::LINK_ADDED:        return FText::FormatOrdered(LOCTEXT("DDS_LinkAdded", "Added Link from '{0}' to {1}"), A, B);
+	case EMergeDiffType::NODE_MOVED:        return FText::FormatOrdered(LOCTEXT("DDS_NodeMoved", "Moved Node '{0}'"), A);
+	case EMergeDiffType::NODE_COMMENT:      return FText::FormatOrdered(LOCTEXT("DDS_NodeCommentChanged", "Comment Changed Node '{0}'"), A);
+	case EMergeDiffType::GRAPH_ADDED:       return FText::FormatOrdered(LOCTEXT("DDS_GraphAdded", "Added Graph '{0}'"), A);
+	case EMergeDiffType::GRAPH_REMOVED:     return FText::FormatOrdered(LOCTEXT("DDS_GraphRemoved", "Removed Graph '{0}'"), A);
+	case EMergeDiffType::GRAPH_CHANGED:     return FText::FormatOrdered(LOCTEXT("DDS_GraphChanged", "Changed Graph '{0}'"), A);
+	default: return FText::GetEmpty();
+	}
+}
+
+FLinearColor FDiffHelper::GetDisplayColor(EMergeDiffType Type)
+{
+	switch (Type)
+	{
+	case EMergeDiffType::NODE_REMOVED:      return FLinearColor(1.f,0.4f,0.4f);
+	case EMergeDiffType::NODE_ADDED:        return FLinearColor(0.3f,1.0f,0.4f);
+	case EMergeDiffType::PIN_REMOVED:       return FLinearColor(0.45f,0.4f,0.4f);
+	case EMergeDiffType::PIN_ADDED:         return FLinearColor(0.45f,0.4f,0.4f);
+	case EMergeDiffType::PIN_DEFAULT_VALUE: return FLinearColor(0.665f,0.13f,0.455f);
+	case EMergeDiffType::LINK_REMOVED:      return FLinearColor(0.5f,0.3f,0.85f);
+	case EMergeDiffType::LINK_ADDED:        return FLinearColor(0.5f,0.3f,0.85f);
+	case EMergeDiffType::NODE_MOVED:        return FLinearColor(0.9f, 0.84f, 0.43f);
+	case EMergeDiffType::NODE_COMMENT:      return FLinearColor(0.25f,0.4f,0.5f);
+	case EMergeDiffType::GRAPH_ADDED:       return FLinearColor(0.3f,1.0f,0.4f);
+	case EMergeDiffType::GRAPH_REMOVED:     return FLinearColor(1.f,0.4f,0.4f);
+	case EMergeDiffType::GRAPH_CHANGED:     return FLinearColor(0.9f, 0.84f, 0.43f);
+	default: return FLinearColor::White;
+	}
+}
+
 /*******************************************************************************
 * Static helper function implementations
 *******************************************************************************/
@@ -522,75 +972,71 @@ static FText GetNodeTitle(const UEdGraphNode* Node)
 	return Node->GetNodeTitle(ENodeTitleType::ListView);
 }
 
-void DiffR_NodeRemoved(FMergeDiffResults& Results, UEdGraphNode* NodeRemoved)
+void DiffR_NodeRemoved(FMergeDiffSink& Results, UEdGraphNode* NodeRemoved)
 {
 	FMergeDiffResult Diff = {};
 	Diff.Type    = EMergeDiffType::NODE_REMOVED;
 	Diff.NodeOld = NodeRemoved;
 	
-	// Only generate the display data if it will be stored
-	if (Results.CanStoreResults())
+	// Only generate the display data if it will be used
+	if (Results.NeedsDisplayData())
 	{
-		Diff.DisplayString = FText::FormatOrdered(
-			LOCTEXT("DDS_NodeRemoved", "Removed Node '{0}'"), GetNodeTitle(NodeRemoved));
-		Diff.DisplayColor = FLinearColor(1.f,0.4f,0.4f);
+		Diff.DisplayString = FDiffHelper::FormatDisplayString(Diff.Type, GetNodeTitle(NodeRemoved));
+		Diff.DisplayColor = FDiffHelper::GetDisplayColor(Diff.Type);
 	}
 
 	Results.Add(Diff);
 }
 
-void DiffR_NodeAdded(FMergeDiffResults& Results, UEdGraphNode* NodeAdded)
+void DiffR_NodeAdded(FMergeDiffSink& Results, UEdGraphNode* NodeAdded)
 {
 	FMergeDiffResult Diff = {};
 	Diff.Type    = EMergeDiffType::NODE_ADDED;
 	Diff.NodeNew = NodeAdded;
 	
-	// Only generate the display data if it will be stored
-	if (Results.CanStoreResults())
+	// Only generate the display data if it will be used
+	if (Results.NeedsDisplayData())
 	{
-		Diff.DisplayString = FText::FormatOrdered(
-			LOCTEXT("DDS_NodeAdded", "Added Node '{0}'"), GetNodeTitle(NodeAdded));
-		Diff.DisplayColor = FLinearColor(0.3f,1.0f,0.4f);
+		Diff.DisplayString = FDiffHelper::FormatDisplayString(Diff.Type, GetNodeTitle(NodeAdded));
+		Diff.DisplayColor = FDiffHelper::GetDisplayColor(Diff.Type);
 	}
 
 	Results.Add(Diff);
 }
 
-void DiffR_PinRemoved(FMergeDiffResults& Results, UEdGraphPin* OldPin)
+void DiffR_PinRemoved(FMergeDiffSink& Results, UEdGraphPin* OldPin)
 {
 	FMergeDiffResult Diff = {};
 	Diff.Type   = EMergeDiffType::PIN_REMOVED;
 	Diff.PinOld = OldPin;
 
-	// Only generate the display data if it will be stored
-	if (Results.CanStoreResults())
+	// Only generate the display data if it will be used
+	if (Results.NeedsDisplayData())
 	{
-		Diff.DisplayString = FText::FormatOrdered(
-			LOCTEXT("DDS_PinRemoved", "Removed Pin '{0}' from '{1}'"), OldPin->GetDisplayName(), GetNodeTitle(OldPin->GetOwningNode()));
-		Diff.DisplayColor = FLinearColor(0.45f,0.4f,0.4f);
+		Diff.DisplayString = FDiffHelper::FormatDisplayString(Diff.Type, OldPin->GetDisplayName(), GetNodeTitle(OldPin->GetOwningNode()));
+		Diff.DisplayColor = FDiffHelper::GetDisplayColor(Diff.Type);
 	}
 
 	Results.Add(Diff);
 }
 
-void DiffR_PinAdded(FMergeDiffResults& Results, UEdGraphPin* NewPin)
+void DiffR_PinAdded(FMergeDiffSink& Results, UEdGraphPin* NewPin)
 {
 	FMergeDiffResult Diff = {};
 	Diff.Type   = EMergeDiffType::PIN_ADDED;
 	Diff.PinNew = NewPin;
 
-	// Only generate the display data if it will be stored
-	if (Results.CanStoreResults())
+	// Only generate the display data if it will be used
+	if (Results.NeedsDisplayData())
 	{
-		Diff.DisplayString = FText::FormatOrdered(
-			LOCTEXT("DDS_PinAdded", "Added Pin '{0}' to '{1}'"), NewPin->GetDisplayName(), GetNodeTitle(NewPin->GetOwningNode()));
-		Diff.DisplayColor = FLinearColor(0.45f,0.4f,0.4f);
+		Diff.DisplayString = FDiffHelper::FormatDisplayString(Diff.Type, NewPin->GetDisplayName(), GetNodeTitle(NewPin->GetOwningNode()));
+		Diff.DisplayColor = FDiffHelper::GetDisplayColor(Diff.Type);
 	}
 
 	Results.Add(Diff);
 }
 
-void DiffR_LinkRemoved(FMergeDiffResults& Results, const FLinkMatch& LinkMatch)
+void DiffR_LinkRemoved(FMergeDiffSink& Results, const FLinkMatch& LinkMatch)
 {
 	FMergeDiffResult Diff = {};
 	Diff.Type          = EMergeDiffType::LINK_REMOVED;
@@ -599,18 +1045,17 @@ void DiffR_LinkRemoved(FMergeDiffResults& Results, const FLinkMatch& LinkMatch)
 	Diff.LinkTargetOld = LinkMatch.OldLink.TargetPin;
 	Diff.LinkTargetNew = LinkMatch.NewLink.TargetPin;
 
-	// Only generate the display data if it will be stored
-	if (Results.CanStoreResults())
+	// Only generate the display data if it will be used
+	if (Results.NeedsDisplayData())
 	{
-		Diff.DisplayString = FText::FormatOrdered(LOCTEXT("DDS_LinkRemoved", "Removed Link from '{0}' to {1}"), 
-			GetNodeTitle(Diff.PinOld->GetOwningNode()), GetNodeTitle(Diff.LinkTargetOld->GetOwningNode()));
-		Diff.DisplayColor = FLinearColor(0.5f,0.3f,0.85f);
+		Diff.DisplayString = FDiffHelper::FormatDisplayString(Diff.Type, GetNodeTitle(Diff.PinOld->GetOwningNode()), GetNodeTitle(Diff.LinkTargetOld->GetOwningNode()));
+		Diff.DisplayColor = FDiffHelper::GetDisplayColor(Diff.Type);
 	}
 
 	Results.Add(Diff);
 }
 
-void DiffR_LinkAdded(FMergeDiffResults& Results, const FLinkMatch& LinkMatch)
+void DiffR_LinkAdded(FMergeDiffSink& Results, const FLinkMatch& LinkMatch)
 {
 	FMergeDiffResult Diff = {};
 	Diff.Type          = EMergeDiffType::LINK_ADDED;
@@ -619,64 +1064,62 @@ void DiffR_LinkAdded(FMergeDiffResults& Results, const FLinkMatch& LinkMatch)
 	Diff.LinkTargetOld = LinkMatch.OldLink.TargetPin;
 	Diff.LinkTargetNew = LinkMatch.NewLink.TargetPin;
 
-	// Only generate the display data if it will be stored
-	if (Results.CanStoreResults())
+	// Only generate the display data if it will be used
+	if (Results.NeedsDisplayData())
 	{
-		Diff.DisplayString = FText::FormatOrdered(LOCTEXT("DDS_LinkAdded", "Added Link from '{0}' to {1}"), 
-			GetNodeTitle(Diff.PinNew->GetOwningNode()), GetNodeTitle(Diff.LinkTargetNew->GetOwningNode()));
-		Diff.DisplayColor = FLinearColor(0.5f,0.3f,0.85f);
+		Diff.DisplayString = FDiffHelper::FormatDisplayString(Diff.Type, GetNodeTitle(Diff.PinNew->GetOwningNode()), GetNodeTitle(Diff.LinkTargetNew->GetOwningNode()));
+		Diff.DisplayColor = FDiffHelper::GetDisplayColor(Diff.Type);
 	}
 
 	Results.Add(Diff);
 }
 
-void DiffR_PinDefaultChanged(FMergeDiffResults& Results, UEdGraphPin* OldPin, UEdGraphPin* NewPin)
+void DiffR_PinDefaultChanged(FMergeDiffSink& Results, UEdGraphPin* OldPin, UEdGraphPin* NewPin)
 {
 	FMergeDiffResult Diff = {};
 	Diff.Type          = EMergeDiffType::PIN_DEFAULT_VALUE;
 	Diff.PinOld        = OldPin;
 	Diff.PinNew        = NewPin;
 
-	// Only generate the display data if it will be stored
-	if (Results.CanStoreResults())
+	// Only generate the display data if it will be used
+	if (Results.NeedsDisplayData())
 	{
-		Diff.DisplayString = FText::FormatOrdered(LOCTEXT("DDS_PinDefaultChanged", "Pin Default '{0}' ['{1}' -> '{2}']")
-			, OldPin->GetDisplayName(), OldPin->GetDefaultAsText(), NewPin->GetDefaultAsText());
-		Diff.DisplayColor = FLinearColor(0.665f,0.13f,0.455f);
+		Diff.DisplayString = FDiffHelper::FormatDisplayString(Diff.Type, OldPin->GetDisplayName(), OldPin->GetDefaultAsText(), NewPin->GetDefaultAsText());
+		Diff.DisplayColor = FDiffHelper::GetDisplayColor(Diff.Type);
 	}
 
 	Results.Add(Diff);
 }
 
-void DiffR_NodeMoved(FMergeDiffResults& Results, UEdGraphNode* OldNode, UEdGraphNode* NewNode)
+void DiffR_NodeMoved(FMergeDiffSink& Results, UEdGraphNode* OldNode, UEdGraphNode* NewNode)
 {
 	FMergeDiffResult Diff = {};
 	Diff.Type    = EMergeDiffType::NODE_MOVED;
 	Diff.NodeOld = OldNode;
 	Diff.NodeNew = NewNode;
 
-	// Only generate the display data if it will be stored
-	if (Results.CanStoreResults())
+	// Only generate the display data if it will be used
+	if (Results.NeedsDisplayData())
 	{
-		Diff.DisplayString = FText::FormatOrdered(LOCTEXT("DDS_NodeMoved", "Moved Node '{0}'"), GetNodeTitle(OldNode));
-		Diff.DisplayColor = FLinearColor(0.9f, 0.84f, 0.43f);
+		Diff.DisplayString = FDiffHelper::FormatDisplayString(Diff.Type, GetNodeTitle(OldNode));
+		Diff.DisplayColor = FDiffHelper::GetDisplayColor(Diff.Type);
 	}
 
 	Results.Add(Diff);
 }
 
-void DiffR_NodeCommentChanged(FMergeDiffResults& Results, UEdGraphNode* OldNode, UEdGraphNode* NewNode)
+void DiffR_NodeCommentChanged(FMergeDiffSink& Results, UEdGraphNode* OldNode, UEdGraphNode* NewNode)
 {
 	FMergeDiffResult Diff = {};
 	Diff.Type    = EMergeDiffType::NODE_COMMENT;
 	Diff.NodeOld = OldNode;
 	Diff.NodeNew = NewNode;
 
-	// Only generate the display data if it will be stored
-	if (Results.CanStoreResults())
+	// Only generate the display data if it will be used
+	if (Results.NeedsDisplayData())
 	{
-		Diff.DisplayString = FText::FormatOrdered(LOCTEXT("DDS_NodeCommentChanged", "Comment Changed Node '{0}'"), GetNodeTitle(OldNode));
-		Diff.DisplayColor = FLinearColor(0.25f,0.4f,0.5f);
+		Diff.DisplayString = FDiffHelper::FormatDisplayString(Diff.Type, GetNodeTitle(OldNode));
+		Diff.DisplayColor = FDiffHelper::GetDisplayColor(Diff.Type);
 	}
 
 	Results.Add(Diff);
@@ -28,6 +28,12 @@ enum struct EMergeDiffType
 	NODE_MOVED,
 	NODE_COMMENT,
 
+	// Changes to a graph as a whole, these are always listed before the changes to its nodes. They come last so
+	// the values of the other types, which are stored in merge sessions, stay the same
+	GRAPH_ADDED,
+	GRAPH_REMOVED,
+	GRAPH_CHANGED,	// The graph was kept and changed by one side, while the other side removed it
+
 	// Currently only used when internal properties changed
 	// we can't resolve them, but would be nice to show when this is the case
 	// used by UAIGraphNode, and UK2Node_MathExpression
@@ -40,6 +46,9 @@ enum struct ENodeMatchStrategy
 	EXACT = 1 << 0,
 	APPROXIMATE = 1 << 1,
 
+	// Matches unmatched nodes through the links of nodes which are already matched, runs before APPROXIMATE
+	PROPAGATE = 1 << 2,
+
 	ALL = -1
 };
 
@@ -108,32 +117,106 @@ struct FMergeDiffResult
 	FLinearColor DisplayColor;
 };
 
-class FMergeDiffResults
+// Receives the diffs as FDiffHelper finds them, so callers only pay for what they use
+class FMergeDiffSink
 {
 public:
-	FMergeDiffResults(TArray<FMergeDiffResult>* ResultsOut = nullptr)
-		: ResultArray(ResultsOut)
-		, NumDiffsFound(0) 
-	{}
+	virtual ~FMergeDiffSink() {}
 
 	void Add(const FMergeDiffResult& Result)
 	{
 		if (Result.Type == EMergeDiffType::NO_DIFFERENCE) return;
 
 		NumDiffsFound++;
-
-		if (ResultArray) ResultArray->Add(Result);
+		OnDiff(Result);
 	}
 
-	bool CanStoreResults() const { return ResultArray != nullptr; }
-
-	int32 NumStored() const { return ResultArray ? ResultArray->Num() : 0; }
 	int32 NumFound() const { return NumDiffsFound; }
 	bool HasFoundDiffs() const { return NumDiffsFound > 0; }
 
+	// The display text of a diff is only formatted for sinks which use it
+	virtual bool NeedsDisplayData() const { return false; }
+
+	// Once a sink is done the diff stops as soon as possible, so the remaining diffs are never found.
+	// Diffs of the same node or pin can still be added after a sink is done
+	virtual bool IsDone() const { return false; }
+
+protected:
+	virtual void OnDiff(const FMergeDiffResult& Result) {}
+
+private:
+	int32 NumDiffsFound = 0;
+};
+
+// Only counts the diffs
+class FMergeDiffCounter : public FMergeDiffSink
+{
+};
+
+// Counts the diffs up to a maximum, used to check whether there are more diffs than some amount
+class FMergeDiffBoundedCounter : public FMergeDiffSink
+{
+public:
+	explicit FMergeDiffBoundedCounter(int32 InMaxDiffs) : MaxDiffs(InMaxDiffs) {}
+
+	bool IsDone() const override { return NumFound() >= MaxDiffs; }
+
+private:
+	int32 MaxDiffs;
+};
+
+// Stops at the first diff, used to check whether two graphs are different at all
+class FMergeDiffAnyDifference : public FMergeDiffBoundedCounter
+{
+public:
+	FMergeDiffAnyDifference() : FMergeDiffBoundedCounter(1) {}
+};
+
+// Counts the diffs of each type
+class FMergeDiffHistogram : public FMergeDiffSink
+{
+public:
+	int32 GetCount(EMergeDiffType Type) const
+	{
+		const int32 Index = static_cast<int32>(Type);
+		return Counts.IsValidIndex(Index) ? Counts[Index] : 0;
+	}
+
+protected:
+	void OnDiff(const FMergeDiffResult& Result) override
+	{
+		const int32 Index = static_cast<int32>(Result.Type);
+		if (Counts.Num() <= Index) Counts.SetNumZeroed(Index + 1);
+
+		Counts[Index]++;
+	}
+
+private:
+	TArray<int32> Counts;
+};
+
+// Stores the diffs together with their display data, optionally only the first MaxDiffs of them
+class FMergeDiffCollector : public FMergeDiffSink
+{
+public:
+	explicit FMergeDiffCollector(TArray<FMergeDiffResult>& InResults, int32 InMaxDiffs = MAX_int32)
+		: Results(InResults)
+		, MaxDiffs(InMaxDiffs)
+	{}
+
+	bool NeedsDisplayData() const override { return true; }
+	bool IsDone() const override { return NumFound() >= MaxDiffs; }
+
+protected:
+	void OnDiff(const FMergeDiffResult& Result) override
+	{
+		// The diff can find a few more diffs before it stops
+		if (NumFound() <= MaxDiffs) Results.Add(Result);
+	}
+
 private:
-	TArray<FMergeDiffResult>* ResultArray;
-	int32 NumDiffsFound;
+	TArray<FMergeDiffResult>& Results;
+	int32 MaxDiffs;
 };
 
 struct FDiffHelper
@@ -141,7 +224,7 @@ struct FDiffHelper
 	static void DiffGraphs(
 		UEdGraph* OldGraph,
 		UEdGraph* NewGraph,
-		FMergeDiffResults& DiffsOut,
+		FMergeDiffSink& DiffsOut,
 		ENodeMatchStrategy MatchStrategy = ENodeMatchStrategy::ALL,
 		TArray<FNodeMatch>* NodeMatchesOut = nullptr,
 		TArray<UEdGraphNode*>* UnmatchedOldNodesOut = nullptr,
@@ -150,17 +233,17 @@ struct FDiffHelper
 	static void DiffNodes(
 		UEdGraphNode* OldNode, 
 		UEdGraphNode* NewNode, 
-		FMergeDiffResults& DiffsOut);
+		FMergeDiffSink& DiffsOut);
 
 	static void DiffPins(
 		UEdGraphPin* OldPin,
 		UEdGraphPin* NewPin,
-		FMergeDiffResults& DiffsOut);
+		FMergeDiffSink& DiffsOut);
 
 	static void DiffLinks(
 		const FGraphLink& OldLink,
 		const FGraphLink& NewLink,
-		FMergeDiffResults& DiffsOut);
+		FMergeDiffSink& DiffsOut);
 
 	static bool IsExactNodeMatch(const UEdGraphNode* OldNode, const UEdGraphNode* NewNode);
 
@@ -188,6 +271,25 @@ struct FDiffHelper
 		TArray<UEdGraphNode*>& UnmatchedNewNodes
 	);
 
+	// Propagates the seed matches along the links of the graphs, see PropagateNodeMatch
+	static TArray<FNodeMatch> FindPropagatedNodeMatches(
+		const TArray<FNodeMatch>& SeedMatches,
+		TArray<UEdGraphNode*>& UnmatchedOldNodes,
+		TArray<UEdGraphNode*>& UnmatchedNewNodes
+	);
+
+	// Matches the unmatched neighbours of a pair of matched nodes. A neighbour linked to a matched pin is matched
+	// when it is the only node of its type linked to that pin through a pin of the same name, in both graphs.
+	// Nodes with the same title are told apart by what they are connected to, before any pairs are scored
+	static void PropagateNodeMatch(
+		const FNodeMatch& Match,
+		TFunctionRef<bool(UEdGraphNode*)> IsOldNodeUnmatched,
+		TFunctionRef<bool(UEdGraphNode*)> IsNewNodeUnmatched,
+		TFunctionRef<void(UEdGraphNode*, UEdGraphNode*)> AddMatch
+	);
+
+	// Matches the nodes of each type one after another. The node titles are built and cached by the nodes
+	// themselves, which is not thread safe, FGraphSnapshotDiff matches the types of a snapshot in parallel
 	static TArray<FNodeMatch> FindApproximateNodeMatches(
 		TArray<UEdGraphNode*>& UnmatchedOldNodes,
 		TArray<UEdGraphNode*>& UnmatchedNewNodes
@@ -200,4 +302,93 @@ struct FDiffHelper
 	
 	// Matches the nodes based on exact match, or class and title
 	static bool WeakNodeMatch(UEdGraphNode* OldNode, UEdGraphNode* NewNode);
+
+	// Display data of the diffs. The arguments depend on the type: the node title for node diffs, the pin name and
+	// node title for pin diffs, the source and target node titles for link diffs, and the pin name followed by
+	// the old and new default value for PIN_DEFAULT_VALUE
+	static FText FormatDisplayString(EMergeDiffType Type, const FText& A, const FText& B = FText::GetEmpty(), const FText& C = FText::GetEmpty());
+	static FLinearColor GetDisplayColor(EMergeDiffType Type);
+};
+
+// Resumable version of FDiffHelper::DiffGraphs, which does the work in small steps so it can be spread
+// over multiple frames. Since it touches the UObjects of the graphs it should only be stepped on the game thread
+struct FIncrementalGraphDiff
+{
+	enum struct EPhase
+	{
+		ExactMatching = 0,
+		PropagateMatching,
+		GatherNodeTypes,
+		ApproximateMatching,
+		DiffMatchedNodes,
+		DiffUnmatchedNodes,
+		Done
+	};
+
+	FIncrementalGraphDiff(UEdGraph* OldGraph, UEdGraph* NewGraph, ENodeMatchStrategy MatchStrategy = ENodeMatchStrategy::ALL);
+
+	// Does work until the deadline, in FPlatformTime::Seconds, has passed. Returns true once the diff is done.
+	// A single bucket of approximate matches is never split, so a step can overrun the deadline by one bucket
+	bool Step(double Deadline);
+	bool IsDone() const { return Phase == EPhase::Done; }
+	EPhase GetPhase() const { return Phase; }
+
+	// Results, these are complete once the diff is done
+	TArray<FMergeDiffResult> Diffs;
+	TArray<FNodeMatch> NodeMatches;
+	TArray<UEdGraphNode*> UnmatchedOldNodes;
+	TArray<UEdGraphNode*> UnmatchedNewNodes;
+
+private:
+	// Nodes which are approximately matched need to have the same class and title
+	struct FNodeTypeKey
+	{
+		UClass* Class;
+		FString Title;
+
+		bool operator==(const FNodeTypeKey& Other) const { return Class == Other.Class && Title == Other.Title; }
+		friend uint32 GetTypeHash(const FNodeTypeKey& Key) { return HashCombine(::GetTypeHash(Key.Class), ::GetTypeHash(Key.Title)); }
+	};
+
+	struct FNodeTypeBucket
+	{
+		TArray<UEdGraphNode*> OldNodes;
+		TArray<UEdGraphNode*> NewNodes;
+	};
+
+	// Each of these work on their phase until it is done, or the deadline has passed
+	void StepExactMatching(double Deadline);
+	void StepPropagateMatching(double Deadline);
+	void StepGatherNodeTypes(double Deadline);
+	void StepApproximateMatching(double Deadline);
+	void StepDiffMatchedNodes(double Deadline);
+	void StepDiffUnmatchedNodes(double Deadline);
+
+	bool HasTimeLeft(double Deadline);
+	void AddMatch(int32 OldIndex, int32 NewIndex);
+	void BeginPhase(EPhase NextPhase);
+
+	UEdGraph* OldGraph;
+	UEdGraph* NewGraph;
+	ENodeMatchStrategy MatchStrategy;
+
+	EPhase Phase;
+	bool bHasProgressed = false;
+
+	// Index of the next node to process in the current phase, and the next bucket during approximate matching
+	int32 NodeIndex = 0;
+	int32 BucketIndex = 0;
+
+	// Which nodes of both graphs have been matched, indexed like the Nodes array of the graph
+	TBitArray<> OldMatched;
+	TBitArray<> NewMatched;
+	TMap<UEdGraphNode*, int32> OldNodeIndices;
+	TMap<UEdGraphNode*, int32> NewNodeIndices;
+
+	// New nodes by guid and name, used to find exact matches without comparing every pair of nodes
+	TMultiMap<FGuid, int32> NewNodesByGuid;
+	TMultiMap<FName, int32> NewNodesByName;
+
+	TArray<FNodeTypeBucket> Buckets;
+	TMap<FNodeTypeKey, int32> BucketIndices;
 };
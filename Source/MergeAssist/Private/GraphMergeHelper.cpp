@@ -1,9 +1,18 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "GraphMergeHelper.h"
+#include "MergeAssist.h"
+#include "MergeAssistStats.h"
+#include "MergeAssistSettings.h"
+#include "MergeTransactionState.h"
+#include "UnionFind.h"
 
+#include "Engine/Blueprint.h"
 #include "EdGraph/EdGraph.h"
 #include "EdGraphUtilities.h"
+#include "ScopedTransaction.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
 
 #define LOCTEXT_NAMESPACE "GraphMergeHelper"
 
@@ -23,6 +32,8 @@ static UEdGraphPin* SafeFindPin(UEdGraphNode* Node, UEdGraphPin* Pin)
 
 static void CloneGraphIntoGraph(UEdGraph* FromGraph, UEdGraph* TargetGraph, TMap<UEdGraphNode*, UEdGraphNode*>& NodeMappingOut)
 {
+	MERGEASSIST_SCOPE(CloneGraphIntoGraph, Cloning);
+
 	// Clear the target graph
 	while(TargetGraph->Nodes.Num()) TargetGraph->RemoveNode(TargetGraph->Nodes[0]);
 
@@ -46,21 +57,95 @@ static void CloneGraphIntoGraph(UEdGraph* FromGraph, UEdGraph* TargetGraph, TMap
 		NodeMappingOut.Add(BaseNode, NewNode);
 	}
 
+	// The graphs of collapsed nodes are owned by their node, so they are moved along with the nodes
+	TargetGraph->SubGraphs = MoveTemp(TmpGraph->SubGraphs);
+
 	// Notify the target graph that it was changed
 	TargetGraph->NotifyGraphChanged();
 }
 
-static TArray<TSharedPtr<MergeGraphChange>> GenerateChangeList(const TArray<FMergeDiffResult>& RemoteDifferences, const TArray<FMergeDiffResult>& LocalDifferences)
+TArray<UEdGraph*>* FindMatchingGraphList(UBlueprint* Blueprint, const UEdGraph* SourceGraph)
+{
+	const UBlueprint* SourceBlueprint = Cast<UBlueprint>(SourceGraph->GetOuter());
+	if (!Blueprint || !SourceBlueprint) return nullptr;
+
+	if (SourceBlueprint->UbergraphPages.Contains(SourceGraph)) return &Blueprint->UbergraphPages;
+	if (SourceBlueprint->FunctionGraphs.Contains(SourceGraph)) return &Blueprint->FunctionGraphs;
+	if (SourceBlueprint->MacroGraphs.Contains(SourceGraph)) return &Blueprint->MacroGraphs;
+	if (SourceBlueprint->DelegateSignatureGraphs.Contains(SourceGraph)) return &Blueprint->DelegateSignatureGraphs;
+
+	// The graphs of implemented interfaces only exist together with the interface
+	return nullptr;
+}
+
+// Whether the remote and local side made exactly the same change, these are not a conflict. Changes to
+// nodes which only exist in the remote or local graph are matched through their base node
+static bool AreIdenticalDiffs(
+	const FMergeDiffResult& RemoteDiff,
+	const FMergeDiffResult& LocalDiff,
+	const TMap<UEdGraphNode*, UEdGraphNode*>& RemoteToBaseNodeMap,
+	const TMap<UEdGraphNode*, UEdGraphNode*>& LocalToBaseNodeMap)
+{
+	if (RemoteDiff.Type != LocalDiff.Type) return false;
+
+	switch (RemoteDiff.Type)
+	{
+	case EMergeDiffType::NODE_REMOVED:
+		return RemoteDiff.NodeOld == LocalDiff.NodeOld;
+	case EMergeDiffType::PIN_REMOVED:
+		return RemoteDiff.PinOld == LocalDiff.PinOld;
+	case EMergeDiffType::PIN_DEFAULT_VALUE:
+		return RemoteDiff.PinOld == LocalDiff.PinOld
+			&& RemoteDiff.PinNew->DefaultValue == LocalDiff.PinNew->DefaultValue
+			&& RemoteDiff.PinNew->DefaultObject == LocalDiff.PinNew->DefaultObject
+			&& RemoteDiff.PinNew->DefaultTextValue.EqualTo(LocalDiff.PinNew->DefaultTextValue);
+	case EMergeDiffType::LINK_REMOVED:
+		return RemoteDiff.PinOld == LocalDiff.PinOld && RemoteDiff.LinkTargetOld == LocalDiff.LinkTargetOld;
+	case EMergeDiffType::LINK_ADDED:
+	{
+		if (RemoteDiff.PinOld != LocalDiff.PinOld) return false;
+		if (RemoteDiff.LinkTargetOld || LocalDiff.LinkTargetOld) return RemoteDiff.LinkTargetOld == LocalDiff.LinkTargetOld;
+
+		UEdGraphNode* RemoteTarget = RemoteToBaseNodeMap.FindRef(RemoteDiff.LinkTargetNew->GetOwningNode());
+		UEdGraphNode* LocalTarget = LocalToBaseNodeMap.FindRef(LocalDiff.LinkTargetNew->GetOwningNode());
+		return RemoteTarget && RemoteTarget == LocalTarget && RemoteDiff.LinkTargetNew->PinName == LocalDiff.LinkTargetNew->PinName;
+	}
+	case EMergeDiffType::NODE_MOVED:
+		return RemoteDiff.NodeOld == LocalDiff.NodeOld
+			&& RemoteDiff.NodeNew->NodePosX == LocalDiff.NodeNew->NodePosX
+			&& RemoteDiff.NodeNew->NodePosY == LocalDiff.NodeNew->NodePosY;
+	case EMergeDiffType::NODE_COMMENT:
+		return RemoteDiff.NodeOld == LocalDiff.NodeOld && RemoteDiff.NodeNew->NodeComment == LocalDiff.NodeNew->NodeComment;
+	default:
+		return false;
+	}
+}
+
+static TArray<TSharedPtr<MergeGraphChange>> GenerateChangeList(
+	const TArray<FMergeDiffResult>& RemoteDifferences,
+	const TArray<FMergeDiffResult>& LocalDifferences,
+	const TMap<UEdGraphNode*, UEdGraphNode*>& RemoteToBaseNodeMap,
+	const TMap<UEdGraphNode*, UEdGraphNode*>& LocalToBaseNodeMap)
 {
+	MERGEASSIST_SCOPE(GenerateChangeList, GenerateChangeList);
+
 	TMap<const FMergeDiffResult*, const FMergeDiffResult*> ConflictMap;
 
+	// Remote and local diffs which made the same change, only the remote change is kept for these
+	TSet<const FMergeDiffResult*> IdenticalDiffs;
+
 	// Generate a mapping of all conflicts
 	for (const auto& RemoteDiff : RemoteDifferences)
 	{
+		// Added nodes and pins do not exist in the base graph, so there is nothing they can conflict with
+		if (!RemoteDiff.NodeOld && !RemoteDiff.PinOld) continue;
+
 		const FMergeDiffResult* ConflictingDifference = nullptr;
 
 		for (const auto& LocalDiff : LocalDifferences)
 		{
+			bool bIsConflict = false;
+
 			// The conflict detection code is based on the code from SMergeGraphView.cpp
 			// However it seems that both are affected by some of the inconsistencies in
 			// the FGraphDiffControl::DiffGraphs implementation
@@ -69,25 +154,34 @@ static TArray<TSharedPtr<MergeGraphChange>> GenerateChangeList(const TArray<FMer
 				const bool bIsRemoveDiff = RemoteDiff.Type == EMergeDiffType::NODE_REMOVED || LocalDiff.Type == EMergeDiffType::NODE_REMOVED;
 				const bool bIsNodeMoveDiff = RemoteDiff.Type == EMergeDiffType::NODE_MOVED || LocalDiff.Type == EMergeDiffType::NODE_MOVED;
 
+				// A node can be moved together with any other change to it, but only to a single position
+				const bool bAreBothMoveDiffs = RemoteDiff.Type == EMergeDiffType::NODE_MOVED && LocalDiff.Type == EMergeDiffType::NODE_MOVED;
+
 				// Check if both diffs effect the same pin, note that Pin1 can be set to nullptr
 				// in this case the change effects the entire node, which for our purposes is the 
 				// same as if they would be effecting the same pin
 				const bool bAreEffectingSamePin = RemoteDiff.PinOld == LocalDiff.PinOld;
 
-				if ((bIsRemoveDiff || bAreEffectingSamePin) && !bIsNodeMoveDiff)
-				{
-					ConflictingDifference = &LocalDiff;
-					break;
-				}
+				bIsConflict = (bIsRemoveDiff || bAreEffectingSamePin) && (!bIsNodeMoveDiff || bAreBothMoveDiffs);
 			}
 			else if (RemoteDiff.PinOld != nullptr && (RemoteDiff.PinOld == LocalDiff.PinOld))
 			{
-				// it's possible the users made the same change to the same pin, but given the wide
-				// variety of changes that can be made to a pin it is difficult to identify the change 
-				// as identical, for now I'm just flagging all changes to the same pin as a conflict:
-				ConflictingDifference = &LocalDiff;
-				break;
+				// Changes to the same pin conflict, unless both users made exactly the same change
+				bIsConflict = true;
+			}
+
+			if (!bIsConflict) continue;
+
+			// The remote change covers identical local changes, but can still conflict with other local changes
+			if (AreIdenticalDiffs(RemoteDiff, LocalDiff, RemoteToBaseNodeMap, LocalToBaseNodeMap))
+			{
+				IdenticalDiffs.Add(&RemoteDiff);
+				IdenticalDiffs.Add(&LocalDiff);
+				continue;
 			}
+
+			ConflictingDifference = &LocalDiff;
+			break;
 		}
 
 		if (ConflictingDifference != nullptr)
@@ -108,6 +202,11 @@ static TArray<TSharedPtr<MergeGraphChange>> GenerateChangeList(const TArray<FMer
 				FText::Format(LOCTEXT("ConflictIdentifier", "CONFLICT: '{0}' conflicts with '{1}'"), 
 					(*ConflictingDiff)->DisplayString, Diff.DisplayString) ;
 
+			if (!ConflictingDiff && IdenticalDiffs.Contains(&Diff))
+			{
+				Label = FText::Format(LOCTEXT("IdenticalChange", "{0} (same in local)"), Diff.DisplayString);
+			}
+
 			auto NewEntry = TSharedPtr<MergeGraphChange>(new MergeGraphChange());
 			NewEntry->Label = Label;
 			NewEntry->DisplayColor = Diff.DisplayColor;
@@ -124,7 +223,7 @@ static TArray<TSharedPtr<MergeGraphChange>> GenerateChangeList(const TArray<FMer
 			const FMergeDiffResult** ConflictingDiff = ConflictMap.Find(&Diff);
 
 			// Since we already handled all the conflicts we can skip them for now
-			if (!ConflictingDiff)
+			if (!ConflictingDiff && !IdenticalDiffs.Contains(&Diff))
 			{
 				auto NewEntry = TSharedPtr<MergeGraphChange>(new MergeGraphChange());
 				NewEntry->Label = Diff.DisplayString;
@@ -139,186 +238,1892 @@ static TArray<TSharedPtr<MergeGraphChange>> GenerateChangeList(const TArray<FMer
 		}
 	}
 
-	// Sort the combined list of all changes, this ensure that the order in which they are displayed 
-	// to the user is maintained
-	struct SortChangeByDisplayOrder
+	// Sort the combined list of all changes, this ensure that the order in which they are displayed 
+	// to the user is maintained
+	struct SortChangeByDisplayOrder
+	{
+		bool operator() (const TSharedPtr<MergeGraphChange>& A, const TSharedPtr<MergeGraphChange>& B) const
+		{
+			const EMergeDiffType AType = A->RemoteDiff.Type != EMergeDiffType::NO_DIFFERENCE ? A->RemoteDiff.Type : A->LocalDiff.Type;
+			const EMergeDiffType BType = B->RemoteDiff.Type != EMergeDiffType::NO_DIFFERENCE ? B->RemoteDiff.Type : B->LocalDiff.Type;
+
+			return AType < BType;
+		}
+	};
+
+	Sort(Ret.GetData(), Ret.Num(), SortChangeByDisplayOrder());
+	
+	return Ret;
+}
+
+// Order in which the sub changes of a composite change are applied, they are reverted in the opposite
+// order. Nodes need to exist before anything can link to them, and links to a removed node can only be
+// found before the node itself is removed
+static int32 GetApplyOrder(EMergeDiffType Type)
+{
+	switch (Type)
+	{
+	case EMergeDiffType::NODE_ADDED:        return 0;
+	case EMergeDiffType::PIN_ADDED:         return 1;
+	case EMergeDiffType::PIN_DEFAULT_VALUE: return 2;
+	case EMergeDiffType::LINK_REMOVED:      return 3;
+	case EMergeDiffType::LINK_ADDED:        return 4;
+	case EMergeDiffType::PIN_REMOVED:       return 5;
+	case EMergeDiffType::NODE_MOVED:        return 6;
+	case EMergeDiffType::NODE_COMMENT:      return 7;
+	case EMergeDiffType::NODE_REMOVED:      return 8;
+	default: return 9;
+	}
+}
+
+// The diff of a change which is not conflicting, only one of the diffs is set for these
+static const FMergeDiffResult& GetChangeDiff(const MergeGraphChange& Change)
+{
+	return Change.RemoteDiff.Type != EMergeDiffType::NO_DIFFERENCE ? Change.RemoteDiff : Change.LocalDiff;
+}
+
+// The diff which is applied to put a sub change of a composite change into the given state. Sub changes of conflict
+// groups have a diff for both sides, or none for a side when another conflict in the group already has it
+static const FMergeDiffResult& GetSubChangeDiff(const MergeGraphChange& SubChange, EMergeState State)
+{
+	static const FMergeDiffResult NoDifference{};
+
+	if (State == EMergeState::Remote) return SubChange.RemoteDiff;
+	if (State == EMergeState::Local) return SubChange.LocalDiff;
+	return NoDifference;
+}
+
+// Indices of the sub changes of a composite change, in the order in which they are applied to get it into the given
+// state. For composites of a single side this is the order of the sub changes themselves
+static TArray<int32> GetSubChangeApplyOrder(const MergeGraphChange& Change, EMergeState State)
+{
+	TArray<int32> Order;
+	Order.Reserve(Change.SubChanges.Num());
+	for (int32 i = 0; i < Change.SubChanges.Num(); ++i) Order.Add(i);
+
+	Order.StableSort([&Change, State](int32 A, int32 B)
+	{
+		return GetApplyOrder(GetSubChangeDiff(*Change.SubChanges[A], State).Type) < GetApplyOrder(GetSubChangeDiff(*Change.SubChanges[B], State).Type);
+	});
+
+	return Order;
+}
+
+// Moves of blocks of nodes, e.g. by dragging a selection or auto arranging, result in a move for each node.
+// Nodes of one side which are moved by exactly the same offset are grouped into a single composite change,
+// and moves which are shorter than the minimum distance are ignored altogether
+static TArray<TSharedPtr<MergeGraphChange>> GroupRigidMoves(const TArray<TSharedPtr<MergeGraphChange>>& ChangeList, const UMergeAssistSettings& Settings)
+{
+	MERGEASSIST_SCOPE(GroupRigidMoves, GenerateChangeList);
+
+	const auto IsMove = [](const MergeGraphChange& Change)
+	{
+		return !Change.bHasConflicts && GetChangeDiff(Change).Type == EMergeDiffType::NODE_MOVED;
+	};
+
+	const auto GetOffset = [](const FMergeDiffResult& Diff)
+	{
+		return FIntPoint(Diff.NodeNew->NodePosX - Diff.NodeOld->NodePosX, Diff.NodeNew->NodePosY - Diff.NodeOld->NodePosY);
+	};
+
+	// Moves of each side grouped by their offset, in the display order of the change list
+	TMap<FIntPoint, TArray<TSharedPtr<MergeGraphChange>>> MoveGroups[2];
+	TSet<const MergeGraphChange*> IgnoredMoves;
+
+	for (const auto& Change : ChangeList)
+	{
+		if (!IsMove(*Change)) continue;
+
+		const FIntPoint Offset = GetOffset(GetChangeDiff(*Change));
+		if (FMath::Sqrt(static_cast<float>(Offset.SizeSquared())) < Settings.MinMoveDistance)
+		{
+			IgnoredMoves.Add(Change.Get());
+			continue;
+		}
+
+		const int32 Side = Change->RemoteDiff.Type != EMergeDiffType::NO_DIFFERENCE ? 0 : 1;
+		MoveGroups[Side].FindOrAdd(Offset).Add(Change);
+	}
+
+	TArray<TSharedPtr<MergeGraphChange>> Ret;
+	Ret.Reserve(ChangeList.Num());
+
+	for (const auto& Change : ChangeList)
+	{
+		if (!IsMove(*Change))
+		{
+			Ret.Add(Change);
+			continue;
+		}
+
+		if (IgnoredMoves.Contains(Change.Get())) continue;
+
+		const FMergeDiffResult& Diff = GetChangeDiff(*Change);
+		const int32 Side = Change->RemoteDiff.Type != EMergeDiffType::NO_DIFFERENCE ? 0 : 1;
+		const FIntPoint Offset = GetOffset(Diff);
+		TArray<TSharedPtr<MergeGraphChange>>& Group = MoveGroups[Side].FindChecked(Offset);
+
+		if (!Settings.bDetectRigidMoves || Group.Num() < Settings.MinRigidMoveNodes)
+		{
+			Ret.Add(Change);
+			continue;
+		}
+
+		// Groups are shown at the position of their first move
+		if (Group[0] != Change) continue;
+
+		auto Composite = TSharedPtr<MergeGraphChange>(new MergeGraphChange());
+		Composite->Label = FText::Format(LOCTEXT("RigidMove", "Moved {0} nodes by ({1}, {2})"), Group.Num(), Offset.X, Offset.Y);
+		Composite->DisplayColor = Change->DisplayColor;
+		Composite->RemoteDiff = Change->RemoteDiff;
+		Composite->LocalDiff = Change->LocalDiff;
+		Composite->bHasConflicts = false;
+		Composite->SubChanges = Group;
+
+		Ret.Add(Composite);
+	}
+
+	return Ret;
+}
+
+// Identifies a link between two nodes, both ends of a link report the same change to it
+struct FClusterLinkKey
+{
+	int32 Side;
+	EMergeDiffType Type;
+	UEdGraphNode* OutputNode;
+	FName OutputPin;
+	UEdGraphNode* InputNode;
+	FName InputPin;
+
+	bool operator==(const FClusterLinkKey& Other) const
+	{
+		return Side == Other.Side && Type == Other.Type
+			&& OutputNode == Other.OutputNode && OutputPin == Other.OutputPin
+			&& InputNode == Other.InputNode && InputPin == Other.InputPin;
+	}
+
+	friend uint32 GetTypeHash(const FClusterLinkKey& Key)
+	{
+		uint32 Hash = HashCombine(GetTypeHash(Key.OutputNode), GetTypeHash(Key.OutputPin));
+		Hash = HashCombine(Hash, HashCombine(GetTypeHash(Key.InputNode), GetTypeHash(Key.InputPin)));
+		return HashCombine(Hash, static_cast<uint32>(Key.Type) * 2 + Key.Side);
+	}
+};
+
+// Identifies a diff of one side by the nodes and pins it points at, without touching them
+struct FMergeDiffKey
+{
+	FMergeDiffKey(int32 InSide, const FMergeDiffResult& Diff)
+		: Side(InSide), Type(Diff.Type)
+		, NodeOld(Diff.NodeOld), NodeNew(Diff.NodeNew)
+		, PinOld(Diff.PinOld), PinNew(Diff.PinNew)
+		, LinkTargetOld(Diff.LinkTargetOld), LinkTargetNew(Diff.LinkTargetNew)
+	{}
+
+	int32 Side;
+	EMergeDiffType Type;
+	const void* NodeOld;
+	const void* NodeNew;
+	const void* PinOld;
+	const void* PinNew;
+	const void* LinkTargetOld;
+	const void* LinkTargetNew;
+
+	bool operator==(const FMergeDiffKey& Other) const
+	{
+		return Side == Other.Side && Type == Other.Type
+			&& NodeOld == Other.NodeOld && NodeNew == Other.NodeNew
+			&& PinOld == Other.PinOld && PinNew == Other.PinNew
+			&& LinkTargetOld == Other.LinkTargetOld && LinkTargetNew == Other.LinkTargetNew;
+	}
+
+	friend uint32 GetTypeHash(const FMergeDiffKey& Key)
+	{
+		uint32 Hash = HashCombine(GetTypeHash(Key.NodeOld), GetTypeHash(Key.NodeNew));
+		Hash = HashCombine(Hash, HashCombine(GetTypeHash(Key.PinOld), GetTypeHash(Key.PinNew)));
+		Hash = HashCombine(Hash, HashCombine(GetTypeHash(Key.LinkTargetOld), GetTypeHash(Key.LinkTargetNew)));
+		return HashCombine(Hash, static_cast<uint32>(Key.Type) * 2 + Key.Side);
+	}
+};
+
+// Groups the changes which are not conflicting into composite changes, by the node they belong to. Changes
+// to added or removed nodes are grouped together with the links to them, and connected nodes which are added
+// or removed are grouped together as well. This way each of these can be applied in a single operation
+static TArray<TSharedPtr<MergeGraphChange>> ClusterChanges(
+	const TArray<TSharedPtr<MergeGraphChange>>& ChangeList,
+	const TMap<UEdGraphNode*, UEdGraphNode*>& RemoteToBaseNodeMap,
+	const TMap<UEdGraphNode*, UEdGraphNode*>& LocalToBaseNodeMap)
+{
+	MERGEASSIST_SCOPE(ClusterChanges, GenerateChangeList);
+
+	// Conflicts are resolved on their own, and composite changes are already grouped
+	const auto IsClusterable = [](const MergeGraphChange& Change)
+	{
+		return !Change.bHasConflicts && !Change.SubChanges.Num();
+	};
+
+	const auto GetSide = [](const MergeGraphChange& Change)
+	{
+		return Change.RemoteDiff.Type != EMergeDiffType::NO_DIFFERENCE ? 0 : 1;
+	};
+
+	// Nodes are grouped by their base node where possible, so changes from the base and the remote
+	// or local graph end up together
+	const TMap<UEdGraphNode*, UEdGraphNode*>* const ToBaseNodeMaps[] = { &RemoteToBaseNodeMap, &LocalToBaseNodeMap };
+	const auto ToBase = [&ToBaseNodeMaps](UEdGraphNode* Node, int32 Side)
+	{
+		UEdGraphNode* const* BaseNode = ToBaseNodeMaps[Side]->Find(Node);
+		return BaseNode ? *BaseNode : Node;
+	};
+
+	// Added nodes are from the remote or local graph, removed nodes from the base graph
+	TSet<UEdGraphNode*> AddedOrRemovedNodes[2];
+	for (const auto& Change : ChangeList)
+	{
+		if (!IsClusterable(*Change)) continue;
+
+		const FMergeDiffResult& Diff = GetChangeDiff(*Change);
+		if (Diff.Type == EMergeDiffType::NODE_ADDED) AddedOrRemovedNodes[GetSide(*Change)].Add(Diff.NodeNew);
+		if (Diff.Type == EMergeDiffType::NODE_REMOVED) AddedOrRemovedNodes[GetSide(*Change)].Add(Diff.NodeOld);
+	}
+
+	FUnionFind Clusters(ChangeList.Num());
+	TMap<UEdGraphNode*, int32> NodeClusters[2];
+	TSet<FClusterLinkKey> SeenLinks;
+	TBitArray<> Duplicates(false, ChangeList.Num());
+
+	const auto AddToNodeCluster = [&Clusters, &NodeClusters](int32 Index, int32 Side, UEdGraphNode* Node)
+	{
+		if (const int32* Cluster = NodeClusters[Side].Find(Node)) Clusters.Union(*Cluster, Index);
+		else NodeClusters[Side].Add(Node, Index);
+	};
+
+	for (int32 Index = 0; Index < ChangeList.Num(); ++Index)
+	{
+		const MergeGraphChange& Change = *ChangeList[Index];
+		if (!IsClusterable(Change)) continue;
+
+		const int32 Side = GetSide(Change);
+		const FMergeDiffResult& Diff = GetChangeDiff(Change);
+
+		switch (Diff.Type)
+		{
+		case EMergeDiffType::NODE_ADDED:
+			AddToNodeCluster(Index, Side, Diff.NodeNew);
+			break;
+		case EMergeDiffType::NODE_REMOVED:
+		case EMergeDiffType::NODE_MOVED:
+		case EMergeDiffType::NODE_COMMENT:
+			AddToNodeCluster(Index, Side, Diff.NodeOld);
+			break;
+		case EMergeDiffType::PIN_ADDED:
+			AddToNodeCluster(Index, Side, ToBase(Diff.PinNew->GetOwningNode(), Side));
+			break;
+		case EMergeDiffType::PIN_REMOVED:
+		case EMergeDiffType::PIN_DEFAULT_VALUE:
+			AddToNodeCluster(Index, Side, Diff.PinOld->GetOwningNode());
+			break;
+		case EMergeDiffType::LINK_ADDED:
+		case EMergeDiffType::LINK_REMOVED:
+		{
+			UEdGraphPin* LinkTarget = Diff.Type == EMergeDiffType::LINK_ADDED ? Diff.LinkTargetNew : Diff.LinkTargetOld;
+			UEdGraphNode* TargetNode = LinkTarget->GetOwningNode();
+
+			// Links to added or removed nodes can only be applied together with the node
+			if (AddedOrRemovedNodes[Side].Contains(TargetNode))
+			{
+				AddToNodeCluster(Index, Side, TargetNode);
+				break;
+			}
+
+			// Otherwise both ends report the link, only keep the first report and group it with the node of the output pin
+			UEdGraphNode* SourceNode = Diff.PinOld->GetOwningNode();
+			TargetNode = ToBase(TargetNode, Side);
+
+			const bool bSourceIsOutput = Diff.PinOld->Direction == EGPD_Output;
+			const FClusterLinkKey Key = bSourceIsOutput
+				? FClusterLinkKey{ Side, Diff.Type, SourceNode, Diff.PinOld->PinName, TargetNode, LinkTarget->PinName }
+				: FClusterLinkKey{ Side, Diff.Type, TargetNode, LinkTarget->PinName, SourceNode, Diff.PinOld->PinName };
+
+			bool bAlreadySeen = false;
+			SeenLinks.Add(Key, &bAlreadySeen);
+
+			if (bAlreadySeen) Duplicates[Index] = true;
+			else AddToNodeCluster(Index, Side, bSourceIsOutput ? SourceNode : TargetNode);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	// Connected nodes which are added or removed are kept together
+	for (int32 Side = 0; Side < 2; ++Side)
+	{
+		for (UEdGraphNode* Node : AddedOrRemovedNodes[Side])
+		{
+			for (UEdGraphPin* Pin : Node->Pins)
+			{
+				for (UEdGraphPin* LinkedPin : Pin->LinkedTo)
+				{
+					UEdGraphNode* LinkedNode = LinkedPin ? LinkedPin->GetOwningNode() : nullptr;
+					if (!AddedOrRemovedNodes[Side].Contains(LinkedNode)) continue;
+
+					Clusters.Union(NodeClusters[Side].FindChecked(Node), NodeClusters[Side].FindChecked(LinkedNode));
+				}
+			}
+		}
+	}
+
+	// Gather the members of each cluster, in the display order of the change list
+	TMap<int32, TArray<TSharedPtr<MergeGraphChange>>> ClusterMembers;
+	for (int32 Index = 0; Index < ChangeList.Num(); ++Index)
+	{
+		if (!IsClusterable(*ChangeList[Index]) || Duplicates[Index]) continue;
+		ClusterMembers.FindOrAdd(Clusters.Find(Index)).Add(ChangeList[Index]);
+	}
+
+	TArray<TSharedPtr<MergeGraphChange>> Ret;
+	Ret.Reserve(ClusterMembers.Num());
+
+	for (int32 Index = 0; Index < ChangeList.Num(); ++Index)
+	{
+		if (Duplicates[Index]) continue;
+
+		// Clusters are shown at the position of their first, and most important, change
+		TArray<TSharedPtr<MergeGraphChange>>* Members = IsClusterable(*ChangeList[Index]) ? ClusterMembers.Find(Clusters.Find(Index)) : nullptr;
+		if (!Members || Members->Num() == 1)
+		{
+			Ret.Add(ChangeList[Index]);
+			continue;
+		}
+
+		if ((*Members)[0] != ChangeList[Index]) continue;
+
+		const MergeGraphChange& Primary = *(*Members)[0];
+
+		auto Composite = TSharedPtr<MergeGraphChange>(new MergeGraphChange());
+		Composite->Label = FText::Format(LOCTEXT("CompositeChange", "{0} (+{1} changes)"), Primary.Label, Members->Num() - 1);
+		Composite->DisplayColor = Primary.DisplayColor;
+		Composite->RemoteDiff = Primary.RemoteDiff;
+		Composite->LocalDiff = Primary.LocalDiff;
+		Composite->bHasConflicts = false;
+
+		Composite->SubChanges = MoveTemp(*Members);
+		Composite->SubChanges.StableSort([](const TSharedPtr<MergeGraphChange>& A, const TSharedPtr<MergeGraphChange>& B)
+		{
+			return GetApplyOrder(GetChangeDiff(*A).Type) < GetApplyOrder(GetChangeDiff(*B).Type);
+		});
+
+		Ret.Add(Composite);
+	}
+
+	return Ret;
+}
+
+// Groups the conflicts which touch the same base node, either directly, through one of its pins, or as the target
+// of a link, into conflict groups. These are the connected components of the conflict graph, and are resolved as a
+// whole by picking the same side for all of their conflicts
+static TArray<TSharedPtr<MergeGraphChange>> GroupConflicts(
+	const TArray<TSharedPtr<MergeGraphChange>>& ChangeList,
+	const TMap<UEdGraphNode*, UEdGraphNode*>& RemoteToBaseNodeMap,
+	const TMap<UEdGraphNode*, UEdGraphNode*>& LocalToBaseNodeMap)
+{
+	MERGEASSIST_SCOPE(GroupConflicts, GenerateChangeList);
+
+	const auto IsGroupable = [](const MergeGraphChange& Change)
+	{
+		return Change.bHasConflicts && !Change.SubChanges.Num();
+	};
+
+	const auto GetOwningNode = [](UEdGraphPin* Pin) { return Pin ? Pin->GetOwningNode() : nullptr; };
+
+	const TMap<UEdGraphNode*, UEdGraphNode*>* const ToBaseNodeMaps[] = { &RemoteToBaseNodeMap, &LocalToBaseNodeMap };
+	const auto ToBase = [&ToBaseNodeMaps](UEdGraphNode* Node, int32 Side)
+	{
+		UEdGraphNode* const* BaseNode = ToBaseNodeMaps[Side]->Find(Node);
+		return BaseNode ? *BaseNode : Node;
+	};
+
+	FUnionFind Groups(ChangeList.Num());
+	TMap<UEdGraphNode*, int32> NodeGroups;
+	int32 NumConflicts = 0;
+
+	const auto AddToNodeGroup = [&Groups, &NodeGroups](int32 Index, UEdGraphNode* Node)
+	{
+		if (!Node) return;
+
+		if (const int32* Group = NodeGroups.Find(Node)) Groups.Union(*Group, Index);
+		else NodeGroups.Add(Node, Index);
+	};
+
+	for (int32 Index = 0; Index < ChangeList.Num(); ++Index)
+	{
+		const MergeGraphChange& Change = *ChangeList[Index];
+		if (!IsGroupable(Change)) continue;
+
+		++NumConflicts;
+
+		const FMergeDiffResult* const Diffs[] = { &Change.RemoteDiff, &Change.LocalDiff };
+		for (int32 Side = 0; Side < 2; ++Side)
+		{
+			const FMergeDiffResult& Diff = *Diffs[Side];
+			AddToNodeGroup(Index, Diff.NodeOld ? Diff.NodeOld : GetOwningNode(Diff.PinOld));
+			AddToNodeGroup(Index, Diff.LinkTargetOld ? GetOwningNode(Diff.LinkTargetOld) : ToBase(GetOwningNode(Diff.LinkTargetNew), Side));
+		}
+	}
+
+	if (NumConflicts < 2) return ChangeList;
+
+	// Gather the members of each group, in the display order of the change list
+	TMap<int32, TArray<TSharedPtr<MergeGraphChange>>> GroupMembers;
+	for (int32 Index = 0; Index < ChangeList.Num(); ++Index)
+	{
+		if (IsGroupable(*ChangeList[Index])) GroupMembers.FindOrAdd(Groups.Find(Index)).Add(ChangeList[Index]);
+	}
+
+	TArray<TSharedPtr<MergeGraphChange>> Ret;
+	Ret.Reserve(ChangeList.Num());
+
+	for (int32 Index = 0; Index < ChangeList.Num(); ++Index)
+	{
+		TArray<TSharedPtr<MergeGraphChange>>* Members = IsGroupable(*ChangeList[Index]) ? GroupMembers.Find(Groups.Find(Index)) : nullptr;
+		if (!Members || Members->Num() == 1)
+		{
+			Ret.Add(ChangeList[Index]);
+			continue;
+		}
+
+		if ((*Members)[0] != ChangeList[Index]) continue;
+
+		// A diff of one side can conflict with multiple diffs of the other side, it is only kept by the first of
+		// these. Picking a side for the group then leaves the others in the base state
+		TSet<FMergeDiffKey> SeenDiffs;
+		for (const auto& Member : *Members)
+		{
+			bool bAlreadySeen = false;
+
+			SeenDiffs.Add(FMergeDiffKey(0, Member->RemoteDiff), &bAlreadySeen);
+			if (bAlreadySeen) Member->RemoteDiff = FMergeDiffResult{};
+
+			SeenDiffs.Add(FMergeDiffKey(1, Member->LocalDiff), &bAlreadySeen);
+			if (bAlreadySeen) Member->LocalDiff = FMergeDiffResult{};
+		}
+
+		const MergeGraphChange& Primary = *(*Members)[0];
+
+		auto Composite = TSharedPtr<MergeGraphChange>(new MergeGraphChange());
+		Composite->Label = FText::Format(LOCTEXT("ConflictGroup", "{0} (+{1} conflicts)"), Primary.Label, Members->Num() - 1);
+		Composite->DisplayColor = Primary.DisplayColor;
+		Composite->RemoteDiff = Primary.RemoteDiff;
+		Composite->LocalDiff = Primary.LocalDiff;
+		Composite->bHasConflicts = true;
+		Composite->SubChanges = MoveTemp(*Members);
+
+		Ret.Add(Composite);
+	}
+
+	return Ret;
+}
+
+// Sorts the diffs between a graph and its base graph, and converts the node matches into a node mapping
+static void FinishDifferences(TArray<FMergeDiffResult>& Results, const TArray<FNodeMatch>& NodeMatches, TMap<UEdGraphNode*, UEdGraphNode*>& NodeMappingOut)
+{
+	// Sort the results by the EMergeDiffType, this is the order in which the 
+	// different types should be displayed to the user
+	Sort(Results.GetData(), Results.Num(), 
+		[](const FMergeDiffResult& A, const FMergeDiffResult& B)
+	{
+		return A.Type < B.Type;
+	});
+
+	// Convert the node matches into a node mapping
+	// this can be used to later figure out which nodes we are talking about
+	for (const auto& NodeMatch : NodeMatches)
+	{
+		if (!NodeMatch.IsValid()) continue;
+
+		NodeMappingOut.Add(NodeMatch.NewNode, NodeMatch.OldNode);
+	}
+}
+
+// Runs the remote and local diffs through all the steps which turn them into changes
+static TArray<TSharedPtr<MergeGraphChange>> GenerateChanges(
+	const FSourceGraphDiffs& RemoteDifferences,
+	const FSourceGraphDiffs& LocalDifferences,
+	const TMap<UEdGraphNode*, UEdGraphNode*>& RemoteToBaseNodeMap,
+	const TMap<UEdGraphNode*, UEdGraphNode*>& LocalToBaseNodeMap)
+{
+	const UMergeAssistSettings& Settings = *GetDefault<UMergeAssistSettings>();
+
+	TArray<TSharedPtr<MergeGraphChange>> ChangeList = GenerateChangeList(RemoteDifferences.Diffs, LocalDifferences.Diffs, RemoteToBaseNodeMap, LocalToBaseNodeMap);
+	ChangeList = GroupRigidMoves(ChangeList, Settings);
+	ChangeList = ClusterChanges(ChangeList, RemoteToBaseNodeMap, LocalToBaseNodeMap);
+	return GroupConflicts(ChangeList, RemoteToBaseNodeMap, LocalToBaseNodeMap);
+}
+
+static bool HasConflictingChanges(const TArray<TSharedPtr<MergeGraphChange>>& ChangeList)
+{
+	for (const auto& Change : ChangeList)
+	{
+		if (Change->bHasConflicts) return true;
+	}
+
+	return false;
+}
+
+// Generates the change list from the remote and local diffs, the node mappings need to be set already
+static void FinishGraphMergeDiffs(FGraphMergeDiffs& Diffs, const TArray<FMergeDiffResult>& RemoteDifferences, const TArray<FMergeDiffResult>& LocalDifferences)
+{
+	for (const auto& Diff : RemoteDifferences) Diffs.RemoteDifferences.Add(Diff);
+	for (const auto& Diff : LocalDifferences) Diffs.LocalDifferences.Add(Diff);
+
+	Diffs.bHasRemoteChanges = RemoteDifferences.Num() != 0;
+	Diffs.bHasLocalChanges = LocalDifferences.Num() != 0;
+
+	Diffs.ChangeList = GenerateChanges(Diffs.RemoteDifferences, Diffs.LocalDifferences, Diffs.RemoteToBaseNodeMap, Diffs.LocalToBaseNodeMap);
+
+	// Check if any of the changes contain conflicts, if this is the case then 
+	// mark the graph as containing conflicts
+	Diffs.bHasConflicts = HasConflictingChanges(Diffs.ChangeList);
+}
+
+void FSourceGraphDiffs::Add(const FMergeDiffResult& Diff)
+{
+	const auto GetOwningNode = [](UEdGraphPin* Pin) { return Pin ? Pin->GetOwningNode() : nullptr; };
+
+	FMergeDiffNodes DiffNodes;
+	DiffNodes.Old = Diff.NodeOld ? Diff.NodeOld : GetOwningNode(Diff.PinOld);
+	DiffNodes.New = Diff.NodeNew ? Diff.NodeNew : GetOwningNode(Diff.PinNew);
+	DiffNodes.LinkTargetOld = GetOwningNode(Diff.LinkTargetOld);
+	DiffNodes.LinkTargetNew = GetOwningNode(Diff.LinkTargetNew);
+
+	Diffs.Add(Diff);
+	Nodes.Add(DiffNodes);
+}
+
+FGraphMergeDiffs FGraphMergeDiffs::Deferred()
+{
+	FGraphMergeDiffs Diffs;
+	Diffs.bIsDeferred = true;
+	return Diffs;
+}
+
+FGraphMergeDiffs FGraphMergeDiffs::FromDifferences(const TArray<FMergeDiffResult>& RemoteDifferences, const TArray<FMergeDiffResult>& LocalDifferences,
+	TMap<UEdGraphNode*, UEdGraphNode*>&& RemoteToBaseNodeMap, TMap<UEdGraphNode*, UEdGraphNode*>&& LocalToBaseNodeMap)
+{
+	FGraphMergeDiffs Diffs;
+	Diffs.RemoteToBaseNodeMap = MoveTemp(RemoteToBaseNodeMap);
+	Diffs.LocalToBaseNodeMap = MoveTemp(LocalToBaseNodeMap);
+
+	FinishGraphMergeDiffs(Diffs, RemoteDifferences, LocalDifferences);
+	return Diffs;
+}
+
+FGraphMergeDiffs FGraphMergeDiffs::Generate(UEdGraph* RemoteGraph, UEdGraph* BaseGraph, UEdGraph* LocalGraph)
+{
+	const auto GenerateDifferences = [](UEdGraph* NewGraph, UEdGraph* OldGraph, TMap<UEdGraphNode*, UEdGraphNode*>& NodeMappingOut)
+	{
+		TArray<FMergeDiffResult> Results;
+		FMergeDiffCollector DiffResults(Results);
+		TArray<FNodeMatch> NodeMatches;
+
+		// Diff the graphs, and collect both the diffs and node matches
+		FDiffHelper::DiffGraphs(OldGraph, NewGraph, DiffResults, ENodeMatchStrategy::ALL, &NodeMatches);
+
+		FinishDifferences(Results, NodeMatches, NodeMappingOut);
+		return Results;
+	};
+
+	FGraphMergeDiffs Diffs;
+
+	TArray<FMergeDiffResult> RemoteDifferences;
+	TArray<FMergeDiffResult> LocalDifferences;
+
+	if (RemoteGraph && BaseGraph)
+	{
+		RemoteDifferences = GenerateDifferences(RemoteGraph, BaseGraph, Diffs.RemoteToBaseNodeMap);
+	}
+
+	if (LocalGraph && BaseGraph)
+	{
+		LocalDifferences = GenerateDifferences(LocalGraph, BaseGraph, Diffs.LocalToBaseNodeMap);
+	}
+
+	FinishGraphMergeDiffs(Diffs, RemoteDifferences, LocalDifferences);
+	return Diffs;
+}
+
+FIncrementalGraphMergeDiffs::FIncrementalGraphMergeDiffs(UEdGraph* RemoteGraph, UEdGraph* BaseGraph, UEdGraph* LocalGraph)
+{
+	if (RemoteGraph && BaseGraph) RemoteDiff.Reset(new FIncrementalGraphDiff(BaseGraph, RemoteGraph));
+	if (LocalGraph && BaseGraph) LocalDiff.Reset(new FIncrementalGraphDiff(BaseGraph, LocalGraph));
+}
+
+bool FIncrementalGraphMergeDiffs::Step(double Deadline)
+{
+	if (RemoteDiff && !RemoteDiff->Step(Deadline)) return false;
+	if (LocalDiff && !LocalDiff->Step(Deadline)) return false;
+
+	return true;
+}
+
+FGraphMergeDiffs FIncrementalGraphMergeDiffs::Finish()
+{
+	check(IsDone());
+
+	FGraphMergeDiffs Diffs;
+
+	TArray<FMergeDiffResult> RemoteDifferences;
+	TArray<FMergeDiffResult> LocalDifferences;
+
+	if (RemoteDiff)
+	{
+		RemoteDifferences = MoveTemp(RemoteDiff->Diffs);
+		FinishDifferences(RemoteDifferences, RemoteDiff->NodeMatches, Diffs.RemoteToBaseNodeMap);
+	}
+
+	if (LocalDiff)
+	{
+		LocalDifferences = MoveTemp(LocalDiff->Diffs);
+		FinishDifferences(LocalDifferences, LocalDiff->NodeMatches, Diffs.LocalToBaseNodeMap);
+	}
+
+	FinishGraphMergeDiffs(Diffs, RemoteDifferences, LocalDifferences);
+	return Diffs;
+}
+
+FGraphMergeSnapshotDiffs::FGraphMergeSnapshotDiffs(UEdGraph* InRemoteGraph, UEdGraph* InBaseGraph, UEdGraph* InLocalGraph)
+	: RemoteGraph(InRemoteGraph)
+	, BaseGraph(InBaseGraph)
+	, LocalGraph(InLocalGraph)
+{
+	// Graphs without a base graph are not diffed, so there is no need to capture them
+	if (!BaseGraph) return;
+
+	BaseSnapshot = FGraphSnapshotCache::FindOrCapture(BaseGraph);
+	if (RemoteGraph) RemoteSnapshot = FGraphSnapshotCache::FindOrCapture(RemoteGraph);
+	if (LocalGraph) LocalSnapshot = FGraphSnapshotCache::FindOrCapture(LocalGraph);
+}
+
+void FGraphMergeSnapshotDiffs::Diff()
+{
+	if (RemoteSnapshot.IsValid() && RemoteSnapshot->IsValid() && BaseSnapshot->IsValid())
+	{
+		RemoteDiff.Reset(new FGraphSnapshotDiff(*BaseSnapshot, *RemoteSnapshot));
+		RemoteDiff->Diff();
+	}
+
+	if (LocalSnapshot.IsValid() && LocalSnapshot->IsValid() && BaseSnapshot->IsValid())
+	{
+		LocalDiff.Reset(new FGraphSnapshotDiff(*BaseSnapshot, *LocalSnapshot));
+		LocalDiff->Diff();
+	}
+}
+
+FGraphMergeDiffs FGraphMergeSnapshotDiffs::Finish()
+{
+	check(IsInGameThread());
+
+	const auto ResolveDifferences = [](const FGraphSnapshotDiff& SnapshotDiff, UEdGraph* NewGraph, UEdGraph* OldGraph, TMap<UEdGraphNode*, UEdGraphNode*>& NodeMappingOut)
+	{
+		TArray<FMergeDiffResult> Results;
+		Results.Reserve(SnapshotDiff.Diffs.Num());
+		for (const auto& Diff : SnapshotDiff.Diffs) Results.Add(SnapshotDiff.Resolve(Diff, OldGraph, NewGraph));
+
+		TArray<FNodeMatch> NodeMatches;
+		NodeMatches.Reserve(SnapshotDiff.NodeMatches.Num());
+		for (const auto& Match : SnapshotDiff.NodeMatches) NodeMatches.Add(SnapshotDiff.Resolve(Match, OldGraph, NewGraph));
+
+		FinishDifferences(Results, NodeMatches, NodeMappingOut);
+		return Results;
+	};
+
+	FGraphMergeDiffs Diffs;
+
+	TArray<FMergeDiffResult> RemoteDifferences;
+	TArray<FMergeDiffResult> LocalDifferences;
+
+	if (RemoteDiff) RemoteDifferences = ResolveDifferences(*RemoteDiff, RemoteGraph, BaseGraph, Diffs.RemoteToBaseNodeMap);
+	if (LocalDiff) LocalDifferences = ResolveDifferences(*LocalDiff, LocalGraph, BaseGraph, Diffs.LocalToBaseNodeMap);
+
+	FinishGraphMergeDiffs(Diffs, RemoteDifferences, LocalDifferences);
+	return Diffs;
+}
+
+GraphMergeHelper::GraphMergeHelper(UEdGraph* RemoteGraph, UEdGraph* BaseGraph, UEdGraph* LocalGraph, UEdGraph* TargetGraph)
+	: GraphMergeHelper(RemoteGraph, BaseGraph, LocalGraph, TargetGraph, FGraphMergeDiffs::Generate(RemoteGraph, BaseGraph, LocalGraph))
+{
+}
+
+GraphMergeHelper::GraphMergeHelper(UEdGraph* RemoteGraph, UEdGraph* BaseGraph, UEdGraph* LocalGraph, UEdGraph* TargetGraph, FGraphMergeDiffs&& PrecomputedDiffs)
+	: GraphName(TargetGraph->GetFName())
+	, ChangeList(MoveTemp(PrecomputedDiffs.ChangeList))
+	, RemoteGraph(RemoteGraph)
+	, BaseGraph(BaseGraph)
+	, LocalGraph(LocalGraph)
+	, TargetGraph(TargetGraph)
+	, bHasRemoteChanges(PrecomputedDiffs.bHasRemoteChanges)
+	, bHasLocalChanges(PrecomputedDiffs.bHasLocalChanges)
+	, bHasConflicts(PrecomputedDiffs.bHasConflicts)
+	, RemoteDifferences(MoveTemp(PrecomputedDiffs.RemoteDifferences))
+	, LocalDifferences(MoveTemp(PrecomputedDiffs.LocalDifferences))
+	, bDiffsDeferred(PrecomputedDiffs.bIsDeferred)
+	, RemoteToBaseNodeMap(MoveTemp(PrecomputedDiffs.RemoteToBaseNodeMap))
+	, LocalToBaseNodeMap(MoveTemp(PrecomputedDiffs.LocalToBaseNodeMap))
+{
+	TransactionState = NewObject<UMergeTransactionState>(GetTransientPackage(), NAME_None, RF_Transactional);
+	TransactionState->OnUndone.AddRaw(this, &GraphMergeHelper::OnTransactionUndone);
+
+	// Nested graphs are added and removed together with the node they belong to, other graphs have a change of their own
+	UEdGraph* const SourceGraph = BaseGraph ? BaseGraph : (RemoteGraph ? RemoteGraph : LocalGraph);
+	TargetBlueprint = Cast<UBlueprint>(TargetGraph->GetOuter());
+	if (SourceGraph) TargetGraphList = FindMatchingGraphList(TargetBlueprint, SourceGraph);
+
+	// Clone the base graph into the target graph. Graphs which are newly added in the remote or local
+	// blueprint start out the same as in the base blueprint, empty and not part of the target blueprint
+	if (BaseGraph)
+	{
+		CloneGraphIntoGraph(BaseGraph, TargetGraph, BaseToTargetNodeMap);
+	}
+	else if (TargetGraphList)
+	{
+		ClearTargetGraph();
+		TargetGraphList->Remove(TargetGraph);
+	}
+
+	UpdateGraphChange();
+
+	// Only subscribe once the target graph is cloned, so the clone is not picked up as an edit
+	UEdGraph* const Graphs[] = { RemoteGraph, BaseGraph, LocalGraph, TargetGraph };
+	for (int32 i = 0; i < ARRAY_COUNT(Graphs); ++i)
+	{
+		if (!Graphs[i]) continue;
+		GraphChangedHandles[i] = Graphs[i]->AddOnGraphChangedHandler(FOnGraphChanged::FDelegate::CreateRaw(this, &GraphMergeHelper::OnGraphChanged));
+	}
+}
+
+GraphMergeHelper::~GraphMergeHelper()
+{
+	UEdGraph* const Graphs[] = { RemoteGraph, BaseGraph, LocalGraph, TargetGraph };
+	for (int32 i = 0; i < ARRAY_COUNT(Graphs); ++i)
+	{
+		if (Graphs[i]) Graphs[i]->RemoveOnGraphChangedHandler(GraphChangedHandles[i]);
+	}
+
+	// The transactions which recorded the state keep it alive, undoing them still restores the target graph
+	TransactionState->OnUndone.RemoveAll(this);
+}
+
+void GraphMergeHelper::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	Collector.AddReferencedObject(TransactionState);
+
+	// The graphs have to outlive the helper, since it unsubscribes from them when it is destroyed. The target
+	// blueprint is referenced as well, since the target graph is not part of it while it is removed
+	Collector.AddReferencedObject(RemoteGraph);
+	Collector.AddReferencedObject(BaseGraph);
+	Collector.AddReferencedObject(LocalGraph);
+	Collector.AddReferencedObject(TargetGraph);
+	Collector.AddReferencedObject(TargetBlueprint);
+}
+
+void GraphMergeHelper::SetDiffs(FGraphMergeDiffs&& Diffs)
+{
+	// The changes are replaced as a whole, so the states of any applied changes would be lost
+	check(!ChangeList.ContainsByPredicate([](const TSharedPtr<MergeGraphChange>& Change) { return Change->MergeState != EMergeState::Base; }));
+
+	ChangeList = MoveTemp(Diffs.ChangeList);
+	bHasRemoteChanges = Diffs.bHasRemoteChanges;
+	bHasLocalChanges = Diffs.bHasLocalChanges;
+	bHasConflicts = Diffs.bHasConflicts;
+	RemoteDifferences = MoveTemp(Diffs.RemoteDifferences);
+	LocalDifferences = MoveTemp(Diffs.LocalDifferences);
+	RemoteToBaseNodeMap = MoveTemp(Diffs.RemoteToBaseNodeMap);
+	LocalToBaseNodeMap = MoveTemp(Diffs.LocalToBaseNodeMap);
+
+	UpdateGraphChange();
+	++ChangeListRevision;
+
+	// Edits made while the graphs were being diffed are processed on the next flush
+	bDiffsDeferred = false;
+	ApplicabilityCache.Reset();
+	++ApplicabilityRevision;
+}
+
+bool GraphMergeHelper::CanApplyRemoteChange(MergeGraphChange& Change)
+{
+	return GetApplicability(Change).bCanApplyRemote;
+}
+
+bool GraphMergeHelper::CanApplyLocalChange(MergeGraphChange& Change)
+{
+	return GetApplicability(Change).bCanApplyLocal;
+}
+
+bool GraphMergeHelper::CanRevertChange(MergeGraphChange& Change)
+{
+	return GetApplicability(Change).bCanRevert;
+}
+
+const GraphMergeHelper::FCachedApplicability& GraphMergeHelper::GetApplicability(MergeGraphChange& Change)
+{
+	FCachedApplicability& Cached = ApplicabilityCache.FindOrAdd(&Change);
+	if (Cached.Revision == ApplicabilityRevision) return Cached;
+
+	Cached.Revision = ApplicabilityRevision;
+	Cached.bCanApplyRemote = CheckApplyRemoteChange(Change);
+	Cached.bCanApplyLocal = CheckApplyLocalChange(Change);
+	Cached.bCanRevert = CheckRevertChange(Change);
+	return Cached;
+}
+
+const FMergeConflictCounts& GraphMergeHelper::GetConflictCounts() const
+{
+	if (ConflictCountsRevision == ApplicabilityRevision) return ConflictCounts;
+
+	ConflictCountsRevision = ApplicabilityRevision;
+	ConflictCounts = FMergeConflictCounts();
+
+	for (const auto& Change : ChangeList)
+	{
+		if (!Change->bHasConflicts) continue;
+
+		ConflictCounts.NumConflicts += FMath::Max(Change->SubChanges.Num(), 1);
+		ConflictCounts.NumGroups++;
+		if (Change->MergeState == EMergeState::Base) ConflictCounts.NumUnresolvedGroups++;
+	}
+
+	return ConflictCounts;
+}
+
+bool GraphMergeHelper::CheckApplyRemoteChange(MergeGraphChange& Change)
+{
+	if (Change.MergeState == EMergeState::Remote) return true;
+
+	if (Change.SubChanges.Num())
+	{
+		return Change.RemoteDiff.Type != EMergeDiffType::NO_DIFFERENCE && CanApplySubChanges(Change, EMergeState::Remote);
+	}
+
+	// We do not check if the local change is already applied.
+	// This means that if we can not apply the remote change 
+	// right now, this might still be possible after we revert
+	// the local change.
+	return ApplyDiff(Change.RemoteDiff, false);
+}
+
+bool GraphMergeHelper::CheckApplyLocalChange(MergeGraphChange& Change)
+{
+	if (Change.MergeState == EMergeState::Local) return true;
+
+	if (Change.SubChanges.Num())
+	{
+		return Change.LocalDiff.Type != EMergeDiffType::NO_DIFFERENCE && CanApplySubChanges(Change, EMergeState::Local);
+	}
+
+	// We do not check if the remote change is already applied.
+	// This means that if we can not apply the local change 
+	// right now, this might still be possible after we revert
+	// the remote change.
+	return ApplyDiff(Change.LocalDiff, false);
+}
+
+bool GraphMergeHelper::CheckRevertChange(MergeGraphChange& Change)
+{
+	if (Change.SubChanges.Num())
+	{
+		return Change.MergeState == EMergeState::Base || CanApplySubChanges(Change, EMergeState::Base);
+	}
+
+	if (Change.MergeState == EMergeState::Remote)
+	{
+		return RevertDiff(Change.RemoteDiff, false);	
+	}
+	else if (Change.MergeState == EMergeState::Local)
+	{
+		return RevertDiff(Change.LocalDiff, false);
+	}
+	
+	// If neither the Remote or local diff are applied, that means 
+	// we are currently in the base state. So reverting always 
+	// succeeds
+	return true;
+}
+
+bool GraphMergeHelper::ApplyRemoteChange(MergeGraphChange& Change)
+{
+	FScopedEditBatch Batch(*this, LOCTEXT("ApplyRemoteChange", "Apply Remote Change"));
+	TGuardValue<bool> ModifyingTarget(bIsModifyingTarget, true);
+	++ApplicabilityRevision;
+
+	if (Change.SubChanges.Num()) return ApplySubChanges(Change, EMergeState::Remote);
+
+	// If the change is currently applied as a local change
+	if (Change.MergeState == EMergeState::Local)
+	{
+		if (!RevertChange(Change)) return false;
+	}
+
+	// Apply the diff, if we are in the base state
+	if (Change.MergeState == EMergeState::Base)
+	{
+		const bool Ret = ApplyDiff(Change.RemoteDiff, true);
+		if (Ret) SetMergeState(Change, EMergeState::Remote);
+		return Ret;
+	}
+
+	return false;
+}
+
+bool GraphMergeHelper::ApplyLocalChange(MergeGraphChange & Change)
+{
+	FScopedEditBatch Batch(*this, LOCTEXT("ApplyLocalChange", "Apply Local Change"));
+	TGuardValue<bool> ModifyingTarget(bIsModifyingTarget, true);
+	++ApplicabilityRevision;
+
+	if (Change.SubChanges.Num()) return ApplySubChanges(Change, EMergeState::Local);
+
+	// If the change is currently applied as a remote change
+	if (Change.MergeState == EMergeState::Remote)
+	{
+		if (!RevertChange(Change)) return false;
+	}
+
+	// Apply the diff, if we are in the base state
+	if (Change.MergeState == EMergeState::Base)
+	{
+		const bool Ret = ApplyDiff(Change.LocalDiff, true);
+		if (Ret) SetMergeState(Change, EMergeState::Local);
+		return Ret;
+	}
+
+	return false;}
+
+bool GraphMergeHelper::RevertChange(MergeGraphChange & Change)
+{
+	FScopedEditBatch Batch(*this, LOCTEXT("RevertChange", "Revert Change"));
+	TGuardValue<bool> ModifyingTarget(bIsModifyingTarget, true);
+	++ApplicabilityRevision;
+
+	if (Change.SubChanges.Num()) return RevertSubChanges(Change);
+
+	// If there is a change applied revert it to the base state
+	if (Change.MergeState == EMergeState::Remote)
+	{
+		const bool Ret = RevertDiff(Change.RemoteDiff, true);
+		if (Ret) SetMergeState(Change, EMergeState::Base);
+		return Ret;
+	}
+	
+	if (Change.MergeState == EMergeState::Local)
+	{
+		const bool Ret = RevertDiff(Change.LocalDiff, true);
+		if (Ret) SetMergeState(Change, EMergeState::Base);
+		return Ret;
+	}
+
+	return true;
+}
+
+bool GraphMergeHelper::CanApplySubChanges(MergeGraphChange& Change, EMergeState State)
+{
+	// Reverting undoes the diff each sub change was applied from, sub changes without a diff are skipped
+	const bool bRevert = State == EMergeState::Base;
+	const auto GetDiff = [bRevert, State](const MergeGraphChange& SubChange) -> const FMergeDiffResult&
+	{
+		return GetSubChangeDiff(SubChange, bRevert ? SubChange.MergeState : State);
+	};
+
+	// Links to nodes which are added, or restored, by the same change can only be checked once the
+	// node exists in the target graph. Since the node itself can be added, so can the links to it
+	TSet<UEdGraphNode*> CreatedNodes;
+	for (const auto& SubChange : Change.SubChanges)
+	{
+		const FMergeDiffResult& Diff = GetDiff(*SubChange);
+		if (!bRevert && Diff.Type == EMergeDiffType::NODE_ADDED) CreatedNodes.Add(Diff.NodeNew);
+		if (bRevert && Diff.Type == EMergeDiffType::NODE_REMOVED) CreatedNodes.Add(Diff.NodeOld);
+	}
+
+	for (const auto& SubChange : Change.SubChanges)
+	{
+		const FMergeDiffResult& Diff = GetDiff(*SubChange);
+
+		if (Diff.Type == EMergeDiffType::NO_DIFFERENCE) continue;
+		if (Diff.Type == EMergeDiffType::LINK_ADDED && CreatedNodes.Contains(Diff.LinkTargetNew->GetOwningNode())) continue;
+		if (Diff.Type == EMergeDiffType::LINK_REMOVED && CreatedNodes.Contains(Diff.LinkTargetOld->GetOwningNode())) continue;
+
+		const bool bCanPerform = bRevert ? RevertDiff(Diff, false) : ApplyDiff(Diff, false);
+		if (!bCanPerform) return false;
+	}
+
+	return true;
+}
+
+bool GraphMergeHelper::ApplySubChanges(MergeGraphChange& Change, EMergeState State)
+{
+	const bool bRemote = State == EMergeState::Remote;
+	const FMergeDiffResult& Diff = bRemote ? Change.RemoteDiff : Change.LocalDiff;
+	if (Diff.Type == EMergeDiffType::NO_DIFFERENCE) return false;
+
+	// Conflict groups can switch sides, so the side which is picked right now is reverted first. Other composite
+	// changes only contain changes from a single side, so they are either applied or in the base state
+	const EMergeState PreviousState = Change.MergeState;
+	if (PreviousState != EMergeState::Base)
+	{
+		if (!Change.bHasConflicts || PreviousState == State) return false;
+		if (!RevertSubChanges(Change)) return false;
+	}
+
+	const TArray<int32> Order = GetSubChangeApplyOrder(Change, State);
+	for (int32 i = 0; i < Order.Num(); ++i)
+	{
+		MergeGraphChange& SubChange = *Change.SubChanges[Order[i]];
+		if (GetSubChangeDiff(SubChange, State).Type == EMergeDiffType::NO_DIFFERENCE) continue;
+
+		const bool bApplied = bRemote ? ApplyRemoteChange(SubChange) : ApplyLocalChange(SubChange);
+		if (!bApplied)
+		{
+			// Roll back the sub changes which were already applied, so the change is applied either completely or not at all
+			for (int32 j = i - 1; j >= 0; --j) RevertChange(*Change.SubChanges[Order[j]]);
+
+			// And pick the previous side again when switching sides failed
+			if (PreviousState != EMergeState::Base) ApplySubChanges(Change, PreviousState);
+			return false;
+		}
+	}
+
+	SetMergeState(Change, State);
+	return true;
+}
+
+bool GraphMergeHelper::RevertSubChanges(MergeGraphChange& Change)
+{
+	if (Change.MergeState == EMergeState::Base) return true;
+
+	// The state of each sub change is kept, the sub changes of a conflict group which was updated after
+	// its graph was edited can be applied from different sides
+	TArray<EMergeState> States;
+	for (const auto& SubChange : Change.SubChanges) States.Add(SubChange->MergeState);
+
+	const TArray<int32> Order = GetSubChangeApplyOrder(Change, Change.MergeState);
+	for (int32 i = Order.Num() - 1; i >= 0; --i)
+	{
+		if (!RevertChange(*Change.SubChanges[Order[i]]))
+		{
+			// Reapply the sub changes which were already reverted
+			for (int32 j = i + 1; j < Order.Num(); ++j)
+			{
+				MergeGraphChange& SubChange = *Change.SubChanges[Order[j]];
+				if (States[Order[j]] == EMergeState::Remote) ApplyRemoteChange(SubChange);
+				else if (States[Order[j]] == EMergeState::Local) ApplyLocalChange(SubChange);
+			}
+			return false;
+		}
+	}
+
+	SetMergeState(Change, EMergeState::Base);
+	return true;
+}
+
+// Diffs the edited nodes of a source graph and the base graph again, together with the nodes linked to them, and
+// replaces their diffs. Nodes which are removed are unmatched, and added nodes are matched when they have an exact
+// match, e.g. when their removal is undone. Anything else keeps the node matches found by the full diff
+static void RediffEditedNodes(
+	UEdGraph* BaseGraph,
+	UEdGraph* NewGraph,
+	const TSet<UEdGraphNode*>& EditedBaseNodes,
+	const TSet<UEdGraphNode*>& EditedNewNodes,
+	FSourceGraphDiffs& Differences,
+	TMap<UEdGraphNode*, UEdGraphNode*>& NewToBaseNodeMap)
+{
+	MERGEASSIST_SCOPE(RediffEditedNodes, Matching);
+
+	// Removed nodes are no longer part of their graph
+	TSet<UEdGraphNode*> BaseNodes;
+	TSet<UEdGraphNode*> NewNodes;
+	BaseNodes.Append(BaseGraph->Nodes);
+	NewNodes.Append(NewGraph->Nodes);
+
+	TMap<UEdGraphNode*, UEdGraphNode*> BaseToNewNodeMap;
+	BaseToNewNodeMap.Reserve(NewToBaseNodeMap.Num());
+	for (const auto& Pair : NewToBaseNodeMap) BaseToNewNodeMap.Add(Pair.Value, Pair.Key);
+
+	TSet<UEdGraphNode*> AffectedBaseNodes = EditedBaseNodes;
+	TSet<UEdGraphNode*> AffectedNewNodes = EditedNewNodes;
+
+	// Matched nodes are always diffed together
+	const auto AddBaseNode = [&AffectedBaseNodes, &AffectedNewNodes, &BaseToNewNodeMap](UEdGraphNode* Node)
+	{
+		AffectedBaseNodes.Add(Node);
+		if (UEdGraphNode* NewNode = BaseToNewNodeMap.FindRef(Node)) AffectedNewNodes.Add(NewNode);
+	};
+
+	const auto AddNewNode = [&AffectedBaseNodes, &AffectedNewNodes, &NewToBaseNodeMap](UEdGraphNode* Node)
+	{
+		AffectedNewNodes.Add(Node);
+		if (UEdGraphNode* BaseNode = NewToBaseNodeMap.FindRef(Node)) AffectedBaseNodes.Add(BaseNode);
+	};
+
+	// The node a removed node was matched with is diffed again, which reports it as added or removed
+	for (UEdGraphNode* Node : EditedNewNodes)
+	{
+		UEdGraphNode* BaseNode = NewToBaseNodeMap.FindRef(Node);
+		if (NewNodes.Contains(Node) || !BaseNode) continue;
+
+		NewToBaseNodeMap.Remove(Node);
+		BaseToNewNodeMap.Remove(BaseNode);
+		AffectedBaseNodes.Add(BaseNode);
+	}
+
+	for (UEdGraphNode* Node : EditedBaseNodes)
+	{
+		UEdGraphNode* NewNode = BaseToNewNodeMap.FindRef(Node);
+		if (BaseNodes.Contains(Node) || !NewNode) continue;
+
+		NewToBaseNodeMap.Remove(NewNode);
+		BaseToNewNodeMap.Remove(Node);
+		AffectedNewNodes.Add(NewNode);
+	}
+
+	// Edited nodes which are not matched are only matched by their guid, the lookups are built on first use
+	TMap<FGuid, UEdGraphNode*> BaseNodesByGuid;
+	TMap<FGuid, UEdGraphNode*> NewNodesByGuid;
+
+	const auto FindByGuid = [](UEdGraph* Graph, TMap<FGuid, UEdGraphNode*>& NodesByGuid, const FGuid& Guid)
+	{
+		if (!NodesByGuid.Num())
+		{
+			for (UEdGraphNode* Node : Graph->Nodes)
+			{
+				if (Node) NodesByGuid.Add(Node->NodeGuid, Node);
+			}
+		}
+
+		return NodesByGuid.FindRef(Guid);
+	};
+
+	for (UEdGraphNode* Node : EditedNewNodes)
+	{
+		if (!NewNodes.Contains(Node) || NewToBaseNodeMap.Contains(Node)) continue;
+
+		UEdGraphNode* BaseNode = FindByGuid(BaseGraph, BaseNodesByGuid, Node->NodeGuid);
+		if (!BaseNode || BaseToNewNodeMap.Contains(BaseNode) || !FDiffHelper::IsExactNodeMatch(BaseNode, Node)) continue;
+
+		NewToBaseNodeMap.Add(Node, BaseNode);
+		BaseToNewNodeMap.Add(BaseNode, Node);
+		AffectedBaseNodes.Add(BaseNode);
+	}
+
+	for (UEdGraphNode* Node : EditedBaseNodes)
+	{
+		if (!BaseNodes.Contains(Node) || BaseToNewNodeMap.Contains(Node)) continue;
+
+		UEdGraphNode* NewNode = FindByGuid(NewGraph, NewNodesByGuid, Node->NodeGuid);
+		if (!NewNode || NewToBaseNodeMap.Contains(NewNode) || !FDiffHelper::IsExactNodeMatch(Node, NewNode)) continue;
+
+		NewToBaseNodeMap.Add(NewNode, Node);
+		BaseToNewNodeMap.Add(Node, NewNode);
+		AffectedNewNodes.Add(NewNode);
+	}
+
+	for (UEdGraphNode* Node : AffectedNewNodes.Array()) AddNewNode(Node);
+	for (UEdGraphNode* Node : AffectedBaseNodes.Array()) AddBaseNode(Node);
+
+	// Editing the links of a node changes the diffs of the nodes on the other end as well
+	const auto GetLinkedNodes = [](const TSet<UEdGraphNode*>& Nodes, const TSet<UEdGraphNode*>& GraphNodes)
+	{
+		TArray<UEdGraphNode*> LinkedNodes;
+		for (UEdGraphNode* Node : Nodes)
+		{
+			if (!GraphNodes.Contains(Node)) continue;
+
+			for (UEdGraphPin* Pin : Node->Pins)
+			{
+				for (UEdGraphPin* LinkedPin : Pin->LinkedTo)
+				{
+					if (LinkedPin) LinkedNodes.Add(LinkedPin->GetOwningNode());
+				}
+			}
+		}
+		return LinkedNodes;
+	};
+
+	const TArray<UEdGraphNode*> LinkedNewNodes = GetLinkedNodes(AffectedNewNodes, NewNodes);
+	const TArray<UEdGraphNode*> LinkedBaseNodes = GetLinkedNodes(AffectedBaseNodes, BaseNodes);
+	for (UEdGraphNode* Node : LinkedNewNodes) AddNewNode(Node);
+	for (UEdGraphNode* Node : LinkedBaseNodes) AddBaseNode(Node);
+
+	// Links to an affected node are also reported by the node on the other end, which might no longer be linked to it
+	for (const FMergeDiffNodes& Nodes : Differences.Nodes)
+	{
+		const bool bLinksToAffectedNode = (Nodes.LinkTargetOld && AffectedBaseNodes.Contains(Nodes.LinkTargetOld))
+			|| (Nodes.LinkTargetNew && AffectedNewNodes.Contains(Nodes.LinkTargetNew));
+		if (!bLinksToAffectedNode) continue;
+
+		if (Nodes.Old) AddBaseNode(Nodes.Old);
+		if (Nodes.New) AddNewNode(Nodes.New);
+	}
+
+	// Remove the diffs of the affected nodes, keeping the order of the others
+	int32 NumKept = 0;
+	for (int32 Index = 0; Index < Differences.Num(); ++Index)
+	{
+		const FMergeDiffNodes& Nodes = Differences.Nodes[Index];
+		const bool bIsAffected = (Nodes.Old && AffectedBaseNodes.Contains(Nodes.Old))
+			|| (Nodes.New && AffectedNewNodes.Contains(Nodes.New));
+		if (bIsAffected) continue;
+
+		if (Index != NumKept)
+		{
+			Differences.Diffs[NumKept] = MoveTemp(Differences.Diffs[Index]);
+			Differences.Nodes[NumKept] = Differences.Nodes[Index];
+		}
+		++NumKept;
+	}
+
+	Differences.Diffs.SetNum(NumKept, false);
+	Differences.Nodes.SetNum(NumKept, false);
+
+	// And diff them again, the change list sorts the diffs by type so they can be added in any order
+	TArray<FMergeDiffResult> Results;
+	FMergeDiffCollector DiffResults(Results);
+
+	for (UEdGraphNode* Node : AffectedNewNodes)
+	{
+		if (NewNodes.Contains(Node)) FDiffHelper::DiffNodes(NewToBaseNodeMap.FindRef(Node), Node, DiffResults);
+	}
+
+	for (UEdGraphNode* Node : AffectedBaseNodes)
+	{
+		if (BaseNodes.Contains(Node) && !BaseToNewNodeMap.Contains(Node)) FDiffHelper::DiffNodes(Node, nullptr, DiffResults);
+	}
+
+	for (const auto& Diff : Results) Differences.Add(Diff);
+
+	MERGEASSIST_COUNT(Nodes, AffectedNewNodes.Num() + AffectedBaseNodes.Num());
+	MERGEASSIST_COUNT(Diffs, Results.Num());
+}
+
+void GraphMergeHelper::OnGraphChanged(const FEdGraphEditAction& Action)
+{
+	// Selecting nodes does not change them, and notifications without any nodes are accompanied by the
+	// nodes themselves being modified
+	if (!(Action.Action & (GRAPHACTION_AddNode | GRAPHACTION_RemoveNode))) return;
+
+	for (const UEdGraphNode* Node : Action.Nodes)
+	{
+		AddEditedNode(Action.Graph, const_cast<UEdGraphNode*>(Node));
+	}
+}
+
+void GraphMergeHelper::AddEditedNode(UEdGraph* Graph, UEdGraphNode* Node)
+{
+	if (!Graph || !Node) return;
+	if (Graph != RemoteGraph && Graph != BaseGraph && Graph != LocalGraph && Graph != TargetGraph) return;
+	if (Graph == TargetGraph && bIsModifyingTarget) return;
+
+	// Nodes are modified before they are edited, so the edits are only processed when they are flushed
+	EditedNodes.FindOrAdd(Graph).Add(Node);
+}
+
+bool GraphMergeHelper::FlushGraphEdits()
+{
+	if (!EditedNodes.Num() || bDiffsDeferred) return false;
+
+	const TMap<UEdGraph*, TSet<UEdGraphNode*>> Edits = MoveTemp(EditedNodes);
+	EditedNodes.Reset();
+
+	const TSet<UEdGraphNode*> NoEdits;
+	const auto FindEdits = [&Edits, &NoEdits](UEdGraph* Graph) -> const TSet<UEdGraphNode*>&
+	{
+		const TSet<UEdGraphNode*>* Nodes = Graph ? Edits.Find(Graph) : nullptr;
+		return Nodes ? *Nodes : NoEdits;
+	};
+
+	// Edits to the base graph change the diffs of both sides
+	const TSet<UEdGraphNode*>& EditedBaseNodes = FindEdits(BaseGraph);
+	bool bSourcesEdited = false;
+
+	if (RemoteGraph && BaseGraph && (EditedBaseNodes.Num() || FindEdits(RemoteGraph).Num()))
+	{
+		RediffEditedNodes(BaseGraph, RemoteGraph, EditedBaseNodes, FindEdits(RemoteGraph), RemoteDifferences, RemoteToBaseNodeMap);
+		bSourcesEdited = true;
+	}
+
+	if (LocalGraph && BaseGraph && (EditedBaseNodes.Num() || FindEdits(LocalGraph).Num()))
+	{
+		RediffEditedNodes(BaseGraph, LocalGraph, EditedBaseNodes, FindEdits(LocalGraph), LocalDifferences, LocalToBaseNodeMap);
+		bSourcesEdited = true;
+	}
+
+	const bool bTargetNodesRemoved = TargetGraph && ForgetRemovedTargetNodes(FindEdits(TargetGraph));
+	if (bSourcesEdited) UpdateChangeList();
+
+	// Any edit to the target graph can change which changes can be applied
+	++ApplicabilityRevision;
+
+	if (bSourcesEdited || bTargetNodesRemoved) OnChangeListUpdated.Broadcast();
+	return true;
+}
+
+bool GraphMergeHelper::ForgetRemovedTargetNodes(const TSet<UEdGraphNode*>& EditedTargetNodes)
+{
+	if (!EditedTargetNodes.Num()) return false;
+
+	TSet<UEdGraphNode*> TargetNodes;
+	TargetNodes.Append(TargetGraph->Nodes);
+
+	TSet<UEdGraphNode*> RemovedNodes;
+	for (UEdGraphNode* Node : EditedTargetNodes)
+	{
+		if (!TargetNodes.Contains(Node)) RemovedNodes.Add(Node);
+	}
+
+	if (!RemovedNodes.Num()) return false;
+
+	// Nodes removed by hand no longer exist in the target graph as far as the changes are concerned
+	TMap<UEdGraphNode*, UEdGraphNode*>& ReplacedBaseNodes = TransactionState->ReplacedBaseNodes;
+	for (const auto& Pair : BaseToTargetNodeMap)
+	{
+		if (RemovedNodes.Contains(Pair.Value) && !ReplacedBaseNodes.Contains(Pair.Key)) ReplacedBaseNodes.Add(Pair.Key, nullptr);
+	}
+
+	for (auto& Pair : ReplacedBaseNodes)
+	{
+		if (RemovedNodes.Contains(Pair.Value)) Pair.Value = nullptr;
+	}
+
+	TMap<UEdGraphNode*, UEdGraphNode*>& NewNodesInTargetGraph = TransactionState->NewNodesInTargetGraph;
+	for (auto It = NewNodesInTargetGraph.CreateIterator(); It; ++It)
+	{
+		if (RemovedNodes.Contains(It.Value())) It.RemoveCurrent();
+	}
+
+	// Which makes the changes which added or edited them unapplied. The nodes are looked up the same way the
+	// diffs are applied, so a node which can no longer be found is one of the removed nodes
+	const auto IsTargetNodeRemoved = [this, &NewNodesInTargetGraph](const FMergeDiffResult& Diff)
+	{
+		switch (Diff.Type)
+		{
+		case EMergeDiffType::NODE_ADDED:
+			return !NewNodesInTargetGraph.Contains(Diff.NodeNew);
+		case EMergeDiffType::PIN_ADDED:
+			return !FindNodeInTargetGraph(Diff.PinNew->GetOwningNode());
+		case EMergeDiffType::PIN_REMOVED:
+		case EMergeDiffType::PIN_DEFAULT_VALUE:
+			return !GetBaseNodeInTargetGraph(Diff.PinOld->GetOwningNode());
+		case EMergeDiffType::LINK_ADDED:
+			return !GetBaseNodeInTargetGraph(Diff.PinOld->GetOwningNode()) || !FindNodeInTargetGraph(Diff.LinkTargetNew->GetOwningNode());
+		case EMergeDiffType::LINK_REMOVED:
+			return !GetBaseNodeInTargetGraph(Diff.PinOld->GetOwningNode()) || !FindNodeInTargetGraph(Diff.LinkTargetOld->GetOwningNode());
+		case EMergeDiffType::NODE_MOVED:
+		case EMergeDiffType::NODE_COMMENT:
+			return !GetBaseNodeInTargetGraph(Diff.NodeOld);
+		default:
+			// Removed nodes stay removed, and graph changes do not belong to a node
+			return false;
+		}
+	};
+
+	const auto ResetRemovedNode = [this, &IsTargetNodeRemoved](MergeGraphChange& Change)
+	{
+		if (Change.MergeState == EMergeState::Base) return;
+
+		const FMergeDiffResult& Diff = Change.MergeState == EMergeState::Remote ? Change.RemoteDiff : Change.LocalDiff;
+		if (IsTargetNodeRemoved(Diff)) SetMergeState(Change, EMergeState::Base);
+	};
+
+	for (const auto& Change : ChangeList)
+	{
+		if (!Change->SubChanges.Num())
+		{
+			ResetRemovedNode(*Change);
+			continue;
+		}
+
+		bool bAnyApplied = false;
+		for (const auto& SubChange : Change->SubChanges)
+		{
+			ResetRemovedNode(*SubChange);
+			bAnyApplied |= SubChange->MergeState != EMergeState::Base;
+		}
+
+		if (!bAnyApplied) SetMergeState(*Change, EMergeState::Base);
+	}
+
+	return true;
+}
+
+void GraphMergeHelper::UpdateChangeList()
+{
+	TArray<TSharedPtr<MergeGraphChange>> NewChangeList = GenerateChanges(RemoteDifferences, LocalDifferences, RemoteToBaseNodeMap, LocalToBaseNodeMap);
+
+	// The new changes are matched to the existing ones through their diffs, so they keep their state
+	TMap<FMergeDiffKey, TSharedPtr<MergeGraphChange>> OldChanges;
+	TMap<const MergeGraphChange*, TSharedPtr<MergeGraphChange>> OldComposites;
+
+	const auto AddOldChange = [&OldChanges](const TSharedPtr<MergeGraphChange>& Change)
+	{
+		if (Change->RemoteDiff.Type != EMergeDiffType::NO_DIFFERENCE) OldChanges.Add(FMergeDiffKey(0, Change->RemoteDiff), Change);
+		if (Change->LocalDiff.Type != EMergeDiffType::NO_DIFFERENCE) OldChanges.Add(FMergeDiffKey(1, Change->LocalDiff), Change);
+	};
+
+	for (const auto& Change : ChangeList)
+	{
+		// The change of the graph as a whole is not generated from the diffs, it is kept as is
+		if (Change == GraphChange) continue;
+
+		if (!Change->SubChanges.Num())
+		{
+			AddOldChange(Change);
+			continue;
+		}
+
+		for (const auto& SubChange : Change->SubChanges)
+		{
+			AddOldChange(SubChange);
+			OldComposites.Add(SubChange.Get(), Change);
+		}
+	}
+
+	TSet<const MergeGraphChange*> ReusedChanges;
+	int32 NumLostChanges = 0;
+
+	const auto Reuse = [&OldChanges, &ReusedChanges, &NumLostChanges](TSharedPtr<MergeGraphChange>& Change)
+	{
+		const TSharedPtr<MergeGraphChange>* Found = nullptr;
+		if (Change->RemoteDiff.Type != EMergeDiffType::NO_DIFFERENCE) Found = OldChanges.Find(FMergeDiffKey(0, Change->RemoteDiff));
+		if (!Found && Change->LocalDiff.Type != EMergeDiffType::NO_DIFFERENCE) Found = OldChanges.Find(FMergeDiffKey(1, Change->LocalDiff));
+		if (!Found || ReusedChanges.Contains(Found->Get())) return;
+
+		const TSharedPtr<MergeGraphChange> Old = *Found;
+		ReusedChanges.Add(Old.Get());
+
+		// The state is only kept when the diff which was applied still exists
+		EMergeState State = EMergeState::Base;
+		if (Old->MergeState == EMergeState::Remote && FMergeDiffKey(0, Old->RemoteDiff) == FMergeDiffKey(0, Change->RemoteDiff)) State = EMergeState::Remote;
+		if (Old->MergeState == EMergeState::Local && FMergeDiffKey(1, Old->LocalDiff) == FMergeDiffKey(1, Change->LocalDiff)) State = EMergeState::Local;
+		if (Old->MergeState != State) ++NumLostChanges;
+
+		Old->Label = Change->Label;
+		Old->bIsLabeledAsMove = false;
+		Old->DisplayColor = Change->DisplayColor;
+		Old->RemoteDiff = Change->RemoteDiff;
+		Old->LocalDiff = Change->LocalDiff;
+		Old->bHasConflicts = Change->bHasConflicts;
+		Old->MergeState = State;
+
+		Change = Old;
+	};
+
+	for (auto& Change : NewChangeList)
+	{
+		if (!Change->SubChanges.Num())
+		{
+			Reuse(Change);
+			continue;
+		}
+
+		EMergeState State = EMergeState::Base;
+		for (auto& SubChange : Change->SubChanges)
+		{
+			Reuse(SubChange);
+			if (SubChange->MergeState != EMergeState::Base) State = SubChange->MergeState;
+		}
+
+		// Composites which still consist of exactly the same changes are kept as well
+		const TSharedPtr<MergeGraphChange> OldComposite = OldComposites.FindRef(Change->SubChanges[0].Get());
+		bool bIsSameComposite = OldComposite.IsValid() && OldComposite->SubChanges.Num() == Change->SubChanges.Num();
+		for (int32 i = 1; i < Change->SubChanges.Num() && bIsSameComposite; ++i)
+		{
+			bIsSameComposite = OldComposites.FindRef(Change->SubChanges[i].Get()) == OldComposite;
+		}
+
+		if (bIsSameComposite)
+		{
+			OldComposite->Label = Change->Label;
+			OldComposite->bIsLabeledAsMove = false;
+			OldComposite->DisplayColor = Change->DisplayColor;
+			OldComposite->RemoteDiff = Change->RemoteDiff;
+			OldComposite->LocalDiff = Change->LocalDiff;
+			OldComposite->SubChanges = MoveTemp(Change->SubChanges);
+			Change = OldComposite;
+		}
+
+		Change->MergeState = State;
+	}
+
+	// Applied changes which no longer exist are not reverted, since the diffs they were applied from are gone
+	for (const auto& Pair : OldChanges)
+	{
+		if (!ReusedChanges.Contains(Pair.Value.Get()) && Pair.Value->MergeState != EMergeState::Base)
+		{
+			ReusedChanges.Add(Pair.Value.Get());
+			++NumLostChanges;
+		}
+	}
+
+	if (NumLostChanges)
+	{
+		UE_LOG(LogMergeAssist, Warning, TEXT("%d applied changes of graph '%s' no longer exist after it was edited, their edits are kept in the target graph"),
+			NumLostChanges, *GraphName.ToString());
+	}
+
+	ChangeList = MoveTemp(NewChangeList);
+	bHasRemoteChanges = RemoteDifferences.Num() != 0;
+	bHasLocalChanges = LocalDifferences.Num() != 0;
+	bHasConflicts = HasConflictingChanges(ChangeList);
+
+	// Whether a graph which was removed by one side was changed by the other can change with the edit
+	UpdateGraphChange();
+	++ChangeListRevision;
+
+	ApplicabilityCache.Reset();
+}
+
+void GraphMergeHelper::UpdateGraphChange()
+{
+	const auto MakeDiff = [this](EMergeDiffType Type)
+	{
+		FMergeDiffResult Diff;
+		Diff.Type = Type;
+		Diff.DisplayString = FDiffHelper::FormatDisplayString(Type, FText::FromName(GraphName));
+		Diff.DisplayColor = FDiffHelper::GetDisplayColor(Type);
+		return Diff;
+	};
+
+	FMergeDiffResult RemoteDiff;
+	FMergeDiffResult LocalDiff;
+	bool bIsIdentical = false;
+
+	if (TargetGraphList && !BaseGraph)
+	{
+		if (RemoteGraph) RemoteDiff = MakeDiff(EMergeDiffType::GRAPH_ADDED);
+		if (LocalGraph) LocalDiff = MakeDiff(EMergeDiffType::GRAPH_ADDED);
+
+		// A graph which was added by both sides only conflicts when they added different nodes
+		if (RemoteGraph && LocalGraph)
+		{
+			FMergeDiffAnyDifference AnyDifference;
+			FDiffHelper::DiffGraphs(RemoteGraph, LocalGraph, AnyDifference);
+			bIsIdentical = !AnyDifference.HasFoundDiffs();
+		}
+	}
+	else if (TargetGraphList)
+	{
+		// Removing a graph only conflicts with the other side when that side changed the graph
+		if (!RemoteGraph) RemoteDiff = MakeDiff(EMergeDiffType::GRAPH_REMOVED);
+		else if (!LocalGraph && RemoteDifferences.Num()) RemoteDiff = MakeDiff(EMergeDiffType::GRAPH_CHANGED);
+
+		if (!LocalGraph) LocalDiff = MakeDiff(EMergeDiffType::GRAPH_REMOVED);
+		else if (!RemoteGraph && LocalDifferences.Num()) LocalDiff = MakeDiff(EMergeDiffType::GRAPH_CHANGED);
+
+		bIsIdentical = !RemoteGraph && !LocalGraph;
+	}
+
+	// Identical changes are only kept as the remote change, same as the changes of the nodes
+	if (bIsIdentical) LocalDiff = FMergeDiffResult();
+
+	const bool bHasRemoteDiff = RemoteDiff.Type != EMergeDiffType::NO_DIFFERENCE;
+	const bool bHasLocalDiff = LocalDiff.Type != EMergeDiffType::NO_DIFFERENCE;
+
+	if (!bHasRemoteDiff && !bHasLocalDiff)
+	{
+		if (GraphChange) ChangeList.Remove(GraphChange);
+		GraphChange.Reset();
+		return;
+	}
+
+	if (!GraphChange) GraphChange = MakeShareable(new MergeGraphChange());
+
+	const bool bIsConflict = bHasRemoteDiff && bHasLocalDiff;
+	const FMergeDiffResult& Diff = bHasRemoteDiff ? RemoteDiff : LocalDiff;
+
+	GraphChange->Label = Diff.DisplayString;
+	if (bIsConflict)
+	{
+		GraphChange->Label = FText::Format(LOCTEXT("ConflictIdentifier", "CONFLICT: '{0}' conflicts with '{1}'"), LocalDiff.DisplayString, RemoteDiff.DisplayString);
+	}
+	else if (bIsIdentical)
+	{
+		GraphChange->Label = FText::Format(LOCTEXT("IdenticalChange", "{0} (same in local)"), RemoteDiff.DisplayString);
+	}
+
+	// The state is only kept while the side it was applied from still has a change
+	EMergeState& State = GraphChange->MergeState;
+	if ((State == EMergeState::Remote && !bHasRemoteDiff) || (State == EMergeState::Local && !bHasLocalDiff)) State = EMergeState::Base;
+
+	GraphChange->DisplayColor = Diff.DisplayColor;
+	GraphChange->RemoteDiff = RemoteDiff;
+	GraphChange->LocalDiff = LocalDiff;
+	GraphChange->bHasConflicts = bIsConflict;
+
+	// The graph has to exist before any of its nodes can be changed, so its change is listed first
+	if (!ChangeList.Num() || ChangeList[0] != GraphChange)
+	{
+		ChangeList.Remove(GraphChange);
+		ChangeList.Insert(GraphChange, 0);
+	}
+
+	bHasRemoteChanges |= bHasRemoteDiff;
+	bHasLocalChanges |= bHasLocalDiff;
+	bHasConflicts |= bIsConflict;
+}
+
+static bool MatchesRuleChangeType(EMergeRuleChangeType RuleType, EMergeDiffType Type)
+{
+	switch (RuleType)
+	{
+	case EMergeRuleChangeType::Any:             return true;
+	case EMergeRuleChangeType::None:            return Type == EMergeDiffType::NO_DIFFERENCE;
+	case EMergeRuleChangeType::NodeRemoved:     return Type == EMergeDiffType::NODE_REMOVED;
+	case EMergeRuleChangeType::NodeAdded:       return Type == EMergeDiffType::NODE_ADDED;
+	case EMergeRuleChangeType::PinRemoved:      return Type == EMergeDiffType::PIN_REMOVED;
+	case EMergeRuleChangeType::PinAdded:        return Type == EMergeDiffType::PIN_ADDED;
+	case EMergeRuleChangeType::PinDefaultValue: return Type == EMergeDiffType::PIN_DEFAULT_VALUE;
+	case EMergeRuleChangeType::LinkRemoved:     return Type == EMergeDiffType::LINK_REMOVED;
+	case EMergeRuleChangeType::LinkAdded:       return Type == EMergeDiffType::LINK_ADDED;
+	case EMergeRuleChangeType::NodeMoved:       return Type == EMergeDiffType::NODE_MOVED;
+	case EMergeRuleChangeType::NodeComment:     return Type == EMergeDiffType::NODE_COMMENT;
+	default: return false;
+	}
+}
+
+static bool MatchesRule(const FMergeAutoResolveRule& Rule, const MergeGraphChange& Change)
+{
+	if (Rule.bOnlyConflicts && !Change.bHasConflicts) return false;
+
+	// The version the rule picks has to exist
+	const FMergeDiffResult& PickedDiff = Rule.Resolution == EMergeRuleResolution::TakeRemote ? Change.RemoteDiff : Change.LocalDiff;
+	if (PickedDiff.Type == EMergeDiffType::NO_DIFFERENCE) return false;
+
+	// Every conflict of a conflict group has to match, a side which a conflict shares with another conflict in the group is skipped
+	if (Change.bHasConflicts && Change.SubChanges.Num())
 	{
-		bool operator() (const TSharedPtr<MergeGraphChange>& A, const TSharedPtr<MergeGraphChange>& B) const
+		for (const auto& SubChange : Change.SubChanges)
 		{
-			const EMergeDiffType AType = A->RemoteDiff.Type != EMergeDiffType::NO_DIFFERENCE ? A->RemoteDiff.Type : A->LocalDiff.Type;
-			const EMergeDiffType BType = B->RemoteDiff.Type != EMergeDiffType::NO_DIFFERENCE ? B->RemoteDiff.Type : B->LocalDiff.Type;
+			const EMergeDiffType RemoteType = SubChange->RemoteDiff.Type;
+			const EMergeDiffType LocalType = SubChange->LocalDiff.Type;
 
-			return AType < BType;
+			if (RemoteType != EMergeDiffType::NO_DIFFERENCE && !MatchesRuleChangeType(Rule.RemoteChange, RemoteType)) return false;
+			if (LocalType != EMergeDiffType::NO_DIFFERENCE && !MatchesRuleChangeType(Rule.LocalChange, LocalType)) return false;
 		}
-	};
 
-	Sort(Ret.GetData(), Ret.Num(), SortChangeByDisplayOrder());
-	
-	return Ret;
+		return true;
+	}
+
+	return MatchesRuleChangeType(Rule.RemoteChange, Change.RemoteDiff.Type) && MatchesRuleChangeType(Rule.LocalChange, Change.LocalDiff.Type);
 }
 
-GraphMergeHelper::GraphMergeHelper(UEdGraph* RemoteGraph, UEdGraph* BaseGraph, UEdGraph* LocalGraph, UEdGraph* TargetGraph)
-	: GraphName(TargetGraph->GetFName())
-	, RemoteGraph(RemoteGraph)
-	, BaseGraph(BaseGraph)
-	, LocalGraph(LocalGraph)
-	, TargetGraph(TargetGraph)
+int32 GraphMergeHelper::ApplyNonConflictingChanges()
 {
-	// Clone the base graph into the target graph
-	CloneGraphIntoGraph(BaseGraph, TargetGraph, BaseToTargetNodeMap);
+	BeginEditBatch(LOCTEXT("ApplyNonConflictingChanges", "Apply Non Conflicting Changes"));
 
-	const auto GenerateDifferences = [](UEdGraph* NewGraph, UEdGraph* OldGraph, TMap<UEdGraphNode*, UEdGraphNode*>& NodeMappingOut)
+	int32 NumApplied = 0;
+	int32 NumFailed = 0;
+	for (const auto& Change : ChangeList)
 	{
-		TArray<FMergeDiffResult> Results;
-		FMergeDiffResults DiffResults = FMergeDiffResults(&Results);
-		TArray<FNodeMatch> NodeMatches;
+		// Conflicts always need to be resolved by the user
+		if (Change->bHasConflicts) continue;
 
-		// Diff the graphs, and collect both the diffs and node matches
-		FDiffHelper::DiffGraphs(OldGraph, NewGraph, DiffResults, ENodeMatchStrategy::ALL, &NodeMatches);
+		// Without a conflict only one of the diffs is set
+		const bool bIsRemoteChange = Change->RemoteDiff.Type != EMergeDiffType::NO_DIFFERENCE;
+		const bool bApplied = bIsRemoteChange
+			? ApplyRemoteChange(*Change)
+			: ApplyLocalChange(*Change);
 
-		// Sort the results by the EMergeDiffType, this is the order in which the 
-		// different types should be displayed to the user
-		Sort(Results.GetData(), Results.Num(), 
-			[](const FMergeDiffResult& A, const FMergeDiffResult& B)
-		{
-			return A.Type < B.Type;
-		});
+		if (bApplied) ++NumApplied;
+		else ++NumFailed;
+	}
 
-		// Convert the node matches into a node mapping
-		// this can be used to later figure out which nodes we are talking about
-		for (const auto& NodeMatch : NodeMatches)
-		{
-			if (!NodeMatch.IsValid()) continue;
+	EndEditBatch();
 
-			NodeMappingOut.Add(NodeMatch.NewNode, NodeMatch.OldNode);
-		}
+	if (NumApplied) OnChangeListUpdated.Broadcast();
+	return NumFailed;
+}
 
-		return Results;
-	};
+int32 GraphMergeHelper::ApplyAutoResolveRules(const TArray<FMergeAutoResolveRule>& Rules)
+{
+	if (!Rules.Num()) return 0;
 
-	TArray<FMergeDiffResult> RemoteDifferences;
-	TArray<FMergeDiffResult> LocalDifferences;
+	BeginEditBatch(LOCTEXT("AutoResolve", "Auto Resolve Conflicts"));
 
-	if (RemoteGraph && BaseGraph)
+	int32 NumResolved = 0;
+	for (const auto& Change : ChangeList)
 	{
-		RemoteDifferences = GenerateDifferences(RemoteGraph, BaseGraph, RemoteToBaseNodeMap);
-		bHasRemoteChanges = RemoteDifferences.Num() != 0;
+		// Versions which were already picked, by hand or by an earlier rule, are kept
+		if (Change->MergeState != EMergeState::Base) continue;
+
+		const FMergeAutoResolveRule* Rule = Rules.FindByPredicate([&Change](const FMergeAutoResolveRule& Candidate)
+		{
+			return MatchesRule(Candidate, *Change);
+		});
+
+		if (!Rule) continue;
+
+		const bool bResolved = Rule->Resolution == EMergeRuleResolution::TakeRemote
+			? ApplyRemoteChange(*Change)
+			: ApplyLocalChange(*Change);
+
+		if (bResolved) ++NumResolved;
 	}
 
-	if (LocalGraph && BaseGraph)
+	EndEditBatch();
+
+	if (NumResolved) OnChangeListUpdated.Broadcast();
+	return NumResolved;
+}
+
+int32 GraphMergeHelper::ApplyMergeStates(TFunctionRef<EMergeState(const MergeGraphChange&)> GetMergeState)
+{
+	TArray<MergeGraphChange*> Remaining;
+	for (const auto& Change : ChangeList)
 	{
-		LocalDifferences = GenerateDifferences(LocalGraph, BaseGraph, LocalToBaseNodeMap);
-		bHasLocalChanges = LocalDifferences.Num() != 0;
+		if (GetMergeState(*Change) != Change->MergeState) Remaining.Add(Change.Get());
 	}
 
-	ChangeList = GenerateChangeList(RemoteDifferences, LocalDifferences);
+	if (!Remaining.Num()) return 0;
 
-	// Check if any of the changes contain conflicts, if this is the case then 
-	// mark the graph as containing conflicts
-	for (const auto& Change : ChangeList)
+	BeginEditBatch(LOCTEXT("ApplyMergeStates", "Apply Merge States"));
+
+	// Changes can depend on each other, e.g. a link to a node that is added by another change
+	int32 NumApplied = 0;
+	int32 NumRemaining;
+	do
 	{
-		if (Change->bHasConflicts)
+		NumRemaining = Remaining.Num();
+		Remaining.RemoveAll([this, &GetMergeState, &NumApplied](MergeGraphChange* Change)
 		{
-			bHasConflicts = true;
-			break;
-		}
+			bool bApplied = false;
+			switch (GetMergeState(*Change))
+			{
+			case EMergeState::Remote: bApplied = ApplyRemoteChange(*Change); break;
+			case EMergeState::Local:  bApplied = ApplyLocalChange(*Change);  break;
+			case EMergeState::Base:   bApplied = RevertChange(*Change);      break;
+			}
+
+			if (bApplied) ++NumApplied;
+			return bApplied;
+		});
 	}
-}
+	while (Remaining.Num() && Remaining.Num() != NumRemaining);
 
-bool GraphMergeHelper::CanApplyRemoteChange(MergeGraphChange & Change)
-{
-	if (Change.MergeState == EMergeState::Remote) return true;
+	EndEditBatch();
 
-	// We do not check if the local change is already applied.
-	// This means that if we can not apply the remote change 
-	// right now, this might still be possible after we revert
-	// the local change.
-	return ApplyDiff(Change.RemoteDiff, false);
+	if (NumApplied) OnChangeListUpdated.Broadcast();
+	return NumApplied;
 }
 
-bool GraphMergeHelper::CanApplyLocalChange(MergeGraphChange& Change)
+void GraphMergeHelper::BeginEditBatch(const FText& Description)
 {
-	if (Change.MergeState == EMergeState::Local) return true;
-
-	// We do not check if the remote change is already applied.
-	// This means that if we can not apply the local change 
-	// right now, this might still be possible after we revert
-	// the remote change.
-	return ApplyDiff(Change.LocalDiff, false);
+	if (EditBatchDepth++ == 0) TransactionDescription = Description;
 }
 
-bool GraphMergeHelper::CanRevertChange(MergeGraphChange& Change)
+void GraphMergeHelper::EndEditBatch()
 {
-	if (Change.MergeState == EMergeState::Remote)
+	check(EditBatchDepth > 0);
+	if (--EditBatchDepth) return;
+
+	if (bTargetGraphChangedInBatch)
 	{
-		return RevertDiff(Change.RemoteDiff, false);	
+		TGuardValue<bool> ModifyingTarget(bIsModifyingTarget, true);
+		bTargetGraphChangedInBatch = false;
+		TargetGraph->NotifyGraphChanged();
 	}
-	else if (Change.MergeState == EMergeState::Local)
+
+	if (Transaction)
 	{
-		return RevertDiff(Change.LocalDiff, false);
+		// Keep the recorded states up to date, so the next transaction records the states after this one
+		if (GUndo) RecordMergeStates();
+		Transaction.Reset();
 	}
-	
-	// If neither the Remote or local diff are applied, that means 
-	// we are currently in the base state. So reverting always 
-	// succeeds
-	return true;
 }
 
-bool GraphMergeHelper::ApplyRemoteChange(MergeGraphChange& Change)
+void GraphMergeHelper::BeginTransaction()
 {
-	// If the change is currently applied as a local change
-	if (Change.MergeState == EMergeState::Local)
-	{
-		if (!RevertChange(Change)) return false;
-	}
+	check(EditBatchDepth > 0);
+	if (Transaction) return;
 
-	// Apply the diff, if we are in the base state
-	if (Change.MergeState == EMergeState::Base)
-	{
-		const bool Ret = ApplyDiff(Change.RemoteDiff, true);
-		if (Ret) Change.MergeState = EMergeState::Remote;
-		return Ret;
-	}
+	// Commandlets can not undo, so they do not record anything
+	Transaction.Reset(new FScopedTransaction(TransactionDescription, !IsRunningCommandlet()));
+	if (!GUndo) return;
 
-	return false;
+	// The states have to be recorded before the first edit, undoing the transaction restores them
+	RecordMergeStates();
+	TransactionState->Modify();
 }
 
-bool GraphMergeHelper::ApplyLocalChange(MergeGraphChange & Change)
+void GraphMergeHelper::RecordMergeStates()
 {
-	// If the change is currently applied as a remote change
-	if (Change.MergeState == EMergeState::Remote)
+	TArray<uint8>& MergeStates = TransactionState->MergeStates;
+
+	// The change list only has to be scanned for new changes after it was updated, which can also change the states
+	// of the changes it kept. Otherwise only the changes whose state was set since the last recording are updated
+	if (RecordedChangeListRevision != ChangeListRevision)
 	{
-		if (!RevertChange(Change)) return false;
+		const auto Record = [this](const TSharedPtr<MergeGraphChange>& Change)
+		{
+			if (!RecordedChangeIndices.Contains(Change.Get())) RecordedChangeIndices.Add(Change.Get(), RecordedChanges.Add(Change));
+		};
+
+		// Changes which were added to the change list since the last transaction get the next free index
+		for (const auto& Change : ChangeList)
+		{
+			Record(Change);
+			for (const auto& SubChange : Change->SubChanges) Record(SubChange);
+		}
+
+		MergeStates.SetNumUninitialized(RecordedChanges.Num());
+		for (int32 i = 0; i < RecordedChanges.Num(); ++i) MergeStates[i] = (uint8)RecordedChanges[i]->MergeState;
+
+		RecordedChangeListRevision = ChangeListRevision;
+		ChangesWithNewState.Reset();
+		return;
 	}
 
-	// Apply the diff, if we are in the base state
-	if (Change.MergeState == EMergeState::Base)
+	// Undoing a transaction restores the states recorded before it, which can be fewer than there are recorded changes
+	const int32 NumRecordedStates = MergeStates.Num();
+	MergeStates.SetNumUninitialized(RecordedChanges.Num());
+	for (int32 i = NumRecordedStates; i < RecordedChanges.Num(); ++i) MergeStates[i] = (uint8)RecordedChanges[i]->MergeState;
+
+	// The changes are only used as keys, changes which were never recorded can be gone already
+	for (const MergeGraphChange* Change : ChangesWithNewState)
 	{
-		const bool Ret = ApplyDiff(Change.LocalDiff, true);
-		if (Ret) Change.MergeState = EMergeState::Local;
-		return Ret;
+		if (const int32* Index = RecordedChangeIndices.Find(Change)) MergeStates[*Index] = (uint8)RecordedChanges[*Index]->MergeState;
 	}
 
-	return false;}
+	ChangesWithNewState.Reset();
+}
 
-bool GraphMergeHelper::RevertChange(MergeGraphChange & Change)
+void GraphMergeHelper::SetMergeState(MergeGraphChange& Change, EMergeState State)
 {
-	// If there is a change applied revert it to the base state
-	if (Change.MergeState == EMergeState::Remote)
-	{
-		const bool Ret = RevertDiff(Change.RemoteDiff, true);
-		if (Ret) Change.MergeState = EMergeState::Base;
-		return Ret;
-	}
-	
-	if (Change.MergeState == EMergeState::Local)
+	if (Change.MergeState == State) return;
+
+	Change.MergeState = State;
+	ChangesWithNewState.Add(&Change);
+}
+
+void GraphMergeHelper::OnTransactionUndone()
+{
+	// The target graph and the node mappings are restored by the transaction itself, changes which
+	// were recorded after the restored states keep their current state
+	const TArray<uint8>& MergeStates = TransactionState->MergeStates;
+	for (int32 i = 0; i < MergeStates.Num() && i < RecordedChanges.Num(); ++i)
 	{
-		const bool Ret = RevertDiff(Change.LocalDiff, true);
-		if (Ret) Change.MergeState = EMergeState::Base;
-		return Ret;
+		RecordedChanges[i]->MergeState = (EMergeState)MergeStates[i];
 	}
 
-	return true;
+	++ApplicabilityRevision;
+	ApplicabilityCache.Reset();
+	OnChangeListUpdated.Broadcast();
+}
+
+void GraphMergeHelper::NotifyTargetGraphChanged()
+{
+	if (EditBatchDepth) bTargetGraphChangedInBatch = true;
+	else TargetGraph->NotifyGraphChanged();
 }
 
 UEdGraphNode* GraphMergeHelper::FindNodeInTargetGraph(UEdGraphNode* Node)
@@ -333,7 +2138,7 @@ UEdGraphNode* GraphMergeHelper::FindNodeInTargetGraph(UEdGraphNode* Node)
 
 	// Check if the node is newly added, in this case we have a direct
 	// mapping between the node and target graph
-	auto** FoundNode = NewNodesInTargetGraph.Find(Node);
+	auto** FoundNode = TransactionState->NewNodesInTargetGraph.Find(Node);
 	if (FoundNode) return *FoundNode;
 
 	// If the node is from either the Base, Local, or Remote graphs, translate
@@ -358,14 +2163,17 @@ UEdGraphNode* GraphMergeHelper::FindNodeInTargetGraph(UEdGraphNode* Node)
 	// determine which node it would be on the target graph
 	if (!BaseNode) return nullptr;
 
-	auto** TargetNode = BaseToTargetNodeMap.Find(BaseNode);
-	return TargetNode ? *TargetNode : nullptr;
+	return GetBaseNodeInTargetGraph(BaseNode);
 }
 
 UEdGraphNode* GraphMergeHelper::GetBaseNodeInTargetGraph(UEdGraphNode* SourceNode)
 {
 	if (SourceNode == nullptr) return nullptr;
 
+	// Base nodes which were removed or restored during the merge are mapped to their current node
+	UEdGraphNode** ReplacedNode = TransactionState->ReplacedBaseNodes.Find(SourceNode);
+	if (ReplacedNode) return *ReplacedNode;
+
 	// Try and find the node in the target graph
 	// NOTE: This would only support nodes in the target graph which are 
 	// created through the GraphMergeHelper
@@ -379,6 +2187,8 @@ UEdGraphNode* GraphMergeHelper::GetBaseNodeInTargetGraph(UEdGraphNode* SourceNod
 
 bool GraphMergeHelper::ApplyDiff(const FMergeDiffResult& Diff, const bool bCanWrite)
 {
+	// Each diff checks whether it can be applied before it writes anything, and only opens the transaction
+	// right before its first edit, so diffs which can not be applied do not open a transaction
 	switch (Diff.Type)
 	{
 	case EMergeDiffType::NODE_REMOVED:      return ApplyDiff_NODE_REMOVED     (Diff, bCanWrite);
@@ -390,6 +2200,9 @@ bool GraphMergeHelper::ApplyDiff(const FMergeDiffResult& Diff, const bool bCanWr
 	case EMergeDiffType::PIN_DEFAULT_VALUE: return ApplyDiff_PIN_DEFAULT_VALUE(Diff, bCanWrite);
 	case EMergeDiffType::NODE_MOVED:        return ApplyDiff_NODE_MOVED       (Diff, bCanWrite);
 	case EMergeDiffType::NODE_COMMENT:      return ApplyDiff_NODE_COMMENT     (Diff, bCanWrite);
+	case EMergeDiffType::GRAPH_ADDED:       return ApplyDiff_GRAPH_ADDED      (Diff, bCanWrite);
+	case EMergeDiffType::GRAPH_REMOVED:     return ApplyDiff_GRAPH_REMOVED    (Diff, bCanWrite);
+	case EMergeDiffType::GRAPH_CHANGED:     return ApplyDiff_GRAPH_CHANGED    (Diff, bCanWrite);
 	default: return false;
 	}
 }
@@ -407,29 +2220,72 @@ bool GraphMergeHelper::RevertDiff(const FMergeDiffResult& Diff, const bool bCanW
 	case EMergeDiffType::PIN_DEFAULT_VALUE: return RevertDiff_PIN_DEFAULT_VALUE(Diff, bCanWrite);
 	case EMergeDiffType::NODE_MOVED:        return RevertDiff_NODE_MOVED       (Diff, bCanWrite);
 	case EMergeDiffType::NODE_COMMENT:      return RevertDiff_NODE_COMMENT     (Diff, bCanWrite);
+	case EMergeDiffType::GRAPH_ADDED:       return RevertDiff_GRAPH_ADDED      (Diff, bCanWrite);
+	case EMergeDiffType::GRAPH_REMOVED:     return RevertDiff_GRAPH_REMOVED    (Diff, bCanWrite);
+	case EMergeDiffType::GRAPH_CHANGED:     return RevertDiff_GRAPH_CHANGED    (Diff, bCanWrite);
 	default: return false;
 	}
 }
 
+// Records an object in the transaction of the current edit batch before it is edited. Outside of a
+// transaction there is nothing to record, so the object is not marked as modified either
+static void ModifyInTransaction(UObject* Object)
+{
+	if (GUndo && Object) Object->Modify();
+}
+
+// Records the nodes linked to a pin, before its links are broken
+static void ModifyLinkedNodes(UEdGraphPin* Pin)
+{
+	for (UEdGraphPin* LinkedPin : Pin->LinkedTo)
+	{
+		if (LinkedPin) ModifyInTransaction(LinkedPin->GetOwningNode());
+	}
+}
+
 bool GraphMergeHelper::CloneToTarget(UEdGraphNode* SourceNode, bool bRestoreLinks, const bool CanWrite, UEdGraphNode** OutNewNode)
 {
+	MERGEASSIST_SCOPE(CloneToTarget, Cloning);
+
 	// Make sure we have a source node we need to copy
 	// and that this node does not already exist in the target graph
 	{
-		UEdGraphNode* TargetNode = GetBaseNodeInTargetGraph(SourceNode);
+		UEdGraphNode* TargetNode = FindNodeInTargetGraph(SourceNode);
 		if (!SourceNode || TargetNode) return false;
 	}
 
-	// Ensure that we can duplicate the source node, and log an error when this is not the case
-	// I've yet to encounter any nodes which can not be duplicated
-	check(SourceNode->CanDuplicateNode());
-
 	// This is all the checking we can do before commiting to changes
 	if (!CanWrite) return true;
+	BeginTransaction();
+
+	// Only the node list of the graph is recorded, the new node did not exist before the transaction
+	ModifyInTransaction(TargetGraph);
 
 	UEdGraphNode* NewNode = nullptr;
 
 	// Clone the node to the target graph
+	if (!SourceNode->CanDuplicateNode())
+	{
+		// Nodes which can not be copied by the user, like the entry and result nodes of functions, are duplicated
+		// directly. Their links still point into the source graph, so they are cleared without touching it
+		NewNode = CastChecked<UEdGraphNode>(StaticDuplicateObject(SourceNode, TargetGraph));
+		for (UEdGraphPin* Pin : NewNode->Pins)
+		{
+			// The links are only duplicated one way, a source pin which links back to the copy would change the source graph
+			for (UEdGraphPin* LinkedPin : Pin->LinkedTo)
+			{
+				if (LinkedPin && !ensureMsgf(!LinkedPin->LinkedTo.Contains(Pin), TEXT("Duplicating node '%s' linked the source graph to the copy"), *SourceNode->GetName()))
+				{
+					LinkedPin->LinkedTo.Remove(Pin);
+				}
+			}
+
+			Pin->LinkedTo.Reset();
+		}
+
+		TargetGraph->AddNode(NewNode, false, false);
+	}
+	else
 	{
 		TSet<UObject*> NodesToExport;
 		NodesToExport.Add(SourceNode);
@@ -470,8 +2326,9 @@ bool GraphMergeHelper::CloneToTarget(UEdGraphNode* SourceNode, bool bRestoreLink
 			NewPin->BreakAllPinLinks();
 			for (UEdGraphPin* SrcLink : SrcPin->LinkedTo)
 			{
-				// Find the node on the other end of the link in the target graph
-				if (UEdGraphNode* NewLinkNode = GetBaseNodeInTargetGraph(SrcLink->GetOwningNode()))
+				// Find the node on the other end of the link in the target graph, the source node
+				// can be from any of the graphs, so we can not only look at the base nodes here
+				if (UEdGraphNode* NewLinkNode = FindNodeInTargetGraph(SrcLink->GetOwningNode()))
 				{
 					// Try and find a pin with the same name and direction
 					UEdGraphPin* NewLink = NewLinkNode->FindPin(SrcLink->PinName, SrcLink->Direction);
@@ -481,6 +2338,7 @@ bool GraphMergeHelper::CloneToTarget(UEdGraphNode* SourceNode, bool bRestoreLink
 					// to relevant changes have been made to the pin.
 					if (NewLink && NewLink->PinType == SrcLink->PinType)
 					{
+						ModifyInTransaction(NewLinkNode);
 						NewPin->MakeLinkTo(NewLink);
 					}
 				}
@@ -492,29 +2350,38 @@ bool GraphMergeHelper::CloneToTarget(UEdGraphNode* SourceNode, bool bRestoreLink
 
 bool GraphMergeHelper::ApplyDiff_NODE_REMOVED(const FMergeDiffResult& Diff, const bool bCanWrite)
 {
+	MERGEASSIST_SCOPE(ApplyDiff_NODE_REMOVED, ApplyDiff);
+
 	UEdGraphNode* TargetNode = GetBaseNodeInTargetGraph(Diff.NodeOld);
 
 	if (!TargetNode) return false;
 
 	if (bCanWrite)
 	{
+		BeginTransaction();
+		ModifyInTransaction(TargetGraph);
+		ModifyInTransaction(TargetNode);
+		for (UEdGraphPin* Pin : TargetNode->Pins) ModifyLinkedNodes(Pin);
+
 		TargetNode->BreakAllNodeLinks();
 		TargetGraph->RemoveNode(TargetNode);
-		BaseToTargetNodeMap.Remove(Diff.NodeOld);
+		TransactionState->ReplacedBaseNodes.Add(Diff.NodeOld, nullptr);
 	}
 
 	return true;
 }
 
 bool GraphMergeHelper::ApplyDiff_NODE_ADDED(const FMergeDiffResult& Diff, const bool bCanWrite)
-{	
+{
+	MERGEASSIST_SCOPE(ApplyDiff_NODE_ADDED, ApplyDiff);
+
 	UEdGraphNode* NewNode = nullptr;
 	
 	const bool Ret = CloneToTarget(Diff.NodeNew, true, bCanWrite, &NewNode);
 	if (NewNode && bCanWrite)
 	{
 		// Update the mapping to reflect our new node
-		NewNodesInTargetGraph.Add(Diff.NodeNew, NewNode);
+		TransactionState->NewNodesInTargetGraph.Add(Diff.NodeNew, NewNode);
 	}
 
 	return Ret;
@@ -522,6 +2389,8 @@ bool GraphMergeHelper::ApplyDiff_NODE_ADDED(const FMergeDiffResult& Diff, const
 
 bool GraphMergeHelper::ApplyDiff_PIN_REMOVED(const FMergeDiffResult& Diff, const bool bCanWrite)
 {
+	MERGEASSIST_SCOPE(ApplyDiff_PIN_REMOVED, ApplyDiff);
+
 	UEdGraphNode* TargetNode = GetBaseNodeInTargetGraph(Diff.PinOld->GetOwningNode());
 	UEdGraphPin* TargetPin = SafeFindPin(TargetNode, Diff.PinOld);
 
@@ -529,8 +2398,12 @@ bool GraphMergeHelper::ApplyDiff_PIN_REMOVED(const FMergeDiffResult& Diff, const
 
 	if (bCanWrite)
 	{
+		BeginTransaction();
+		ModifyInTransaction(TargetNode);
+		ModifyLinkedNodes(TargetPin);
+
 		TargetNode->RemovePin(TargetPin);
-		TargetNode->GetGraph()->NotifyGraphChanged();
+		NotifyTargetGraphChanged();
 	}
 
 	return true;
@@ -538,6 +2411,8 @@ bool GraphMergeHelper::ApplyDiff_PIN_REMOVED(const FMergeDiffResult& Diff, const
 
 bool GraphMergeHelper::ApplyDiff_PIN_ADDED(const FMergeDiffResult& Diff, const bool bCanWrite)
 {
+	MERGEASSIST_SCOPE(ApplyDiff_PIN_ADDED, ApplyDiff);
+
 	UEdGraphNode* TargetNode = FindNodeInTargetGraph(Diff.PinNew->GetOwningNode());
 
 	if (!TargetNode) return false;
@@ -547,6 +2422,9 @@ bool GraphMergeHelper::ApplyDiff_PIN_ADDED(const FMergeDiffResult& Diff, const b
 
 	if (bCanWrite)
 	{
+		BeginTransaction();
+		ModifyInTransaction(TargetNode);
+
 		auto Pin = TargetNode->CreatePin(
 			Diff.PinNew->Direction,
 			Diff.PinNew->PinType.PinCategory, 
@@ -557,7 +2435,7 @@ bool GraphMergeHelper::ApplyDiff_PIN_ADDED(const FMergeDiffResult& Diff, const b
 
 		// We need to manually notify the graph that is was changed
 		// since CreatePin does not do this internally
-		TargetNode->GetGraph()->NotifyGraphChanged();
+		NotifyTargetGraphChanged();
 
 		return Pin != nullptr;
 	}
@@ -567,6 +2445,8 @@ bool GraphMergeHelper::ApplyDiff_PIN_ADDED(const FMergeDiffResult& Diff, const b
 
 bool GraphMergeHelper::ApplyDiff_LINK_REMOVED(const FMergeDiffResult& Diff, const bool bCanWrite)
 {
+	MERGEASSIST_SCOPE(ApplyDiff_LINK_REMOVED, ApplyDiff);
+
 	UEdGraphNode* TargetNode = GetBaseNodeInTargetGraph(Diff.PinOld->GetOwningNode());
 	UEdGraphPin* TargetPin = SafeFindPin(TargetNode, Diff.PinOld);
 
@@ -587,6 +2467,9 @@ bool GraphMergeHelper::ApplyDiff_LINK_REMOVED(const FMergeDiffResult& Diff, cons
 
 	if (bCanWrite)
 	{
+		BeginTransaction();
+		ModifyInTransaction(TargetNode);
+		ModifyInTransaction((*FoundLinkTarget)->GetOwningNode());
 		TargetPin->BreakLinkTo(*FoundLinkTarget);
 	}
 
@@ -595,6 +2478,8 @@ bool GraphMergeHelper::ApplyDiff_LINK_REMOVED(const FMergeDiffResult& Diff, cons
 
 bool GraphMergeHelper::ApplyDiff_LINK_ADDED(const FMergeDiffResult& Diff, const bool bCanWrite)
 {
+	MERGEASSIST_SCOPE(ApplyDiff_LINK_ADDED, ApplyDiff);
+
 	UEdGraphNode* TargetNode = GetBaseNodeInTargetGraph(Diff.PinOld->GetOwningNode());
 	UEdGraphPin* TargetPin = SafeFindPin(TargetNode, Diff.PinOld);
 
@@ -608,6 +2493,9 @@ bool GraphMergeHelper::ApplyDiff_LINK_ADDED(const FMergeDiffResult& Diff, const
 
 	if (bCanWrite)
 	{
+		BeginTransaction();
+		ModifyInTransaction(TargetNode);
+		ModifyInTransaction(LinkTargetNode);
 		TargetPin->MakeLinkTo(LinkTargetPin);
 	}
 
@@ -616,6 +2504,8 @@ bool GraphMergeHelper::ApplyDiff_LINK_ADDED(const FMergeDiffResult& Diff, const
 
 bool GraphMergeHelper::ApplyDiff_PIN_DEFAULT_VALUE(const FMergeDiffResult& Diff, const bool bCanWrite)
 {
+	MERGEASSIST_SCOPE(ApplyDiff_PIN_DEFAULT_VALUE, ApplyDiff);
+
 	UEdGraphNode* TargetNode = GetBaseNodeInTargetGraph(Diff.PinOld->GetOwningNode());
 	UEdGraphPin* TargetPin = SafeFindPin(TargetNode, Diff.PinOld);
 
@@ -623,6 +2513,9 @@ bool GraphMergeHelper::ApplyDiff_PIN_DEFAULT_VALUE(const FMergeDiffResult& Diff,
 
 	if (bCanWrite)
 	{
+		BeginTransaction();
+		ModifyInTransaction(TargetNode);
+
 		// Copy all the values to the target pin
 		// Only one of these values will be set, however the other 
 		// values should be safe to copy, since they are initialized 
@@ -637,12 +2530,16 @@ bool GraphMergeHelper::ApplyDiff_PIN_DEFAULT_VALUE(const FMergeDiffResult& Diff,
 
 bool GraphMergeHelper::ApplyDiff_NODE_MOVED(const FMergeDiffResult& Diff, const bool bCanWrite)
 {
+	MERGEASSIST_SCOPE(ApplyDiff_NODE_MOVED, ApplyDiff);
+
 	UEdGraphNode* TargetNode = GetBaseNodeInTargetGraph(Diff.NodeOld);
 
 	if (!TargetNode) return false;
 
 	if (bCanWrite)
 	{
+		BeginTransaction();
+		ModifyInTransaction(TargetNode);
 		TargetNode->NodePosX = Diff.NodeNew->NodePosX;
 		TargetNode->NodePosY = Diff.NodeNew->NodePosY;
 	}
@@ -652,12 +2549,16 @@ bool GraphMergeHelper::ApplyDiff_NODE_MOVED(const FMergeDiffResult& Diff, const
 
 bool GraphMergeHelper::ApplyDiff_NODE_COMMENT(const FMergeDiffResult& Diff, const bool bCanWrite)
 {
+	MERGEASSIST_SCOPE(ApplyDiff_NODE_COMMENT, ApplyDiff);
+
 	UEdGraphNode* TargetNode = GetBaseNodeInTargetGraph(Diff.NodeOld);
 
 	if (!TargetNode) return false;
 
 	if (bCanWrite)
 	{
+		BeginTransaction();
+		ModifyInTransaction(TargetNode);
 		TargetNode->NodeComment = Diff.NodeNew->NodeComment;
 	}
 
@@ -666,13 +2567,15 @@ bool GraphMergeHelper::ApplyDiff_NODE_COMMENT(const FMergeDiffResult& Diff, cons
 
 bool GraphMergeHelper::RevertDiff_NODE_REMOVED(const FMergeDiffResult& Diff, const bool bCanWrite)
 {
+	MERGEASSIST_SCOPE(RevertDiff_NODE_REMOVED, RevertDiff);
+
 	UEdGraphNode* NewNode = nullptr;
 
 	const bool Ret = CloneToTarget(Diff.NodeOld, true, bCanWrite, &NewNode);
 	if (NewNode && bCanWrite)
 	{
 		// Update the mapping to reflect our new node
-		BaseToTargetNodeMap.Add(Diff.NodeOld, NewNode);
+		TransactionState->ReplacedBaseNodes.Add(Diff.NodeOld, NewNode);
 	}
 
 	return Ret;
@@ -680,15 +2583,22 @@ bool GraphMergeHelper::RevertDiff_NODE_REMOVED(const FMergeDiffResult& Diff, con
 
 bool GraphMergeHelper::RevertDiff_NODE_ADDED(const FMergeDiffResult& Diff, const bool bCanWrite)
 {
+	MERGEASSIST_SCOPE(RevertDiff_NODE_ADDED, RevertDiff);
+
 	UEdGraphNode* TargetNode = FindNodeInTargetGraph(Diff.NodeNew);
 
 	if (!TargetNode) return false;
 
 	if (bCanWrite)
 	{
+		BeginTransaction();
+		ModifyInTransaction(TargetGraph);
+		ModifyInTransaction(TargetNode);
+		for (UEdGraphPin* Pin : TargetNode->Pins) ModifyLinkedNodes(Pin);
+
 		TargetNode->BreakAllNodeLinks();
 		TargetGraph->RemoveNode(TargetNode);
-		BaseToTargetNodeMap.Remove(Diff.NodeNew);
+		TransactionState->NewNodesInTargetGraph.Remove(Diff.NodeNew);
 	}
 
 	return true;
@@ -696,6 +2606,8 @@ bool GraphMergeHelper::RevertDiff_NODE_ADDED(const FMergeDiffResult& Diff, const
 
 bool GraphMergeHelper::RevertDiff_PIN_REMOVED(const FMergeDiffResult& Diff, const bool bCanWrite)
 {
+	MERGEASSIST_SCOPE(RevertDiff_PIN_REMOVED, RevertDiff);
+
 	UEdGraphNode* TargetNode = GetBaseNodeInTargetGraph(Diff.PinOld->GetOwningNode());
 
 	if (!TargetNode) return false;
@@ -705,6 +2617,9 @@ bool GraphMergeHelper::RevertDiff_PIN_REMOVED(const FMergeDiffResult& Diff, cons
 
 	if (bCanWrite)
 	{
+		BeginTransaction();
+		ModifyInTransaction(TargetNode);
+
 		auto Pin = TargetNode->CreatePin(
 			Diff.PinOld->Direction,
 			Diff.PinOld->PinType.PinCategory, 
@@ -715,7 +2630,7 @@ bool GraphMergeHelper::RevertDiff_PIN_REMOVED(const FMergeDiffResult& Diff, cons
 
 		// We need to manually notify the graph that is was changed
 		// since CreatePin does not do this internally
-		TargetNode->GetGraph()->NotifyGraphChanged();
+		NotifyTargetGraphChanged();
 
 		return Pin != nullptr;
 	}
@@ -725,6 +2640,8 @@ bool GraphMergeHelper::RevertDiff_PIN_REMOVED(const FMergeDiffResult& Diff, cons
 
 bool GraphMergeHelper::RevertDiff_PIN_ADDED(const FMergeDiffResult& Diff, const bool bCanWrite)
 {
+	MERGEASSIST_SCOPE(RevertDiff_PIN_ADDED, RevertDiff);
+
 	UEdGraphNode* TargetNode = FindNodeInTargetGraph(Diff.PinNew->GetOwningNode());
 	UEdGraphPin* TargetPin = SafeFindPin(TargetNode, Diff.PinNew);
 
@@ -732,8 +2649,12 @@ bool GraphMergeHelper::RevertDiff_PIN_ADDED(const FMergeDiffResult& Diff, const
 
 	if (bCanWrite)
 	{
+		BeginTransaction();
+		ModifyInTransaction(TargetNode);
+		ModifyLinkedNodes(TargetPin);
+
 		TargetNode->RemovePin(TargetPin);
-		TargetNode->GetGraph()->NotifyGraphChanged();
+		NotifyTargetGraphChanged();
 	}
 
 	return true;
@@ -741,6 +2662,8 @@ bool GraphMergeHelper::RevertDiff_PIN_ADDED(const FMergeDiffResult& Diff, const
 
 bool GraphMergeHelper::RevertDiff_LINK_REMOVED(const FMergeDiffResult& Diff, const bool bCanWrite)
 {
+	MERGEASSIST_SCOPE(RevertDiff_LINK_REMOVED, RevertDiff);
+
 	UEdGraphNode* TargetNode = GetBaseNodeInTargetGraph(Diff.PinOld->GetOwningNode());
 	UEdGraphPin* TargetPin = SafeFindPin(TargetNode, Diff.PinOld);
 
@@ -754,6 +2677,9 @@ bool GraphMergeHelper::RevertDiff_LINK_REMOVED(const FMergeDiffResult& Diff, con
 
 	if (bCanWrite)
 	{
+		BeginTransaction();
+		ModifyInTransaction(TargetNode);
+		ModifyInTransaction(LinkTargetNode);
 		TargetPin->MakeLinkTo(LinkTargetPin);
 	}
 
@@ -762,6 +2688,8 @@ bool GraphMergeHelper::RevertDiff_LINK_REMOVED(const FMergeDiffResult& Diff, con
 
 bool GraphMergeHelper::RevertDiff_LINK_ADDED(const FMergeDiffResult& Diff, const bool bCanWrite)
 {
+	MERGEASSIST_SCOPE(RevertDiff_LINK_ADDED, RevertDiff);
+
 	UEdGraphNode* TargetNode = GetBaseNodeInTargetGraph(Diff.PinOld->GetOwningNode());
 	UEdGraphPin* TargetPin = SafeFindPin(TargetNode, Diff.PinOld);
 
@@ -782,6 +2710,9 @@ bool GraphMergeHelper::RevertDiff_LINK_ADDED(const FMergeDiffResult& Diff, const
 
 	if (bCanWrite)
 	{
+		BeginTransaction();
+		ModifyInTransaction(TargetNode);
+		ModifyInTransaction((*FoundLinkTarget)->GetOwningNode());
 		TargetPin->BreakLinkTo(*FoundLinkTarget);
 	}
 
@@ -790,6 +2721,8 @@ bool GraphMergeHelper::RevertDiff_LINK_ADDED(const FMergeDiffResult& Diff, const
 
 bool GraphMergeHelper::RevertDiff_PIN_DEFAULT_VALUE(const FMergeDiffResult& Diff, const bool bCanWrite)
 {
+	MERGEASSIST_SCOPE(RevertDiff_PIN_DEFAULT_VALUE, RevertDiff);
+
 	UEdGraphNode* TargetNode = GetBaseNodeInTargetGraph(Diff.PinOld->GetOwningNode());
 	UEdGraphPin* TargetPin = SafeFindPin(TargetNode, Diff.PinOld);
 
@@ -797,6 +2730,9 @@ bool GraphMergeHelper::RevertDiff_PIN_DEFAULT_VALUE(const FMergeDiffResult& Diff
 
 	if (bCanWrite)
 	{
+		BeginTransaction();
+		ModifyInTransaction(TargetNode);
+
 		// Copy all the values to the target pin
 		// Only one of these values will be set, however the other 
 		// values should be safe to copy, since they are initialized 
@@ -811,12 +2747,16 @@ bool GraphMergeHelper::RevertDiff_PIN_DEFAULT_VALUE(const FMergeDiffResult& Diff
 
 bool GraphMergeHelper::RevertDiff_NODE_MOVED(const FMergeDiffResult& Diff, const bool bCanWrite)
 {
+	MERGEASSIST_SCOPE(RevertDiff_NODE_MOVED, RevertDiff);
+
 	UEdGraphNode* TargetNode = GetBaseNodeInTargetGraph(Diff.NodeOld);
 
 	if (!TargetNode) return false;
 
 	if (bCanWrite)
 	{
+		BeginTransaction();
+		ModifyInTransaction(TargetNode);
 		TargetNode->NodePosX = Diff.NodeOld->NodePosX;
 		TargetNode->NodePosY = Diff.NodeOld->NodePosY;
 	}
@@ -826,6 +2766,8 @@ bool GraphMergeHelper::RevertDiff_NODE_MOVED(const FMergeDiffResult& Diff, const
 
 bool GraphMergeHelper::RevertDiff_NODE_COMMENT(const FMergeDiffResult& Diff, const bool bCanWrite)
 {
+	MERGEASSIST_SCOPE(RevertDiff_NODE_COMMENT, RevertDiff);
+
 	// !IMPORTANT: For NODE_MOVED and NODE_COMMENT Node2 refers to the node in the base graph
 	UEdGraphNode* TargetNode = GetBaseNodeInTargetGraph(Diff.NodeOld);
 
@@ -833,10 +2775,123 @@ bool GraphMergeHelper::RevertDiff_NODE_COMMENT(const FMergeDiffResult& Diff, con
 
 	if (bCanWrite)
 	{
+		BeginTransaction();
+		ModifyInTransaction(TargetNode);
 		TargetNode->NodeComment = Diff.NodeOld->NodeComment;
 	}
 
 	return true;
 }
 
+UEdGraph* GraphMergeHelper::GetGraphChangeSource(const FMergeDiffResult& Diff) const
+{
+	// The graph changes are always applied from the diffs of the change itself
+	if (!GraphChange) return nullptr;
+	if (&Diff == &GraphChange->RemoteDiff) return RemoteGraph;
+	if (&Diff == &GraphChange->LocalDiff) return LocalGraph;
+	return nullptr;
+}
+
+bool GraphMergeHelper::IsTargetGraphListed() const
+{
+	return TargetGraphList && TargetGraphList->Contains(TargetGraph);
+}
+
+void GraphMergeHelper::ClearTargetGraph()
+{
+	ModifyInTransaction(TargetGraph);
+	for (UEdGraphNode* Node : TargetGraph->Nodes) ModifyInTransaction(Node);
+
+	while (TargetGraph->Nodes.Num()) TargetGraph->RemoveNode(TargetGraph->Nodes[0]);
+	TargetGraph->SubGraphs.Reset();
+}
+
+bool GraphMergeHelper::ApplyDiff_GRAPH_ADDED(const FMergeDiffResult& Diff, const bool bCanWrite)
+{
+	MERGEASSIST_SCOPE(ApplyDiff_GRAPH_ADDED, ApplyDiff);
+
+	UEdGraph* SourceGraph = GetGraphChangeSource(Diff);
+
+	if (!SourceGraph || !TargetGraphList || IsTargetGraphListed()) return false;
+
+	if (bCanWrite)
+	{
+		BeginTransaction();
+		ModifyInTransaction(TargetBlueprint);
+		ClearTargetGraph();
+
+		// There are no changes for the nodes of an added graph, so their mapping is not needed
+		TMap<UEdGraphNode*, UEdGraphNode*> NodeMapping;
+		CloneGraphIntoGraph(SourceGraph, TargetGraph, NodeMapping);
+		TargetGraphList->Add(TargetGraph);
+	}
+
+	return true;
+}
+
+bool GraphMergeHelper::ApplyDiff_GRAPH_REMOVED(const FMergeDiffResult& Diff, const bool bCanWrite)
+{
+	MERGEASSIST_SCOPE(ApplyDiff_GRAPH_REMOVED, ApplyDiff);
+
+	if (!IsTargetGraphListed()) return false;
+
+	if (bCanWrite)
+	{
+		BeginTransaction();
+		ModifyInTransaction(TargetBlueprint);
+		TargetGraphList->Remove(TargetGraph);
+	}
+
+	return true;
+}
+
+bool GraphMergeHelper::ApplyDiff_GRAPH_CHANGED(const FMergeDiffResult& Diff, const bool bCanWrite)
+{
+	MERGEASSIST_SCOPE(ApplyDiff_GRAPH_CHANGED, ApplyDiff);
+
+	// Keeping the graph leaves it as it is, its nodes are merged through their own changes
+	return IsTargetGraphListed();
+}
+
+bool GraphMergeHelper::RevertDiff_GRAPH_ADDED(const FMergeDiffResult& Diff, const bool bCanWrite)
+{
+	MERGEASSIST_SCOPE(RevertDiff_GRAPH_ADDED, RevertDiff);
+
+	if (!IsTargetGraphListed()) return false;
+
+	if (bCanWrite)
+	{
+		BeginTransaction();
+		ModifyInTransaction(TargetBlueprint);
+		ClearTargetGraph();
+		TargetGraphList->Remove(TargetGraph);
+		NotifyTargetGraphChanged();
+	}
+
+	return true;
+}
+
+bool GraphMergeHelper::RevertDiff_GRAPH_REMOVED(const FMergeDiffResult& Diff, const bool bCanWrite)
+{
+	MERGEASSIST_SCOPE(RevertDiff_GRAPH_REMOVED, RevertDiff);
+
+	if (!TargetGraphList || IsTargetGraphListed()) return false;
+
+	if (bCanWrite)
+	{
+		BeginTransaction();
+		ModifyInTransaction(TargetBlueprint);
+		TargetGraphList->Add(TargetGraph);
+	}
+
+	return true;
+}
+
+bool GraphMergeHelper::RevertDiff_GRAPH_CHANGED(const FMergeDiffResult& Diff, const bool bCanWrite)
+{
+	MERGEASSIST_SCOPE(RevertDiff_GRAPH_CHANGED, RevertDiff);
+
+	return true;
+}
+
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
@@ -4,9 +4,18 @@
 
 #include "CoreMinimal.h"
 #include "FDiffHelper.h"
+#include "GraphSnapshot.h"
+#include "GraphSnapshotDiff.h"
+#include "GraphSnapshotCache.h"
+#include "UObject/GCObject.h"
 
+class UBlueprint;
 class UEdGraph;
 class UEdGraphNode;
+class UMergeTransactionState;
+class FScopedTransaction;
+struct FEdGraphEditAction;
+struct FMergeAutoResolveRule;
 
 static const FLinearColor SoftRed = FColor(0xF4, 0x43, 0x36);
 static const FLinearColor SoftBlue = FColor(0x21, 0x96, 0xF3);
@@ -30,13 +39,151 @@ struct MergeGraphChange
 
 	bool bHasConflicts;
 	EMergeState MergeState;
+
+	// Set once the label names the graph the node was moved to or from, the label is generated
+	// again when the change list is updated, after which the move has to be labeled again
+	bool bIsLabeledAsMove;
+
+	// Changes which are applied and reverted together with this change, in the order in which they
+	// are applied. Composite changes either only contain changes from a single side, or are conflict
+	// groups, which only contain conflicts that touch the same nodes. Their remote and local diffs are
+	// those of the most important sub change, and are only used for display
+	TArray<TSharedPtr<MergeGraphChange>> SubChanges;
 };
 
-class GraphMergeHelper
+struct FMergeConflictCounts
+{
+	// Conflicts between a remote and local change, including those inside conflict groups
+	int32 NumConflicts = 0;
+
+	// Conflict groups, a conflict which is not part of a group counts as a group of its own
+	int32 NumGroups = 0;
+
+	// Groups for which no side has been picked yet
+	int32 NumUnresolvedGroups = 0;
+};
+
+// The nodes a diff belongs to, and the nodes of its link target, in the base graph and the remote or local graph
+struct FMergeDiffNodes
+{
+	UEdGraphNode* Old;
+	UEdGraphNode* New;
+	UEdGraphNode* LinkTargetOld;
+	UEdGraphNode* LinkTargetNew;
+};
+
+// The diffs between a remote or local graph and the base graph. These are kept after the change list is
+// generated, so the diffs of nodes which are edited during the merge can be replaced. The nodes of each diff
+// are stored when it is added, since the pins of an edited node might already be destroyed by the edit
+struct FSourceGraphDiffs
+{
+	void Add(const FMergeDiffResult& Diff);
+	int32 Num() const { return Diffs.Num(); }
+
+	TArray<FMergeDiffResult> Diffs;
+	TArray<FMergeDiffNodes> Nodes;
+};
+
+// The changes between the remote and local graphs and their base graph. Generating
+// these only reads from the source graphs, and never touches the target graph. So
+// unlike the GraphMergeHelper itself these can be generated on a worker thread, as
+// long as no other thread is accessing the same source graphs at the same time
+struct FGraphMergeDiffs
+{
+	static FGraphMergeDiffs Generate(UEdGraph* RemoteGraph, UEdGraph* BaseGraph, UEdGraph* LocalGraph);
+
+	// Placeholder for diffs which are set later through GraphMergeHelper::SetDiffs
+	static FGraphMergeDiffs Deferred();
+
+	// Generates the changes from diffs which were found before, e.g. the diffs saved in a merge session.
+	// The node maps map the nodes of the remote and local graph to the nodes of the base graph
+	static FGraphMergeDiffs FromDifferences(const TArray<FMergeDiffResult>& RemoteDifferences, const TArray<FMergeDiffResult>& LocalDifferences,
+		TMap<UEdGraphNode*, UEdGraphNode*>&& RemoteToBaseNodeMap, TMap<UEdGraphNode*, UEdGraphNode*>&& LocalToBaseNodeMap);
+
+	TArray<TSharedPtr<MergeGraphChange>> ChangeList;
+
+	FSourceGraphDiffs RemoteDifferences;
+	FSourceGraphDiffs LocalDifferences;
+
+	TMap<UEdGraphNode*, UEdGraphNode*> RemoteToBaseNodeMap;
+	TMap<UEdGraphNode*, UEdGraphNode*> LocalToBaseNodeMap;
+
+	bool bHasRemoteChanges = false;
+	bool bHasLocalChanges = false;
+	bool bHasConflicts = false;
+	bool bIsDeferred = false;
+};
+
+// Resumable version of FGraphMergeDiffs::Generate, which diffs the remote and local graphs
+// over multiple steps, see FIncrementalGraphDiff
+struct FIncrementalGraphMergeDiffs
+{
+	FIncrementalGraphMergeDiffs(UEdGraph* RemoteGraph, UEdGraph* BaseGraph, UEdGraph* LocalGraph);
+
+	// Diffs until the deadline, in FPlatformTime::Seconds, has passed. Returns true once both graphs are diffed
+	bool Step(double Deadline);
+	bool IsDone() const { return (!RemoteDiff || RemoteDiff->IsDone()) && (!LocalDiff || LocalDiff->IsDone()); }
+
+	// Generates the changes from the diffs, this can only be called once everything is diffed
+	FGraphMergeDiffs Finish();
+
+private:
+	TUniquePtr<FIncrementalGraphDiff> RemoteDiff;
+	TUniquePtr<FIncrementalGraphDiff> LocalDiff;
+};
+
+// Version of FGraphMergeDiffs::Generate which diffs snapshots of the graphs. The snapshots are captured, or
+// taken from the snapshot cache, on construction, on the game thread. After that Diff can be called from any thread, since it does not
+// touch the graphs. Finish converts the diffs back to the graphs, and needs to be called on the game thread
+struct FGraphMergeSnapshotDiffs
+{
+	FGraphMergeSnapshotDiffs(UEdGraph* RemoteGraph, UEdGraph* BaseGraph, UEdGraph* LocalGraph);
+
+	void Diff();
+	FGraphMergeDiffs Finish();
+
+private:
+	UEdGraph* RemoteGraph;
+	UEdGraph* BaseGraph;
+	UEdGraph* LocalGraph;
+
+	TSharedPtr<const FGraphSnapshot, ESPMode::ThreadSafe> RemoteSnapshot;
+	TSharedPtr<const FGraphSnapshot, ESPMode::ThreadSafe> BaseSnapshot;
+	TSharedPtr<const FGraphSnapshot, ESPMode::ThreadSafe> LocalSnapshot;
+
+	TUniquePtr<FGraphSnapshotDiff> RemoteDiff;
+	TUniquePtr<FGraphSnapshotDiff> LocalDiff;
+};
+
+// The list of graphs of the blueprint which holds the same kind of graph as the source graph does in its own blueprint,
+// e.g. the function graphs. Returns null for nested graphs, and for the graphs of implemented interfaces
+TArray<UEdGraph*>* FindMatchingGraphList(UBlueprint* Blueprint, const UEdGraph* SourceGraph);
+
+DECLARE_MULTICAST_DELEGATE(FOnMergeChangeListUpdated);
+
+// Merges the changes of a single graph into the target graph. Edits made to any of the graphs during the merge, by
+// hand or by another editor, are collected until FlushGraphEdits is called. Nodes which are added to or removed from the
+// graphs are picked up by the helper itself, other modifications of the nodes are passed in by the owner through
+// AddEditedNode, see BlueprintMergeHelper. Only the edited nodes and the nodes linked to them are diffed again, after
+// which the change list is updated, keeping the state of the changes which still exist.
+// Applying and reverting changes is undoable, every call to a public function is a single transaction.
+//
+// A graph which was added or removed by the remote or local blueprint has a change for the graph as a whole, at the
+// start of the change list. Applying it adds the target graph to, or removes it from, the graphs of its blueprint
+class GraphMergeHelper : public FGCObject
 {
 public:
 	GraphMergeHelper(UEdGraph* RemoteGraph, UEdGraph* BaseGraph, UEdGraph* LocalGraph, UEdGraph* TargetGraph);
-	~GraphMergeHelper() = default;
+	GraphMergeHelper(UEdGraph* RemoteGraph, UEdGraph* BaseGraph, UEdGraph* LocalGraph, UEdGraph* TargetGraph, FGraphMergeDiffs&& PrecomputedDiffs);
+	~GraphMergeHelper();
+
+	// The graph change handlers are bound to the helper itself
+	GraphMergeHelper(const GraphMergeHelper&) = delete;
+	GraphMergeHelper& operator=(const GraphMergeHelper&) = delete;
+
+	// Replaces the changes of the graph, used when the diffs are generated after the helper
+	// was created. This should only be called before any of the changes are applied
+	void SetDiffs(FGraphMergeDiffs&& Diffs);
 
 	bool CanApplyRemoteChange(MergeGraphChange& Change);
 	bool CanApplyLocalChange(MergeGraphChange& Change);
@@ -50,17 +197,106 @@ public:
 	bool ExistsInLocal() const {return LocalGraph != nullptr; }
 	bool ExistsInBase() const {return BaseGraph != nullptr; }
 
+	UEdGraph* GetRemoteGraph() const { return RemoteGraph; }
+	UEdGraph* GetBaseGraph() const { return BaseGraph; }
+	UEdGraph* GetLocalGraph() const { return LocalGraph; }
+	UEdGraph* GetTargetGraph() const { return TargetGraph; }
+
 	bool HasRemoteChanges() const {return bHasRemoteChanges; }
 	bool HasLocalChanges() const { return bHasLocalChanges; }
 	bool HasConflicts() const { return bHasConflicts; }
 
+	// Counted once after the change list or the state of any change changed, so this can be queried every frame
+	const FMergeConflictCounts& GetConflictCounts() const;
+
+	// Applies every change which does not conflict, in a single batch. Returns the number of changes which could not be applied
+	int32 ApplyNonConflictingChanges();
+
+	// Picks a version for the changes which are still in the base state, using the first rule that matches them.
+	// They are applied in a single batch, returns the number of changes which were resolved
+	int32 ApplyAutoResolveRules(const TArray<FMergeAutoResolveRule>& Rules);
+
+	// Puts every change into the state returned for it, in a single batch. Changes which depend on other
+	// changes are retried until none of the remaining ones can be applied, returns the number of changes put into their state
+	int32 ApplyMergeStates(TFunctionRef<EMergeState(const MergeGraphChange&)> GetMergeState);
+
+	// The diffs the change list was generated from, together with the node mappings used to generate it
+	const FSourceGraphDiffs& GetRemoteDifferences() const { return RemoteDifferences; }
+	const FSourceGraphDiffs& GetLocalDifferences() const { return LocalDifferences; }
+	const TMap<UEdGraphNode*, UEdGraphNode*>& GetRemoteToBaseNodeMap() const { return RemoteToBaseNodeMap; }
+	const TMap<UEdGraphNode*, UEdGraphNode*>& GetLocalToBaseNodeMap() const { return LocalToBaseNodeMap; }
+
 	UEdGraphNode* FindNodeInTargetGraph(UEdGraphNode* Node);
 
+	// Records a node of one of the graphs as edited, nodes of other graphs are ignored
+	void AddEditedNode(UEdGraph* Graph, UEdGraphNode* Node);
+
+	// Processes the edits made to the graphs since the last flush, returns true if there were any
+	bool FlushGraphEdits();
+
+	// Bumped whenever the change list is generated again, changes which are kept across an update keep their MergeGraphChange
+	uint32 GetChangeListRevision() const { return ChangeListRevision; }
+
+	/** FGCObject interface */
+	void AddReferencedObjects(FReferenceCollector& Collector) override;
+
 public:
 	const FName GraphName;
 	TArray<TSharedPtr<MergeGraphChange>> ChangeList;
 
+	// Broadcast after the change list was updated because one of the graphs was edited, or after their state changed
+	// because the target graph was. Changes which still exist keep their MergeGraphChange and state
+	FOnMergeChangeListUpdated OnChangeListUpdated;
+
 private:
+	// Graph edits
+	void OnGraphChanged(const FEdGraphEditAction& Action);
+
+	// Returns true if any of the edited nodes were removed from the target graph
+	bool ForgetRemovedTargetNodes(const TSet<UEdGraphNode*>& EditedTargetNodes);
+	void UpdateChangeList();
+
+	// Changes applied in a batch notify the target graph once, when the outermost batch ends. The edits
+	// of the outermost batch are a single transaction, described by the description of that batch
+	void BeginEditBatch(const FText& Description);
+	void EndEditBatch();
+	void NotifyTargetGraphChanged();
+
+	struct FScopedEditBatch
+	{
+		FScopedEditBatch(GraphMergeHelper& InHelper, const FText& Description) : Helper(InHelper) { Helper.BeginEditBatch(Description); }
+		~FScopedEditBatch() { Helper.EndEditBatch(); }
+
+		GraphMergeHelper& Helper;
+	};
+
+	int32 EditBatchDepth = 0;
+	bool bTargetGraphChangedInBatch = false;
+
+	// The transaction is only opened right before the batch edits the target graph, so batches
+	// which do not change anything do not end up in the undo history
+	void BeginTransaction();
+	void RecordMergeStates();
+	void OnTransactionUndone();
+
+	TUniquePtr<FScopedTransaction> Transaction;
+	FText TransactionDescription;
+
+	// Recorded in every transaction, together with the nodes the transaction edits
+	UMergeTransactionState* TransactionState;
+
+	// Every change whose state was recorded, by the index of its state in the transaction state. Changes
+	// which were replaced when the change list was updated are kept, since older transactions refer to them
+	TArray<TSharedPtr<MergeGraphChange>> RecordedChanges;
+	TMap<const MergeGraphChange*, int32> RecordedChangeIndices;
+
+	// Recording the states only goes over the whole change list when it was updated since it was last recorded,
+	// otherwise only the changes whose state was set through SetMergeState are recorded
+	void SetMergeState(MergeGraphChange& Change, EMergeState State);
+	TArray<const MergeGraphChange*> ChangesWithNewState;
+	uint32 ChangeListRevision = 1;
+	uint32 RecordedChangeListRevision = 0;
+
 	UEdGraphNode* GetBaseNodeInTargetGraph(UEdGraphNode* SourceNode);
 
 	bool ApplyDiff(const FMergeDiffResult& Diff, const bool bCanWrite);
@@ -68,27 +304,80 @@ private:
 
 	bool CloneToTarget(UEdGraphNode* SourceNode, bool bRestoreLinks, const bool CanWrite, UEdGraphNode** OutNewNode = nullptr);
 
-	// Graphs
-	UEdGraph* const RemoteGraph;
-	UEdGraph* const BaseGraph;
-	UEdGraph* const LocalGraph;
-	UEdGraph* const TargetGraph;	
+	// Uncached versions of CanApplyRemoteChange, CanApplyLocalChange and CanRevertChange
+	bool CheckApplyRemoteChange(MergeGraphChange& Change);
+	bool CheckApplyLocalChange(MergeGraphChange& Change);
+	bool CheckRevertChange(MergeGraphChange& Change);
+
+	// Composite changes, checking whether they can be put into the base state checks if they can be reverted
+	bool CanApplySubChanges(MergeGraphChange& Change, EMergeState State);
+	bool ApplySubChanges(MergeGraphChange& Change, EMergeState State);
+	bool RevertSubChanges(MergeGraphChange& Change);
+
+	// Graph changes, the change of the graph as a whole is kept when the change list is updated
+	void UpdateGraphChange();
+	UEdGraph* GetGraphChangeSource(const FMergeDiffResult& Diff) const;
+	bool IsTargetGraphListed() const;
+	void ClearTargetGraph();
+
+	TSharedPtr<MergeGraphChange> GraphChange;
+
+	// The graphs of the target blueprint the target graph belongs to, null for nested graphs
+	TArray<UEdGraph*>* TargetGraphList = nullptr;
+	UBlueprint* TargetBlueprint = nullptr;
+
+	// Graphs, these are kept alive by the helper since it is subscribed to their changes
+	UEdGraph* RemoteGraph;
+	UEdGraph* BaseGraph;
+	UEdGraph* LocalGraph;
+	UEdGraph* TargetGraph;
 
 	bool bHasRemoteChanges;
 	bool bHasLocalChanges;
 	bool bHasConflicts;
 
+	// Diffs of the source graphs, the change list is generated from these
+	FSourceGraphDiffs RemoteDifferences;
+	FSourceGraphDiffs LocalDifferences;
+
+	// Nodes edited since the last flush, by the graph they were in when they were edited. The diffs are deferred
+	// while the graphs are diffed over multiple frames, the edits are processed once they are set
+	TMap<UEdGraph*, TSet<UEdGraphNode*>> EditedNodes;
+	bool bDiffsDeferred = false;
+
+	// Set while the helper itself modifies the target graph, so those edits are not picked up
+	bool bIsModifyingTarget = false;
+
+	FDelegateHandle GraphChangedHandles[4];
+
+	// Whether the changes can be applied or reverted is cached, the cache is invalidated by bumping
+	// the revision whenever the target graph or the change list is modified
+	struct FCachedApplicability
+	{
+		uint32 Revision = 0;
+		bool bCanApplyRemote = false;
+		bool bCanApplyLocal = false;
+		bool bCanRevert = false;
+	};
+
+	const FCachedApplicability& GetApplicability(MergeGraphChange& Change);
+
+	TMap<const MergeGraphChange*, FCachedApplicability> ApplicabilityCache;
+	uint32 ApplicabilityRevision = 1;
+
+	// The conflict counts are invalidated by the same revision
+	mutable FMergeConflictCounts ConflictCounts;
+	mutable uint32 ConflictCountsRevision = 0;
+
 	// Mapping of nodes between the different maps, note that we only need 
-	// to map towards the target graph, so remote/local -> base -> target
+	// to map towards the target graph, so remote/local -> base -> target.
+	// The base to target map is the mapping of the clone of the base graph,
+	// base nodes which were removed or restored since then are mapped by
+	// the transaction state instead, along with the new nodes
 	TMap<UEdGraphNode*, UEdGraphNode*> BaseToTargetNodeMap;
 	TMap<UEdGraphNode*, UEdGraphNode*> RemoteToBaseNodeMap;
 	TMap<UEdGraphNode*, UEdGraphNode*> LocalToBaseNodeMap;
 
-	// New nodes are an exception for this however, since they do not 
-	// exist in the base graph. So we directly map between these and 
-	// the target graph
-	TMap<UEdGraphNode*, UEdGraphNode*> NewNodesInTargetGraph;
-
 	bool ApplyDiff_NODE_REMOVED     (const FMergeDiffResult& Diff, const bool bCanWrite);
 	bool ApplyDiff_NODE_ADDED       (const FMergeDiffResult& Diff, const bool bCanWrite);
 	bool ApplyDiff_PIN_REMOVED      (const FMergeDiffResult& Diff, const bool bCanWrite);
@@ -98,6 +387,9 @@ private:
 	bool ApplyDiff_PIN_DEFAULT_VALUE(const FMergeDiffResult& Diff, const bool bCanWrite);
 	bool ApplyDiff_NODE_MOVED       (const FMergeDiffResult& Diff, const bool bCanWrite);
 	bool ApplyDiff_NODE_COMMENT     (const FMergeDiffResult& Diff, const bool bCanWrite);
+	bool ApplyDiff_GRAPH_ADDED      (const FMergeDiffResult& Diff, const bool bCanWrite);
+	bool ApplyDiff_GRAPH_REMOVED    (const FMergeDiffResult& Diff, const bool bCanWrite);
+	bool ApplyDiff_GRAPH_CHANGED    (const FMergeDiffResult& Diff, const bool bCanWrite);
 
 	bool RevertDiff_NODE_REMOVED     (const FMergeDiffResult& Diff, const bool bCanWrite);
 	bool RevertDiff_NODE_ADDED       (const FMergeDiffResult& Diff, const bool bCanWrite);
@@ -108,4 +400,7 @@ private:
 	bool RevertDiff_PIN_DEFAULT_VALUE(const FMergeDiffResult& Diff, const bool bCanWrite);
 	bool RevertDiff_NODE_MOVED       (const FMergeDiffResult& Diff, const bool bCanWrite);
 	bool RevertDiff_NODE_COMMENT     (const FMergeDiffResult& Diff, const bool bCanWrite);
+	bool RevertDiff_GRAPH_ADDED      (const FMergeDiffResult& Diff, const bool bCanWrite);
+	bool RevertDiff_GRAPH_REMOVED    (const FMergeDiffResult& Diff, const bool bCanWrite);
+	bool RevertDiff_GRAPH_CHANGED    (const FMergeDiffResult& Diff, const bool bCanWrite);
 };
@@ -0,0 +1,340 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GraphSnapshot.h"
+#include "MergeAssistStats.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraph/EdGraphNode.h"
+#include "EdGraph/EdGraphPin.h"
+#include "Serialization/Archive.h"
+#include "Misc/SecureHash.h"
+
+// Stored at the start of the snapshot, the tables follow in the order of the counts
+struct FGraphSnapshotHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	FGuid GraphGuid;
+	int32 NumNodes;
+	int32 NumPins;
+	int32 NumLinks;
+	int32 NumStrings;
+	int32 NumChars;
+};
+
+static const uint32 GraphSnapshotMagic = 0x4D414753; // 'MAGS'
+
+// Needs to be increased whenever the layout of the snapshot changes
+static const uint32 GraphSnapshotVersion = 1;
+
+// Byte offsets of the tables in the storage
+struct FGraphSnapshotLayout
+{
+	int64 Nodes;
+	int64 Pins;
+	int64 LinkTargets;
+	int64 StringOffsets;
+	int64 Chars;
+	int64 Size;
+
+	explicit FGraphSnapshotLayout(const FGraphSnapshotHeader& Header)
+	{
+		Nodes = Align(sizeof(FGraphSnapshotHeader), alignof(FGraphSnapshot::FNode));
+		Pins = Align(Nodes + int64(Header.NumNodes) * sizeof(FGraphSnapshot::FNode), alignof(FGraphSnapshot::FPin));
+		LinkTargets = Align(Pins + int64(Header.NumPins) * sizeof(FGraphSnapshot::FPin), alignof(int32));
+		StringOffsets = LinkTargets + int64(Header.NumLinks) * sizeof(int32);
+		Chars = Align(StringOffsets + int64(Header.NumStrings) * sizeof(int32), alignof(TCHAR));
+		Size = Chars + int64(Header.NumChars) * sizeof(TCHAR);
+	}
+};
+
+// Interns the strings of a snapshot while it is being captured, index 0 is always the empty string
+struct FGraphSnapshotStrings
+{
+	FGraphSnapshotStrings() { Intern(FString()); }
+
+	int32 Intern(const FString& String)
+	{
+		if (const int32* Existing = Indices.Find(String)) return *Existing;
+
+		const int32 Index = Offsets.Add(Chars.Num());
+		Chars.Append(*String, String.Len());
+		Chars.Add(TEXT('\0'));
+
+		Indices.Add(String, Index);
+		return Index;
+	}
+
+	TMap<FString, int32> Indices;
+	TArray<int32> Offsets;
+	TArray<TCHAR> Chars;
+};
+
+template<typename ElementType>
+static void CopyTable(TArray<uint8>& Storage, int64 Offset, const TArray<ElementType>& Table)
+{
+	if (Table.Num()) FMemory::Memcpy(Storage.GetData() + Offset, Table.GetData(), Table.Num() * sizeof(ElementType));
+}
+
+FGraphSnapshot FGraphSnapshot::Capture(const UEdGraph* Graph)
+{
+	check(IsInGameThread());
+
+	FGraphSnapshot Snapshot;
+	if (!Graph) return Snapshot;
+
+	MERGEASSIST_SCOPE(CaptureSnapshot, Snapshot);
+
+	FGraphSnapshotStrings Strings;
+	TArray<FNode> NodeTable;
+	TArray<FPin> PinTable;
+	TArray<int32> LinkTable;
+
+	// Assign the indices of the pins first, so the links can refer to them
+	TMap<const UEdGraphPin*, int32> PinIndices;
+	for (const UEdGraphNode* Node : Graph->Nodes)
+	{
+		if (!Node) continue;
+
+		for (const UEdGraphPin* Pin : Node->Pins)
+		{
+			if (Pin) PinIndices.Add(Pin, PinIndices.Num());
+		}
+	}
+
+	NodeTable.Reserve(Graph->Nodes.Num());
+	PinTable.Reserve(PinIndices.Num());
+
+	for (int32 NodeIndex = 0; NodeIndex < Graph->Nodes.Num(); ++NodeIndex)
+	{
+		const UEdGraphNode* Node = Graph->Nodes[NodeIndex];
+		if (!Node) continue;
+
+		FNode& NodeEntry = NodeTable[NodeTable.AddDefaulted()];
+		NodeEntry.Guid = Node->NodeGuid;
+		NodeEntry.Name = Strings.Intern(Node->GetName());
+		NodeEntry.Class = Strings.Intern(Node->GetClass()->GetPathName());
+		NodeEntry.Title = Strings.Intern(Node->GetNodeTitle(ENodeTitleType::FullTitle).ToString());
+		NodeEntry.ListTitle = Strings.Intern(Node->GetNodeTitle(ENodeTitleType::ListView).ToString());
+		NodeEntry.Comment = Strings.Intern(Node->NodeComment);
+		NodeEntry.PosX = Node->NodePosX;
+		NodeEntry.PosY = Node->NodePosY;
+		NodeEntry.FirstPin = PinTable.Num();
+		NodeEntry.NumPins = 0;
+		NodeEntry.SourceIndex = NodeIndex;
+
+		for (int32 PinIndex = 0; PinIndex < Node->Pins.Num(); ++PinIndex)
+		{
+			const UEdGraphPin* Pin = Node->Pins[PinIndex];
+			if (!Pin) continue;
+
+			FPin& PinEntry = PinTable[PinTable.AddDefaulted()];
+			PinEntry.Name = Strings.Intern(Pin->PinName.ToString());
+			PinEntry.DisplayName = Strings.Intern(Pin->GetDisplayName().ToString());
+			PinEntry.DefaultValue = Strings.Intern(Pin->DefaultValue);
+			PinEntry.DefaultText = Strings.Intern(Pin->DefaultTextValue.ToString());
+			PinEntry.DefaultObject = Strings.Intern(Pin->DefaultObject ? Pin->DefaultObject->GetPathName() : FString());
+			PinEntry.DefaultAsText = Strings.Intern(Pin->GetDefaultAsText().ToString());
+			PinEntry.Node = NodeTable.Num() - 1;
+			PinEntry.FirstLink = LinkTable.Num();
+			PinEntry.NumLinks = 0;
+			PinEntry.SourceIndex = PinIndex;
+			PinEntry.Direction = static_cast<uint8>(Pin->Direction);
+			PinEntry.bHidden = Pin->bHidden ? 1 : 0;
+
+			// Links to pins outside of the graph can not be represented, these should not exist
+			for (const UEdGraphPin* Target : Pin->LinkedTo)
+			{
+				if (const int32* TargetIndex = PinIndices.Find(Target))
+				{
+					LinkTable.Add(*TargetIndex);
+					PinEntry.NumLinks++;
+				}
+			}
+
+			NodeEntry.NumPins++;
+		}
+	}
+
+	FGraphSnapshotHeader Header = {};
+	Header.Magic = GraphSnapshotMagic;
+	Header.Version = GraphSnapshotVersion;
+	Header.GraphGuid = Graph->GraphGuid;
+	Header.NumNodes = NodeTable.Num();
+	Header.NumPins = PinTable.Num();
+	Header.NumLinks = LinkTable.Num();
+	Header.NumStrings = Strings.Offsets.Num();
+	Header.NumChars = Strings.Chars.Num();
+
+	const FGraphSnapshotLayout Layout(Header);
+
+	Snapshot.Storage.SetNumZeroed(static_cast<int32>(Layout.Size));
+	FMemory::Memcpy(Snapshot.Storage.GetData(), &Header, sizeof(Header));
+	CopyTable(Snapshot.Storage, Layout.Nodes, NodeTable);
+	CopyTable(Snapshot.Storage, Layout.Pins, PinTable);
+	CopyTable(Snapshot.Storage, Layout.LinkTargets, LinkTable);
+	CopyTable(Snapshot.Storage, Layout.StringOffsets, Strings.Offsets);
+	CopyTable(Snapshot.Storage, Layout.Chars, Strings.Chars);
+
+	verify(Snapshot.InitializeTables(Snapshot.Storage.GetData(), Snapshot.Storage.Num()));
+
+	MERGEASSIST_COUNT(Nodes, Header.NumNodes);
+	MERGEASSIST_COUNT(Pins, Header.NumPins);
+	MERGEASSIST_COUNT(Links, Header.NumLinks);
+
+	return Snapshot;
+}
+
+bool FGraphSnapshot::InitializeTables(const uint8* InData, int64 InSize)
+{
+	Data = nullptr;
+	Size = 0;
+	Nodes = TArrayView<const FNode>();
+	Pins = TArrayView<const FPin>();
+	LinkTargets = TArrayView<const int32>();
+	StringOffsets = TArrayView<const int32>();
+	Chars = TArrayView<const TCHAR>();
+
+	if (!InData || InSize < static_cast<int64>(sizeof(FGraphSnapshotHeader))) return false;
+
+	// The tables are aligned within the snapshot, so the data needs to be aligned as well
+	if (!IsAligned(InData, alignof(FGraphSnapshotHeader))) return false;
+
+	FGraphSnapshotHeader Header;
+	FMemory::Memcpy(&Header, InData, sizeof(Header));
+
+	if (Header.Magic != GraphSnapshotMagic || Header.Version != GraphSnapshotVersion) return false;
+	if (Header.NumNodes < 0 || Header.NumPins < 0 || Header.NumLinks < 0 || Header.NumStrings < 1 || Header.NumChars < 1) return false;
+
+	const FGraphSnapshotLayout Layout(Header);
+	if (Layout.Size != InSize) return false;
+
+	GraphGuid = Header.GraphGuid;
+	Nodes = TArrayView<const FNode>(reinterpret_cast<const FNode*>(InData + Layout.Nodes), Header.NumNodes);
+	Pins = TArrayView<const FPin>(reinterpret_cast<const FPin*>(InData + Layout.Pins), Header.NumPins);
+	LinkTargets = TArrayView<const int32>(reinterpret_cast<const int32*>(InData + Layout.LinkTargets), Header.NumLinks);
+	StringOffsets = TArrayView<const int32>(reinterpret_cast<const int32*>(InData + Layout.StringOffsets), Header.NumStrings);
+	Chars = TArrayView<const TCHAR>(reinterpret_cast<const TCHAR*>(InData + Layout.Chars), Header.NumChars);
+
+	// The tables are read without bounds checks, so make sure all the indices are valid. Snapshots
+	// are read back from disk, where they could be truncated or corrupted
+	if (!AreTablesValid())
+	{
+		Nodes = TArrayView<const FNode>();
+		Pins = TArrayView<const FPin>();
+		LinkTargets = TArrayView<const int32>();
+		StringOffsets = TArrayView<const int32>();
+		Chars = TArrayView<const TCHAR>();
+		return false;
+	}
+
+	Data = InData;
+	Size = InSize;
+	return true;
+}
+
+bool FGraphSnapshot::AreTablesValid() const
+{
+	const auto IsValidString = [this](int32 Index) { return Index >= 0 && Index < StringOffsets.Num(); };
+
+	// Every string needs to be terminated before the end of the characters
+	if (Chars[Chars.Num() - 1] != TEXT('\0')) return false;
+
+	for (const int32 Offset : StringOffsets)
+	{
+		if (Offset < 0 || Offset >= Chars.Num()) return false;
+	}
+
+	for (const FNode& Node : Nodes)
+	{
+		if (!IsValidString(Node.Name) || !IsValidString(Node.Class) || !IsValidString(Node.Title)
+			|| !IsValidString(Node.ListTitle) || !IsValidString(Node.Comment)) return false;
+
+		if (Node.FirstPin < 0 || Node.NumPins < 0 || Node.FirstPin + Node.NumPins > Pins.Num()) return false;
+	}
+
+	for (const FPin& Pin : Pins)
+	{
+		if (!IsValidString(Pin.Name) || !IsValidString(Pin.DisplayName) || !IsValidString(Pin.DefaultValue)
+			|| !IsValidString(Pin.DefaultText) || !IsValidString(Pin.DefaultObject) || !IsValidString(Pin.DefaultAsText)) return false;
+
+		if (Pin.Node < 0 || Pin.Node >= Nodes.Num()) return false;
+		if (Pin.FirstLink < 0 || Pin.NumLinks < 0 || Pin.FirstLink + Pin.NumLinks > LinkTargets.Num()) return false;
+	}
+
+	for (const int32 Target : LinkTargets)
+	{
+		if (Target < 0 || Target >= Pins.Num()) return false;
+	}
+
+	return true;
+}
+
+UEdGraphNode* FGraphSnapshot::FindSourceNode(const UEdGraph* Graph, int32 NodeIndex) const
+{
+	if (!Graph || NodeIndex == INDEX_NONE) return nullptr;
+
+	const int32 SourceIndex = Nodes[NodeIndex].SourceIndex;
+	return Graph->Nodes.IsValidIndex(SourceIndex) ? Graph->Nodes[SourceIndex] : nullptr;
+}
+
+UEdGraphPin* FGraphSnapshot::FindSourcePin(const UEdGraph* Graph, int32 PinIndex) const
+{
+	if (PinIndex == INDEX_NONE) return nullptr;
+
+	const FPin& Pin = Pins[PinIndex];
+	UEdGraphNode* Node = FindSourceNode(Graph, Pin.Node);
+
+	return Node && Node->Pins.IsValidIndex(Pin.SourceIndex) ? Node->Pins[Pin.SourceIndex] : nullptr;
+}
+
+FString FGraphSnapshot::GetContentHash() const
+{
+	if (!IsValid()) return FString();
+
+	FMD5 Hash;
+	Hash.Update(reinterpret_cast<const uint8*>(&GraphGuid), sizeof(GraphGuid));
+
+	const auto UpdateTable = [&Hash](const auto& Table)
+	{
+		if (Table.Num()) Hash.Update(reinterpret_cast<const uint8*>(Table.GetData()), Table.Num() * sizeof(Table[0]));
+	};
+
+	// The pins have padding at the end, which is not initialized when they are captured
+	UpdateTable(Nodes);
+	for (const FPin& Pin : Pins)
+	{
+		Hash.Update(reinterpret_cast<const uint8*>(&Pin), STRUCT_OFFSET(FPin, bHidden) + sizeof(Pin.bHidden));
+	}
+
+	UpdateTable(LinkTargets);
+	UpdateTable(StringOffsets);
+	UpdateTable(Chars);
+
+	uint8 Digest[16];
+	Hash.Final(Digest);
+	return BytesToHex(Digest, sizeof(Digest));
+}
+
+FArchive& operator<<(FArchive& Ar, FGraphSnapshot& Snapshot)
+{
+	// The snapshot is stored as a single block, so it can be read back without any fix ups.
+	// This uses the same format as an array of bytes
+	if (Ar.IsLoading())
+	{
+		Ar << Snapshot.Storage;
+
+		if (!Snapshot.InitializeTables(Snapshot.Storage.GetData(), Snapshot.Storage.Num()))
+		{
+			Snapshot.Storage.Empty();
+			Ar.SetError();
+		}
+	}
+	else
+	{
+		int32 NumBytes = static_cast<int32>(Snapshot.Size);
+		Ar << NumBytes;
+		Ar.Serialize(const_cast<uint8*>(Snapshot.Data), NumBytes);
+	}
+
+	return Ar;
+}
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UEdGraph;
+class UEdGraphNode;
+class UEdGraphPin;
+
+// Flattened copy of a UEdGraph with everything the diff needs, without any references to
+// UObjects. Snapshots are captured on the game thread, after which they can be diffed on
+// any thread, see FGraphSnapshotDiff.
+//
+// All the tables are stored in a single block of memory, in the order they are declared in.
+// Strings are interned and referenced by their index, and the links of a pin are stored in
+// compressed sparse row form: the targets of a pin are LinkTargets[FirstLink, FirstLink + NumLinks)
+struct FGraphSnapshot
+{
+	struct FNode
+	{
+		FGuid Guid;
+		int32 Name;
+		int32 Class;
+		int32 Title;		// Full title, used for matching
+		int32 ListTitle;	// Title shown to the user
+		int32 Comment;
+		int32 PosX;
+		int32 PosY;
+		int32 FirstPin;
+		int32 NumPins;
+
+		// Index of the node in the Nodes array of the graph
+		int32 SourceIndex;
+	};
+
+	struct FPin
+	{
+		int32 Name;
+		int32 DisplayName;
+		int32 DefaultValue;
+		int32 DefaultText;
+		int32 DefaultObject;
+		int32 DefaultAsText;
+		int32 Node;
+		int32 FirstLink;
+		int32 NumLinks;
+
+		// Index of the pin in the Pins array of its node
+		int32 SourceIndex;
+
+		uint8 Direction;
+		uint8 bHidden;
+	};
+
+	FGraphSnapshot() = default;
+
+	// The tables point into the storage, so snapshots can be moved but not copied
+	FGraphSnapshot(FGraphSnapshot&&) = default;
+	FGraphSnapshot& operator=(FGraphSnapshot&&) = default;
+	FGraphSnapshot(const FGraphSnapshot&) = delete;
+	FGraphSnapshot& operator=(const FGraphSnapshot&) = delete;
+
+	// Must be called on the game thread
+	static FGraphSnapshot Capture(const UEdGraph* Graph);
+
+	bool IsValid() const { return Data != nullptr; }
+
+	const FGuid& GetGraphGuid() const { return GraphGuid; }
+
+	// Hash of everything the diff reads, snapshots of graphs with the same contents have the same hash
+	FString GetContentHash() const;
+
+	int32 NumNodes() const { return Nodes.Num(); }
+	int32 NumPins() const { return Pins.Num(); }
+	int32 NumLinks() const { return LinkTargets.Num(); }
+	int32 NumStrings() const { return StringOffsets.Num(); }
+
+	const FNode& GetNode(int32 Index) const { return Nodes[Index]; }
+	const FPin& GetPin(int32 Index) const { return Pins[Index]; }
+	TArrayView<const int32> GetLinkTargets(const FPin& Pin) const { return TArrayView<const int32>(LinkTargets.GetData() + Pin.FirstLink, Pin.NumLinks); }
+	const TCHAR* GetString(int32 Index) const { return Chars.GetData() + StringOffsets[Index]; }
+
+	// Finds the node or pin the snapshot was captured from, the graph must not have changed since
+	UEdGraphNode* FindSourceNode(const UEdGraph* Graph, int32 NodeIndex) const;
+	UEdGraphPin* FindSourcePin(const UEdGraph* Graph, int32 PinIndex) const;
+
+	// Size of the stored snapshot in bytes
+	int64 GetAllocatedSize() const { return Storage.Num(); }
+
+	friend FArchive& operator<<(FArchive& Ar, FGraphSnapshot& Snapshot);
+
+private:
+	// Points the tables into the data, returns false if the data is not a valid snapshot
+	bool InitializeTables(const uint8* InData, int64 InSize);
+	bool AreTablesValid() const;
+
+	TArray<uint8> Storage;
+
+	const uint8* Data = nullptr;
+	int64 Size = 0;
+
+	FGuid GraphGuid;
+	TArrayView<const FNode> Nodes;
+	TArrayView<const FPin> Pins;
+	TArrayView<const int32> LinkTargets;
+	TArrayView<const int32> StringOffsets;
+	TArrayView<const TCHAR> Chars;
+};
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GraphSnapshotCache.h"
+#include "EdGraph/EdGraph.h"
+#include "UObject/Package.h"
+
+TMap<const UEdGraph*, FGraphSnapshotCache::FCachedSnapshot> FGraphSnapshotCache::CachedSnapshots;
+
+TSharedRef<const FGraphSnapshot, ESPMode::ThreadSafe> FGraphSnapshotCache::FindOrCapture(const UEdGraph* Graph)
+{
+	check(IsInGameThread());
+
+	const FGuid PackageGuid = GetPackageGuid(Graph);
+	if (!PackageGuid.IsValid()) return MakeShared<FGraphSnapshot, ESPMode::ThreadSafe>(FGraphSnapshot::Capture(Graph));
+
+	// The package guid identifies the revision of the graph, so the snapshot does not need to be checked against the graph
+	const FCachedSnapshot* Cached = CachedSnapshots.Find(Graph);
+	if (Cached && Cached->Graph.Get() == Graph && Cached->PackageGuid == PackageGuid) return Cached->Snapshot;
+
+	// Drop the snapshots of the graphs which were garbage collected, before their address is reused
+	for (auto It = CachedSnapshots.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().Graph.IsValid()) It.RemoveCurrent();
+	}
+
+	TSharedRef<const FGraphSnapshot, ESPMode::ThreadSafe> Snapshot = MakeShared<FGraphSnapshot, ESPMode::ThreadSafe>(FGraphSnapshot::Capture(Graph));
+	CachedSnapshots.Add(Graph, FCachedSnapshot{ Graph, PackageGuid, Snapshot });
+	return Snapshot;
+}
+
+void FGraphSnapshotCache::Clear()
+{
+	CachedSnapshots.Empty();
+}
+
+FGuid FGraphSnapshotCache::GetPackageGuid(const UEdGraph* Graph)
+{
+	if (!Graph) return FGuid();
+
+	const UPackage* Package = Graph->GetOutermost();
+
+	// The package guid only identifies the revision of a package which was loaded from disk and not changed since
+	if (Package == GetTransientPackage() || Package->HasAnyFlags(RF_Transient) || Package->IsDirty()) return FGuid();
+	return Package->GetGuid();
+}
@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GraphSnapshot.h"
+#include "UObject/WeakObjectPtr.h"
+
+class UEdGraph;
+
+// Keeps the snapshots of the graphs which are diffed in memory, so a graph which is diffed more than once, e.g. the
+// source graphs shared by the blueprints in the merge list, or a graph which is hashed for the merge session, is only captured once.
+//
+// Snapshots are keyed by the graph and the guid of the package it was loaded from, which changes every time the package
+// is saved. Graphs in transient or unsaved packages can change without their package guid changing, so they are always captured.
+// A snapshot is dropped from the cache once its graph is garbage collected
+class FGraphSnapshotCache
+{
+public:
+	// Returns the cached snapshot of the graph, or captures and caches it when there is none. Must be called on the game thread
+	static TSharedRef<const FGraphSnapshot, ESPMode::ThreadSafe> FindOrCapture(const UEdGraph* Graph);
+
+	// Drops all cached snapshots
+	static void Clear();
+
+private:
+	struct FCachedSnapshot
+	{
+		TWeakObjectPtr<const UEdGraph> Graph;
+		FGuid PackageGuid;
+		TSharedRef<const FGraphSnapshot, ESPMode::ThreadSafe> Snapshot;
+	};
+
+	// Returns an invalid guid if the snapshots of the graph can not be cached
+	static FGuid GetPackageGuid(const UEdGraph* Graph);
+
+	static TMap<const UEdGraph*, FCachedSnapshot> CachedSnapshots;
+};
@@ -0,0 +1,547 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GraphSnapshotDiff.h"
+#include "MergeAssistStats.h"
+#include "NodeSpatialIndex.h"
+#include "Async/ParallelFor.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraph/EdGraphNode.h"
+#include "EdGraph/EdGraphPin.h"
+
+static int32 AddDiff(TArray<FSnapshotDiffResult>* DiffsOut, EMergeDiffType Type,
+	int32 NodeOld, int32 NodeNew, int32 PinOld = INDEX_NONE, int32 PinNew = INDEX_NONE,
+	int32 LinkTargetOld = INDEX_NONE, int32 LinkTargetNew = INDEX_NONE)
+{
+	if (DiffsOut)
+	{
+		DiffsOut->Add(FSnapshotDiffResult{ Type, NodeOld, NodeNew, PinOld, PinNew, LinkTargetOld, LinkTargetNew });
+	}
+
+	return 1;
+}
+
+FGraphSnapshotDiff::FGraphSnapshotDiff(const FGraphSnapshot& OldSnapshot, const FGraphSnapshot& NewSnapshot)
+	: Old(OldSnapshot)
+	, New(NewSnapshot)
+{
+	TMap<FString, int32> OldStrings;
+	OldStrings.Reserve(Old.NumStrings());
+
+	for (int32 i = 0; i < Old.NumStrings(); ++i)
+	{
+		OldStrings.Add(Old.GetString(i), i);
+	}
+
+	NewToOldStrings.SetNumUninitialized(New.NumStrings());
+	for (int32 i = 0; i < New.NumStrings(); ++i)
+	{
+		const int32* OldIndex = OldStrings.Find(New.GetString(i));
+		NewToOldStrings[i] = OldIndex ? *OldIndex : -2 - i;
+	}
+}
+
+void FGraphSnapshotDiff::Diff(ENodeMatchStrategy MatchStrategy, bool bParallel)
+{
+	Diffs.Reset();
+	NodeMatches.Reset();
+	UnmatchedOldNodes.Reset();
+	UnmatchedNewNodes.Reset();
+
+	OldMatched.Init(false, Old.NumNodes());
+	NewMatched.Init(false, New.NumNodes());
+
+	MERGEASSIST_COUNT(Nodes, Old.NumNodes() + New.NumNodes());
+
+	// Call the different match algorithms based on the strategy
+	if (IsFlagSet(MatchStrategy, ENodeMatchStrategy::EXACT)) FindExactNodeMatches();
+	if (IsFlagSet(MatchStrategy, ENodeMatchStrategy::PROPAGATE)) FindPropagatedNodeMatches();
+	if (IsFlagSet(MatchStrategy, ENodeMatchStrategy::APPROXIMATE)) FindApproximateNodeMatches(bParallel);
+
+	for (int32 i = 0; i < Old.NumNodes(); ++i)
+	{
+		if (!OldMatched[i]) UnmatchedOldNodes.Add(i);
+	}
+
+	for (int32 i = 0; i < New.NumNodes(); ++i)
+	{
+		if (!NewMatched[i]) UnmatchedNewNodes.Add(i);
+	}
+
+	// Diff all the matched nodes, and the unmatched nodes to generate NODE_ADDED and NODE_REMOVED diffs
+	for (const FSnapshotNodeMatch& Match : NodeMatches) DiffNodes(Match.OldNode, Match.NewNode, &Diffs);
+	for (const int32 OldNode : UnmatchedOldNodes) DiffNodes(OldNode, INDEX_NONE, &Diffs);
+	for (const int32 NewNode : UnmatchedNewNodes) DiffNodes(INDEX_NONE, NewNode, &Diffs);
+
+	MERGEASSIST_COUNT(Diffs, Diffs.Num());
+}
+
+bool FGraphSnapshotDiff::IsExactNodeMatch(int32 OldNode, int32 NewNode) const
+{
+	const FGraphSnapshot::FNode& OldEntry = Old.GetNode(OldNode);
+	const FGraphSnapshot::FNode& NewEntry = New.GetNode(NewNode);
+
+	// Nodes with different classes (types) can never be a match
+	if (!IsSameString(OldEntry.Class, NewEntry.Class)) return false;
+
+	// nodes with the same GUID are a match
+	if (OldEntry.Guid == NewEntry.Guid) return true;
+
+	// Nodes of the same graph with the same name are the same node
+	return Old.GetGraphGuid() == New.GetGraphGuid() && IsSameString(OldEntry.Name, NewEntry.Name);
+}
+
+bool FGraphSnapshotDiff::WeakNodeMatch(int32 OldNode, int32 NewNode) const
+{
+	if (IsExactNodeMatch(OldNode, NewNode)) return true;
+
+	const FGraphSnapshot::FNode& OldEntry = Old.GetNode(OldNode);
+	const FGraphSnapshot::FNode& NewEntry = New.GetNode(NewNode);
+
+	return IsSameString(OldEntry.Class, NewEntry.Class) && IsSameString(OldEntry.Title, NewEntry.Title);
+}
+
+void FGraphSnapshotDiff::FindExactNodeMatches()
+{
+	MERGEASSIST_SCOPE(FindExactNodeMatches, Matching);
+
+	// Only nodes with the same guid or name can be exact matches, names are keyed by their index in the old snapshot
+	TMultiMap<FGuid, int32> NewNodesByGuid;
+	TMultiMap<int32, int32> NewNodesByName;
+
+	for (int32 i = 0; i < New.NumNodes(); ++i)
+	{
+		NewNodesByGuid.Add(New.GetNode(i).Guid, i);
+		NewNodesByName.Add(NewToOldStrings[New.GetNode(i).Name], i);
+	}
+
+	TArray<int32> Candidates;
+	int32 NumCandidatePairs = 0;
+
+	for (int32 OldNode = 0; OldNode < Old.NumNodes(); ++OldNode)
+	{
+		Candidates.Reset();
+		NewNodesByGuid.MultiFind(Old.GetNode(OldNode).Guid, Candidates);
+		NewNodesByName.MultiFind(Old.GetNode(OldNode).Name, Candidates);
+
+		// Same as FDiffHelper::FindExactNodeMatches, match the first unmatched node of the new graph
+		int32 BestNode = INDEX_NONE;
+		for (const int32 Candidate : Candidates)
+		{
+			if (NewMatched[Candidate] || (BestNode != INDEX_NONE && Candidate >= BestNode)) continue;
+
+			++NumCandidatePairs;
+			if (IsExactNodeMatch(OldNode, Candidate)) BestNode = Candidate;
+		}
+
+		if (BestNode != INDEX_NONE) AddMatch(OldNode, BestNode);
+	}
+
+	MERGEASSIST_COUNT(CandidatePairs, NumCandidatePairs);
+}
+
+void FGraphSnapshotDiff::FindPropagatedNodeMatches()
+{
+	MERGEASSIST_SCOPE(PropagateNodeMatches, Matching);
+
+	// Same as FDiffHelper::FindPropagatedNodeMatches, the matches found so far are the worklist
+	for (int32 i = 0; i < NodeMatches.Num(); ++i)
+	{
+		const FSnapshotNodeMatch Match = NodeMatches[i];
+		PropagateNodeMatch(Match);
+	}
+}
+
+void FGraphSnapshotDiff::PropagateNodeMatch(const FSnapshotNodeMatch& Match)
+{
+	// Returns the only candidate which is linked through the same pin of a node of the same type, or INDEX_NONE
+	const auto FindUniqueTarget = [](const FGraphSnapshot& TargetSnapshot, const FGraphSnapshot& CandidateSnapshot, int32 Target,
+		TArrayView<const int32> Candidates, const TBitArray<>& CandidateMatched, const TFunctionRef<bool(int32, int32)>& IsSameString)
+	{
+		const FGraphSnapshot::FPin& TargetPin = TargetSnapshot.GetPin(Target);
+		const FGraphSnapshot::FNode& TargetNode = TargetSnapshot.GetNode(TargetPin.Node);
+
+		int32 UniqueCandidate = INDEX_NONE;
+		for (const int32 Candidate : Candidates)
+		{
+			const FGraphSnapshot::FPin& CandidatePin = CandidateSnapshot.GetPin(Candidate);
+			if (CandidateMatched[CandidatePin.Node]) continue;
+
+			const FGraphSnapshot::FNode& CandidateNode = CandidateSnapshot.GetNode(CandidatePin.Node);
+			const bool bIsSameTarget = CandidatePin.Direction == TargetPin.Direction
+				&& IsSameString(TargetPin.Name, CandidatePin.Name)
+				&& IsSameString(TargetNode.Class, CandidateNode.Class)
+				&& IsSameString(TargetNode.Title, CandidateNode.Title);
+
+			if (!bIsSameTarget) continue;
+			if (UniqueCandidate != INDEX_NONE) return INDEX_NONE;
+
+			UniqueCandidate = Candidate;
+		}
+
+		return UniqueCandidate;
+	};
+
+	// Strings are compared in the direction of the lookup, from the old to the new snapshot or the other way around
+	const auto IsSameOldToNew = [this](int32 OldString, int32 NewString) { return IsSameString(OldString, NewString); };
+	const auto IsSameNewToOld = [this](int32 NewString, int32 OldString) { return IsSameString(OldString, NewString); };
+
+	const FGraphSnapshot::FNode& OldEntry = Old.GetNode(Match.OldNode);
+	const FGraphSnapshot::FNode& NewEntry = New.GetNode(Match.NewNode);
+
+	// Match the visible pins by name, the same way DiffNodes does
+	TArray<int32, TInlineAllocator<16>> UnmatchedNewPins;
+	for (int32 Pin = NewEntry.FirstPin; Pin < NewEntry.FirstPin + NewEntry.NumPins; ++Pin)
+	{
+		if (!New.GetPin(Pin).bHidden) UnmatchedNewPins.Add(Pin);
+	}
+
+	for (int32 OldPin = OldEntry.FirstPin; OldPin < OldEntry.FirstPin + OldEntry.NumPins; ++OldPin)
+	{
+		if (Old.GetPin(OldPin).bHidden) continue;
+
+		const int32 NewIndex = UnmatchedNewPins.IndexOfByPredicate([this, OldPin](int32 NewPin)
+		{
+			return IsSameString(Old.GetPin(OldPin).Name, New.GetPin(NewPin).Name);
+		});
+
+		if (NewIndex == INDEX_NONE) continue;
+
+		const int32 NewPin = UnmatchedNewPins[NewIndex];
+		UnmatchedNewPins.RemoveAt(NewIndex);
+
+		const TArrayView<const int32> OldTargets = Old.GetLinkTargets(Old.GetPin(OldPin));
+		const TArrayView<const int32> NewTargets = New.GetLinkTargets(New.GetPin(NewPin));
+
+		for (const int32 OldTarget : OldTargets)
+		{
+			const int32 OldNeighbour = Old.GetPin(OldTarget).Node;
+			if (OldMatched[OldNeighbour]) continue;
+
+			const int32 NewTarget = FindUniqueTarget(Old, New, OldTarget, NewTargets, NewMatched, IsSameOldToNew);
+			if (NewTarget == INDEX_NONE) continue;
+
+			// The match needs to be unique both ways, otherwise two identical neighbours would be told apart by their order
+			if (FindUniqueTarget(New, Old, NewTarget, OldTargets, OldMatched, IsSameNewToOld) != OldTarget) continue;
+
+			AddMatch(OldNeighbour, New.GetPin(NewTarget).Node);
+		}
+	}
+}
+
+void FGraphSnapshotDiff::AddMatch(int32 OldNode, int32 NewNode)
+{
+	OldMatched[OldNode] = true;
+	NewMatched[NewNode] = true;
+	NodeMatches.Add(FSnapshotNodeMatch{ OldNode, NewNode });
+}
+
+void FGraphSnapshotDiff::FindApproximateNodeMatches(bool bParallel)
+{
+	MERGEASSIST_SCOPE(FindApproximateNodeMatches, Matching);
+
+	struct FNodeTypeBucket
+	{
+		TArray<int32> OldNodes;
+		TArray<int32> NewNodes;
+	};
+
+	// Bucket the unmatched nodes by their class and title, using the string indices of the old snapshot
+	TArray<FNodeTypeBucket> Buckets;
+	TMap<TPair<int32, int32>, int32> BucketIndices;
+
+	for (int32 OldNode = 0; OldNode < Old.NumNodes(); ++OldNode)
+	{
+		if (OldMatched[OldNode]) continue;
+
+		const FGraphSnapshot::FNode& Entry = Old.GetNode(OldNode);
+		const TPair<int32, int32> Key(Entry.Class, Entry.Title);
+
+		const int32* ExistingBucket = BucketIndices.Find(Key);
+		const int32 Bucket = ExistingBucket ? *ExistingBucket : BucketIndices.Add(Key, Buckets.AddDefaulted());
+		Buckets[Bucket].OldNodes.Add(OldNode);
+	}
+
+	for (int32 NewNode = 0; NewNode < New.NumNodes(); ++NewNode)
+	{
+		if (NewMatched[NewNode]) continue;
+
+		// Types which do not exist in the old graph can not be matched
+		const FGraphSnapshot::FNode& Entry = New.GetNode(NewNode);
+		const int32* Bucket = BucketIndices.Find(TPair<int32, int32>(NewToOldStrings[Entry.Class], NewToOldStrings[Entry.Title]));
+		if (Bucket) Buckets[*Bucket].NewNodes.Add(NewNode);
+	}
+
+	// The matches of a bucket never affect another bucket, since every node is in a single bucket
+	TArray<TArray<FSnapshotNodeMatch>> BucketMatches;
+	BucketMatches.SetNum(Buckets.Num());
+
+	ParallelFor(Buckets.Num(), [this, &Buckets, &BucketMatches, bParallel](int32 Index)
+	{
+		const FNodeTypeBucket& Bucket = Buckets[Index];
+		if (Bucket.OldNodes.Num() && Bucket.NewNodes.Num())
+		{
+			FindApproximateNodeMatchesBetweenNodesOfTheSameType(Bucket.OldNodes, Bucket.NewNodes, bParallel, BucketMatches[Index]);
+		}
+	}, !bParallel);
+
+	// Add the matches in the order of the buckets, so the results do not depend on the order the tasks finished in
+	for (const TArray<FSnapshotNodeMatch>& Matches : BucketMatches)
+	{
+		for (const FSnapshotNodeMatch& Match : Matches) AddMatch(Match.OldNode, Match.NewNode);
+	}
+}
+
+void FGraphSnapshotDiff::FindApproximateNodeMatchesBetweenNodesOfTheSameType(const TArray<int32>& OldNodes, const TArray<int32>& NewNodes,
+	bool bParallel, TArray<FSnapshotNodeMatch>& MatchesOut) const
+{
+	struct FPotentialNodeMatch
+	{
+		int32 OldIndex;
+		int32 NewIndex;
+		int32 DiffCount;
+	};
+
+	// Number of pairs scored by a single task when scoring in parallel
+	static const int32 PairsPerTask = 256;
+
+	// Same as FDiffHelper, large sets of nodes are only paired with the nodes closest to them
+	TArray<int32> OldPositionsX;
+	TArray<int32> OldPositionsY;
+	TArray<int32> NewPositionsX;
+	TArray<int32> NewPositionsY;
+
+	for (const int32 OldNode : OldNodes)
+	{
+		OldPositionsX.Add(Old.GetNode(OldNode).PosX);
+		OldPositionsY.Add(Old.GetNode(OldNode).PosY);
+	}
+
+	for (const int32 NewNode : NewNodes)
+	{
+		NewPositionsX.Add(New.GetNode(NewNode).PosX);
+		NewPositionsY.Add(New.GetNode(NewNode).PosY);
+	}
+
+	TArray<TPair<int32, int32>> CandidatePairs;
+	FNodeSpatialIndex::FindCandidatePairs(OldPositionsX, OldPositionsY, NewPositionsX, NewPositionsY, CandidatePairs);
+
+	MERGEASSIST_COUNT(CandidatePairs, CandidatePairs.Num());
+
+	// Generate the potential matches, and assign them a weight based on the number of diffs. Every
+	// task writes its own range of the potential matches, so their order does not depend on the tasks
+	TArray<FPotentialNodeMatch> PotentialMatches;
+	PotentialMatches.SetNumUninitialized(CandidatePairs.Num());
+
+	const int32 NumTasks = FMath::DivideAndRoundUp(CandidatePairs.Num(), PairsPerTask);
+	ParallelFor(NumTasks, [this, &OldNodes, &NewNodes, &CandidatePairs, &PotentialMatches](int32 Task)
+	{
+		const int32 LastPair = FMath::Min((Task + 1) * PairsPerTask, CandidatePairs.Num());
+		for (int32 i = Task * PairsPerTask; i < LastPair; ++i)
+		{
+			const TPair<int32, int32>& Pair = CandidatePairs[i];
+			PotentialMatches[i] = FPotentialNodeMatch{ Pair.Key, Pair.Value, DiffNodes(OldNodes[Pair.Key], NewNodes[Pair.Value], nullptr) };
+		}
+	}, !bParallel || NumTasks < 2);
+
+	// The first match we encounter is the best match, a stable sort keeps the results deterministic
+	StableSort(PotentialMatches.GetData(), PotentialMatches.Num(), [](const FPotentialNodeMatch& A, const FPotentialNodeMatch& B)
+	{
+		return A.DiffCount < B.DiffCount;
+	});
+
+	// The nodes of this set are not in any other set, so which of them are matched can be tracked locally
+	TBitArray<> OldNodeMatched(false, OldNodes.Num());
+	TBitArray<> NewNodeMatched(false, NewNodes.Num());
+
+	for (const FPotentialNodeMatch& Match : PotentialMatches)
+	{
+		// Skip the matches which overlap with a better match
+		if (OldNodeMatched[Match.OldIndex] || NewNodeMatched[Match.NewIndex]) continue;
+
+		OldNodeMatched[Match.OldIndex] = true;
+		NewNodeMatched[Match.NewIndex] = true;
+		MatchesOut.Add(FSnapshotNodeMatch{ OldNodes[Match.OldIndex], NewNodes[Match.NewIndex] });
+	}
+}
+
+int32 FGraphSnapshotDiff::DiffNodes(int32 OldNode, int32 NewNode, TArray<FSnapshotDiffResult>* DiffsOut) const
+{
+	// Ensure that at least one of the nodes is passed in
+	if (OldNode == INDEX_NONE && NewNode == INDEX_NONE) return 0;
+
+	MERGEASSIST_SCOPE(DiffNodes, DiffNodes);
+
+	if (NewNode == INDEX_NONE) return AddDiff(DiffsOut, EMergeDiffType::NODE_REMOVED, OldNode, INDEX_NONE);
+	if (OldNode == INDEX_NONE) return AddDiff(DiffsOut, EMergeDiffType::NODE_ADDED, INDEX_NONE, NewNode);
+
+	const FGraphSnapshot::FNode& OldEntry = Old.GetNode(OldNode);
+	const FGraphSnapshot::FNode& NewEntry = New.GetNode(NewNode);
+
+	int32 NumDiffs = 0;
+
+	if (!IsSameString(OldEntry.Comment, NewEntry.Comment))
+	{
+		NumDiffs += AddDiff(DiffsOut, EMergeDiffType::NODE_COMMENT, OldNode, NewNode);
+	}
+
+	if (OldEntry.PosX != NewEntry.PosX || OldEntry.PosY != NewEntry.PosY)
+	{
+		NumDiffs += AddDiff(DiffsOut, EMergeDiffType::NODE_MOVED, OldNode, NewNode);
+	}
+
+	// Gather all the visible pins, and match them by name
+	TArray<int32, TInlineAllocator<16>> UnmatchedOldPins;
+	TArray<int32, TInlineAllocator<16>> UnmatchedNewPins;
+
+	for (int32 Pin = OldEntry.FirstPin; Pin < OldEntry.FirstPin + OldEntry.NumPins; ++Pin)
+	{
+		if (!Old.GetPin(Pin).bHidden) UnmatchedOldPins.Add(Pin);
+	}
+
+	for (int32 Pin = NewEntry.FirstPin; Pin < NewEntry.FirstPin + NewEntry.NumPins; ++Pin)
+	{
+		if (!New.GetPin(Pin).bHidden) UnmatchedNewPins.Add(Pin);
+	}
+
+	MERGEASSIST_COUNT(Pins, UnmatchedOldPins.Num() + UnmatchedNewPins.Num());
+
+	for (int32 i = 0; i < UnmatchedOldPins.Num(); ++i)
+	{
+		const int32 OldPin = UnmatchedOldPins[i];
+		const int32 NewIndex = UnmatchedNewPins.IndexOfByPredicate([this, OldPin](int32 NewPin)
+		{
+			return IsSameString(Old.GetPin(OldPin).Name, New.GetPin(NewPin).Name);
+		});
+
+		if (NewIndex == INDEX_NONE) continue;
+
+		NumDiffs += DiffPins(OldPin, UnmatchedNewPins[NewIndex], DiffsOut);
+
+		UnmatchedOldPins.RemoveAt(i--);
+		UnmatchedNewPins.RemoveAt(NewIndex);
+	}
+
+	// The unmatched pins generate PIN_REMOVED and PIN_ADDED diffs
+	for (const int32 OldPin : UnmatchedOldPins) NumDiffs += DiffPins(OldPin, INDEX_NONE, DiffsOut);
+	for (const int32 NewPin : UnmatchedNewPins) NumDiffs += DiffPins(INDEX_NONE, NewPin, DiffsOut);
+
+	return NumDiffs;
+}
+
+int32 FGraphSnapshotDiff::DiffPins(int32 OldPin, int32 NewPin, TArray<FSnapshotDiffResult>* DiffsOut) const
+{
+	if (NewPin == INDEX_NONE) return AddDiff(DiffsOut, EMergeDiffType::PIN_REMOVED, INDEX_NONE, INDEX_NONE, OldPin, INDEX_NONE);
+	if (OldPin == INDEX_NONE) return AddDiff(DiffsOut, EMergeDiffType::PIN_ADDED, INDEX_NONE, INDEX_NONE, INDEX_NONE, NewPin);
+
+	const FGraphSnapshot::FPin& OldEntry = Old.GetPin(OldPin);
+	const FGraphSnapshot::FPin& NewEntry = New.GetPin(NewPin);
+
+	int32 NumDiffs = 0;
+
+	const bool bDefaultValueChanged = !IsSameString(OldEntry.DefaultObject, NewEntry.DefaultObject)
+		|| !IsSameString(OldEntry.DefaultText, NewEntry.DefaultText)
+		|| !IsSameString(OldEntry.DefaultValue, NewEntry.DefaultValue);
+
+	// The default value is hidden from the user when the new pin has links
+	if (NewEntry.NumLinks == 0 && bDefaultValueChanged)
+	{
+		NumDiffs += AddDiff(DiffsOut, EMergeDiffType::PIN_DEFAULT_VALUE, INDEX_NONE, INDEX_NONE, OldPin, NewPin);
+	}
+
+	TArray<int32, TInlineAllocator<8>> UnmatchedOldTargets(Old.GetLinkTargets(OldEntry).GetData(), OldEntry.NumLinks);
+	TArray<int32, TInlineAllocator<8>> UnmatchedNewTargets(New.GetLinkTargets(NewEntry).GetData(), NewEntry.NumLinks);
+
+	MERGEASSIST_COUNT(Links, UnmatchedOldTargets.Num() + UnmatchedNewTargets.Num());
+
+	// If the targets have the same name, direction, and owner then they are the same target
+	for (int32 i = 0; i < UnmatchedOldTargets.Num(); ++i)
+	{
+		const FGraphSnapshot::FPin& OldTarget = Old.GetPin(UnmatchedOldTargets[i]);
+		const int32 NewIndex = UnmatchedNewTargets.IndexOfByPredicate([this, &OldTarget](int32 NewTargetIndex)
+		{
+			const FGraphSnapshot::FPin& NewTarget = New.GetPin(NewTargetIndex);
+			return OldTarget.Direction == NewTarget.Direction
+				&& IsSameString(OldTarget.Name, NewTarget.Name)
+				&& WeakNodeMatch(OldTarget.Node, NewTarget.Node);
+		});
+
+		if (NewIndex == INDEX_NONE) continue;
+
+		UnmatchedOldTargets.RemoveAt(i--);
+		UnmatchedNewTargets.RemoveAt(NewIndex);
+	}
+
+	for (const int32 OldTarget : UnmatchedOldTargets)
+	{
+		NumDiffs += AddDiff(DiffsOut, EMergeDiffType::LINK_REMOVED, INDEX_NONE, INDEX_NONE, OldPin, NewPin, OldTarget, INDEX_NONE);
+	}
+
+	for (const int32 NewTarget : UnmatchedNewTargets)
+	{
+		NumDiffs += AddDiff(DiffsOut, EMergeDiffType::LINK_ADDED, INDEX_NONE, INDEX_NONE, OldPin, NewPin, INDEX_NONE, NewTarget);
+	}
+
+	return NumDiffs;
+}
+
+FText FGraphSnapshotDiff::GetDisplayString(const FSnapshotDiffResult& Diff) const
+{
+	const auto NodeTitle = [](const FGraphSnapshot& Snapshot, int32 Node)
+	{
+		return FText::FromString(Snapshot.GetString(Snapshot.GetNode(Node).ListTitle));
+	};
+
+	const auto PinName = [](const FGraphSnapshot& Snapshot, int32 Pin)
+	{
+		return FText::FromString(Snapshot.GetString(Snapshot.GetPin(Pin).DisplayName));
+	};
+
+	const auto PinNodeTitle = [&NodeTitle](const FGraphSnapshot& Snapshot, int32 Pin)
+	{
+		return NodeTitle(Snapshot, Snapshot.GetPin(Pin).Node);
+	};
+
+	switch (Diff.Type)
+	{
+	case EMergeDiffType::NODE_REMOVED:
+	case EMergeDiffType::NODE_MOVED:
+	case EMergeDiffType::NODE_COMMENT:
+		return FDiffHelper::FormatDisplayString(Diff.Type, NodeTitle(Old, Diff.NodeOld));
+	case EMergeDiffType::NODE_ADDED:
+		return FDiffHelper::FormatDisplayString(Diff.Type, NodeTitle(New, Diff.NodeNew));
+	case EMergeDiffType::PIN_REMOVED:
+		return FDiffHelper::FormatDisplayString(Diff.Type, PinName(Old, Diff.PinOld), PinNodeTitle(Old, Diff.PinOld));
+	case EMergeDiffType::PIN_ADDED:
+		return FDiffHelper::FormatDisplayString(Diff.Type, PinName(New, Diff.PinNew), PinNodeTitle(New, Diff.PinNew));
+	case EMergeDiffType::PIN_DEFAULT_VALUE:
+		return FDiffHelper::FormatDisplayString(Diff.Type, PinName(Old, Diff.PinOld),
+			FText::FromString(Old.GetString(Old.GetPin(Diff.PinOld).DefaultAsText)),
+			FText::FromString(New.GetString(New.GetPin(Diff.PinNew).DefaultAsText)));
+	case EMergeDiffType::LINK_REMOVED:
+		return FDiffHelper::FormatDisplayString(Diff.Type, PinNodeTitle(Old, Diff.PinOld), PinNodeTitle(Old, Diff.LinkTargetOld));
+	case EMergeDiffType::LINK_ADDED:
+		return FDiffHelper::FormatDisplayString(Diff.Type, PinNodeTitle(New, Diff.PinNew), PinNodeTitle(New, Diff.LinkTargetNew));
+	default:
+		return FText::GetEmpty();
+	}
+}
+
+FMergeDiffResult FGraphSnapshotDiff::Resolve(const FSnapshotDiffResult& Diff, const UEdGraph* OldGraph, const UEdGraph* NewGraph) const
+{
+	FMergeDiffResult Result = {};
+	Result.Type          = Diff.Type;
+	Result.NodeOld       = Old.FindSourceNode(OldGraph, Diff.NodeOld);
+	Result.NodeNew       = New.FindSourceNode(NewGraph, Diff.NodeNew);
+	Result.PinOld        = Old.FindSourcePin(OldGraph, Diff.PinOld);
+	Result.PinNew        = New.FindSourcePin(NewGraph, Diff.PinNew);
+	Result.LinkTargetOld = Old.FindSourcePin(OldGraph, Diff.LinkTargetOld);
+	Result.LinkTargetNew = New.FindSourcePin(NewGraph, Diff.LinkTargetNew);
+	Result.DisplayString = GetDisplayString(Diff);
+	Result.DisplayColor  = FDiffHelper::GetDisplayColor(Diff.Type);
+	return Result;
+}
+
+FNodeMatch FGraphSnapshotDiff::Resolve(const FSnapshotNodeMatch& Match, const UEdGraph* OldGraph, const UEdGraph* NewGraph) const
+{
+	return FNodeMatch{ Old.FindSourceNode(OldGraph, Match.OldNode), New.FindSourceNode(NewGraph, Match.NewNode) };
+}
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FDiffHelper.h"
+#include "GraphSnapshot.h"
+
+struct FSnapshotNodeMatch
+{
+	int32 OldNode;
+	int32 NewNode;
+};
+
+// Diff between two snapshots, the nodes and pins are indices into the old or new snapshot.
+// Unset values are INDEX_NONE, which values are set is the same as for FMergeDiffResult
+struct FSnapshotDiffResult
+{
+	EMergeDiffType Type;
+
+	int32 NodeOld;
+	int32 NodeNew;
+
+	int32 PinOld;
+	int32 PinNew;
+
+	int32 LinkTargetOld;
+	int32 LinkTargetNew;
+};
+
+// Version of FDiffHelper::DiffGraphs which works on snapshots instead of the graphs themselves.
+// It finds the same matches and diffs, but never touches any UObjects, so it can run on any thread.
+// The snapshots are only read from, so multiple diffs can use the same snapshots at the same time,
+// this is checked by the MergeAssist.Correctness.ParallelSnapshotDiff test
+class FGraphSnapshotDiff
+{
+public:
+	// The snapshots need to outlive the diff
+	FGraphSnapshotDiff(const FGraphSnapshot& OldSnapshot, const FGraphSnapshot& NewSnapshot);
+
+	// When parallel, the approximate matching of each node type, and the scoring of large sets of nodes
+	// of the same type, run as separate tasks. The results are the same either way
+	void Diff(ENodeMatchStrategy MatchStrategy = ENodeMatchStrategy::ALL, bool bParallel = true);
+
+	// Display text of a diff, generated from the strings in the snapshots
+	FText GetDisplayString(const FSnapshotDiffResult& Diff) const;
+
+	// Converts a diff to one pointing at the nodes and pins of the graphs the snapshots were captured from.
+	// The graphs must not have changed since, and this needs to be called on the game thread
+	FMergeDiffResult Resolve(const FSnapshotDiffResult& Diff, const UEdGraph* OldGraph, const UEdGraph* NewGraph) const;
+	FNodeMatch Resolve(const FSnapshotNodeMatch& Match, const UEdGraph* OldGraph, const UEdGraph* NewGraph) const;
+
+public:
+	TArray<FSnapshotDiffResult> Diffs;
+	TArray<FSnapshotNodeMatch> NodeMatches;
+	TArray<int32> UnmatchedOldNodes;
+	TArray<int32> UnmatchedNewNodes;
+
+private:
+	// Strings are compared by index, using the index of the same string in the old snapshot
+	bool IsSameString(int32 OldString, int32 NewString) const { return NewToOldStrings[NewString] == OldString; }
+
+	bool IsExactNodeMatch(int32 OldNode, int32 NewNode) const;
+	bool WeakNodeMatch(int32 OldNode, int32 NewNode) const;
+
+	void FindExactNodeMatches();
+	void FindPropagatedNodeMatches();
+	void PropagateNodeMatch(const FSnapshotNodeMatch& Match);
+	void AddMatch(int32 OldNode, int32 NewNode);
+	void FindApproximateNodeMatches(bool bParallel);
+
+	// Only reads the diff, so it can be called for multiple sets of nodes at the same time
+	void FindApproximateNodeMatchesBetweenNodesOfTheSameType(const TArray<int32>& OldNodes, const TArray<int32>& NewNodes,
+		bool bParallel, TArray<FSnapshotNodeMatch>& MatchesOut) const;
+
+	// These return the number of diffs found, the diffs are only stored when an output array is passed in
+	int32 DiffNodes(int32 OldNode, int32 NewNode, TArray<FSnapshotDiffResult>* DiffsOut) const;
+	int32 DiffPins(int32 OldPin, int32 NewPin, TArray<FSnapshotDiffResult>* DiffsOut) const;
+
+	const FGraphSnapshot& Old;
+	const FGraphSnapshot& New;
+
+	// Index of each string of the new snapshot in the old snapshot, strings which do not
+	// exist in the old snapshot get a unique negative index so they never compare equal
+	TArray<int32> NewToOldStrings;
+
+	TBitArray<> OldMatched;
+	TBitArray<> NewMatched;
+};
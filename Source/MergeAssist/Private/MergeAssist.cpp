@@ -1,13 +1,18 @@
 #include "MergeAssist.h"
 
 #include "SBlueprintMergeAssist.h"
+#include "SBatchMergeView.h"
 #include "BlueprintMergeData.h"
 
 #include "SDockTab.h"
+#include "Misc/App.h"
 
 #define LOCTEXT_NAMESPACE "FMergeAssistModule"
 
+DEFINE_LOG_CATEGORY(LogMergeAssist);
+
 static const FName MergeAssistTabId = FName(TEXT("MergeAssist"));
+static const FName BatchMergeAssistTabId = FName(TEXT("BatchMergeAssist"));
 
 class FMergeAssistModule : public IMergeAssistModule
 {
@@ -21,6 +26,9 @@ void FMergeAssistModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
 
+	// There is no UI to open when running the merge commandlet
+	if (IsRunningCommandlet()) return;
+
 	// Define our tab spawner, which opens our merge UI with the test blueprints preselected
 	// this is done to speed up iteration time when testing and developing
 	const auto TabSpawner = FOnSpawnTab::CreateStatic([](const FSpawnTabArgs&)
@@ -38,9 +46,16 @@ void FMergeAssistModule::StartupModule()
 		);
 
 		// Create a dock tab and fill it with the merge assist UI
+		const TSharedRef<SBlueprintMergeAssist> MergeAssist = SNew(SBlueprintMergeAssist, Data);
+		const TWeakPtr<SBlueprintMergeAssist> WeakMergeAssist = MergeAssist;
+
 		return SNew(SDockTab)
+		.OnTabClosed_Lambda([WeakMergeAssist](TSharedRef<SDockTab>)
+		{
+			if (const TSharedPtr<SBlueprintMergeAssist> Closed = WeakMergeAssist.Pin()) Closed->OnClosed();
+		})
 		[
-			SNew(SBlueprintMergeAssist, Data)
+			MergeAssist
 		];
 	});
 
@@ -51,6 +66,22 @@ void FMergeAssistModule::StartupModule()
 	TabSpawnerEntry.SetDisplayName(LOCTEXT("TabTitle", "Merge Assist"));
 	TabSpawnerEntry.SetTooltipText(LOCTEXT("TooltipText", "Open the Merge assist tool"));
 
+	// Register the tab spawner for merging a list of blueprints at once
+	FTabSpawnerEntry& BatchTabSpawnerEntry = FGlobalTabmanager::Get()->RegisterNomadTabSpawner(BatchMergeAssistTabId,
+		FOnSpawnTab::CreateStatic([](const FSpawnTabArgs&)
+	{
+		return SNew(SDockTab)
+		[
+			SNew(SBatchMergeView)
+		];
+	}));
+
+	BatchTabSpawnerEntry.SetDisplayName(LOCTEXT("BatchTabTitle", "Batch Merge Assist"));
+	BatchTabSpawnerEntry.SetTooltipText(LOCTEXT("BatchTooltipText", "Merge a list of blueprints at once"));
+
+	// Don't open the merge UI in sessions without a user, e.g. when running the automation tests headless
+	if (FApp::IsUnattended() || !FApp::CanEverRender()) return;
+
 	// @TODO: Stop the tab from opening by default
 	FGlobalTabmanager::Get()->InvokeTab(MergeAssistTabId);
 }
@@ -60,7 +91,10 @@ void FMergeAssistModule::ShutdownModule()
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
 
+	if (IsRunningCommandlet()) return;
+
 	FGlobalTabmanager::Get()->UnregisterNomadTabSpawner(MergeAssistTabId);
+	FGlobalTabmanager::Get()->UnregisterNomadTabSpawner(BatchMergeAssistTabId);
 }
 
 #undef LOCTEXT_NAMESPACE
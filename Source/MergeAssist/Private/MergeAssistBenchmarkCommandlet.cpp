@@ -0,0 +1,266 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MergeAssistBenchmarkCommandlet.h"
+#include "MergeAssist.h"
+#include "SyntheticGraphGenerator.h"
+#include "GraphMergeHelper.h"
+#include "FDiffHelper.h"
+
+#include "EdGraph/EdGraph.h"
+#include "Engine/Blueprint.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Misc/FileHelper.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+static const double BytesToMB = 1.0 / (1024.0 * 1024.0);
+
+// Timings of a single phase of the benchmark, in milliseconds
+struct FBenchmarkPhase
+{
+	FString Name;
+	TArray<double> Samples;
+
+	double Percentile(float Fraction) const
+	{
+		if (!Samples.Num()) return 0.0;
+
+		TArray<double> Sorted = Samples;
+		Sorted.Sort();
+
+		// Nearest rank, so the p95 of a couple of samples is the slowest one
+		const int32 Rank = FMath::CeilToInt(Fraction * Sorted.Num());
+		return Sorted[FMath::Clamp(Rank - 1, 0, Sorted.Num() - 1)];
+	}
+
+	TSharedRef<FJsonObject> ToJson() const
+	{
+		const TSharedRef<FJsonObject> Json = MakeShareable(new FJsonObject());
+		Json->SetNumberField(TEXT("p50"), Percentile(0.50f));
+		Json->SetNumberField(TEXT("p95"), Percentile(0.95f));
+		Json->SetNumberField(TEXT("min"), Percentile(0.0f));
+		Json->SetNumberField(TEXT("max"), Percentile(1.0f));
+		return Json;
+	}
+};
+
+// Tracks the highest memory usage seen during a benchmark. The usage is sampled on a background thread while
+// the benchmark runs, since the temporaries of a phase are already freed again once the phase returns
+struct FBenchmarkMemory : public FRunnable
+{
+	FBenchmarkMemory()
+		: StartUsedPhysical(FPlatformMemory::GetStats().UsedPhysical)
+		, PeakUsedPhysical(StartUsedPhysical)
+	{
+		Thread = FRunnableThread::Create(this, TEXT("MergeAssistBenchmarkMemory"), 0, TPri_AboveNormal);
+	}
+
+	~FBenchmarkMemory()
+	{
+		Finish();
+	}
+
+	// Stops sampling, returns the highest usage since the benchmark started
+	uint64 Finish()
+	{
+		if (Thread)
+		{
+			Thread->Kill(true);
+			delete Thread;
+			Thread = nullptr;
+		}
+
+		Sample();
+		return PeakUsedPhysical;
+	}
+
+	/** FRunnable interface */
+	uint32 Run() override
+	{
+		while (!bStopping)
+		{
+			Sample();
+			FPlatformProcess::Sleep(0.001f);
+		}
+		return 0;
+	}
+
+	void Stop() override
+	{
+		bStopping = true;
+	}
+
+	const uint64 StartUsedPhysical;
+
+private:
+	// Called by the sampling thread, and once more after it stopped
+	void Sample()
+	{
+		PeakUsedPhysical = FMath::Max<uint64>(PeakUsedPhysical, FPlatformMemory::GetStats().UsedPhysical);
+	}
+
+	uint64 PeakUsedPhysical;
+	FThreadSafeBool bStopping;
+	FRunnableThread* Thread = nullptr;
+};
+
+template<typename FunctionType>
+static void TimePhase(FBenchmarkPhase& Phase, FunctionType&& Function)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	Function();
+	Phase.Samples.Add((FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+static TSharedRef<FJsonObject> RunBenchmark(const FSyntheticGraphSettings& Settings, int32 Iterations)
+{
+	FBenchmarkMemory Memory;
+
+	FBenchmarkPhase GeneratePhase { TEXT("Generate") };
+	FBenchmarkPhase DiffPhase { TEXT("DiffGraphs") };
+	FBenchmarkPhase ConstructPhase { TEXT("GraphMergeHelper") };
+	FBenchmarkPhase ApplyPhase { TEXT("ApplyAll") };
+
+	FSyntheticMergeGraphs Graphs;
+	TimePhase(GeneratePhase, [&]() { Graphs = FSyntheticGraphGenerator(Settings).Generate(); });
+
+	// Nothing references the generated blueprints, so keep them alive ourselves
+	UBlueprint* Blueprints[] = { Graphs.RemoteBlueprint, Graphs.BaseBlueprint, Graphs.LocalBlueprint, Graphs.TargetBlueprint };
+	for (UBlueprint* Blueprint : Blueprints) Blueprint->AddToRoot();
+
+	int32 NumRemoteDiffs = 0, NumLocalDiffs = 0, NumChanges = 0, NumConflicts = 0, NumFailed = 0;
+
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		TimePhase(DiffPhase, [&]()
+		{
+			FMergeDiffCounter RemoteDiffs, LocalDiffs;
+			FDiffHelper::DiffGraphs(Graphs.BaseGraph, Graphs.RemoteGraph, RemoteDiffs);
+			FDiffHelper::DiffGraphs(Graphs.BaseGraph, Graphs.LocalGraph, LocalDiffs);
+
+			NumRemoteDiffs = RemoteDiffs.NumFound();
+			NumLocalDiffs = LocalDiffs.NumFound();
+		});
+
+		// Constructing the merge helper resets the target graph, so every iteration starts from the same state
+		TSharedPtr<GraphMergeHelper> MergeHelper;
+		TimePhase(ConstructPhase, [&]()
+		{
+			MergeHelper = MakeShareable(new GraphMergeHelper(Graphs.RemoteGraph, Graphs.BaseGraph, Graphs.LocalGraph, Graphs.TargetGraph));
+		});
+
+		NumChanges = MergeHelper->ChangeList.Num();
+		NumConflicts = 0;
+		NumFailed = 0;
+
+		// Apply every change, taking the remote side of conflicts
+		TimePhase(ApplyPhase, [&]()
+		{
+			for (const auto& Change : MergeHelper->ChangeList)
+			{
+				if (Change->bHasConflicts) ++NumConflicts;
+
+				const bool bIsRemoteChange = Change->RemoteDiff.Type != EMergeDiffType::NO_DIFFERENCE;
+				const bool bApplied = bIsRemoteChange
+					? MergeHelper->ApplyRemoteChange(*Change)
+					: MergeHelper->ApplyLocalChange(*Change);
+
+				if (!bApplied) ++NumFailed;
+			}
+		});
+	}
+
+	const TSharedRef<FJsonObject> Result = MakeShareable(new FJsonObject());
+	Result->SetNumberField(TEXT("nodes"), Settings.NumNodes);
+	Result->SetNumberField(TEXT("remoteDiffs"), NumRemoteDiffs);
+	Result->SetNumberField(TEXT("localDiffs"), NumLocalDiffs);
+	Result->SetNumberField(TEXT("changes"), NumChanges);
+	Result->SetNumberField(TEXT("conflicts"), NumConflicts);
+	Result->SetNumberField(TEXT("failed"), NumFailed);
+
+	const TSharedRef<FJsonObject> Phases = MakeShareable(new FJsonObject());
+	for (const FBenchmarkPhase* Phase : { &GeneratePhase, &DiffPhase, &ConstructPhase, &ApplyPhase })
+	{
+		Phases->SetObjectField(Phase->Name, Phase->ToJson());
+	}
+	Result->SetObjectField(TEXT("phases"), Phases);
+
+	// Peak usage of the whole process, and the peak increase during this benchmark
+	const uint64 PeakUsedPhysical = Memory.Finish();
+	Result->SetNumberField(TEXT("peakUsedPhysicalMB"), FPlatformMemory::GetStats().PeakUsedPhysical * BytesToMB);
+	Result->SetNumberField(TEXT("peakDeltaMB"), (PeakUsedPhysical - Memory.StartUsedPhysical) * BytesToMB);
+
+	UE_LOG(LogMergeAssist, Display, TEXT("%8d nodes: diff %9.2fms, construct %9.2fms, apply %9.2fms (p50), %d changes, %d conflicts, %d failed"),
+		Settings.NumNodes, DiffPhase.Percentile(0.5f), ConstructPhase.Percentile(0.5f), ApplyPhase.Percentile(0.5f), NumChanges, NumConflicts, NumFailed);
+
+	for (UBlueprint* Blueprint : Blueprints) Blueprint->RemoveFromRoot();
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	return Result;
+}
+
+UMergeAssistBenchmarkCommandlet::UMergeAssistBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UMergeAssistBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString SizesString = TEXT("100,1000,5000,10000,50000");
+	FString OutputPath;
+	int32 Iterations = 5;
+
+	FSyntheticGraphSettings Settings;
+
+	FParse::Value(*Params, TEXT("Sizes="), SizesString);
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	FParse::Value(*Params, TEXT("Seed="), Settings.Seed);
+	FParse::Value(*Params, TEXT("LinkDensity="), Settings.LinkDensity);
+	FParse::Value(*Params, TEXT("AddRate="), Settings.AddRate);
+	FParse::Value(*Params, TEXT("RemoveRate="), Settings.RemoveRate);
+	FParse::Value(*Params, TEXT("MoveRate="), Settings.MoveRate);
+	FParse::Value(*Params, TEXT("DefaultEditRate="), Settings.DefaultEditRate);
+	FParse::Value(*Params, TEXT("RewireRate="), Settings.RewireRate);
+
+	TArray<FString> Sizes;
+	SizesString.ParseIntoArray(Sizes, TEXT(","));
+
+	TArray<TSharedPtr<FJsonValue>> Results;
+	for (const FString& Size : Sizes)
+	{
+		Settings.NumNodes = FCString::Atoi(*Size);
+		if (Settings.NumNodes <= 0) continue;
+
+		Results.Add(MakeShareable(new FJsonValueObject(RunBenchmark(Settings, FMath::Max(Iterations, 1)))));
+	}
+
+	const TSharedRef<FJsonObject> Report = MakeShareable(new FJsonObject());
+	Report->SetNumberField(TEXT("iterations"), Iterations);
+	Report->SetNumberField(TEXT("seed"), Settings.Seed);
+	Report->SetNumberField(TEXT("linkDensity"), Settings.LinkDensity);
+	Report->SetArrayField(TEXT("results"), Results);
+
+	FString ReportString;
+	const auto Writer = TJsonWriterFactory<>::Create(&ReportString);
+	FJsonSerializer::Serialize(Report, Writer);
+
+	UE_LOG(LogMergeAssist, Display, TEXT("%s"), *ReportString);
+
+	if (!OutputPath.IsEmpty() && !FFileHelper::SaveStringToFile(ReportString, *OutputPath))
+	{
+		UE_LOG(LogMergeAssist, Error, TEXT("Failed to write the benchmark results to '%s'"), *OutputPath);
+		return 1;
+	}
+
+	return 0;
+}
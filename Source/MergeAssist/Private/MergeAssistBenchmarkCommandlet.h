@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MergeAssistBenchmarkCommandlet.generated.h"
+
+/**
+ * Measures how the diff and merge code scales with the size of a graph, using
+ * graphs generated by the FSyntheticGraphGenerator. For every graph size the
+ * diff, the merge helper construction, and applying all changes are timed
+ * separately, the results are written as JSON.
+ *
+ * Usage:
+ *   UE4Editor-Cmd <Project> -run=MergeAssistBenchmark [-Sizes=100,1000,5000,10000,50000] [-Iterations=5]
+ *       [-Seed=0] [-LinkDensity=1.5] [-AddRate=0.02] [-RemoveRate=0.02] [-MoveRate=0.05]
+ *       [-DefaultEditRate=0.02] [-RewireRate=0.02] [-Output=<File>]
+ */
+UCLASS()
+class UMergeAssistBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMergeAssistBenchmarkCommandlet();
+
+	/** UCommandlet interface */
+	int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,195 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MergeAssistCommandlet.h"
+#include "MergeAssist.h"
+#include "BlueprintMergeHelper.h"
+#include "BatchMergeHelper.h"
+#include "GraphMergeHelper.h"
+#include "MergeAssistStats.h"
+
+#include "Engine/Blueprint.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+static void WriteMergeReport(const TSharedRef<FJsonObject>& Report, const FString& ReportPath)
+{
+	FString ReportString;
+	const auto Writer = TJsonWriterFactory<>::Create(&ReportString);
+	FJsonSerializer::Serialize(Report, Writer);
+
+	UE_LOG(LogMergeAssist, Display, TEXT("%s"), *ReportString);
+
+	if (!ReportPath.IsEmpty() && !FFileHelper::SaveStringToFile(ReportString, *ReportPath))
+	{
+		UE_LOG(LogMergeAssist, Error, TEXT("Failed to write the merge report to '%s'"), *ReportPath);
+	}
+}
+
+static const TCHAR* LexToString(EBatchMergeStatus Status)
+{
+	switch (Status)
+	{
+	case EBatchMergeStatus::Failed:         return TEXT("failed");
+	case EBatchMergeStatus::Diffed:         return TEXT("diffed");
+	case EBatchMergeStatus::AutoMerged:     return TEXT("merged");
+	case EBatchMergeStatus::NeedsAttention: return TEXT("conflicts");
+	default:                                return TEXT("pending");
+	}
+}
+
+static int32 RunBatchMerge(const FString& MergeListPath, const FString& ReportPath)
+{
+	FString MergeList;
+	if (!FFileHelper::LoadFileToString(MergeList, *MergeListPath))
+	{
+		UE_LOG(LogMergeAssist, Error, TEXT("Failed to read merge list '%s'"), *MergeListPath);
+		return EMergeCommandletResult::Error;
+	}
+
+	TArray<TSharedPtr<FBatchMergeEntry>> Entries;
+	FString ParseError;
+	if (!BatchMergeHelper::ParseMergeList(MergeList, Entries, ParseError))
+	{
+		UE_LOG(LogMergeAssist, Error, TEXT("Failed to parse merge list '%s': %s"), *MergeListPath, *ParseError);
+		return EMergeCommandletResult::Error;
+	}
+
+	FMergeAssistStats::Reset();
+
+	BatchMergeHelper Batch(Entries);
+	Batch.LoadAll();
+	Batch.DiffAll();
+	Batch.MergeAll(false, true);
+
+	UE_LOG(LogMergeAssist, Display, TEXT("%s"), *FMergeAssistStats::GetSummary());
+
+	// Print a summary table, and gather the reports of all the merges
+	TArray<TSharedPtr<FJsonValue>> Assets;
+
+	UE_LOG(LogMergeAssist, Display, TEXT("%-10s %8s %10s  %s"), TEXT("Status"), TEXT("Changes"), TEXT("Conflicts"), TEXT("Target"));
+	for (const auto& Entry : Batch.Entries)
+	{
+		UE_LOG(LogMergeAssist, Display, TEXT("%-10s %8d %10d  %s %s"),
+			LexToString(Entry->Status), Entry->NumChanges, Entry->NumConflicts, *Entry->TargetPath, *Entry->Error);
+
+		const TSharedRef<FJsonObject> Asset = MakeShareable(new FJsonObject());
+		Asset->SetStringField(TEXT("remote"), Entry->RemotePath);
+		Asset->SetStringField(TEXT("base"), Entry->BasePath);
+		Asset->SetStringField(TEXT("local"), Entry->LocalPath);
+		Asset->SetStringField(TEXT("target"), Entry->TargetPath);
+		Asset->SetStringField(TEXT("status"), LexToString(Entry->Status));
+		Asset->SetNumberField(TEXT("failed"), Entry->NumFailed);
+		if (!Entry->Error.IsEmpty()) Asset->SetStringField(TEXT("error"), Entry->Error);
+		if (Entry->Report) Asset->SetObjectField(TEXT("report"), Entry->Report);
+		Assets.Add(MakeShareable(new FJsonValueObject(Asset)));
+	}
+
+	const int32 NumFailed = Batch.NumWithStatus(EBatchMergeStatus::Failed);
+	const int32 NumNeedsAttention = Batch.NumWithStatus(EBatchMergeStatus::NeedsAttention);
+
+	const TSharedRef<FJsonObject> Report = MakeShareable(new FJsonObject());
+	Report->SetNumberField(TEXT("merged"), Batch.NumWithStatus(EBatchMergeStatus::AutoMerged));
+	Report->SetNumberField(TEXT("conflicts"), NumNeedsAttention);
+	Report->SetNumberField(TEXT("failed"), NumFailed);
+	Report->SetArrayField(TEXT("assets"), Assets);
+	WriteMergeReport(Report, ReportPath);
+
+	if (NumFailed) return EMergeCommandletResult::Error;
+	return NumNeedsAttention ? EMergeCommandletResult::Conflicts : EMergeCommandletResult::Success;
+}
+
+UMergeAssistCommandlet::UMergeAssistCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UMergeAssistCommandlet::Main(const FString& Params)
+{
+	FString RemotePath, BasePath, LocalPath, TargetPath, ReportPath, OutputPath, BatchPath;
+	FParse::Value(*Params, TEXT("Remote="), RemotePath);
+	FParse::Value(*Params, TEXT("Base="), BasePath);
+	FParse::Value(*Params, TEXT("Local="), LocalPath);
+	FParse::Value(*Params, TEXT("Target="), TargetPath);
+	FParse::Value(*Params, TEXT("Report="), ReportPath);
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+	FParse::Value(*Params, TEXT("Batch="), BatchPath);
+
+	if (!BatchPath.IsEmpty())
+	{
+		return RunBatchMerge(BatchPath, ReportPath);
+	}
+
+	const auto Fail = [&ReportPath](const FString& Message)
+	{
+		UE_LOG(LogMergeAssist, Error, TEXT("%s"), *Message);
+
+		const TSharedRef<FJsonObject> Report = MakeShareable(new FJsonObject());
+		Report->SetStringField(TEXT("error"), Message);
+		WriteMergeReport(Report, ReportPath);
+
+		return EMergeCommandletResult::Error;
+	};
+
+	if (RemotePath.IsEmpty() || BasePath.IsEmpty() || LocalPath.IsEmpty() || TargetPath.IsEmpty())
+	{
+		return Fail(TEXT("Usage: -run=MergeAssist -Remote=<Path> -Base=<Path> -Local=<Path> -Target=<PackageName> [-Report=<File>] [-Output=<File>] or -run=MergeAssist -Batch=<MergeList> [-Report=<File>]"));
+	}
+
+	UBlueprint* RemoteBP = BlueprintMergeHelper::LoadBlueprint(RemotePath);
+	UBlueprint* BaseBP = BlueprintMergeHelper::LoadBlueprint(BasePath);
+	UBlueprint* LocalBP = BlueprintMergeHelper::LoadBlueprint(LocalPath);
+
+	if (!RemoteBP) return Fail(FString::Printf(TEXT("Failed to load remote blueprint '%s'"), *RemotePath));
+	if (!BaseBP)   return Fail(FString::Printf(TEXT("Failed to load base blueprint '%s'"), *BasePath));
+	if (!LocalBP)  return Fail(FString::Printf(TEXT("Failed to load local blueprint '%s'"), *LocalPath));
+
+	// The target is modified and saved, so it always has to be an asset in the project
+	UBlueprint* TargetBP = FPackageName::IsValidLongPackageName(TargetPath) ? BlueprintMergeHelper::LoadBlueprint(TargetPath) : nullptr;
+	if (!TargetBP) return Fail(FString::Printf(TEXT("Failed to load target blueprint '%s', the target must be a package name"), *TargetPath));
+
+	FBlueprintMergeData Data(
+		LocalBP,
+		BaseBP,   FRevisionInfo::InvalidRevision(),
+		RemoteBP, FRevisionInfo::InvalidRevision(),
+		TargetBP
+	);
+
+	FMergeAssistStats::Reset();
+
+	BlueprintMergeHelper Merge(Data);
+	const int32 NumFailed = Merge.ApplyNonConflictingChanges();
+	const int32 NumAutoResolved = Merge.ApplyAutoResolveRules();
+
+	FString TargetFilename;
+	if (!BlueprintMergeHelper::SaveBlueprint(TargetBP, TargetFilename))
+	{
+		return Fail(FString::Printf(TEXT("Failed to save target blueprint '%s'"), *TargetPath));
+	}
+
+	if (!OutputPath.IsEmpty() && IFileManager::Get().Copy(*OutputPath, *TargetFilename) != COPY_OK)
+	{
+		return Fail(FString::Printf(TEXT("Failed to copy '%s' to '%s'"), *TargetFilename, *OutputPath));
+	}
+
+	// Conflicts resolved by the auto resolve rules are merged as well
+	const int32 NumConflicts = Merge.GetConflictCounts().NumUnresolvedGroups;
+
+	const TSharedRef<FJsonObject> Report = Merge.CreateReport();
+	Report->SetNumberField(TEXT("failed"), NumFailed);
+	Report->SetNumberField(TEXT("autoResolved"), NumAutoResolved);
+	WriteMergeReport(Report, ReportPath);
+
+	UE_LOG(LogMergeAssist, Display, TEXT("Merged %d changes into '%s', %d conflicts, %d failed, %d auto resolved"),
+		Merge.NumChanges() - NumConflicts - NumFailed, *TargetPath, NumConflicts, NumFailed, NumAutoResolved);
+	UE_LOG(LogMergeAssist, Display, TEXT("%s"), *FMergeAssistStats::GetSummary());
+
+	return (NumConflicts || NumFailed) ? EMergeCommandletResult::Conflicts : EMergeCommandletResult::Success;
+}
@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MergeAssistCommandlet.generated.h"
+
+// Exit codes returned by the merge commandlet
+namespace EMergeCommandletResult
+{
+	enum Type
+	{
+		// All changes were merged into the target
+		Success = 0,
+		// Non conflicting changes were merged, but conflicts remain
+		Conflicts = 1,
+		// The merge could not be performed
+		Error = 2,
+	};
+}
+
+/**
+ * Merges blueprints without opening the merge UI, all the non conflicting changes
+ * are applied to the target blueprint, which is then saved. Conflicts are written
+ * to a JSON report so they can be picked up by other tools.
+ *
+ * Usage:
+ *   UE4Editor-Cmd <Project> -run=MergeAssist -Remote=<Path> -Base=<Path> -Local=<Path> -Target=<PackageName>
+ *       [-Report=<File>] [-Output=<File>]
+ *
+ * Remote, Base and Local can either be package names, or paths to package files
+ * outside of the project (e.g. the temporary files passed to a git merge driver).
+ * Target must be a blueprint package in the project, after saving it is copied
+ * to Output when specified.
+ *
+ * Batch usage:
+ *   UE4Editor-Cmd <Project> -run=MergeAssist -Batch=<MergeList> [-Report=<File>]
+ *
+ * Every line of the merge list contains the Remote;Base;Local;Target paths of a
+ * single merge, see BatchMergeHelper::ParseMergeList.
+ */
+UCLASS()
+class UMergeAssistCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMergeAssistCommandlet();
+
+	/** UCommandlet interface */
+	int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MergeAssistSettings.h"
+
+UMergeAssistSettings::UMergeAssistSettings()
+{
+	CategoryName = TEXT("Plugins");
+	SectionName = TEXT("MergeAssist");
+}
+
+UMergeAssistProjectSettings::UMergeAssistProjectSettings()
+{
+	CategoryName = TEXT("Plugins");
+	SectionName = TEXT("MergeAssist");
+}
+
+FName UMergeAssistProjectSettings::GetContainerName() const
+{
+	return TEXT("Project");
+}
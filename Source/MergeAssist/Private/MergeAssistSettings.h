@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "MergeAssistSettings.generated.h"
+
+/** Kind of change an auto resolve rule matches, on the remote or local side of a change */
+UENUM()
+enum class EMergeRuleChangeType : uint8
+{
+	Any,
+	None UMETA(ToolTip = "The side has no change"),
+	NodeRemoved,
+	NodeAdded,
+	PinRemoved,
+	PinAdded,
+	PinDefaultValue,
+	LinkRemoved,
+	LinkAdded,
+	NodeMoved,
+	NodeComment
+};
+
+UENUM()
+enum class EMergeRuleResolution : uint8
+{
+	TakeRemote,
+	TakeLocal
+};
+
+/** Picks a version for the changes which match both the remote and the local change type */
+USTRUCT()
+struct FMergeAutoResolveRule
+{
+	GENERATED_BODY()
+
+	UPROPERTY(config, EditAnywhere, Category = "Rule")
+	EMergeRuleChangeType RemoteChange = EMergeRuleChangeType::Any;
+
+	UPROPERTY(config, EditAnywhere, Category = "Rule")
+	EMergeRuleChangeType LocalChange = EMergeRuleChangeType::Any;
+
+	/** Only match changes which conflict, for conflict groups every conflict in the group has to match */
+	UPROPERTY(config, EditAnywhere, Category = "Rule")
+	bool bOnlyConflicts = true;
+
+	UPROPERTY(config, EditAnywhere, Category = "Rule")
+	EMergeRuleResolution Resolution = EMergeRuleResolution::TakeLocal;
+};
+
+/**
+ * Settings of the merge assist, these can be changed in Editor Preferences -> Plugins -> Merge Assist
+ */
+UCLASS(config=EditorPerProjectUserSettings)
+class UMergeAssistSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	UMergeAssistSettings();
+
+	/** Group nodes which were moved by exactly the same offset into a single change */
+	UPROPERTY(config, EditAnywhere, Category = "Layout")
+	bool bDetectRigidMoves = true;
+
+	/** Minimum number of nodes moved by the same offset, before they are grouped into a single change */
+	UPROPERTY(config, EditAnywhere, Category = "Layout", meta = (ClampMin = "2", EditCondition = "bDetectRigidMoves"))
+	int32 MinRigidMoveNodes = 2;
+
+	/** Moves of a node shorter than this distance, in graph units, are ignored. Use 0 to show all moves */
+	UPROPERTY(config, EditAnywhere, Category = "Layout", meta = (ClampMin = "0"))
+	float MinMoveDistance = 0.0f;
+
+	/** Diff the graphs over multiple frames when opening a merge, so the editor does not stall on huge graphs */
+	UPROPERTY(config, EditAnywhere, Category = "Performance")
+	bool bTimeSliceDiffing = true;
+
+	/** Time spent diffing each frame, in milliseconds */
+	UPROPERTY(config, EditAnywhere, Category = "Performance", meta = (ClampMin = "1", EditCondition = "bTimeSliceDiffing"))
+	float DiffFrameBudgetMilliseconds = 10.0f;
+};
+
+/**
+ * Settings of the merge assist which are shared by everyone working on the project, these are saved to
+ * DefaultEditor.ini and can be changed in Project Settings -> Plugins -> Merge Assist
+ */
+UCLASS(config=Editor, defaultconfig)
+class UMergeAssistProjectSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	UMergeAssistProjectSettings();
+
+	/** UDeveloperSettings interface, settings stored in the editor config are shown in the editor preferences by default */
+	FName GetContainerName() const override;
+
+	/**
+	 * Rules used by Auto Resolve, and by the merge commandlet, to pick a version for changes in bulk. The first rule
+	 * which matches a change is used, changes for which a version was already picked are never changed
+	 */
+	UPROPERTY(config, EditAnywhere, Category = "Auto Resolve")
+	TArray<FMergeAutoResolveRule> AutoResolveRules;
+};
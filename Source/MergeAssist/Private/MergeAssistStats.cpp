@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MergeAssistStats.h"
+
+#if MERGEASSIST_WITH_TRACE
+UE_TRACE_CHANNEL_DEFINE(MergeAssistChannel)
+#endif
+
+DEFINE_STAT(STAT_MergeAssist_FindExactNodeMatches);
+DEFINE_STAT(STAT_MergeAssist_PropagateNodeMatches);
+DEFINE_STAT(STAT_MergeAssist_FindApproximateNodeMatches);
+DEFINE_STAT(STAT_MergeAssist_DiffNodes);
+DEFINE_STAT(STAT_MergeAssist_GenerateChangeList);
+DEFINE_STAT(STAT_MergeAssist_GroupRigidMoves);
+DEFINE_STAT(STAT_MergeAssist_ClusterChanges);
+DEFINE_STAT(STAT_MergeAssist_GroupConflicts);
+DEFINE_STAT(STAT_MergeAssist_CaptureSnapshot);
+DEFINE_STAT(STAT_MergeAssist_RediffEditedNodes);
+
+DEFINE_STAT(STAT_MergeAssist_CloneGraphIntoGraph);
+DEFINE_STAT(STAT_MergeAssist_CloneToTarget);
+
+DEFINE_STAT(STAT_MergeAssist_ApplyDiff_NODE_REMOVED);
+DEFINE_STAT(STAT_MergeAssist_ApplyDiff_NODE_ADDED);
+DEFINE_STAT(STAT_MergeAssist_ApplyDiff_PIN_REMOVED);
+DEFINE_STAT(STAT_MergeAssist_ApplyDiff_PIN_ADDED);
+DEFINE_STAT(STAT_MergeAssist_ApplyDiff_LINK_REMOVED);
+DEFINE_STAT(STAT_MergeAssist_ApplyDiff_LINK_ADDED);
+DEFINE_STAT(STAT_MergeAssist_ApplyDiff_PIN_DEFAULT_VALUE);
+DEFINE_STAT(STAT_MergeAssist_ApplyDiff_NODE_MOVED);
+DEFINE_STAT(STAT_MergeAssist_ApplyDiff_NODE_COMMENT);
+DEFINE_STAT(STAT_MergeAssist_ApplyDiff_GRAPH_ADDED);
+DEFINE_STAT(STAT_MergeAssist_ApplyDiff_GRAPH_REMOVED);
+DEFINE_STAT(STAT_MergeAssist_ApplyDiff_GRAPH_CHANGED);
+
+DEFINE_STAT(STAT_MergeAssist_RevertDiff_NODE_REMOVED);
+DEFINE_STAT(STAT_MergeAssist_RevertDiff_NODE_ADDED);
+DEFINE_STAT(STAT_MergeAssist_RevertDiff_PIN_REMOVED);
+DEFINE_STAT(STAT_MergeAssist_RevertDiff_PIN_ADDED);
+DEFINE_STAT(STAT_MergeAssist_RevertDiff_LINK_REMOVED);
+DEFINE_STAT(STAT_MergeAssist_RevertDiff_LINK_ADDED);
+DEFINE_STAT(STAT_MergeAssist_RevertDiff_PIN_DEFAULT_VALUE);
+DEFINE_STAT(STAT_MergeAssist_RevertDiff_NODE_MOVED);
+DEFINE_STAT(STAT_MergeAssist_RevertDiff_NODE_COMMENT);
+DEFINE_STAT(STAT_MergeAssist_RevertDiff_GRAPH_ADDED);
+DEFINE_STAT(STAT_MergeAssist_RevertDiff_GRAPH_REMOVED);
+DEFINE_STAT(STAT_MergeAssist_RevertDiff_GRAPH_CHANGED);
+
+DEFINE_STAT(STAT_MergeAssist_FocusGraph);
+
+DEFINE_STAT(STAT_MergeAssist_Nodes);
+DEFINE_STAT(STAT_MergeAssist_Pins);
+DEFINE_STAT(STAT_MergeAssist_Links);
+DEFINE_STAT(STAT_MergeAssist_CandidatePairs);
+DEFINE_STAT(STAT_MergeAssist_Diffs);
+
+FThreadSafeCounter64 FMergeAssistStats::PhaseCycles[static_cast<int32>(EMergeAssistPhase::Num)];
+FThreadSafeCounter64 FMergeAssistStats::Counters[static_cast<int32>(EMergeAssistCounter::Num)];
+
+void FMergeAssistStats::Reset()
+{
+	for (auto& Cycles : PhaseCycles) Cycles.Reset();
+	for (auto& Counter : Counters) Counter.Reset();
+}
+
+void FMergeAssistStats::AddTime(EMergeAssistPhase Phase, uint64 Cycles)
+{
+	PhaseCycles[static_cast<int32>(Phase)].Add(static_cast<int64>(Cycles));
+}
+
+void FMergeAssistStats::AddCount(EMergeAssistCounter Counter, int64 Amount)
+{
+	Counters[static_cast<int32>(Counter)].Add(Amount);
+}
+
+double FMergeAssistStats::GetMilliseconds(EMergeAssistPhase Phase)
+{
+	return FPlatformTime::ToMilliseconds64(PhaseCycles[static_cast<int32>(Phase)].GetValue());
+}
+
+int64 FMergeAssistStats::GetCount(EMergeAssistCounter Counter)
+{
+	return Counters[static_cast<int32>(Counter)].GetValue();
+}
+
+FString FMergeAssistStats::GetSummary()
+{
+	return FString::Printf(
+		TEXT("Matching %.1fms, DiffNodes %.1fms, ChangeList %.1fms, Cloning %.1fms, Apply %.1fms, Revert %.1fms, FocusGraph %.1fms, Snapshot %.1fms | ")
+		TEXT("%lld nodes, %lld pins, %lld links, %lld candidate pairs, %lld diffs"),
+		GetMilliseconds(EMergeAssistPhase::Matching),
+		GetMilliseconds(EMergeAssistPhase::DiffNodes),
+		GetMilliseconds(EMergeAssistPhase::GenerateChangeList),
+		GetMilliseconds(EMergeAssistPhase::Cloning),
+		GetMilliseconds(EMergeAssistPhase::ApplyDiff),
+		GetMilliseconds(EMergeAssistPhase::RevertDiff),
+		GetMilliseconds(EMergeAssistPhase::FocusGraph),
+		GetMilliseconds(EMergeAssistPhase::Snapshot),
+		GetCount(EMergeAssistCounter::Nodes),
+		GetCount(EMergeAssistCounter::Pins),
+		GetCount(EMergeAssistCounter::Links),
+		GetCount(EMergeAssistCounter::CandidatePairs),
+		GetCount(EMergeAssistCounter::Diffs));
+}
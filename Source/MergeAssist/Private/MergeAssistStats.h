@@ -0,0 +1,158 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "Runtime/Launch/Resources/Version.h"
+
+// Trace channels were introduced together with Unreal Insights, on older engine
+// versions the scopes only show up in the stats system
+#define MERGEASSIST_WITH_TRACE (ENGINE_MAJOR_VERSION > 4 || ENGINE_MINOR_VERSION >= 26)
+
+#if MERGEASSIST_WITH_TRACE
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+UE_TRACE_CHANNEL_EXTERN(MergeAssistChannel)
+
+#define MERGEASSIST_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Name, MergeAssistChannel)
+#else
+#define MERGEASSIST_TRACE_SCOPE(Name)
+#endif
+
+DECLARE_STATS_GROUP(TEXT("MergeAssist"), STATGROUP_MergeAssist, STATCAT_Advanced);
+
+// Matching and diffing
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FindExactNodeMatches"), STAT_MergeAssist_FindExactNodeMatches, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PropagateNodeMatches"), STAT_MergeAssist_PropagateNodeMatches, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FindApproximateNodeMatches"), STAT_MergeAssist_FindApproximateNodeMatches, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("DiffNodes"), STAT_MergeAssist_DiffNodes, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GenerateChangeList"), STAT_MergeAssist_GenerateChangeList, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GroupRigidMoves"), STAT_MergeAssist_GroupRigidMoves, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ClusterChanges"), STAT_MergeAssist_ClusterChanges, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GroupConflicts"), STAT_MergeAssist_GroupConflicts, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("CaptureSnapshot"), STAT_MergeAssist_CaptureSnapshot, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RediffEditedNodes"), STAT_MergeAssist_RediffEditedNodes, STATGROUP_MergeAssist, );
+
+// Target graph modifications
+DECLARE_CYCLE_STAT_EXTERN(TEXT("CloneGraphIntoGraph"), STAT_MergeAssist_CloneGraphIntoGraph, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("CloneToTarget"), STAT_MergeAssist_CloneToTarget, STATGROUP_MergeAssist, );
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ApplyDiff_NODE_REMOVED"), STAT_MergeAssist_ApplyDiff_NODE_REMOVED, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ApplyDiff_NODE_ADDED"), STAT_MergeAssist_ApplyDiff_NODE_ADDED, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ApplyDiff_PIN_REMOVED"), STAT_MergeAssist_ApplyDiff_PIN_REMOVED, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ApplyDiff_PIN_ADDED"), STAT_MergeAssist_ApplyDiff_PIN_ADDED, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ApplyDiff_LINK_REMOVED"), STAT_MergeAssist_ApplyDiff_LINK_REMOVED, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ApplyDiff_LINK_ADDED"), STAT_MergeAssist_ApplyDiff_LINK_ADDED, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ApplyDiff_PIN_DEFAULT_VALUE"), STAT_MergeAssist_ApplyDiff_PIN_DEFAULT_VALUE, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ApplyDiff_NODE_MOVED"), STAT_MergeAssist_ApplyDiff_NODE_MOVED, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ApplyDiff_NODE_COMMENT"), STAT_MergeAssist_ApplyDiff_NODE_COMMENT, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ApplyDiff_GRAPH_ADDED"), STAT_MergeAssist_ApplyDiff_GRAPH_ADDED, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ApplyDiff_GRAPH_REMOVED"), STAT_MergeAssist_ApplyDiff_GRAPH_REMOVED, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ApplyDiff_GRAPH_CHANGED"), STAT_MergeAssist_ApplyDiff_GRAPH_CHANGED, STATGROUP_MergeAssist, );
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RevertDiff_NODE_REMOVED"), STAT_MergeAssist_RevertDiff_NODE_REMOVED, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RevertDiff_NODE_ADDED"), STAT_MergeAssist_RevertDiff_NODE_ADDED, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RevertDiff_PIN_REMOVED"), STAT_MergeAssist_RevertDiff_PIN_REMOVED, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RevertDiff_PIN_ADDED"), STAT_MergeAssist_RevertDiff_PIN_ADDED, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RevertDiff_LINK_REMOVED"), STAT_MergeAssist_RevertDiff_LINK_REMOVED, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RevertDiff_LINK_ADDED"), STAT_MergeAssist_RevertDiff_LINK_ADDED, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RevertDiff_PIN_DEFAULT_VALUE"), STAT_MergeAssist_RevertDiff_PIN_DEFAULT_VALUE, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RevertDiff_NODE_MOVED"), STAT_MergeAssist_RevertDiff_NODE_MOVED, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RevertDiff_NODE_COMMENT"), STAT_MergeAssist_RevertDiff_NODE_COMMENT, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RevertDiff_GRAPH_ADDED"), STAT_MergeAssist_RevertDiff_GRAPH_ADDED, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RevertDiff_GRAPH_REMOVED"), STAT_MergeAssist_RevertDiff_GRAPH_REMOVED, STATGROUP_MergeAssist, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RevertDiff_GRAPH_CHANGED"), STAT_MergeAssist_RevertDiff_GRAPH_CHANGED, STATGROUP_MergeAssist, );
+
+// UI
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FocusGraph"), STAT_MergeAssist_FocusGraph, STATGROUP_MergeAssist, );
+
+// Counters
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Nodes"), STAT_MergeAssist_Nodes, STATGROUP_MergeAssist, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pins"), STAT_MergeAssist_Pins, STATGROUP_MergeAssist, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Links"), STAT_MergeAssist_Links, STATGROUP_MergeAssist, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Candidate pairs"), STAT_MergeAssist_CandidatePairs, STATGROUP_MergeAssist, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Diffs"), STAT_MergeAssist_Diffs, STATGROUP_MergeAssist, );
+
+// Phases shown in the timing summary, the times of a phase include any nested phases
+enum struct EMergeAssistPhase
+{
+	Matching = 0,
+	DiffNodes,
+	GenerateChangeList,
+	Cloning,
+	ApplyDiff,
+	RevertDiff,
+	FocusGraph,
+	Snapshot,
+
+	Num
+};
+
+enum struct EMergeAssistCounter
+{
+	Nodes = 0,
+	Pins,
+	Links,
+	CandidatePairs,
+	Diffs,
+
+	Num
+};
+
+// Per merge timings and counters. Unlike the stats system these are always
+// gathered, so the summary can be shown in the merge UI and commandlet logs.
+// Diffs can be generated on worker threads, so all the counters are atomic
+struct FMergeAssistStats
+{
+	static void Reset();
+
+	static void AddTime(EMergeAssistPhase Phase, uint64 Cycles);
+	static void AddCount(EMergeAssistCounter Counter, int64 Amount);
+
+	static double GetMilliseconds(EMergeAssistPhase Phase);
+	static int64 GetCount(EMergeAssistCounter Counter);
+
+	// Single line summary of all the phases and counters
+	static FString GetSummary();
+
+private:
+	static FThreadSafeCounter64 PhaseCycles[static_cast<int32>(EMergeAssistPhase::Num)];
+	static FThreadSafeCounter64 Counters[static_cast<int32>(EMergeAssistCounter::Num)];
+};
+
+struct FMergeAssistPhaseScope
+{
+	FMergeAssistPhaseScope(EMergeAssistPhase InPhase)
+		: Phase(InPhase)
+		, StartCycles(FPlatformTime::Cycles64())
+	{}
+
+	~FMergeAssistPhaseScope()
+	{
+		FMergeAssistStats::AddTime(Phase, FPlatformTime::Cycles64() - StartCycles);
+	}
+
+private:
+	const EMergeAssistPhase Phase;
+	const uint64 StartCycles;
+};
+
+// Adds a scope to the stats system, the trace channel and the timing summary
+#define MERGEASSIST_SCOPE(Name, Phase) \
+	SCOPE_CYCLE_COUNTER(STAT_MergeAssist_##Name); \
+	MERGEASSIST_TRACE_SCOPE(MergeAssist_##Name); \
+	FMergeAssistPhaseScope MergeAssistPhaseScope_##Name(EMergeAssistPhase::Phase)
+
+// Adds to a counter of the stats system and the timing summary, the amount is only evaluated once.
+// Expands to a single statement, so it can be used as the body of an unbraced if
+#define MERGEASSIST_COUNT(Name, Amount) \
+	do \
+	{ \
+		const int64 MergeAssistCountAmount = (Amount); \
+		INC_DWORD_STAT_BY(STAT_MergeAssist_##Name, MergeAssistCountAmount); \
+		FMergeAssistStats::AddCount(EMergeAssistCounter::Name, MergeAssistCountAmount); \
+	} \
+	while (0)
@@ -0,0 +1,457 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MergeSession.h"
+#include "MergeAssist.h"
+#include "BlueprintMergeHelper.h"
+#include "GraphMergeHelper.h"
+#include "GraphSnapshotCache.h"
+
+#include "Engine/Blueprint.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraph/EdGraphNode.h"
+#include "EdGraph/EdGraphPin.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "ScopedTransaction.h"
+#include "Serialization/NameAsStringProxyArchive.h"
+#include "UObject/Package.h"
+
+#define LOCTEXT_NAMESPACE "MergeSession"
+
+static const uint32 MergeSessionMagic = 0x4D41534D; // 'MASM'
+
+// Needs to be increased whenever the format of the session changes
+static const uint32 MergeSessionVersion = 1;
+
+FArchive& operator<<(FArchive& Ar, FMergeSessionRef& Ref)
+{
+	Ar << Ref.Node << Ref.Pin << Ref.Direction;
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FMergeSessionDiff& Diff)
+{
+	Ar << Diff.Type;
+	Ar << Diff.NodeOld << Diff.NodeNew << Diff.PinOld << Diff.PinNew << Diff.LinkTargetOld << Diff.LinkTargetNew;
+	Ar << Diff.DisplayString << Diff.DisplayColor;
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FMergeSessionGraph& Graph)
+{
+	Ar << Graph.GraphName;
+	Ar << Graph.RemoteHash << Graph.BaseHash << Graph.LocalHash;
+	Ar << Graph.RemoteDiffs << Graph.LocalDiffs;
+	Ar << Graph.RemoteToBaseNodes << Graph.LocalToBaseNodes;
+	Ar << Graph.MergeStates;
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FMergeSession& Session)
+{
+	uint32 Magic = MergeSessionMagic;
+	uint32 Version = MergeSessionVersion;
+	Ar << Magic << Version;
+
+	if (Ar.IsLoading() && (Magic != MergeSessionMagic || Version != MergeSessionVersion))
+	{
+		Ar.SetError();
+		return Ar;
+	}
+
+	Ar << Session.RemotePackage << Session.BasePackage << Session.LocalPackage << Session.TargetPackage;
+	Ar << Session.RemoteRevision << Session.BaseRevision << Session.LocalRevision;
+	Ar << Session.Graphs;
+	return Ar;
+}
+
+static FMergeSessionRef ToSessionRef(const UEdGraphNode* Node)
+{
+	FMergeSessionRef Ref;
+	if (Node) Ref.Node = Node->NodeGuid;
+	return Ref;
+}
+
+static FMergeSessionRef ToSessionRef(const UEdGraphPin* Pin)
+{
+	FMergeSessionRef Ref;
+	if (!Pin) return Ref;
+
+	Ref.Node = Pin->GetOwningNode()->NodeGuid;
+	Ref.Pin = Pin->PinName;
+	Ref.Direction = static_cast<uint8>(Pin->Direction);
+	return Ref;
+}
+
+static FMergeSessionDiff ToSessionDiff(const FMergeDiffResult& Diff)
+{
+	FMergeSessionDiff SessionDiff;
+	SessionDiff.Type = static_cast<uint8>(Diff.Type);
+	SessionDiff.NodeOld = ToSessionRef(Diff.NodeOld);
+	SessionDiff.NodeNew = ToSessionRef(Diff.NodeNew);
+	SessionDiff.PinOld = ToSessionRef(Diff.PinOld);
+	SessionDiff.PinNew = ToSessionRef(Diff.PinNew);
+	SessionDiff.LinkTargetOld = ToSessionRef(Diff.LinkTargetOld);
+	SessionDiff.LinkTargetNew = ToSessionRef(Diff.LinkTargetNew);
+	SessionDiff.DisplayString = Diff.DisplayString.ToString();
+	SessionDiff.DisplayColor = Diff.DisplayColor;
+	return SessionDiff;
+}
+
+static FString HashGraph(const UEdGraph* Graph)
+{
+	return Graph ? FGraphSnapshotCache::FindOrCapture(Graph)->GetContentHash() : FString();
+}
+
+// Nodes of a graph by their guid, the saved diffs of graphs with duplicate guids can not be resolved
+struct FMergeSessionNodeIndex
+{
+	explicit FMergeSessionNodeIndex(const UEdGraph* Graph)
+	{
+		if (!Graph) return;
+
+		Nodes.Reserve(Graph->Nodes.Num());
+		for (UEdGraphNode* Node : Graph->Nodes)
+		{
+			if (!Node) continue;
+
+			if (Nodes.Contains(Node->NodeGuid)) bHasDuplicates = true;
+			else Nodes.Add(Node->NodeGuid, Node);
+		}
+	}
+
+	UEdGraphNode* Find(const FGuid& Guid) const
+	{
+		UEdGraphNode* const* Node = Nodes.Find(Guid);
+		return Node ? *Node : nullptr;
+	}
+
+	TMap<FGuid, UEdGraphNode*> Nodes;
+	bool bHasDuplicates = false;
+};
+
+// Returns false if any of the nodes or pins of the diff no longer exist
+static bool ResolveDiff(const FMergeSessionDiff& SessionDiff, const FMergeSessionNodeIndex& OldNodes, const FMergeSessionNodeIndex& NewNodes, FMergeDiffResult& OutDiff)
+{
+	bool bResolved = true;
+
+	const auto FindNode = [&bResolved](const FMergeSessionNodeIndex& Nodes, const FMergeSessionRef& Ref) -> UEdGraphNode*
+	{
+		if (!Ref.Node.IsValid()) return nullptr;
+
+		UEdGraphNode* Node = Nodes.Find(Ref.Node);
+		if (!Node) bResolved = false;
+		return Node;
+	};
+
+	const auto FindPin = [&bResolved, &FindNode](const FMergeSessionNodeIndex& Nodes, const FMergeSessionRef& Ref) -> UEdGraphPin*
+	{
+		UEdGraphNode* Node = FindNode(Nodes, Ref);
+		if (!Node) return nullptr;
+
+		UEdGraphPin* Pin = Node->FindPin(Ref.Pin, static_cast<EEdGraphPinDirection>(Ref.Direction));
+		if (!Pin) bResolved = false;
+		return Pin;
+	};
+
+	OutDiff.Type = static_cast<EMergeDiffType>(SessionDiff.Type);
+	OutDiff.NodeOld = FindNode(OldNodes, SessionDiff.NodeOld);
+	OutDiff.NodeNew = FindNode(NewNodes, SessionDiff.NodeNew);
+	OutDiff.PinOld = FindPin(OldNodes, SessionDiff.PinOld);
+	OutDiff.PinNew = FindPin(NewNodes, SessionDiff.PinNew);
+	OutDiff.LinkTargetOld = FindPin(OldNodes, SessionDiff.LinkTargetOld);
+	OutDiff.LinkTargetNew = FindPin(NewNodes, SessionDiff.LinkTargetNew);
+	OutDiff.DisplayString = FText::FromString(SessionDiff.DisplayString);
+	OutDiff.DisplayColor = SessionDiff.DisplayColor;
+
+	return bResolved;
+}
+
+static bool ResolveDiffs(const TArray<FMergeSessionDiff>& SessionDiffs, const TMap<FGuid, FGuid>& SessionNodeMap,
+	const FMergeSessionNodeIndex& OldNodes, const FMergeSessionNodeIndex& NewNodes,
+	TArray<FMergeDiffResult>& OutDiffs, TMap<UEdGraphNode*, UEdGraphNode*>& OutNodeMap)
+{
+	OutDiffs.SetNum(SessionDiffs.Num());
+	for (int32 Index = 0; Index < SessionDiffs.Num(); ++Index)
+	{
+		if (!ResolveDiff(SessionDiffs[Index], OldNodes, NewNodes, OutDiffs[Index])) return false;
+	}
+
+	OutNodeMap.Reserve(SessionNodeMap.Num());
+	for (const auto& Pair : SessionNodeMap)
+	{
+		UEdGraphNode* NewNode = NewNodes.Find(Pair.Key);
+		UEdGraphNode* OldNode = OldNodes.Find(Pair.Value);
+		if (!NewNode || !OldNode) return false;
+
+		OutNodeMap.Add(NewNode, OldNode);
+	}
+
+	return true;
+}
+
+// Generates the changes of a graph from the saved diffs, returns false if the graph needs to be diffed again
+static bool RestoreGraphDiffs(const FMergeSessionGraph& SessionGraph, UEdGraph* RemoteGraph, UEdGraph* BaseGraph, UEdGraph* LocalGraph, FGraphMergeDiffs& OutDiffs)
+{
+	// The saved diffs can only be used when none of the source graphs changed since they were saved
+	if (SessionGraph.BaseHash != HashGraph(BaseGraph)
+		|| SessionGraph.RemoteHash != HashGraph(RemoteGraph)
+		|| SessionGraph.LocalHash != HashGraph(LocalGraph)) return false;
+
+	const FMergeSessionNodeIndex RemoteNodes(RemoteGraph);
+	const FMergeSessionNodeIndex BaseNodes(BaseGraph);
+	const FMergeSessionNodeIndex LocalNodes(LocalGraph);
+	if (RemoteNodes.bHasDuplicates || BaseNodes.bHasDuplicates || LocalNodes.bHasDuplicates) return false;
+
+	TArray<FMergeDiffResult> RemoteDifferences;
+	TArray<FMergeDiffResult> LocalDifferences;
+	TMap<UEdGraphNode*, UEdGraphNode*> RemoteToBaseNodeMap;
+	TMap<UEdGraphNode*, UEdGraphNode*> LocalToBaseNodeMap;
+
+	if (!ResolveDiffs(SessionGraph.RemoteDiffs, SessionGraph.RemoteToBaseNodes, BaseNodes, RemoteNodes, RemoteDifferences, RemoteToBaseNodeMap)) return false;
+	if (!ResolveDiffs(SessionGraph.LocalDiffs, SessionGraph.LocalToBaseNodes, BaseNodes, LocalNodes, LocalDifferences, LocalToBaseNodeMap)) return false;
+
+	OutDiffs = FGraphMergeDiffs::FromDifferences(RemoteDifferences, LocalDifferences, MoveTemp(RemoteToBaseNodeMap), MoveTemp(LocalToBaseNodeMap));
+	return true;
+}
+
+FMergeSession FMergeSession::Capture(const BlueprintMergeHelper& Merge)
+{
+	FMergeSession Session;
+	Session.SetInputs(Merge.Data);
+
+	for (const auto& MergeHelper : Merge.GraphMergeHelpers)
+	{
+		// Graphs which are still being diffed do not have any changes yet
+		const FName GraphName = MergeHelper->GraphName;
+		if (Merge.IsDiffPending(GraphName)) continue;
+
+		// Make sure the saved diffs include the edits made to the graphs since the last tick
+		MergeHelper->FlushGraphEdits();
+
+		FMergeSessionGraph& Graph = Session.Graphs[Session.Graphs.AddDefaulted()];
+		Graph.GraphName = GraphName;
+		Graph.RemoteHash = HashGraph(Merge.FindRemoteGraph(GraphName));
+		Graph.BaseHash = HashGraph(Merge.FindBaseGraph(GraphName));
+		Graph.LocalHash = HashGraph(Merge.FindLocalGraph(GraphName));
+
+		for (const auto& Diff : MergeHelper->GetRemoteDifferences().Diffs) Graph.RemoteDiffs.Add(ToSessionDiff(Diff));
+		for (const auto& Diff : MergeHelper->GetLocalDifferences().Diffs) Graph.LocalDiffs.Add(ToSessionDiff(Diff));
+
+		for (const auto& Pair : MergeHelper->GetRemoteToBaseNodeMap()) Graph.RemoteToBaseNodes.Add(Pair.Key->NodeGuid, Pair.Value->NodeGuid);
+		for (const auto& Pair : MergeHelper->GetLocalToBaseNodeMap()) Graph.LocalToBaseNodes.Add(Pair.Key->NodeGuid, Pair.Value->NodeGuid);
+
+		for (const auto& Change : MergeHelper->ChangeList)
+		{
+			if (Change->MergeState == EMergeState::Base) continue;
+			Graph.MergeStates.Add(GetChangeKey(*Change), static_cast<uint8>(Change->MergeState));
+		}
+	}
+
+	return Session;
+}
+
+bool FMergeSession::Save(const FString& Filename) const
+{
+	// Write to a temporary file first, so a session which is being written is never loaded
+	const FString TempFilename = Filename + TEXT(".tmp");
+
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TempFilename));
+	if (!Writer) return false;
+
+	// Names are stored as strings, since the file is read back by a different process
+	FNameAsStringProxyArchive Ar(*Writer);
+	Ar << const_cast<FMergeSession&>(*this);
+
+	const bool bWritten = !Ar.IsError() && !Writer->IsError() && Writer->Close();
+	Writer.Reset();
+
+	if (!bWritten || !IFileManager::Get().Move(*Filename, *TempFilename, true, true))
+	{
+		IFileManager::Get().Delete(*TempFilename, false, true, true);
+		return false;
+	}
+
+	return true;
+}
+
+bool FMergeSession::Load(const FString& Filename, FMergeSession& OutSession)
+{
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Filename, FILEREAD_Silent));
+	if (!Reader) return false;
+
+	FNameAsStringProxyArchive Ar(*Reader);
+	Ar << OutSession;
+
+	if (Ar.IsError() || Reader->IsError())
+	{
+		UE_LOG(LogMergeAssist, Warning, TEXT("Ignoring merge session '%s', it is not a valid session"), *Filename);
+		OutSession = FMergeSession();
+		return false;
+	}
+
+	return true;
+}
+
+bool FMergeSession::IsSessionFor(const FBlueprintMergeData& Data) const
+{
+	FMergeSession Inputs;
+	Inputs.SetInputs(Data);
+
+	return RemotePackage == Inputs.RemotePackage
+		&& BasePackage == Inputs.BasePackage
+		&& LocalPackage == Inputs.LocalPackage
+		&& TargetPackage == Inputs.TargetPackage
+		&& RemoteRevision == Inputs.RemoteRevision
+		&& BaseRevision == Inputs.BaseRevision
+		&& LocalRevision == Inputs.LocalRevision;
+}
+
+TSharedPtr<FBlueprintMergeDiffs> FMergeSession::GenerateDiffs(const FBlueprintMergeData& Data, int32* OutNumReusedGraphs) const
+{
+	TSharedPtr<FBlueprintMergeDiffs> Diffs = MakeShareable(new FBlueprintMergeDiffs());
+
+	const FBlueprintGraphIndex RemoteGraphs(Data.BlueprintRemote);
+	const FBlueprintGraphIndex BaseGraphs(Data.BlueprintBase);
+	const FBlueprintGraphIndex LocalGraphs(Data.BlueprintLocal);
+
+	// Graphs which could not reuse their saved diffs are diffed again together, in parallel
+	TArray<FName> ChangedGraphNames;
+
+	int32 NumReusedGraphs = 0;
+	for (auto GraphName : BlueprintMergeHelper::EnumerateGraphNames(Data))
+	{
+		UEdGraph* RemoteGraph = RemoteGraphs.Find(GraphName);
+		UEdGraph* BaseGraph = BaseGraphs.Find(GraphName);
+		UEdGraph* LocalGraph = LocalGraphs.Find(GraphName);
+
+		const FMergeSessionGraph* SessionGraph = Graphs.FindByPredicate([GraphName](const FMergeSessionGraph& Graph)
+		{
+			return Graph.GraphName == GraphName;
+		});
+
+		FGraphMergeDiffs GraphDiffs;
+		if (SessionGraph && RestoreGraphDiffs(*SessionGraph, RemoteGraph, BaseGraph, LocalGraph, GraphDiffs))
+		{
+			Diffs->Add(GraphName, MoveTemp(GraphDiffs));
+			++NumReusedGraphs;
+		}
+		else
+		{
+			ChangedGraphNames.Add(GraphName);
+		}
+	}
+
+	BlueprintMergeHelper::GenerateDiffs(Data, ChangedGraphNames, *Diffs);
+
+	if (OutNumReusedGraphs) *OutNumReusedGraphs = NumReusedGraphs;
+	return Diffs;
+}
+
+int32 FMergeSession::Restore(BlueprintMergeHelper& Merge) const
+{
+	const FScopedTransaction Transaction(LOCTEXT("ResumeMergeSession", "Resume Merge Session"));
+
+	int32 NumRestored = 0;
+
+	for (const FMergeSessionGraph& Graph : Graphs)
+	{
+		if (!Graph.MergeStates.Num() || Merge.IsDiffPending(Graph.GraphName)) continue;
+
+		const TSharedPtr<GraphMergeHelper> MergeHelper = Merge.FindGraphMergeHelper(Graph.GraphName);
+		if (!MergeHelper) continue;
+
+		// Changes which no longer exist are skipped, changes which are new stay in the base state
+		NumRestored += MergeHelper->ApplyMergeStates([&Graph](const MergeGraphChange& Change)
+		{
+			const uint8* State = Graph.MergeStates.Find(GetChangeKey(Change));
+			return State ? static_cast<EMergeState>(*State) : EMergeState::Base;
+		});
+	}
+
+	return NumRestored;
+}
+
+static FString GetPinKey(const UEdGraphPin* Pin)
+{
+	if (!Pin) return FString();
+	return Pin->GetOwningNode()->NodeGuid.ToString() + TEXT(".") + Pin->PinName.ToString();
+}
+
+static FString GetDiffKey(const FMergeDiffResult& Diff)
+{
+	if (Diff.Type == EMergeDiffType::NO_DIFFERENCE) return FString();
+
+	// Diffs of a node which exists in the base graph are identified through the base node, since its guid is the
+	// same for every remote and local revision. Only nodes which are added are identified through the new node
+	const UEdGraphNode* Node = Diff.NodeOld ? Diff.NodeOld : Diff.NodeNew;
+	const UEdGraphPin* Pin = Diff.PinOld ? Diff.PinOld : Diff.PinNew;
+	const UEdGraphPin* LinkTarget = Diff.LinkTargetOld ? Diff.LinkTargetOld : Diff.LinkTargetNew;
+
+	return FString::Printf(TEXT("%d|%s|%s|%s"),
+		static_cast<int32>(Diff.Type),
+		Node ? *Node->NodeGuid.ToString() : TEXT(""),
+		*GetPinKey(Pin),
+		*GetPinKey(LinkTarget));
+}
+
+FString FMergeSession::GetChangeKey(const MergeGraphChange& Change)
+{
+	// The diffs of a composite change are only used for display, so it is identified by its sub changes.
+	// These can contain thousands of changes, e.g. a selection of nodes which was moved, so the key is hashed
+	if (Change.SubChanges.Num())
+	{
+		FString SubChangeKeys;
+		for (const auto& SubChange : Change.SubChanges)
+		{
+			SubChangeKeys += GetChangeKey(*SubChange);
+			SubChangeKeys += TEXT(";");
+		}
+
+		return TEXT("G") + FMD5::HashAnsiString(*SubChangeKeys);
+	}
+
+	return TEXT("R") + GetDiffKey(Change.RemoteDiff) + TEXT("L") + GetDiffKey(Change.LocalDiff);
+}
+
+FString FMergeSession::GetSessionFilename(const FBlueprintMergeData& Data)
+{
+	FMergeSession Inputs;
+	Inputs.SetInputs(Data);
+
+	const FString Key = FString::Join(TArray<FString>{
+		Inputs.RemotePackage, Inputs.BasePackage, Inputs.LocalPackage, Inputs.TargetPackage,
+		Inputs.RemoteRevision, Inputs.BaseRevision, Inputs.LocalRevision }, TEXT("|"));
+
+	return GetSessionDirectory() / FMD5::HashAnsiString(*Key) + TEXT(".session");
+}
+
+FString FMergeSession::GetSessionDirectory()
+{
+	return FPaths::ProjectSavedDir() / TEXT("MergeAssist") / TEXT("Sessions");
+}
+
+void FMergeSession::SetInputs(const FBlueprintMergeData& Data)
+{
+	const auto GetPackageName = [](const UBlueprint* Blueprint)
+	{
+		return Blueprint ? Blueprint->GetOutermost()->GetName() : FString();
+	};
+
+	const auto GetRevision = [](const FRevisionInfo& Revision)
+	{
+		return FString::Printf(TEXT("%s@%d"), *Revision.Revision, Revision.Changelist);
+	};
+
+	RemotePackage = GetPackageName(Data.BlueprintRemote);
+	BasePackage = GetPackageName(Data.BlueprintBase);
+	LocalPackage = GetPackageName(Data.BlueprintLocal);
+	TargetPackage = GetPackageName(Data.BlueprintTarget);
+
+	RemoteRevision = GetRevision(Data.RevisionRemote);
+	BaseRevision = GetRevision(Data.RevisionBase);
+	LocalRevision = GetRevision(Data.RevisionLocal);
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BlueprintMergeData.h"
+
+class BlueprintMergeHelper;
+struct MergeGraphChange;
+struct FBlueprintMergeDiffs;
+
+// Pin or node of a saved diff, nodes are found by their guid and pins by their name and direction.
+// Diffs without the pin or node have an invalid node guid
+struct FMergeSessionRef
+{
+	FGuid Node;
+	FName Pin;
+	uint8 Direction = 0;
+
+	friend FArchive& operator<<(FArchive& Ar, FMergeSessionRef& Ref);
+};
+
+// Diff between a remote or local graph and the base graph, see FMergeDiffResult
+struct FMergeSessionDiff
+{
+	uint8 Type = 0;
+
+	FMergeSessionRef NodeOld;
+	FMergeSessionRef NodeNew;
+	FMergeSessionRef PinOld;
+	FMergeSessionRef PinNew;
+	FMergeSessionRef LinkTargetOld;
+	FMergeSessionRef LinkTargetNew;
+
+	FString DisplayString;
+	FLinearColor DisplayColor;
+
+	friend FArchive& operator<<(FArchive& Ar, FMergeSessionDiff& Diff);
+};
+
+struct FMergeSessionGraph
+{
+	FName GraphName;
+
+	// Content hashes of the snapshots of the source graphs, empty for graphs which do not exist
+	FString RemoteHash;
+	FString BaseHash;
+	FString LocalHash;
+
+	// The diffs and node mappings the change list was generated from, these are used instead of
+	// diffing the graphs again when the hashes of all the source graphs match
+	TArray<FMergeSessionDiff> RemoteDiffs;
+	TArray<FMergeSessionDiff> LocalDiffs;
+	TMap<FGuid, FGuid> RemoteToBaseNodes;
+	TMap<FGuid, FGuid> LocalToBaseNodes;
+
+	// Version picked for each change which is not in the base state, by the key of the change
+	TMap<FString, uint8> MergeStates;
+
+	friend FArchive& operator<<(FArchive& Ar, FMergeSessionGraph& Graph);
+};
+
+// The progress of a merge, saved when the merge UI is closed so the merge can be resumed later. The
+// version picked for each change is stored by a key built from the node guids and pin names of its
+// diffs, so the decisions can be replayed on a change list which was generated again
+struct FMergeSession
+{
+	// Captures the decisions of the merge, together with the diffs of every graph
+	static FMergeSession Capture(const BlueprintMergeHelper& Merge);
+
+	bool Save(const FString& Filename) const;
+	static bool Load(const FString& Filename, FMergeSession& OutSession);
+
+	// Whether the session was saved for a merge of the same blueprints and revisions
+	bool IsSessionFor(const FBlueprintMergeData& Data) const;
+
+	// Generates the diffs of the merge, graphs whose source graphs did not change since the
+	// session was saved reuse the saved diffs, only the other graphs are diffed again
+	TSharedPtr<FBlueprintMergeDiffs> GenerateDiffs(const FBlueprintMergeData& Data, int32* OutNumReusedGraphs = nullptr) const;
+
+	// Replays the saved decisions as a single transaction, every graph is restored in a single batch. Returns the number
+	// of changes which were put into their saved state
+	int32 Restore(BlueprintMergeHelper& Merge) const;
+
+	// Stable identity of a change, built from the guids of its nodes and the names of its pins
+	static FString GetChangeKey(const MergeGraphChange& Change);
+
+	// Each merge of the same blueprints and revisions has its own session file
+	static FString GetSessionFilename(const FBlueprintMergeData& Data);
+	static FString GetSessionDirectory();
+
+	friend FArchive& operator<<(FArchive& Ar, FMergeSession& Session);
+
+public:
+	// Package names and revisions of the merged blueprints
+	FString RemotePackage;
+	FString BasePackage;
+	FString LocalPackage;
+	FString TargetPackage;
+
+	FString RemoteRevision;
+	FString BaseRevision;
+	FString LocalRevision;
+
+	TArray<FMergeSessionGraph> Graphs;
+
+private:
+	void SetInputs(const FBlueprintMergeData& Data);
+};
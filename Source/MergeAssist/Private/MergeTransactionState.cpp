@@ -0,0 +1,9 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MergeTransactionState.h"
+
+void UMergeTransactionState::PostEditUndo()
+{
+	Super::PostEditUndo();
+	OnUndone.Broadcast();
+}
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "MergeTransactionState.generated.h"
+
+class UEdGraphNode;
+
+DECLARE_MULTICAST_DELEGATE(FOnMergeTransactionUndone);
+
+/**
+ * The state of a GraphMergeHelper which changes when changes are applied or reverted. It is recorded in the
+ * same transactions as the edits to the target graph, so undoing an apply puts the changes back into the
+ * state they were in, together with the target graph
+ */
+UCLASS(Transient)
+class UMergeTransactionState : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/** State of every change recorded by the merge helper, by the index it was recorded at */
+	UPROPERTY()
+	TArray<uint8> MergeStates;
+
+	/** Node in the target graph of each base node which was removed or restored, removed nodes map to null */
+	UPROPERTY()
+	TMap<UEdGraphNode*, UEdGraphNode*> ReplacedBaseNodes;
+
+	/** Node in the target graph of each node which was added by the remote or local graph */
+	UPROPERTY()
+	TMap<UEdGraphNode*, UEdGraphNode*> NewNodesInTargetGraph;
+
+	/** Broadcast after an undo or redo restored the state */
+	FOnMergeTransactionUndone OnUndone;
+
+	/** UObject interface */
+	void PostEditUndo() override;
+};
@@ -0,0 +1,210 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NodeSpatialIndex.h"
+
+FNodeSpatialIndex::FNodeSpatialIndex(TArrayView<const int32> PositionsX, TArrayView<const int32> PositionsY)
+{
+	check(PositionsX.Num() == PositionsY.Num());
+
+	const int32 Num = PositionsX.Num();
+	if (Num == 0)
+	{
+		CellStarts.Init(0, 2);
+		return;
+	}
+
+	int32 MaxX = PositionsX[0];
+	int32 MaxY = PositionsY[0];
+	MinX = MaxX;
+	MinY = MaxY;
+
+	for (int32 i = 1; i < Num; ++i)
+	{
+		MinX = FMath::Min(MinX, PositionsX[i]);
+		MinY = FMath::Min(MinY, PositionsY[i]);
+		MaxX = FMath::Max(MaxX, PositionsX[i]);
+		MaxY = FMath::Max(MaxY, PositionsY[i]);
+	}
+
+	// Aim for about one node per cell, without creating more cells than nodes along either axis
+	const double Width = double(MaxX) - MinX + 1;
+	const double Height = double(MaxY) - MinY + 1;
+	const double IdealCellSize = FMath::Max(FMath::Sqrt(Width * Height / Num), FMath::Max(Width, Height) / Num);
+
+	CellSize = FMath::Max(1, FMath::CeilToInt(IdealCellSize));
+	NumCellsX = static_cast<int32>(Width / CellSize) + 1;
+	NumCellsY = static_cast<int32>(Height / CellSize) + 1;
+
+	// Counting sort of the nodes by their cell
+	TArray<int32> Cells;
+	Cells.SetNumUninitialized(Num);
+	CellStarts.Init(0, NumCellsX * NumCellsY + 1);
+
+	for (int32 i = 0; i < Num; ++i)
+	{
+		Cells[i] = GetCellY(PositionsY[i]) * NumCellsX + GetCellX(PositionsX[i]);
+		CellStarts[Cells[i] + 1]++;
+	}
+
+	for (int32 Cell = 0; Cell < NumCellsX * NumCellsY; ++Cell)
+	{
+		CellStarts[Cell + 1] += CellStarts[Cell];
+	}
+
+	SortedX.SetNumUninitialized(Num);
+	SortedY.SetNumUninitialized(Num);
+	SortedIndices.SetNumUninitialized(Num);
+
+	TArray<int32> Cursors(CellStarts.GetData(), NumCellsX * NumCellsY);
+	for (int32 i = 0; i < Num; ++i)
+	{
+		const int32 Slot = Cursors[Cells[i]]++;
+		SortedX[Slot] = PositionsX[i];
+		SortedY[Slot] = PositionsY[i];
+		SortedIndices[Slot] = i;
+	}
+}
+
+void FNodeSpatialIndex::FindNearest(int32 X, int32 Y, int32 MaxResults, TArray<int32>& IndicesOut) const
+{
+	struct FNearest
+	{
+		int64 DistanceSquared;
+		int32 Index;
+
+		bool operator<(const FNearest& Other) const
+		{
+			return DistanceSquared != Other.DistanceSquared ? DistanceSquared < Other.DistanceSquared : Index < Other.Index;
+		}
+	};
+
+	IndicesOut.Reset();
+	if (MaxResults <= 0 || SortedIndices.Num() == 0) return;
+
+	TArray<FNearest, TInlineAllocator<16>> Nearest;
+	TArray<int64, TInlineAllocator<64>> Distances;
+
+	const int32 CenterX = GetCellX(X);
+	const int32 CenterY = GetCellY(Y);
+	const int32 MaxRing = FMath::Max(NumCellsX, NumCellsY);
+
+	const auto VisitCell = [&](int32 CellX, int32 CellY)
+	{
+		const int32 Cell = CellY * NumCellsX + CellX;
+		const int32 First = CellStarts[Cell];
+		const int32 Count = CellStarts[Cell + 1] - First;
+		if (Count == 0) return;
+
+		// Compute all the distances of the cell first, this loop has no branches so it can be vectorized
+		Distances.SetNumUninitialized(Count, false);
+		const int32* CellPositionsX = SortedX.GetData() + First;
+		const int32* CellPositionsY = SortedY.GetData() + First;
+		for (int32 i = 0; i < Count; ++i)
+		{
+			const int64 DeltaX = int64(CellPositionsX[i]) - X;
+			const int64 DeltaY = int64(CellPositionsY[i]) - Y;
+			Distances[i] = DeltaX * DeltaX + DeltaY * DeltaY;
+		}
+
+		for (int32 i = 0; i < Count; ++i)
+		{
+			const FNearest Candidate = { Distances[i], SortedIndices[First + i] };
+			if (Nearest.Num() == MaxResults && !(Candidate < Nearest.Last())) continue;
+
+			// Keep the nearest nodes sorted, there are only a few of them
+			int32 Insert = Nearest.Num();
+			while (Insert > 0 && Candidate < Nearest[Insert - 1]) --Insert;
+
+			Nearest.Insert(Candidate, Insert);
+			if (Nearest.Num() > MaxResults) Nearest.Pop(false);
+		}
+	};
+
+	// Visit the cells in rings around the cell of the position. Every node in ring R or further out is at
+	// least R - 1 cells away, so once enough nodes were found within that distance the search can stop
+	for (int32 Ring = 0; Ring <= MaxRing; ++Ring)
+	{
+		const int64 RingDistance = int64(Ring - 1) * CellSize;
+		if (Ring > 0 && Nearest.Num() == MaxResults && Nearest.Last().DistanceSquared <= RingDistance * RingDistance) break;
+
+		const int32 MinCellY = FMath::Max(CenterY - Ring, 0);
+		const int32 MaxCellY = FMath::Min(CenterY + Ring, NumCellsY - 1);
+
+		for (int32 CellY = MinCellY; CellY <= MaxCellY; ++CellY)
+		{
+			// Only the first and last row of the ring are complete, the other rows only have their two ends
+			const bool bIsEdgeRow = CellY == CenterY - Ring || CellY == CenterY + Ring;
+			const int32 Step = bIsEdgeRow ? 1 : FMath::Max(2 * Ring, 1);
+
+			for (int32 CellX = CenterX - Ring; CellX <= CenterX + Ring; CellX += Step)
+			{
+				if (CellX >= 0 && CellX < NumCellsX) VisitCell(CellX, CellY);
+			}
+		}
+	}
+
+	IndicesOut.Reserve(Nearest.Num());
+	for (const FNearest& Entry : Nearest) IndicesOut.Add(Entry.Index);
+}
+
+void FNodeSpatialIndex::FindCandidatePairs(
+	TArrayView<const int32> OldPositionsX, TArrayView<const int32> OldPositionsY,
+	TArrayView<const int32> NewPositionsX, TArrayView<const int32> NewPositionsY,
+	TArray<TPair<int32, int32>>& PairsOut)
+{
+	const int32 NumOld = OldPositionsX.Num();
+	const int32 NumNew = NewPositionsX.Num();
+
+	PairsOut.Reset();
+
+	if (int64(NumOld) * NumNew <= MaxExhaustivePairs)
+	{
+		PairsOut.Reserve(NumOld * NumNew);
+		for (int32 OldIndex = 0; OldIndex < NumOld; ++OldIndex)
+		{
+			for (int32 NewIndex = 0; NewIndex < NumNew; ++NewIndex)
+			{
+				PairsOut.Add(TPair<int32, int32>(OldIndex, NewIndex));
+			}
+		}
+
+		return;
+	}
+
+	// Pair the closest nodes both ways, so every node of either graph has candidates
+	const FNodeSpatialIndex OldNodesIndex(OldPositionsX, OldPositionsY);
+	const FNodeSpatialIndex NewNodesIndex(NewPositionsX, NewPositionsY);
+
+	PairsOut.Reserve((NumOld + NumNew) * NumNearestCandidates);
+
+	TArray<int32> Nearest;
+	for (int32 Old = 0; Old < NumOld; ++Old)
+	{
+		NewNodesIndex.FindNearest(OldPositionsX[Old], OldPositionsY[Old], NumNearestCandidates, Nearest);
+		for (const int32 New : Nearest) PairsOut.Add(TPair<int32, int32>(Old, New));
+	}
+
+	for (int32 New = 0; New < NumNew; ++New)
+	{
+		OldNodesIndex.FindNearest(NewPositionsX[New], NewPositionsY[New], NumNearestCandidates, Nearest);
+		for (const int32 Old : Nearest) PairsOut.Add(TPair<int32, int32>(Old, New));
+	}
+
+	// Use the same order as the exhaustive pairs, and remove the pairs which were found both ways
+	PairsOut.Sort([](const TPair<int32, int32>& A, const TPair<int32, int32>& B)
+	{
+		return A.Key != B.Key ? A.Key < B.Key : A.Value < B.Value;
+	});
+
+	int32 NumUnique = 0;
+	for (int32 i = 0; i < PairsOut.Num(); ++i)
+	{
+		const bool bIsDuplicate = NumUnique > 0
+			&& PairsOut[i].Key == PairsOut[NumUnique - 1].Key
+			&& PairsOut[i].Value == PairsOut[NumUnique - 1].Value;
+
+		if (!bIsDuplicate) PairsOut[NumUnique++] = PairsOut[i];
+	}
+
+	PairsOut.SetNum(NumUnique, false);
+}
@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Uniform grid over the positions of a set of nodes, used to find the nodes closest to a position.
+// The positions are stored sorted by cell as separate X and Y arrays, so the distances of all the
+// nodes in a cell are computed in a single tight loop
+class FNodeSpatialIndex
+{
+public:
+	FNodeSpatialIndex(TArrayView<const int32> PositionsX, TArrayView<const int32> PositionsY);
+
+	// Finds the indices of the MaxResults nodes closest to the position, ordered by distance.
+	// Nodes at the same distance are ordered by their index, so the results are deterministic
+	void FindNearest(int32 X, int32 Y, int32 MaxResults, TArray<int32>& IndicesOut) const;
+
+	// Pairs of old and new nodes which should be scored when approximately matching nodes of the same type.
+	// Small sets of nodes pair everything, larger sets only pair each node with the closest nodes of the other
+	// graph, since nodes of the same type which sit close together in both graphs are likely the same node.
+	// The pairs are indices into the position arrays, sorted by old and then new index
+	static void FindCandidatePairs(
+		TArrayView<const int32> OldPositionsX, TArrayView<const int32> OldPositionsY,
+		TArrayView<const int32> NewPositionsX, TArrayView<const int32> NewPositionsY,
+		TArray<TPair<int32, int32>>& PairsOut);
+
+	// Sets of nodes with up to this many pairs are paired exhaustively
+	static const int32 MaxExhaustivePairs = 64 * 64;
+
+	// Number of closest nodes each node is paired with in larger sets
+	static const int32 NumNearestCandidates = 8;
+
+private:
+	int32 GetCellX(int32 X) const { return FMath::Clamp((X - MinX) / CellSize, 0, NumCellsX - 1); }
+	int32 GetCellY(int32 Y) const { return FMath::Clamp((Y - MinY) / CellSize, 0, NumCellsY - 1); }
+
+	int32 MinX = 0;
+	int32 MinY = 0;
+	int32 CellSize = 1;
+	int32 NumCellsX = 1;
+	int32 NumCellsY = 1;
+
+	// The nodes of cell i are [CellStarts[i], CellStarts[i + 1]) in the sorted arrays
+	TArray<int32> CellStarts;
+	TArray<int32> SortedX;
+	TArray<int32> SortedY;
+	TArray<int32> SortedIndices;
+};
@@ -0,0 +1,268 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SBatchMergeView.h"
+#include "SlateOptMacros.h"
+
+#include "MultiBoxBuilder.h"
+#include "EditorStyle.h"
+#include "SEditableTextBox.h"
+#include "SButton.h"
+#include "SWindow.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopedSlowTask.h"
+
+#include "BatchMergeHelper.h"
+#include "BlueprintMergeHelper.h"
+#include "SBlueprintMergeAssist.h"
+
+BEGIN_SLATE_FUNCTION_BUILD_OPTIMIZATION
+
+#define LOCTEXT_NAMESPACE "SBatchMergeView"
+
+static const FName BatchColumnTarget("Target");
+static const FName BatchColumnChanges("Changes");
+static const FName BatchColumnConflicts("Conflicts");
+static const FName BatchColumnStatus("Status");
+static const FName BatchColumnOpen("Open");
+
+static FText GetStatusDisplayText(EBatchMergeStatus Status)
+{
+	switch (Status)
+	{
+	case EBatchMergeStatus::Failed:         return LOCTEXT("StatusFailed", "Failed");
+	case EBatchMergeStatus::Diffed:         return LOCTEXT("StatusDiffed", "Ready to merge");
+	case EBatchMergeStatus::AutoMerged:     return LOCTEXT("StatusAutoMerged", "Auto merged");
+	case EBatchMergeStatus::NeedsAttention: return LOCTEXT("StatusNeedsAttention", "Needs attention");
+	default:                                return LOCTEXT("StatusPending", "Pending");
+	}
+}
+
+class SBatchMergeEntryRow : public SMultiColumnTableRow<TSharedPtr<FBatchMergeEntry>>
+{
+public:
+	SLATE_BEGIN_ARGS(SBatchMergeEntryRow)
+	{}
+		SLATE_EVENT(FSimpleDelegate, OnOpen)
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs, const TSharedRef<STableViewBase>& OwnerTable, TSharedPtr<FBatchMergeEntry> InEntry)
+	{
+		Entry = InEntry;
+		OnOpen = InArgs._OnOpen;
+
+		SMultiColumnTableRow<TSharedPtr<FBatchMergeEntry>>::Construct(FSuperRowType::FArguments(), OwnerTable);
+	}
+
+	TSharedRef<SWidget> GenerateWidgetForColumn(const FName& ColumnName) override
+	{
+		if (ColumnName == BatchColumnTarget)
+		{
+			return SNew(STextBlock)
+				.Text(FText::FromString(Entry->TargetPath))
+				.ToolTipText(FText::FromString(Entry->Error));
+		}
+
+		if (ColumnName == BatchColumnChanges)
+		{
+			return SNew(STextBlock).Text(FText::AsNumber(Entry->NumChanges));
+		}
+
+		if (ColumnName == BatchColumnConflicts)
+		{
+			return SNew(STextBlock).Text(FText::AsNumber(Entry->NumConflicts));
+		}
+
+		if (ColumnName == BatchColumnStatus)
+		{
+			// Use a lambda so the status is updated after merging
+			const TSharedPtr<FBatchMergeEntry> RowEntry = Entry;
+			return SNew(STextBlock).Text_Lambda([RowEntry]() { return GetStatusDisplayText(RowEntry->Status); });
+		}
+
+		const TSharedPtr<FBatchMergeEntry> RowEntry = Entry;
+		return SNew(SButton)
+			.Text(LOCTEXT("OpenEntry", "Open"))
+			.IsEnabled_Lambda([RowEntry]() { return RowEntry->Status != EBatchMergeStatus::Failed; })
+			.OnClicked_Lambda([this]() { OnOpen.ExecuteIfBound(); return FReply::Handled(); });
+	}
+
+private:
+	TSharedPtr<FBatchMergeEntry> Entry;
+	FSimpleDelegate OnOpen;
+};
+
+void SBatchMergeView::Construct(const FArguments& InArgs)
+{
+	FToolBarBuilder ToolBarBuilder(nullptr, FMultiBoxCustomization::None);
+
+	ToolBarBuilder.AddToolBarButton(
+		FUIAction(FExecuteAction::CreateSP(this, &SBatchMergeView::OnLoadMergeList))
+		, NAME_None
+		, LOCTEXT("LoadMergeListLabel", "Load")
+		, LOCTEXT("LoadMergeListTooltip", "Load and diff all the blueprints in the merge list")
+		, FSlateIcon(FEditorStyle::GetStyleSetName(), "BlueprintMerge.StartMerge")
+	);
+
+	ToolBarBuilder.AddToolBarButton(
+		FUIAction(
+			FExecuteAction::CreateSP(this, &SBatchMergeView::OnMergeWithoutConflicts),
+			FCanExecuteAction::CreateSP(this, &SBatchMergeView::HasEntries))
+		, NAME_None
+		, LOCTEXT("MergeWithoutConflictsLabel", "Merge")
+		, LOCTEXT("MergeWithoutConflictsTooltip", "Merge and save all the blueprints without conflicts")
+		, FSlateIcon(FEditorStyle::GetStyleSetName(), "BlueprintMerge.Finish")
+	);
+
+	ChildSlot
+	[
+		SNew(SVerticalBox)
+		+ SVerticalBox::Slot().AutoHeight().Padding(1.0f)
+		[
+			SNew(SHorizontalBox)
+			+ SHorizontalBox::Slot()
+			.AutoWidth()
+			[
+				ToolBarBuilder.MakeWidget()
+			]
+			+ SHorizontalBox::Slot()
+			.VAlign(VAlign_Center)
+			.Padding(4.0f, 0.0f)
+			[
+				SAssignNew(MergeListPathWidget, SEditableTextBox)
+				.HintText(LOCTEXT("MergeListPathHint", "Path to a merge list, with a Remote;Base;Local;Target line per blueprint"))
+			]
+		]
+		+ SVerticalBox::Slot().Padding(1.0f)
+		[
+			SNew(SBorder).BorderImage(FEditorStyle::GetBrush("ToolPanel.GroupBorder"))
+			[
+				SAssignNew(ListWidget, SListView<TSharedPtr<FBatchMergeEntry>>)
+				.ItemHeight(20)
+				.ListItemsSource(&Entries)
+				.SelectionMode(ESelectionMode::Single)
+				.OnGenerateRow(this, &SBatchMergeView::OnGenerateRow)
+				.HeaderRow
+				(
+					SNew(SHeaderRow)
+					+ SHeaderRow::Column(BatchColumnTarget).DefaultLabel(LOCTEXT("ColumnTarget", "Target")).FillWidth(0.6f)
+					+ SHeaderRow::Column(BatchColumnChanges).DefaultLabel(LOCTEXT("ColumnChanges", "Changes")).FillWidth(0.1f)
+					+ SHeaderRow::Column(BatchColumnConflicts).DefaultLabel(LOCTEXT("ColumnConflicts", "Conflicts")).FillWidth(0.1f)
+					+ SHeaderRow::Column(BatchColumnStatus).DefaultLabel(LOCTEXT("ColumnStatus", "Status")).FillWidth(0.15f)
+					+ SHeaderRow::Column(BatchColumnOpen).DefaultLabel(FText::GetEmpty()).FixedWidth(60.0f)
+				)
+			]
+		]
+		+ SVerticalBox::Slot().AutoHeight()
+		[
+			SAssignNew(StatusWidget, STextBlock)
+			.Justification(ETextJustify::Right)
+			.Text(this, &SBatchMergeView::GetStatusText)
+		]
+	];
+}
+
+void SBatchMergeView::OnLoadMergeList()
+{
+	const FString MergeListPath = MergeListPathWidget->GetText().ToString();
+
+	FString MergeList;
+	TArray<TSharedPtr<FBatchMergeEntry>> NewEntries;
+	FString Error;
+
+	if (!FFileHelper::LoadFileToString(MergeList, *MergeListPath))
+	{
+		Error = FString::Printf(TEXT("Failed to read merge list '%s'"), *MergeListPath);
+	}
+	else
+	{
+		BatchMergeHelper::ParseMergeList(MergeList, NewEntries, Error);
+	}
+
+	if (!Error.IsEmpty())
+	{
+		LoadErrorText = FText::FromString(Error);
+		Batch.Reset();
+		Entries.Empty();
+		ListWidget->RequestListRefresh();
+		return;
+	}
+
+	Batch = MakeShareable(new BatchMergeHelper(NewEntries));
+
+	{
+		FScopedSlowTask SlowTask(2, LOCTEXT("DiffingBlueprints", "Diffing blueprints..."));
+		SlowTask.MakeDialog();
+
+		SlowTask.EnterProgressFrame();
+		Batch->LoadAll();
+
+		SlowTask.EnterProgressFrame();
+		Batch->DiffAll();
+	}
+
+	Entries = Batch->Entries;
+	ListWidget->RequestListRefresh();
+}
+
+void SBatchMergeView::OnMergeWithoutConflicts()
+{
+	if (!Batch) return;
+
+	Batch->MergeAll(true, true);
+}
+
+void SBatchMergeView::OnOpenEntry(TSharedPtr<FBatchMergeEntry> Entry)
+{
+	if (!Entry || Entry->Status == EBatchMergeStatus::Failed) return;
+
+	const FText Title = FText::Format(LOCTEXT("MergeWindowTitle", "Merge Assist - {0}"), FText::FromString(Entry->TargetPath));
+
+	// Open the merge UI with the precomputed diffs, these are consumed by the merge
+	// so opening the same entry again will diff the blueprints again
+	const TSharedRef<SBlueprintMergeAssist> MergeAssist = SNew(SBlueprintMergeAssist, Entry->Data)
+		.PrecomputedDiffs(Entry->Diffs);
+
+	TSharedRef<SWindow> Window = SNew(SWindow)
+		.Title(Title)
+		.ClientSize(FVector2D(1600.0f, 900.0f))
+		[
+			MergeAssist
+		];
+
+	Entry->Diffs.Reset();
+
+	// The merge is saved when its window is closed, so it can be resumed
+	const TWeakPtr<SBlueprintMergeAssist> WeakMergeAssist = MergeAssist;
+	Window->SetOnWindowClosed(FOnWindowClosed::CreateLambda([WeakMergeAssist](const TSharedRef<SWindow>&)
+	{
+		if (const TSharedPtr<SBlueprintMergeAssist> Closed = WeakMergeAssist.Pin()) Closed->OnClosed();
+	}));
+
+	FSlateApplication::Get().AddWindow(Window);
+}
+
+bool SBatchMergeView::HasEntries() const
+{
+	return Entries.Num() != 0;
+}
+
+FText SBatchMergeView::GetStatusText() const
+{
+	if (!Batch) return LoadErrorText;
+
+	return FText::Format(LOCTEXT("BatchStatus", "{0} auto merged, {1} ready to merge, {2} need attention, {3} failed"),
+		Batch->NumWithStatus(EBatchMergeStatus::AutoMerged),
+		Batch->NumWithStatus(EBatchMergeStatus::Diffed),
+		Batch->NumWithStatus(EBatchMergeStatus::NeedsAttention),
+		Batch->NumWithStatus(EBatchMergeStatus::Failed));
+}
+
+TSharedRef<ITableRow> SBatchMergeView::OnGenerateRow(TSharedPtr<FBatchMergeEntry> Entry, const TSharedRef<STableViewBase>& OwnerTable)
+{
+	return SNew(SBatchMergeEntryRow, OwnerTable, Entry)
+		.OnOpen(FSimpleDelegate::CreateSP(this, &SBatchMergeView::OnOpenEntry, Entry));
+}
+
+#undef LOCTEXT_NAMESPACE
+
+END_SLATE_FUNCTION_BUILD_OPTIMIZATION
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SCompoundWidget.h"
+#include "DeclarativeSyntaxSupport.h"
+#include "SListView.h"
+
+struct FBatchMergeEntry;
+class BatchMergeHelper;
+class SEditableTextBox;
+class STextBlock;
+
+/**
+ * Merges a list of blueprints at once, shows which of the blueprints could be
+ * merged automatically, and which need to be merged through the merge assist UI
+ */
+class SBatchMergeView : public SCompoundWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SBatchMergeView)
+	{}
+	SLATE_END_ARGS()
+
+	/** Constructs this widget with InArgs */
+	void Construct(const FArguments& InArgs);
+
+private:
+	/** UI Callbacks */
+	void OnLoadMergeList();
+	void OnMergeWithoutConflicts();
+	void OnOpenEntry(TSharedPtr<FBatchMergeEntry> Entry);
+
+	bool HasEntries() const;
+	FText GetStatusText() const;
+
+	TSharedRef<ITableRow> OnGenerateRow(TSharedPtr<FBatchMergeEntry> Entry, const TSharedRef<STableViewBase>& OwnerTable);
+
+	TSharedPtr<BatchMergeHelper> Batch;
+	TArray<TSharedPtr<FBatchMergeEntry>> Entries;
+	FText LoadErrorText;
+
+	TSharedPtr<SEditableTextBox> MergeListPathWidget;
+	TSharedPtr<SListView<TSharedPtr<FBatchMergeEntry>>> ListWidget;
+	TSharedPtr<STextBlock> StatusWidget;
+};
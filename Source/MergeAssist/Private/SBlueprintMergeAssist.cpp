@@ -1,6 +1,7 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "SBlueprintMergeAssist.h"
+#include "MergeAssist.h"
 #include "SlateOptMacros.h"
 
 //#include "EditorStyle.h"
@@ -13,6 +14,11 @@
 #include "BlueprintMergeData.h"
 #include "SMergeGraphView.h"
 #include "SMergeTreeView.h"
+#include "BlueprintMergeHelper.h"
+#include "MergeAssistStats.h"
+#include "MergeSession.h"
+
+#include "HAL/FileManager.h"
 
 BEGIN_SLATE_FUNCTION_BUILD_OPTIMIZATION
 
@@ -21,6 +27,10 @@ BEGIN_SLATE_FUNCTION_BUILD_OPTIMIZATION
 void SBlueprintMergeAssist::Construct(const FArguments& InArgs, const FBlueprintMergeData& InData)
 {
 	Data = InData;
+	PrecomputedDiffs = InArgs._PrecomputedDiffs;
+
+	// Diffs can only be precomputed for blueprints which are already selected
+	if (PrecomputedDiffs) bIsPickingAssets = false;
 
 	FToolBarBuilder ToolBarBuilder(nullptr, FMultiBoxCustomization::None);
 
@@ -96,6 +106,16 @@ void SBlueprintMergeAssist::Construct(const FArguments& InArgs, const FBlueprint
 		FSlateIcon(FEditorStyle::GetStyleSetName(), "BlueprintMerge.AcceptTarget")
 	);
 
+	ToolBarBuilder.AddToolBarButton(
+		FUIAction(
+			FExecuteAction::CreateRaw(this, &SBlueprintMergeAssist::OnToolbarAutoResolve),
+			FCanExecuteAction::CreateRaw(this, &SBlueprintMergeAssist::IsActivelyMerging))
+		, NAME_None
+		, LOCTEXT("ToolbarAutoResolveLabel", "Auto Resolve")
+		, LOCTEXT("ToolbarAutoResolveTooltip", "Pick a version for all changes which match the auto resolve rules in Project Settings -> Plugins -> Merge Assist"),
+		FSlateIcon(FEditorStyle::GetStyleSetName(), "BlueprintMerge.AcceptTarget")
+	);
+
 	// Buttons for starting and finishing the merge
 	ToolBarBuilder.AddSeparator();
 	ToolBarBuilder.AddToolBarButton(
@@ -167,9 +187,13 @@ void SBlueprintMergeAssist::Construct(const FArguments& InArgs, const FBlueprint
 		+SVerticalBox::Slot().AutoHeight()
 		[
 			SAssignNew(StatusWidget, STextBlock).Justification(ETextJustify::Right)
+			.Text(this, &SBlueprintMergeAssist::GetStatusText)
 		]
 	];
 
+	// Setup the asset picker, this is also shown after a merge started with preselected assets is finished
+	AssetPickerControl = SNew(SMergeAssetPickerView, InData).OnAssetChanged(this, &SBlueprintMergeAssist::OnMergeAssetSelected);
+
 	if (IsActivelyMerging())
 	{
 		OnStartMerge();
@@ -177,15 +201,17 @@ void SBlueprintMergeAssist::Construct(const FArguments& InArgs, const FBlueprint
 	else
 	{
 		bIsPickingAssets = true;
-
-		// Setup the asset picker
-		AssetPickerControl = SNew(SMergeAssetPickerView, InData).OnAssetChanged(this, &SBlueprintMergeAssist::OnMergeAssetSelected);
 	}
 
 	// Change the mode to initialize the UI to the state for the current mode
 	OnModeChanged();
 }
 
+void SBlueprintMergeAssist::OnClosed()
+{
+	if (IsActivelyMerging()) SaveSession();
+}
+
 void SBlueprintMergeAssist::OnToolbarNext()
 {
 	if (MergeTreeWidget) MergeTreeWidget->OnToolBarNext();
@@ -221,6 +247,18 @@ void SBlueprintMergeAssist::OnToolbarRevert()
 	if (MergeTreeWidget) MergeTreeWidget->OnToolbarRevert();
 }
 
+void SBlueprintMergeAssist::OnToolbarAutoResolve()
+{
+	const TSharedPtr<BlueprintMergeHelper> MergeHelper = GraphViewWidget.IsValid() ? GraphViewWidget->GetMergeHelper() : TSharedPtr<BlueprintMergeHelper>();
+	if (!MergeHelper.IsValid()) return;
+
+	// The rules are applied to every graph, including those which are still being diffed
+	GraphViewWidget->FlushPendingDiffs();
+
+	const int32 NumResolved = MergeHelper->ApplyAutoResolveRules();
+	UE_LOG(LogMergeAssist, Display, TEXT("Auto resolved %d changes"), NumResolved);
+}
+
 void SBlueprintMergeAssist::OnToolbarFinishMerge()
 {
 	
@@ -231,6 +269,18 @@ bool SBlueprintMergeAssist::IsSelectingAssets() const
 	return bIsPickingAssets;
 }
 
+FText SBlueprintMergeAssist::GetStatusText() const
+{
+	if (bIsPickingAssets) return FText::GetEmpty();
+
+	const TSharedPtr<BlueprintMergeHelper> MergeHelper = GraphViewWidget.IsValid() ? GraphViewWidget->GetMergeHelper() : TSharedPtr<BlueprintMergeHelper>();
+	if (!MergeHelper.IsValid()) return FText::FromString(FMergeAssistStats::GetSummary());
+
+	const FMergeConflictCounts Counts = MergeHelper->GetConflictCounts();
+	return FText::FromString(FString::Printf(TEXT("%d of %d conflict groups unresolved, %d conflicts | %s"),
+		Counts.NumUnresolvedGroups, Counts.NumGroups, Counts.NumConflicts, *FMergeAssistStats::GetSummary()));
+}
+
 void SBlueprintMergeAssist::OnStartMerge()
 {
 	// Load the correct versions of the blueprint assets
@@ -256,8 +306,31 @@ void SBlueprintMergeAssist::OnStartMerge()
 
 	// @TODO: Create a backup (and cancel functionality in case the user does not merge into a target BP)
 
+	// Precomputed diffs were timed when they were generated, so only reset the timings when diffing here
+	if (!PrecomputedDiffs) FMergeAssistStats::Reset();
+
+	// A merge which was closed before it was finished is resumed from its session. Unless the diffs were
+	// precomputed, the saved diffs are used for the graphs which did not change since the session was saved
+	FMergeSession Session;
+	const bool bResumeSession = FMergeSession::Load(FMergeSession::GetSessionFilename(Data), Session) && Session.IsSessionFor(Data);
+
+	int32 NumReusedGraphs = 0;
+	if (bResumeSession && !PrecomputedDiffs) PrecomputedDiffs = Session.GenerateDiffs(Data, &NumReusedGraphs);
+
 	MergeTreeWidget = SNew(SMergeTreeView);
-	GraphViewWidget = SNew(SMergeGraphView, Data, MergeTreeWidget);
+	GraphViewWidget = SNew(SMergeGraphView, Data, MergeTreeWidget).PrecomputedDiffs(PrecomputedDiffs);
+
+	// The precomputed diffs are consumed by the graph view
+	PrecomputedDiffs.Reset();
+
+	if (bResumeSession)
+	{
+		const TSharedPtr<BlueprintMergeHelper> MergeHelper = GraphViewWidget->GetMergeHelper();
+		const int32 NumRestored = Session.Restore(*MergeHelper);
+
+		UE_LOG(LogMergeAssist, Display, TEXT("Resumed merge session, reused the diffs of %d of %d graphs and restored %d changes"),
+			NumReusedGraphs, MergeHelper->GraphNames.Num(), NumRestored);
+	}
 
 	bIsPickingAssets = false;
 	OnModeChanged();
@@ -267,6 +340,7 @@ void SBlueprintMergeAssist::OnFinishMerge()
 {
 	// For now finishing the merge just closes the UI
 	// Later this will save all changes to the target
+	DeleteSession();
 	bIsPickingAssets = true;
 	OnModeChanged();
 
@@ -276,10 +350,31 @@ void SBlueprintMergeAssist::OnCancelMerge()
 {
 	// For now canceling the merge just closes the UI
 	// Later this will revert all changes to the target
+	DeleteSession();
 	bIsPickingAssets = true;
 	OnModeChanged();
 }
 
+void SBlueprintMergeAssist::SaveSession()
+{
+	const TSharedPtr<BlueprintMergeHelper> MergeHelper = GraphViewWidget.IsValid() ? GraphViewWidget->GetMergeHelper() : TSharedPtr<BlueprintMergeHelper>();
+	if (!MergeHelper.IsValid()) return;
+
+	// Graphs which are still being diffed would be left out of the session
+	GraphViewWidget->FlushPendingDiffs();
+
+	const FString Filename = FMergeSession::GetSessionFilename(Data);
+	if (!FMergeSession::Capture(*MergeHelper).Save(Filename))
+	{
+		UE_LOG(LogMergeAssist, Warning, TEXT("Failed to save the merge session to '%s'"), *Filename);
+	}
+}
+
+void SBlueprintMergeAssist::DeleteSession()
+{
+	IFileManager::Get().Delete(*FMergeSession::GetSessionFilename(Data), false, true, true);
+}
+
 void SBlueprintMergeAssist::OnMergeAssetSelected(EMergeAssetId::Type AssetId, const FAssetRevisionInfo& AssetInfo)
 {
 	switch (AssetId)
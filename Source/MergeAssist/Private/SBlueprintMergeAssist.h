@@ -11,6 +11,7 @@
 #include "Unreal/MergeUtils.h"
 
 struct FAssetRevisionInfo;
+struct FBlueprintMergeDiffs;
 
 /**
  * 
@@ -20,14 +21,23 @@ class SBlueprintMergeAssist : public SCompoundWidget
 public:
 	SLATE_BEGIN_ARGS(SBlueprintMergeAssist)
 	{}
+		/** Diffs generated ahead of time, when set the merge is started immediately */
+		SLATE_ARGUMENT(TSharedPtr<FBlueprintMergeDiffs>, PrecomputedDiffs)
 	SLATE_END_ARGS()
 
 	/** Constructs this widget with InArgs */
 	void Construct(const FArguments& InArgs, const FBlueprintMergeData& InData);
 
+	/**
+	 * Saves the merge session when the merge was not finished, so it can be resumed. Called by the tab or window
+	 * hosting the merge when it is closed, while the merge helpers and the blueprints are still alive
+	 */
+	void OnClosed();
+
 private:
 	bool bIsPickingAssets = true; 
 	FBlueprintMergeData Data;
+	TSharedPtr<FBlueprintMergeDiffs> PrecomputedDiffs;
 
 	/** UI Callbacks */
 	void OnToolbarNext();
@@ -38,15 +48,21 @@ private:
 	void OnToolbarApplyRemote();
 	void OnToolbarApplyLocal();
 	void OnToolbarRevert();
+	void OnToolbarAutoResolve();
 
 	void OnToolbarFinishMerge();
 
 	bool IsSelectingAssets() const;
+	FText GetStatusText() const;
 
 	void OnStartMerge();
 	void OnFinishMerge();
 	void OnCancelMerge();
 
+	/** Merge sessions store the versions picked so far, see FMergeSession */
+	void SaveSession();
+	void DeleteSession();
+
 	/** Asset picker */
 	void OnMergeAssetSelected(EMergeAssetId::Type AssetId, const FAssetRevisionInfo& AssetInfo);
 	bool IsActivelyMerging() const;
@@ -11,7 +11,11 @@
 #include "BlueprintEditor.h"
 #include "BlueprintEditorUtils.h"
 #include "GraphMergeHelper.h"
+#include "BlueprintMergeHelper.h"
 #include "SMergeTreeView.h"
+#include "MergeAssistStats.h"
+#include "MergeAssistSettings.h"
+#include "TimeSlicedMergeDiff.h"
 
 BEGIN_SLATE_FUNCTION_BUILD_OPTIMIZATION
 
@@ -19,6 +23,12 @@ BEGIN_SLATE_FUNCTION_BUILD_OPTIMIZATION
 
 static const FName MergeGraphTabId = FName(TEXT("MergeGraphTab"));
 
+// Number of target graph editors that are kept alive when switching between graphs
+static const int32 MaxCachedTargetGraphEditors = 4;
+
+// Total number of nodes in the cached diff panels, before the least recently used panels are evicted
+static const int32 MaxCachedDiffPanelNodes = 20000;
+
 struct ChangeTreeEntryGraph : IMergeTreeEntry
 {
 	ChangeTreeEntryGraph(
@@ -53,17 +63,54 @@ struct ChangeTreeEntryChange : IMergeTreeEntry
 
 	bool ApplyRemote() override
 	{
-		return MergeHelper->ApplyRemoteChange(*Change);
+		const bool bApplied = MergeHelper->ApplyRemoteChange(*Change);
+		if (bApplied) NotifyStateChanged();
+		return bApplied;
 	}
 
 	bool ApplyLocal() override
 	{
-		return MergeHelper->ApplyLocalChange(*Change);
+		const bool bApplied = MergeHelper->ApplyLocalChange(*Change);
+		if (bApplied) NotifyStateChanged();
+		return bApplied;
 	}
 
 	bool Revert() override
 	{
-		return MergeHelper->RevertChange(*Change);
+		const bool bReverted = MergeHelper->RevertChange(*Change);
+		if (bReverted) NotifyStateChanged();
+		return bReverted;
+	}
+
+	bool HasConflicts() const override
+	{
+		return Change->bHasConflicts;
+	}
+
+	FString GetSearchText() const override
+	{
+		return Change->Label.ToString();
+	}
+
+	EMergeDiffType GetDiffType() const override
+	{
+		return HasRemoteChange() ? Change->RemoteDiff.Type : Change->LocalDiff.Type;
+	}
+
+	bool HasRemoteChange() const override
+	{
+		return Change->RemoteDiff.Type != EMergeDiffType::NO_DIFFERENCE;
+	}
+
+	bool HasLocalChange() const override
+	{
+		return Change->LocalDiff.Type != EMergeDiffType::NO_DIFFERENCE;
+	}
+
+	bool IsResolved() const override
+	{
+		// Changes start out in the base state, until one of the versions is picked
+		return Change->MergeState != EMergeState::Base;
 	}
 
 	SMergeGraphView& GraphView;
@@ -77,19 +124,6 @@ struct FBlueprintRevPair
 	const FRevisionInfo& RevData;
 };
 
-static UEdGraph* FindGraphByName(UBlueprint const& FromBlueprint, const FName& GraphName)
-{
-	TArray<UEdGraph*> Graphs;
-	FromBlueprint.GetAllGraphs(Graphs);
-
-	UEdGraph* Ret = nullptr;
-	if (UEdGraph** Result = Graphs.FindByPredicate(FMatchFName(GraphName)))
-	{
-		Ret = *Result;
-	}
-	return Ret;
-}
-
 TSharedRef<ITableRow> GraphListWidgetGenerateListItems(TSharedPtr<GraphMergeHelper> Item,
 	const TSharedRef<STableViewBase>& OwnerTable)
 {
@@ -135,6 +169,17 @@ void SMergeGraphView::Highlight(MergeGraphChange& Change)
 {
 	// Always clear the old highlight before setting the new one
 	HighlightClear();
+	HighlightChange(Change);
+}
+
+void SMergeGraphView::HighlightChange(MergeGraphChange& Change)
+{
+	// Composite changes highlight all of the nodes and pins they change
+	if (Change.SubChanges.Num())
+	{
+		for (const auto& SubChange : Change.SubChanges) HighlightChange(*SubChange);
+		return;
+	}
 
 	// Highlight the pin if it exists, otherwise highlight the node
 	const auto HighlightPinOrNode = [this](UEdGraphPin* Pin, UEdGraphNode* Node)
@@ -164,6 +209,8 @@ void SMergeGraphView::Highlight(MergeGraphChange& Change)
 	const auto HighlightInTargetGraph = [this](UEdGraphPin* Pin, UEdGraphNode* Node)
 	{
 		// Translate the pin and node to the target graph
+		if (!CurrentTargetGraphEditor) return;
+
 		UEdGraphNode* TargetNode = CurrentGraphMergeHelper->FindNodeInTargetGraph(Pin ? Pin->GetOwningNode() : Node);
 		if (!TargetNode) return;
 
@@ -203,76 +250,24 @@ void SMergeGraphView::HighlightClear()
 	if (CurrentTargetGraphEditor) CurrentTargetGraphEditor->ClearSelectionSet();
 }
 
-void SMergeGraphView::Construct(const FArguments& InArgs, const FBlueprintMergeData& InData, TSharedPtr<SMergeTreeView> MergeTreeWidget)
+void SMergeGraphView::Construct(const FArguments& InArgs, const FBlueprintMergeData& InData, TSharedPtr<SMergeTreeView> InMergeTreeWidget)
 {
 	Data = InData;
+	MergeTreeWidget = InMergeTreeWidget;
 
-	check(Data.BlueprintRemote != nullptr);
-	check(Data.BlueprintBase != nullptr);
-	check(Data.BlueprintLocal != nullptr);
-	check(Data.BlueprintTarget != nullptr);
-
-	// Enumerate all the EVENT graphs in the blueprint
-	// for now we ignore function, delete, and macro graphs
-	// since these could have additional requirements which 
-	// we do not support for now.
-	// !Note: EventGraphs are stored in the UbergraphPages array
-	//        and not in the EventGraphs array.
-	TSet<FName> AllGraphNames;
-	TMap<FName, UEdGraph*> RemoteGraphMap, BaseGraphMap, LocalGraphMap;
-	{
-		const auto RemoteGraphs = Data.BlueprintRemote->UbergraphPages;
-		const auto BaseGraphs =  Data.BlueprintBase->UbergraphPages;
-		const auto LocalGraphs = Data.BlueprintLocal->UbergraphPages;
-
-		const auto Enumerate = [&AllGraphNames](const TArray<UEdGraph*>& GraphsToEnumerate, TMap<FName, UEdGraph*>& OutMap)
-		{
-			for (auto Graph : GraphsToEnumerate)
-			{
-				OutMap.Add(Graph->GetFName(), Graph);
-				AllGraphNames.Add(Graph->GetFName());
-			}
-		};
-
-		Enumerate(RemoteGraphs, RemoteGraphMap);
-		Enumerate(BaseGraphs, BaseGraphMap);
-		Enumerate(LocalGraphs, LocalGraphMap);
-	}
-
-	// Create editors for each of the graphs
-	for (auto GraphName : AllGraphNames)
-	{
-		UEdGraph* TargetGraph = FindGraphByName(*Data.BlueprintTarget, GraphName);
-
-		if (!TargetGraph)
-		{
-			// Create an event graph with the GraphName in case we could not find one with the matching name
-			//FName DocumentName = FBlueprintEditorUtils::FindUniqueKismetName(Data.BlueprintTarget, GraphName.ToString());
-			TargetGraph = FBlueprintEditorUtils::CreateNewGraph(Data.BlueprintTarget, GraphName, UEdGraph::StaticClass(), UEdGraphSchema_K2::StaticClass());
-			FBlueprintEditorUtils::AddUbergraphPage(Data.BlueprintTarget, TargetGraph);
-		}
+	// Diffing huge graphs can take a while, so unless the diffs are already known they are
+	// generated over multiple frames. The graphs start out without changes until then
+	const UMergeAssistSettings& Settings = *GetDefault<UMergeAssistSettings>();
+	const bool bTimeSliceDiffing = Settings.bTimeSliceDiffing && !InArgs._PrecomputedDiffs.IsValid();
 
-		// We found the target graph, or successfully made one
-		if (TargetGraph)
-		{
-			const TSharedPtr<SGraphEditor> Editor = SNew(SGraphEditor)
-					.GraphToEdit(TargetGraph)
-					.IsEditable(true);
+	// Create the merge helpers for all the graphs in the blueprint
+	MergeHelper = MakeShareable(new BlueprintMergeHelper(Data, InArgs._PrecomputedDiffs, bTimeSliceDiffing));
 
-			TargetGraphEditorMap.Add(TargetGraph, Editor);
-		}
-	}
+	// The target graph editors are created on demand by FocusGraph
+	TargetGraphEditorCache.Empty(MaxCachedTargetGraphEditors);
 
-	// Create merge helpers for each of the graphs
-	for (auto GraphName : AllGraphNames)
-	{
-		GraphMergeHelpers.Push(TSharedPtr<GraphMergeHelper>(new GraphMergeHelper(
-			FindGraphByName(*Data.BlueprintRemote, GraphName),
-			FindGraphByName(*Data.BlueprintBase, GraphName),
-			FindGraphByName(*Data.BlueprintLocal, GraphName),
-			FindGraphByName(*Data.BlueprintTarget, GraphName)
-		)));
-	}
+	// The diff panels are evicted by the number of nodes they show, so the cache can hold the panels of every graph
+	DiffPanelCache.Empty(FMath::Max(MergeHelper->GraphNames.Num(), 1));
 
 	// Set up a tab view so we can split the content into different views
 	const TSharedRef<SDockTab> MajorTab = SNew(SDockTab).TabRole(ETabRole::MajorTab);
@@ -307,12 +302,8 @@ void SMergeGraphView::Construct(const FArguments& InArgs, const FBlueprintMergeD
 	}
 
 	// Setup a placeholder for the target graph editor
-	TargetGraphEditorContainer = SNew(SBox)[
-		SNew(SBorder).HAlign(HAlign_Center).VAlign(VAlign_Center)
-		[
-			SNew(STextBlock).Text(FText::FromString("Graph does not exist in target blueprint"))
-		]
-	];
+	TargetGraphEditorContainer = SNew(SBox);
+	SetTargetGraphPlaceholder(LOCTEXT("TargetGraphMissing", "Graph does not exist in target blueprint"));
 
 	const auto GraphTab = TabManager->RestoreFrom(DefaultLayout, nullptr).ToSharedRef();
 
@@ -325,7 +316,7 @@ void SMergeGraphView::Construct(const FArguments& InArgs, const FBlueprintMergeD
 
 	// Focus the first graph in the list by default, 
 	// this is to ensure that all UI elements are initialized
-	FocusGraph(AllGraphNames.Array()[0]);
+	FocusGraph(MergeHelper->GraphNames[0]);
 
 	// We get one tab container with the different tabs, and within this we add the splitter
 	// The reason for this is so we could potentially create a fullscreen target tab
@@ -338,17 +329,95 @@ void SMergeGraphView::Construct(const FArguments& InArgs, const FBlueprintMergeD
 		]
 	];
 
+	if (bTimeSliceDiffing)
+	{
+		TimeSlicedDiff = MakeShareable(new FTimeSlicedMergeDiff(Data, Settings.DiffFrameBudgetMilliseconds));
+		TimeSlicedDiff->OnGraphDiffsGenerated.BindSP(this, &SMergeGraphView::OnGraphDiffsGenerated);
+		return;
+	}
+
 	// Add all of our changes to the merge tree
-	for (auto GraphHelper : GraphMergeHelpers)
+	for (auto GraphHelper : MergeHelper->GraphMergeHelpers)
+	{
+		AddToMergeTree(GraphHelper);
+	}
+}
+
+void SMergeGraphView::AddToMergeTree(TSharedPtr<GraphMergeHelper> GraphHelper)
+{
+	auto GraphEntry = MakeShared<ChangeTreeEntryGraph>(*this, GraphHelper);
+
+	for (auto Change : GraphHelper->ChangeList)
+	{
+		GraphEntry->Children.Add(MakeShared<ChangeTreeEntryChange>(*this, GraphHelper, Change));
+	}
+
+	MergeTreeWidget->Add(GraphEntry);
+
+	// The entry is captured weakly, since it keeps the helper alive itself
+	GraphHelper->OnChangeListUpdated.AddSP(this, &SMergeGraphView::OnChangeListUpdated,
+		TWeakPtr<IMergeTreeEntry>(GraphEntry), TWeakPtr<GraphMergeHelper>(GraphHelper));
+}
+
+void SMergeGraphView::OnChangeListUpdated(TWeakPtr<IMergeTreeEntry> WeakGraphEntry, TWeakPtr<GraphMergeHelper> WeakGraphHelper)
+{
+	TSharedPtr<IMergeTreeEntry> GraphEntry = WeakGraphEntry.Pin();
+	TSharedPtr<GraphMergeHelper> GraphHelper = WeakGraphHelper.Pin();
+	if (!GraphEntry || !GraphHelper) return;
+
+	// Changes which still exist keep their entry, so they stay selected
+	TMap<MergeGraphChange*, TSharedPtr<IMergeTreeEntry>> ChangeEntries;
+	for (const auto& Child : GraphEntry->Children)
 	{
-		auto GraphEntry = MakeShared<ChangeTreeEntryGraph>(*this, GraphHelper);
+		ChangeEntries.Add(StaticCastSharedPtr<ChangeTreeEntryChange>(Child)->Change.Get(), Child);
+	}
 
-		for (auto Change : GraphHelper->ChangeList)
+	GraphEntry->Children.Reset();
+	for (auto Change : GraphHelper->ChangeList)
+	{
+		if (const TSharedPtr<IMergeTreeEntry>* Entry = ChangeEntries.Find(Change.Get()))
+		{
+			GraphEntry->Children.Add(*Entry);
+		}
+		else
 		{
 			GraphEntry->Children.Add(MakeShared<ChangeTreeEntryChange>(*this, GraphHelper, Change));
 		}
+	}
+
+	MergeTreeWidget->Refresh(GraphEntry);
+
+	// The diff panels highlight the diffs they were generated with, so they are generated again
+	if (const FCachedDiffPanels* Cached = DiffPanelCache.Find(GraphHelper->GraphName))
+	{
+		NumCachedDiffPanelNodes -= Cached->NumNodes;
+		DiffPanelCache.Remove(GraphHelper->GraphName);
+	}
+
+	if (CurrentGraphMergeHelper == GraphHelper)
+	{
+		CurrentGraphMergeHelper = nullptr;
+		FocusGraph(GraphHelper->GraphName);
+	}
+}
+
+void SMergeGraphView::FlushPendingDiffs()
+{
+	if (TimeSlicedDiff.IsValid() && !TimeSlicedDiff->IsDone()) TimeSlicedDiff->Flush();
+}
 
-		MergeTreeWidget->Add(GraphEntry);
+void SMergeGraphView::OnGraphDiffsGenerated(FName GraphName, FGraphMergeDiffs& Diffs)
+{
+	TSharedPtr<GraphMergeHelper> GraphHelper = MergeHelper->SetGraphDiffs(GraphName, MoveTemp(Diffs));
+	if (!GraphHelper) return;
+
+	AddToMergeTree(GraphHelper);
+
+	// The focused graph was showing it is being diffed, so focus it again to show its changes
+	if (CurrentGraphMergeHelper == GraphHelper)
+	{
+		CurrentGraphMergeHelper = nullptr;
+		FocusGraph(GraphName);
 	}
 }
 
@@ -357,43 +426,125 @@ void SMergeGraphView::FocusGraph(FName GraphName)
 	// Only change if we focus a different graph
 	if (CurrentGraphMergeHelper && CurrentGraphMergeHelper->GraphName == GraphName) return;
 
+	MERGEASSIST_SCOPE(FocusGraph, FocusGraph);
+
 	// Setup the diff panels for the source graphs
-	UEdGraph* RemoteGraph = FindGraphByName(*DiffPanels[0].Blueprint, GraphName);
-	UEdGraph* BaseGraph = FindGraphByName(*DiffPanels[1].Blueprint, GraphName);
-	UEdGraph* LocalGraph = FindGraphByName(*DiffPanels[2].Blueprint, GraphName);
+	UEdGraph* RemoteGraph = MergeHelper->FindRemoteGraph(GraphName);
+	UEdGraph* BaseGraph = MergeHelper->FindBaseGraph(GraphName);
+	UEdGraph* LocalGraph = MergeHelper->FindLocalGraph(GraphName);
+
+	ShowDiffPanels(GraphName, RemoteGraph, BaseGraph, LocalGraph);
+
+	// Update the diff list being shown to the one based on the selected graph
+	CurrentGraphMergeHelper = MergeHelper->FindGraphMergeHelper(GraphName);
 
-	DiffPanels[0].GeneratePanel(RemoteGraph, BaseGraph);
-	DiffPanels[1].GeneratePanel(BaseGraph, nullptr);
-	DiffPanels[2].GeneratePanel(LocalGraph, BaseGraph);
+	// Open the editor for the target graph, graphs without changes are identical
+	// to the base graph, so there is nothing to edit in the target graph
+	UEdGraph* TargetGraph = MergeHelper->FindTargetGraph(GraphName);
+	const bool bHasChanges = CurrentGraphMergeHelper
+		&& (CurrentGraphMergeHelper->HasRemoteChanges() || CurrentGraphMergeHelper->HasLocalChanges());
 
-	// Open the editor for the target graph
-	UEdGraph* TargetGraph = FindGraphByName(*Data.BlueprintTarget, GraphName);
-	TSharedPtr<SGraphEditor>* TargetEditor = TargetGraph ? TargetGraphEditorMap.Find(TargetGraph) : nullptr;
-	if (TargetEditor != nullptr)
+	if (TargetGraph && bHasChanges)
 	{
-		CurrentTargetGraphEditor = *TargetEditor;
-		TargetGraphEditorContainer->SetContent(TargetEditor->ToSharedRef());
+		CurrentTargetGraphEditor = FindOrCreateTargetGraphEditor(TargetGraph);
+		TargetGraphEditorContainer->SetContent(CurrentTargetGraphEditor.ToSharedRef());
 	}
 	else
 	{
 		CurrentTargetGraphEditor = nullptr;
-		TargetGraphEditorContainer->SetContent(
-			SNew(SBorder).HAlign(HAlign_Center).VAlign(VAlign_Center)
-			[
-				SNew(STextBlock).Text(FText::FromString("Graph does not exist in target blueprint"))
-			]
-		);
+		SetTargetGraphPlaceholder(!TargetGraph
+			? LOCTEXT("TargetGraphMissing", "Graph does not exist in target blueprint")
+			: MergeHelper->IsDiffPending(GraphName)
+			? LOCTEXT("TargetGraphDiffing", "Graph is being diffed")
+			: LOCTEXT("TargetGraphUnchanged", "Graph has no changes"));
+	}
+}
+
+void SMergeGraphView::ShowDiffPanels(FName GraphName, UEdGraph* RemoteGraph, UEdGraph* BaseGraph, UEdGraph* LocalGraph)
+{
+	// Touching the panels makes them the last to be evicted
+	if (const FCachedDiffPanels* Cached = DiffPanelCache.FindAndTouch(GraphName))
+	{
+		for (int32 i = 0; i < DiffPanels.Num(); ++i)
+		{
+			DiffPanels[i].GraphEditorBorder->SetContent(Cached->Contents[i].ToSharedRef());
+			DiffPanels[i].GraphEditor = Cached->GraphEditors[i];
+		}
+		return;
 	}
 
-	// Update the diff list being shown to the one based on the selected graph
-	for (const auto& MergeHelper : GraphMergeHelpers)
+	UEdGraph* const Graphs[] = { RemoteGraph, BaseGraph, LocalGraph };
+	UEdGraph* const GraphsToDiff[] = { BaseGraph, nullptr, BaseGraph };
+
+	FCachedDiffPanels NewPanels;
+	for (int32 i = 0; i < DiffPanels.Num(); ++i)
+	{
+		FDiffPanel& Panel = DiffPanels[i];
+
+		// Panels without a graph only show a placeholder, make sure they do not keep pointing at
+		// the graph editor of the previous graph, since that editor might still be alive in the cache
+		if (!Graphs[i]) Panel.GraphEditor.Reset();
+
+		Panel.GeneratePanel(Graphs[i], GraphsToDiff[i]);
+
+		NewPanels.Contents[i] = Panel.GraphEditorBorder->GetChildren()->GetChildAt(0);
+		NewPanels.GraphEditors[i] = Panel.GraphEditor.Pin();
+		NewPanels.NumNodes += Graphs[i] ? Graphs[i]->Nodes.Num() : 0;
+	}
+
+	NumCachedDiffPanelNodes += NewPanels.NumNodes;
+	DiffPanelCache.Add(GraphName, NewPanels);
+
+	if (NumCachedDiffPanelNodes <= MaxCachedDiffPanelNodes) return;
+
+	// Keep the most recently used panels which fit in the budget, always including the ones we are about to show.
+	// The keys are ordered from the most to the least recently used
+	TArray<FName> CachedGraphNames;
+	DiffPanelCache.GetKeys(CachedGraphNames);
+
+	int32 NumKeptNodes = 0;
+	bool bIsOverBudget = false;
+	for (const FName CachedGraphName : CachedGraphNames)
 	{
-		if (MergeHelper->GraphName == GraphName)
+		const int32 NumNodes = DiffPanelCache.Find(CachedGraphName)->NumNodes;
+
+		// Once a panel does not fit, it is evicted together with all less recently used panels
+		bIsOverBudget |= CachedGraphName != GraphName && NumKeptNodes + NumNodes > MaxCachedDiffPanelNodes;
+		if (!bIsOverBudget)
 		{
-			CurrentGraphMergeHelper = MergeHelper;
-			break;
+			NumKeptNodes += NumNodes;
+			continue;
 		}
+
+		DiffPanelCache.Remove(CachedGraphName);
+		NumCachedDiffPanelNodes -= NumNodes;
+	}
+}
+
+TSharedRef<SGraphEditor> SMergeGraphView::FindOrCreateTargetGraphEditor(UEdGraph* TargetGraph)
+{
+	if (TSharedPtr<SGraphEditor>* Editor = TargetGraphEditorCache.FindAndTouch(TargetGraph))
+	{
+		return Editor->ToSharedRef();
 	}
+
+	// Adding the editor evicts the least recently used editor once the cache is full
+	const TSharedRef<SGraphEditor> Editor = SNew(SGraphEditor)
+		.GraphToEdit(TargetGraph)
+		.IsEditable(true);
+
+	TargetGraphEditorCache.Add(TargetGraph, Editor);
+	return Editor;
+}
+
+void SMergeGraphView::SetTargetGraphPlaceholder(const FText& Message)
+{
+	TargetGraphEditorContainer->SetContent(
+		SNew(SBorder).HAlign(HAlign_Center).VAlign(VAlign_Center)
+		[
+			SNew(STextBlock).Text(Message)
+		]
+	);
 }
 
 TSharedRef<SDockTab> SMergeGraphView::CreateMergeGraphTab(const FSpawnTabArgs& Args)
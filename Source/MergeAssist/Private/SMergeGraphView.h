@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Widgets/SCompoundWidget.h"
 #include "DeclarativeSyntaxSupport.h"
+#include "Containers/LruCache.h"
 #include "BlueprintMergeData.h"
 #include "SBlueprintDiff.h"
 
@@ -14,13 +15,20 @@ class FTabManager;
 enum struct EMergeState;
 struct MergeGraphChange;
 class GraphMergeHelper;
+class BlueprintMergeHelper;
+struct FBlueprintMergeDiffs;
 class SMergeTreeView;
+struct IMergeTreeEntry;
+class FTimeSlicedMergeDiff;
+struct FGraphMergeDiffs;
 
 class SMergeGraphView : public SCompoundWidget
 {
 public:
 	SLATE_BEGIN_ARGS(SMergeGraphView)
 	{}
+		/** Diffs to use instead of diffing the blueprints when constructing the view */
+		SLATE_ARGUMENT(TSharedPtr<FBlueprintMergeDiffs>, PrecomputedDiffs)
 	SLATE_END_ARGS()
 
 	/** Constructs this widget with InArgs */
@@ -31,18 +39,54 @@ public:
 	void Highlight(MergeGraphChange& Change);
 	void HighlightClear();
 
+	TSharedPtr<BlueprintMergeHelper> GetMergeHelper() const { return MergeHelper; }
+
+	// Diffs the graphs which are still being diffed over multiple frames right away, this has
+	// to be done before any action which needs the changes of every graph
+	void FlushPendingDiffs();
+
 private:
 	FBlueprintMergeData Data;
 
 	TSharedPtr<FTabManager> TabManager;
 	TSharedRef<SDockTab> CreateMergeGraphTab(const FSpawnTabArgs& Args);
 
-	TArray<TSharedPtr<GraphMergeHelper>> GraphMergeHelpers;
+	void HighlightChange(MergeGraphChange& Change);
+
+	void AddToMergeTree(TSharedPtr<GraphMergeHelper> GraphHelper);
+	void OnGraphDiffsGenerated(FName GraphName, FGraphMergeDiffs& Diffs);
+	void OnChangeListUpdated(TWeakPtr<IMergeTreeEntry> WeakGraphEntry, TWeakPtr<GraphMergeHelper> WeakGraphHelper);
+
+	void ShowDiffPanels(FName GraphName, UEdGraph* RemoteGraph, UEdGraph* BaseGraph, UEdGraph* LocalGraph);
+	TSharedRef<SGraphEditor> FindOrCreateTargetGraphEditor(UEdGraph* TargetGraph);
+	void SetTargetGraphPlaceholder(const FText& Message);
+
+	TSharedPtr<BlueprintMergeHelper> MergeHelper;
 	TSharedPtr<GraphMergeHelper> CurrentGraphMergeHelper;
+	TSharedPtr<SMergeTreeView> MergeTreeWidget;
+
+	// Diffs the graphs over multiple frames, the graphs are added to the merge tree as their diffs complete
+	TSharedPtr<FTimeSlicedMergeDiff> TimeSlicedDiff;
 
-	TMap<UEdGraph*, TSharedPtr<SGraphEditor>> TargetGraphEditorMap;
+	// Editors for the target graphs are created when a graph is first focused, only
+	// the most recently used ones are kept alive since each of them creates widgets
+	// for all the nodes in the graph
+	TLruCache<UEdGraph*, TSharedPtr<SGraphEditor>> TargetGraphEditorCache;
 	TSharedPtr<SBox> TargetGraphEditorContainer;
 	TSharedPtr<SGraphEditor> CurrentTargetGraphEditor;
 
 	TArray<FDiffPanel> DiffPanels;
+
+	// Generated contents of the remote, base and local diff panels for a graph
+	struct FCachedDiffPanels
+	{
+		TSharedPtr<SWidget> Contents[3];
+		TSharedPtr<SGraphEditor> GraphEditors[3];
+		int32 NumNodes = 0;
+	};
+
+	// Diff panels of recently focused graphs, the least recently used panels are evicted
+	// once the cached panels show more than a fixed number of nodes in total
+	TLruCache<FName, FCachedDiffPanels> DiffPanelCache;
+	int32 NumCachedDiffPanelNodes = 0;
 };
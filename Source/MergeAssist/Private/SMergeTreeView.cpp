@@ -3,9 +3,14 @@
 #include "SMergeTreeView.h"
 #include "SlateOptMacros.h"
 #include "EditorStyle.h"
+#include "MultiBoxBuilder.h"
+#include "SSearchBox.h"
+#include "SComboButton.h"
 
 BEGIN_SLATE_FUNCTION_BUILD_OPTIMIZATION
 
+#define LOCTEXT_NAMESPACE "SMergeTreeView"
+
 static TSharedRef<ITableRow> ChangeTreeOnGenerateRow(
 	TSharedPtr<IMergeTreeEntry> Item, 
 	const TSharedRef<STableViewBase>& OwnerTable)
@@ -42,14 +47,63 @@ static void ChangeTreeOnSelectionChanged(TSharedPtr<IMergeTreeEntry> Item,
 static void ChangeTreeOnGetChildren(TSharedPtr<IMergeTreeEntry> Item,
 	TArray<TSharedPtr<IMergeTreeEntry>>& Children)
 {
-	Children = Item->Children;
+	Children = Item->VisibleChildren;
+}
+
+static const int32 NumDiffTypes = static_cast<int32>(EMergeDiffType::GRAPH_CHANGED) + 1;
+
+// Label of the diff type in the filter menu
+static FText GetDiffTypeLabel(EMergeDiffType Type)
+{
+	switch (Type)
+	{
+		case EMergeDiffType::NODE_REMOVED:      return LOCTEXT("DiffTypeNodeRemoved", "Node removed");
+		case EMergeDiffType::NODE_ADDED:        return LOCTEXT("DiffTypeNodeAdded", "Node added");
+		case EMergeDiffType::PIN_REMOVED:       return LOCTEXT("DiffTypePinRemoved", "Pin removed");
+		case EMergeDiffType::PIN_ADDED:         return LOCTEXT("DiffTypePinAdded", "Pin added");
+		case EMergeDiffType::PIN_DEFAULT_VALUE: return LOCTEXT("DiffTypePinDefaultValue", "Pin default value");
+		case EMergeDiffType::LINK_REMOVED:      return LOCTEXT("DiffTypeLinkRemoved", "Link removed");
+		case EMergeDiffType::LINK_ADDED:        return LOCTEXT("DiffTypeLinkAdded", "Link added");
+		case EMergeDiffType::NODE_MOVED:        return LOCTEXT("DiffTypeNodeMoved", "Node moved");
+		case EMergeDiffType::NODE_COMMENT:      return LOCTEXT("DiffTypeNodeComment", "Node comment");
+		case EMergeDiffType::GRAPH_ADDED:       return LOCTEXT("DiffTypeGraphAdded", "Graph added");
+		case EMergeDiffType::GRAPH_REMOVED:     return LOCTEXT("DiffTypeGraphRemoved", "Graph removed");
+		case EMergeDiffType::GRAPH_CHANGED:     return LOCTEXT("DiffTypeGraphChanged", "Graph changed");
+		default:                                return FText::GetEmpty();
+	}
+}
+
+// Combines the bits of Other into Result, a word at a time
+static void AndBits(TBitArray<>& Result, const TBitArray<>& Other)
+{
+	const int32 NumWords = FMath::DivideAndRoundUp(Result.Num(), NumBitsPerDWORD);
+	uint32* ResultWords = Result.GetData();
+	const uint32* OtherWords = Other.GetData();
+
+	for (int32 i = 0; i < NumWords; ++i) ResultWords[i] &= OtherWords[i];
+}
+
+static void OrBits(TBitArray<>& Result, const TBitArray<>& Other)
+{
+	const int32 NumWords = FMath::DivideAndRoundUp(Result.Num(), NumBitsPerDWORD);
+	uint32* ResultWords = Result.GetData();
+	const uint32* OtherWords = Other.GetData();
+
+	for (int32 i = 0; i < NumWords; ++i) ResultWords[i] |= OtherWords[i];
+}
+
+void IMergeTreeEntry::NotifyStateChanged()
+{
+	if (Tree) Tree->OnEntryStateChanged(*this);
 }
 
 void SMergeTreeView::Construct(const FArguments& InArgs)
 {
+	// Only the rows which are scrolled into view are generated, so the tree stays
+	// responsive regardless of the number of changes
 	Widget = SNew(STreeView<TSharedPtr<IMergeTreeEntry>>)
 		.ItemHeight(20)
-		.TreeItemsSource(&Data)
+		.TreeItemsSource(&FilteredData)
 		.SelectionMode(ESelectionMode::Single)
 		.OnGenerateRow_Static(&ChangeTreeOnGenerateRow)
 		.OnSelectionChanged_Static(&ChangeTreeOnSelectionChanged, &SelectedEntry)
@@ -60,33 +114,408 @@ void SMergeTreeView::Construct(const FArguments& InArgs)
 		// Add a darker background behind the tree view, this helps the text stand out more
 		SNew(SBorder).BorderImage(FEditorStyle::GetBrush("ToolPanel.GroupBorder"))
 		[
-			Widget.ToSharedRef()
-		]		
+			SNew(SVerticalBox)
+			+SVerticalBox::Slot().AutoHeight().Padding(0.0f, 0.0f, 0.0f, 2.0f)
+			[
+				SNew(SHorizontalBox)
+				+SHorizontalBox::Slot()
+				[
+					SNew(SSearchBox)
+					.HintText(LOCTEXT("SearchHint", "Search changes"))
+					.OnTextChanged(this, &SMergeTreeView::OnSearchTextChanged)
+				]
+				+SHorizontalBox::Slot().AutoWidth().Padding(2.0f, 0.0f, 0.0f, 0.0f)
+				[
+					SNew(SComboButton)
+					.ComboButtonStyle(FEditorStyle::Get(), "GenericFilters.ComboButtonStyle")
+					.ForegroundColor(FLinearColor::White)
+					.ToolTipText(LOCTEXT("FiltersTooltip", "Filter the changes by their type and state"))
+					.OnGetMenuContent(this, &SMergeTreeView::CreateFilterMenu)
+					.ButtonContent()
+					[
+						SNew(STextBlock).Text(LOCTEXT("Filters", "Filters"))
+					]
+				]
+			]
+			+SVerticalBox::Slot()
+			[
+				Widget.ToSharedRef()
+			]
+		]
 	];
 }
+
 void SMergeTreeView::Add(TSharedPtr<IMergeTreeEntry> TreeEntry)
 {
+	TreeEntry->Tree = this;
+
+	for (const auto& Child : TreeEntry->Children)
+	{
+		Child->Parent = TreeEntry;
+		Child->Tree = this;
+	}
+
 	Data.Add(TreeEntry);
+	bNavigationIndexDirty = true;
+
+	if (IsFiltering())
+	{
+		RefreshFilter();
+	}
+	else
+	{
+		// Without a filter everything is shown, so there is no need to rebuild the index yet
+		TreeEntry->VisibleChildren = TreeEntry->Children;
+		FilteredData.Add(TreeEntry);
+		Widget->RequestTreeRefresh();
+	}
+}
+
+void SMergeTreeView::Refresh(TSharedPtr<IMergeTreeEntry> TreeEntry)
+{
+	for (const auto& Child : TreeEntry->Children)
+	{
+		Child->Parent = TreeEntry;
+		Child->Tree = this;
+	}
+
+	bNavigationIndexDirty = true;
+	RefreshFilter();
+
+	// The labels of the children which are kept can be different as well
+	Widget->RebuildList();
+}
+
+// Position of the first index in the sorted indices which is greater than the index
+static int32 UpperBound(const TArray<int32>& SortedIndices, int32 Index)
+{
+	int32 Low = 0, High = SortedIndices.Num();
+	while (Low < High)
+	{
+		const int32 Mid = (Low + High) / 2;
+		if (SortedIndices[Mid] <= Index) Low = Mid + 1;
+		else High = Mid;
+	}
+	return Low;
+}
+
+// Position of the first index in the sorted indices which is not less than the index
+static int32 LowerBound(const TArray<int32>& SortedIndices, int32 Index)
+{
+	int32 Low = 0, High = SortedIndices.Num();
+	while (Low < High)
+	{
+		const int32 Mid = (Low + High) / 2;
+		if (SortedIndices[Mid] < Index) Low = Mid + 1;
+		else High = Mid;
+	}
+	return Low;
 }
 
 void SMergeTreeView::OnToolBarPrev()
 {
-	// @TODO: Implement
+	const int32 Index = GetSelectedNavigationIndex();
+	if (Index == INDEX_NONE) return;
+
+	// The visible entries before the selected entry are the previous entries
+	const int32 Previous = LowerBound(VisibleIndices, Index) - 1;
+	if (Previous >= 0) SelectEntry(NavigationOrder[VisibleIndices[Previous]]);
 }
 
 void SMergeTreeView::OnToolBarNext()
 {
-	// @TODO: Implement
+	// Without a selection this starts at the first entry
+	const int32 Index = GetSelectedNavigationIndex();
+
+	const int32 Next = UpperBound(VisibleIndices, Index);
+	if (Next < VisibleIndices.Num()) SelectEntry(NavigationOrder[VisibleIndices[Next]]);
 }
 
 void SMergeTreeView::OnToolBarNextConflict()
 {
-	// @TODO: Implement
+	const int32 Index = GetSelectedNavigationIndex();
+
+	// Find the first visible conflict after the selected entry
+	const int32 Next = UpperBound(VisibleConflictIndices, Index);
+	if (Next < VisibleConflictIndices.Num()) SelectEntry(NavigationOrder[VisibleConflictIndices[Next]]);
 }
 
 void SMergeTreeView::OnToolBarPrevConflict()
 {
-	// @TODO: Implement
+	const int32 Index = GetSelectedNavigationIndex();
+	if (Index == INDEX_NONE) return;
+
+	// The visible conflicts before the selected entry are the previous conflicts
+	const int32 Previous = LowerBound(VisibleConflictIndices, Index) - 1;
+	if (Previous >= 0) SelectEntry(NavigationOrder[VisibleConflictIndices[Previous]]);
+}
+
+void SMergeTreeView::SelectEntry(TSharedPtr<IMergeTreeEntry> Entry)
+{
+	if (const TSharedPtr<IMergeTreeEntry> Parent = Entry->Parent.Pin())
+	{
+		Widget->SetItemExpansion(Parent, true);
+	}
+
+	Widget->RequestScrollIntoView(Entry);
+
+	// Changing the selection calls OnSelected, which focuses and highlights the change
+	Widget->SetSelection(Entry);
+}
+
+int32 SMergeTreeView::GetSelectedNavigationIndex()
+{
+	if (bNavigationIndexDirty) BuildNavigationIndex();
+
+	const int32* Index = SelectedEntry ? NavigationIndices.Find(SelectedEntry.Get()) : nullptr;
+	return Index ? *Index : INDEX_NONE;
+}
+
+void SMergeTreeView::BuildNavigationIndex()
+{
+	NavigationOrder.Reset();
+	NavigationIndices.Reset();
+	ConflictIndices.Reset();
+	SearchTexts.Reset();
+
+	const auto AddEntry = [this](const TSharedPtr<IMergeTreeEntry>& Entry)
+	{
+		const int32 Index = NavigationOrder.Add(Entry);
+		NavigationIndices.Add(Entry.Get(), Index);
+		SearchTexts.Add(Entry->GetSearchText());
+
+		// Entries are added in order, so the conflict indices are sorted as well
+		if (Entry->HasConflicts()) ConflictIndices.Add(Index);
+	};
+
+	// The tree is only two levels deep, graphs with their changes
+	for (const auto& Entry : Data)
+	{
+		AddEntry(Entry);
+		for (const auto& Child : Entry->Children) AddEntry(Child);
+	}
+
+	const int32 NumEntries = NavigationOrder.Num();
+	for (auto& Bits : FacetBits) Bits.Init(false, NumEntries);
+	for (auto& Bits : DiffTypeBits) Bits.Init(false, NumEntries);
+
+	for (int32 Index = 0; Index < NumEntries; ++Index)
+	{
+		const IMergeTreeEntry& Entry = *NavigationOrder[Index];
+
+		FacetBits[static_cast<int32>(EMergeTreeFacet::ConflictsOnly)][Index] = Entry.HasConflicts();
+		FacetBits[static_cast<int32>(EMergeTreeFacet::UnresolvedOnly)][Index] = !Entry.IsResolved();
+		FacetBits[static_cast<int32>(EMergeTreeFacet::Remote)][Index] = Entry.HasRemoteChange();
+		FacetBits[static_cast<int32>(EMergeTreeFacet::Local)][Index] = Entry.HasLocalChange();
+		DiffTypeBits[static_cast<int32>(Entry.GetDiffType())][Index] = true;
+	}
+
+	bNavigationIndexDirty = false;
+
+	UpdateSearchBits();
+	UpdateVisibleBits();
+}
+
+void SMergeTreeView::OnEntryStateChanged(IMergeTreeEntry& Entry)
+{
+	// The bits are initialized from the entries once the index is built
+	if (bNavigationIndexDirty) return;
+
+	const int32* Index = NavigationIndices.Find(&Entry);
+	if (!Index) return;
+
+	FacetBits[static_cast<int32>(EMergeTreeFacet::UnresolvedOnly)][*Index] = !Entry.IsResolved();
+
+	if (IsFacetActive(EMergeTreeFacet::UnresolvedOnly)) RefreshFilter();
+}
+
+TSharedRef<SWidget> SMergeTreeView::CreateFilterMenu()
+{
+	FMenuBuilder MenuBuilder(false, nullptr);
+
+	const auto AddFacetEntry = [this, &MenuBuilder](EMergeTreeFacet Facet, const FText& Label, const FText& Tooltip)
+	{
+		MenuBuilder.AddMenuEntry(Label, Tooltip, FSlateIcon(),
+			FUIAction(
+				FExecuteAction::CreateSP(this, &SMergeTreeView::ToggleFacet, Facet),
+				FCanExecuteAction(),
+				FIsActionChecked::CreateSP(this, &SMergeTreeView::IsFacetActive, Facet)),
+			NAME_None, EUserInterfaceActionType::ToggleButton);
+	};
+
+	MenuBuilder.BeginSection(NAME_None, LOCTEXT("StateSection", "State"));
+	AddFacetEntry(EMergeTreeFacet::ConflictsOnly, LOCTEXT("ConflictsOnly", "Conflicts only"),
+		LOCTEXT("ConflictsOnlyTooltip", "Only show changes which conflict"));
+	AddFacetEntry(EMergeTreeFacet::UnresolvedOnly, LOCTEXT("UnresolvedOnly", "Unresolved only"),
+		LOCTEXT("UnresolvedOnlyTooltip", "Only show changes for which no version has been applied"));
+	MenuBuilder.EndSection();
+
+	MenuBuilder.BeginSection(NAME_None, LOCTEXT("OriginSection", "Origin"));
+	AddFacetEntry(EMergeTreeFacet::Remote, LOCTEXT("Remote", "Remote"),
+		LOCTEXT("RemoteTooltip", "Show changes made in the remote blueprint"));
+	AddFacetEntry(EMergeTreeFacet::Local, LOCTEXT("Local", "Local"),
+		LOCTEXT("LocalTooltip", "Show changes made in the local blueprint"));
+	MenuBuilder.EndSection();
+
+	MenuBuilder.BeginSection(NAME_None, LOCTEXT("DiffTypeSection", "Type"));
+	for (int32 Type = 1; Type < NumDiffTypes; ++Type)
+	{
+		const EMergeDiffType DiffType = static_cast<EMergeDiffType>(Type);
+
+		MenuBuilder.AddMenuEntry(GetDiffTypeLabel(DiffType), FText::GetEmpty(), FSlateIcon(),
+			FUIAction(
+				FExecuteAction::CreateSP(this, &SMergeTreeView::ToggleDiffType, DiffType),
+				FCanExecuteAction(),
+				FIsActionChecked::CreateSP(this, &SMergeTreeView::IsDiffTypeActive, DiffType)),
+			NAME_None, EUserInterfaceActionType::ToggleButton);
+	}
+	MenuBuilder.EndSection();
+
+	return MenuBuilder.MakeWidget();
+}
+
+void SMergeTreeView::OnSearchTextChanged(const FText& Text)
+{
+	SearchText = Text.ToString();
+
+	if (!bNavigationIndexDirty) UpdateSearchBits();
+	RefreshFilter();
+}
+
+void SMergeTreeView::ToggleFacet(EMergeTreeFacet Facet)
+{
+	bool& bActive = ActiveFacets[static_cast<int32>(Facet)];
+	bActive = !bActive;
+
+	RefreshFilter();
+}
+
+bool SMergeTreeView::IsFacetActive(EMergeTreeFacet Facet) const
+{
+	return ActiveFacets[static_cast<int32>(Facet)];
+}
+
+void SMergeTreeView::ToggleDiffType(EMergeDiffType Type)
+{
+	ActiveDiffTypes ^= 1u << static_cast<uint32>(Type);
+
+	RefreshFilter();
+}
+
+bool SMergeTreeView::IsDiffTypeActive(EMergeDiffType Type) const
+{
+	return (ActiveDiffTypes & (1u << static_cast<uint32>(Type))) != 0;
+}
+
+bool SMergeTreeView::IsFiltering() const
+{
+	for (bool bActive : ActiveFacets)
+	{
+		if (bActive) return true;
+	}
+
+	return ActiveDiffTypes != 0 || !SearchText.IsEmpty();
+}
+
+void SMergeTreeView::UpdateSearchBits()
+{
+	const int32 NumEntries = NavigationOrder.Num();
+	SearchBits.Init(false, NumEntries);
+
+	if (SearchText.IsEmpty()) return;
+
+	for (int32 Index = 0; Index < NumEntries; ++Index)
+	{
+		SearchBits[Index] = SearchTexts[Index].Contains(SearchText);
+	}
+}
+
+void SMergeTreeView::UpdateVisibleBits()
+{
+	VisibleBits.Init(true, NavigationOrder.Num());
+	if (IsFiltering()) FilterVisibleBits();
+
+	// The navigation searches these sorted indices, instead of walking the bits
+	VisibleIndices.Reset();
+	for (TConstSetBitIterator<> It(VisibleBits); It; ++It) VisibleIndices.Add(It.GetIndex());
+
+	VisibleConflictIndices.Reset();
+	for (const int32 Index : ConflictIndices)
+	{
+		if (VisibleBits[Index]) VisibleConflictIndices.Add(Index);
+	}
+}
+
+void SMergeTreeView::FilterVisibleBits()
+{
+	const int32 NumEntries = NavigationOrder.Num();
+
+	// Conflicts and unresolved narrow down the changes shown
+	if (IsFacetActive(EMergeTreeFacet::ConflictsOnly)) AndBits(VisibleBits, FacetBits[static_cast<int32>(EMergeTreeFacet::ConflictsOnly)]);
+	if (IsFacetActive(EMergeTreeFacet::UnresolvedOnly)) AndBits(VisibleBits, FacetBits[static_cast<int32>(EMergeTreeFacet::UnresolvedOnly)]);
+
+	// Within the origins and diff types, a change is shown when it matches any of the selected ones
+	if (IsFacetActive(EMergeTreeFacet::Remote) || IsFacetActive(EMergeTreeFacet::Local))
+	{
+		TBitArray<> OriginBits(false, NumEntries);
+		if (IsFacetActive(EMergeTreeFacet::Remote)) OrBits(OriginBits, FacetBits[static_cast<int32>(EMergeTreeFacet::Remote)]);
+		if (IsFacetActive(EMergeTreeFacet::Local)) OrBits(OriginBits, FacetBits[static_cast<int32>(EMergeTreeFacet::Local)]);
+
+		AndBits(VisibleBits, OriginBits);
+	}
+
+	if (ActiveDiffTypes)
+	{
+		TBitArray<> TypeBits(false, NumEntries);
+		for (int32 Type = 0; Type < NumDiffTypes; ++Type)
+		{
+			if (IsDiffTypeActive(static_cast<EMergeDiffType>(Type))) OrBits(TypeBits, DiffTypeBits[Type]);
+		}
+
+		AndBits(VisibleBits, TypeBits);
+	}
+
+	if (!SearchText.IsEmpty()) AndBits(VisibleBits, SearchBits);
+
+	// Entries with children are only shown when any of their children are, the children
+	// directly follow their parent in the navigation order
+	for (int32 Index = 0; Index < NumEntries; ++Index)
+	{
+		const int32 NumChildren = NavigationOrder[Index]->Children.Num();
+		if (!NumChildren) continue;
+
+		bool bAnyChildVisible = false;
+		for (int32 Child = Index + 1; Child <= Index + NumChildren && !bAnyChildVisible; ++Child)
+		{
+			bAnyChildVisible = VisibleBits[Child];
+		}
+
+		VisibleBits[Index] = bAnyChildVisible;
+		Index += NumChildren;
+	}
+}
+
+void SMergeTreeView::RefreshFilter()
+{
+	if (bNavigationIndexDirty) BuildNavigationIndex();
+	else UpdateVisibleBits();
+
+	FilteredData.Reset();
+
+	// Walk the entries in the same order as the navigation index was built
+	int32 Index = 0;
+	for (const auto& Entry : Data)
+	{
+		if (VisibleBits[Index++]) FilteredData.Add(Entry);
+
+		Entry->VisibleChildren.Reset();
+		for (const auto& Child : Entry->Children)
+		{
+			if (VisibleBits[Index++]) Entry->VisibleChildren.Add(Child);
+		}
+	}
+
+	Widget->RequestTreeRefresh();
 }
 
 void SMergeTreeView::OnToolbarApplyRemote()
@@ -113,4 +542,6 @@ void SMergeTreeView::OnToolbarRevert()
 	// @TODO: Add status reporting
 }
 
+#undef LOCTEXT_NAMESPACE
+
 END_SLATE_FUNCTION_BUILD_OPTIMIZATION
@@ -7,7 +7,9 @@
 #include "DeclarativeSyntaxSupport.h"
 
 #include "STreeView.h"
-#include <functional>
+#include "FDiffHelper.h"
+
+class SMergeTreeView;
 
 struct IMergeTreeEntry
 {
@@ -22,8 +24,39 @@ struct IMergeTreeEntry
 	virtual bool ApplyLocal()  { return false; }
 	virtual bool Revert()      { return false; }
 
+	virtual bool HasConflicts() const { return false; }
+
+	// Used by the filter bar, only entries without children are filtered. Entries
+	// with children are shown when any of their children pass the filter
+	virtual FString GetSearchText() const    { return FString(); }
+	virtual EMergeDiffType GetDiffType() const { return EMergeDiffType::NO_DIFFERENCE; }
+	virtual bool HasRemoteChange() const     { return false; }
+	virtual bool HasLocalChange() const      { return false; }
+	virtual bool IsResolved() const          { return true; }
+
+	// Should be called whenever the entry is applied or reverted, so the tree can update its filter
+	void NotifyStateChanged();
+
 	bool bHighLight;
 	TArray<TSharedPtr<IMergeTreeEntry>> Children;
+
+	// Set when the entry is added to the tree
+	TWeakPtr<IMergeTreeEntry> Parent;
+	SMergeTreeView* Tree = nullptr;
+
+	// Children which pass the current filter, these are the ones shown in the tree
+	TArray<TSharedPtr<IMergeTreeEntry>> VisibleChildren;
+};
+
+// Facets of the filter bar, besides the diff type
+enum struct EMergeTreeFacet
+{
+	ConflictsOnly = 0,
+	UnresolvedOnly,
+	Remote,
+	Local,
+
+	Num
 };
 
 class SMergeTreeView : public SCompoundWidget
@@ -38,21 +71,19 @@ public:
 
 	void Add(TSharedPtr<IMergeTreeEntry> TreeEntry);
 
-	// Set the highlight value 
+	// Should be called after the children of an entry were replaced, the rows of all entries are generated again
+	void Refresh(TSharedPtr<IMergeTreeEntry> TreeEntry);
+
+	// Set the highlight value
 	template<typename Predicate>
 	void HighlightByPredicate(Predicate Pred)
 	{
-		std::function<void(TArray<TSharedPtr<IMergeTreeEntry>>&)> Highlight = 
-			[&Highlight, Pred](TArray<TSharedPtr<IMergeTreeEntry>>& Entries)
+		if (bNavigationIndexDirty) BuildNavigationIndex();
+
+		for (const auto& Entry : NavigationOrder)
 		{
-			for (auto Entry : Entries)
-			{
-				Entry->bHighLight = Pred(Entry);
-				Highlight(Entry->Children);
-			}
-		};
-
-		Highlight(Data);
+			Entry->bHighLight = Pred(Entry);
+		}
 	}
 
 	void OnToolBarPrev();
@@ -64,8 +95,61 @@ public:
 	void OnToolbarApplyLocal();
 	void OnToolbarRevert();
 
+	void OnEntryStateChanged(IMergeTreeEntry& Entry);
+
 private:
+	// Selects the entry, expanding its parent and scrolling it into view
+	void SelectEntry(TSharedPtr<IMergeTreeEntry> Entry);
+
+	// Index of the selected entry in the navigation order, INDEX_NONE if nothing is selected
+	int32 GetSelectedNavigationIndex();
+	void BuildNavigationIndex();
+
+	// Filtering
+	TSharedRef<SWidget> CreateFilterMenu();
+	void OnSearchTextChanged(const FText& Text);
+	void ToggleFacet(EMergeTreeFacet Facet);
+	bool IsFacetActive(EMergeTreeFacet Facet) const;
+	void ToggleDiffType(EMergeDiffType Type);
+	bool IsDiffTypeActive(EMergeDiffType Type) const;
+	bool IsFiltering() const;
+
+	void UpdateSearchBits();
+	void UpdateVisibleBits();
+	void FilterVisibleBits();
+	void RefreshFilter();
+
 	TArray<TSharedPtr<IMergeTreeEntry>> Data;
+
+	// Top level entries which pass the filter, the source of the tree widget
+	TArray<TSharedPtr<IMergeTreeEntry>> FilteredData;
+
+	// All the entries in the order they are shown in the tree when fully expanded, the
+	// conflict indices point into this array and are sorted. These are rebuilt lazily
+	// after entries are added
+	TArray<TSharedPtr<IMergeTreeEntry>> NavigationOrder;
+	TMap<IMergeTreeEntry*, int32> NavigationIndices;
+	TArray<int32> ConflictIndices;
+	bool bNavigationIndexDirty = false;
+
+	// A bit per entry in the navigation order for each of the facets, these are built together with
+	// the navigation index and updated when an entry changes. Filtering only combines the bits, so it
+	// does not need to call into the entries
+	TBitArray<> FacetBits[static_cast<int32>(EMergeTreeFacet::Num)];
+	TBitArray<> DiffTypeBits[static_cast<int32>(EMergeDiffType::GRAPH_CHANGED) + 1];
+	TBitArray<> SearchBits;
+	TBitArray<> VisibleBits;
+	TArray<FString> SearchTexts;
+
+	// Sorted indices of the set visible bits, and of the visible conflicts. Updated together with the
+	// visible bits, so moving to the previous or next entry is a binary search
+	TArray<int32> VisibleIndices;
+	TArray<int32> VisibleConflictIndices;
+
+	bool ActiveFacets[static_cast<int32>(EMergeTreeFacet::Num)] = {};
+	uint32 ActiveDiffTypes = 0;
+	FString SearchText;
+
 	TSharedPtr<STreeView<TSharedPtr<IMergeTreeEntry>>> Widget;
 
 	TSharedPtr<IMergeTreeEntry> SelectedEntry;
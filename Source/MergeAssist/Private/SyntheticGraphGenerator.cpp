@@ -0,0 +1,335 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SyntheticGraphGenerator.h"
+
+#include "EdGraph/EdGraph.h"
+#include "EdGraph/EdGraphNode.h"
+#include "EdGraph/EdGraphPin.h"
+#include "EdGraphNode_Comment.h"
+#include "EdGraphSchema_K2.h"
+#include "EdGraphUtilities.h"
+#include "Engine/Blueprint.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "K2Node_CallFunction.h"
+#include "K2Node_ExecutionSequence.h"
+#include "K2Node_IfThenElse.h"
+#include "Kismet/KismetMathLibrary.h"
+#include "Kismet/KismetSystemLibrary.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Kismet2/KismetEditorUtilities.h"
+#include "UObject/Package.h"
+
+static const FName SyntheticGraphName("SyntheticGraph");
+
+// Distance between nodes in the generated graphs, roughly the size of a function call node
+static const float NodeSpacing = 256.0f;
+
+static bool IsLinkablePin(const UEdGraphPin* Pin)
+{
+	if (Pin->bHidden || Pin->ParentPin) return false;
+
+	const FName& Category = Pin->PinType.PinCategory;
+	return Category == UEdGraphSchema_K2::PC_Exec
+		|| Category == UEdGraphSchema_K2::PC_Boolean
+		|| Category == UEdGraphSchema_K2::PC_Int
+		|| Category == UEdGraphSchema_K2::PC_Float
+		|| Category == UEdGraphSchema_K2::PC_String;
+}
+
+// Exec outputs and data inputs can only have a single link
+static bool CanAcceptLink(const UEdGraphPin* Pin)
+{
+	const bool bIsExec = Pin->PinType.PinCategory == UEdGraphSchema_K2::PC_Exec;
+	const bool bIsInput = Pin->Direction == EGPD_Input;
+
+	return bIsExec == bIsInput || Pin->LinkedTo.Num() == 0;
+}
+
+FSyntheticGraphGenerator::FSyntheticGraphGenerator(const FSyntheticGraphSettings& InSettings)
+	: Settings(InSettings)
+	, Random(InSettings.Seed)
+{
+	const UClass* MathLibrary = UKismetMathLibrary::StaticClass();
+	for (const TCHAR* Name : { TEXT("Add_IntInt"), TEXT("Subtract_IntInt"), TEXT("Multiply_IntInt"), TEXT("Add_FloatFloat"),
+		TEXT("Multiply_FloatFloat"), TEXT("Less_IntInt"), TEXT("Greater_FloatFloat"), TEXT("BooleanAND"), TEXT("Not_PreBool") })
+	{
+		if (UFunction* Function = MathLibrary->FindFunctionByName(Name)) PureFunctions.Add(Function);
+	}
+
+	const UClass* SystemLibrary = UKismetSystemLibrary::StaticClass();
+	for (const TCHAR* Name : { TEXT("PrintString"), TEXT("PrintText"), TEXT("CollectGarbage") })
+	{
+		if (UFunction* Function = SystemLibrary->FindFunctionByName(Name)) ImpureFunctions.Add(Function);
+	}
+}
+
+FSyntheticMergeGraphs FSyntheticGraphGenerator::Generate()
+{
+	FSyntheticMergeGraphs Graphs;
+
+	Random.Initialize(Settings.Seed);
+
+	Graphs.BaseBlueprint = CreateBlueprint();
+	Graphs.BaseGraph = CreateGraph(Graphs.BaseBlueprint);
+	PopulateGraph(Graphs.BaseGraph, Settings.NumNodes);
+
+	// Cloning keeps the node guids intact, the same as when a blueprint is edited on two branches
+	Graphs.RemoteBlueprint = CreateBlueprint();
+	Graphs.RemoteGraph = FEdGraphUtilities::CloneGraph(Graphs.BaseGraph, Graphs.RemoteBlueprint);
+	FBlueprintEditorUtils::AddUbergraphPage(Graphs.RemoteBlueprint, Graphs.RemoteGraph);
+
+	Graphs.LocalBlueprint = CreateBlueprint();
+	Graphs.LocalGraph = FEdGraphUtilities::CloneGraph(Graphs.BaseGraph, Graphs.LocalBlueprint);
+	FBlueprintEditorUtils::AddUbergraphPage(Graphs.LocalBlueprint, Graphs.LocalGraph);
+
+	// Use a different seed for both sides, otherwise they would make the exact same changes
+	Random.Initialize(Settings.Seed + 1);
+	MutateGraph(Graphs.RemoteGraph, Settings.NumNodes);
+
+	Random.Initialize(Settings.Seed + 2);
+	MutateGraph(Graphs.LocalGraph, Settings.NumNodes);
+
+	// The target graph is filled with a copy of the base graph by the merge
+	Graphs.TargetBlueprint = CreateBlueprint();
+	Graphs.TargetGraph = CreateGraph(Graphs.TargetBlueprint);
+
+	return Graphs;
+}
+
+void FSyntheticGraphGenerator::PopulateGraph(UEdGraph* Graph, int32 NumNodes)
+{
+	for (int32 Index = 0; Index < NumNodes; ++Index)
+	{
+		CreateRandomNode(Graph);
+	}
+
+	GatherPins(Graph);
+	LinkRandomPins(FMath::RoundToInt(NumNodes * Settings.LinkDensity));
+}
+
+void FSyntheticGraphGenerator::MutateGraph(UEdGraph* Graph, int32 NumBaseNodes)
+{
+	auto NumMutations = [NumBaseNodes](float Rate) { return FMath::RoundToInt(NumBaseNodes * Rate); };
+
+	// Remove nodes first, so we never have to deal with pins of removed nodes afterwards
+	for (int32 Count = NumMutations(Settings.RemoveRate); Count > 0 && Graph->Nodes.Num(); --Count)
+	{
+		UEdGraphNode* Node = Graph->Nodes[Random.RandHelper(Graph->Nodes.Num())];
+		Node->BreakAllNodeLinks();
+		Graph->RemoveNode(Node);
+	}
+
+	GatherPins(Graph);
+
+	for (int32 Count = NumMutations(Settings.AddRate); Count > 0; --Count)
+	{
+		UEdGraphNode* Node = CreateRandomNode(Graph);
+
+		TArray<UEdGraphPin*> Pins = Node->Pins.FilterByPredicate(IsLinkablePin);
+		AddPins(Pins);
+
+		// Give new nodes roughly the same amount of links as the existing nodes
+		for (int32 NumLinks = FMath::RoundToInt(Settings.LinkDensity); NumLinks > 0 && Pins.Num(); --NumLinks)
+		{
+			LinkRandomPin(Pins[Random.RandHelper(Pins.Num())]);
+		}
+	}
+
+	for (int32 Count = NumMutations(Settings.MoveRate); Count > 0 && Graph->Nodes.Num(); --Count)
+	{
+		UEdGraphNode* Node = Graph->Nodes[Random.RandHelper(Graph->Nodes.Num())];
+		Node->NodePosX += Random.RandRange(-4, 4) * 16;
+		Node->NodePosY += Random.RandRange(-4, 4) * 16;
+	}
+
+	for (int32 Count = NumMutations(Settings.DefaultEditRate); Count > 0; --Count)
+	{
+		const FName Category = Random.RandHelper(2) ? UEdGraphSchema_K2::PC_Int : UEdGraphSchema_K2::PC_Float;
+		const TArray<UEdGraphPin*>* Inputs = InputPins.Find(Category);
+		if (!Inputs || !Inputs->Num()) continue;
+
+		// Only unlinked pins show their default value
+		UEdGraphPin* Pin = (*Inputs)[Random.RandHelper(Inputs->Num())];
+		if (Pin->LinkedTo.Num()) continue;
+
+		Pin->DefaultValue = Category == UEdGraphSchema_K2::PC_Int
+			? FString::FromInt(Random.RandRange(-100, 100))
+			: FString::SanitizeFloat(Random.FRandRange(-100.0f, 100.0f));
+	}
+
+	for (int32 Count = NumMutations(Settings.RewireRate); Count > 0; --Count)
+	{
+		const FName Categories[] = { UEdGraphSchema_K2::PC_Boolean, UEdGraphSchema_K2::PC_Int, UEdGraphSchema_K2::PC_Float };
+		const TArray<UEdGraphPin*>* Inputs = InputPins.Find(Categories[Random.RandHelper(3)]);
+		if (!Inputs || !Inputs->Num()) continue;
+
+		UEdGraphPin* Pin = (*Inputs)[Random.RandHelper(Inputs->Num())];
+		if (!Pin->LinkedTo.Num()) continue;
+
+		Pin->BreakAllPinLinks();
+		LinkRandomPin(Pin);
+	}
+
+	InputPins.Empty();
+	OutputPins.Empty();
+}
+
+UEdGraphNode* FSyntheticGraphGenerator::CreateRandomNode(UEdGraph* Graph)
+{
+	const int32 GridSize = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Settings.NumNodes))));
+	const int32 PosX = FMath::RoundToInt(Random.RandHelper(GridSize) * NodeSpacing);
+	const int32 PosY = FMath::RoundToInt(Random.RandHelper(GridSize) * NodeSpacing);
+
+	const float Weights[] = {
+		Settings.BranchWeight,
+		Settings.SequenceWeight,
+		PureFunctions.Num() ? Settings.PureFunctionWeight : 0.0f,
+		ImpureFunctions.Num() ? Settings.ImpureFunctionWeight : 0.0f,
+		Settings.CommentWeight
+	};
+
+	float TotalWeight = 0.0f;
+	for (float Weight : Weights) TotalWeight += FMath::Max(Weight, 0.0f);
+
+	// Pick the node type based on the weights, falling back to branches when no weights are set
+	const int32 NumTypes = ARRAY_COUNT(Weights);
+	int32 Type = 0;
+	if (TotalWeight > 0.0f)
+	{
+		for (float Pick = Random.FRand() * TotalWeight; Type < NumTypes - 1; ++Type)
+		{
+			Pick -= FMath::Max(Weights[Type], 0.0f);
+			if (Pick < 0.0f) break;
+		}
+	}
+
+	UEdGraphNode* NewNode = nullptr;
+
+	switch (Type)
+	{
+	case 0:
+	{
+		FGraphNodeCreator<UK2Node_IfThenElse> NodeCreator(*Graph);
+		NewNode = NodeCreator.CreateNode(false);
+		NodeCreator.Finalize();
+		break;
+	}
+	case 1:
+	{
+		FGraphNodeCreator<UK2Node_ExecutionSequence> NodeCreator(*Graph);
+		NewNode = NodeCreator.CreateNode(false);
+		NodeCreator.Finalize();
+		break;
+	}
+	case 2:
+	case 3:
+	{
+		const TArray<UFunction*>& Functions = Type == 2 ? PureFunctions : ImpureFunctions;
+
+		// The function needs to be set before the pins are allocated by Finalize
+		FGraphNodeCreator<UK2Node_CallFunction> NodeCreator(*Graph);
+		UK2Node_CallFunction* CallNode = NodeCreator.CreateNode(false);
+		CallNode->SetFromFunction(Functions[Random.RandHelper(Functions.Num())]);
+		NodeCreator.Finalize();
+		NewNode = CallNode;
+		break;
+	}
+	default:
+	{
+		FGraphNodeCreator<UEdGraphNode_Comment> NodeCreator(*Graph);
+		UEdGraphNode_Comment* CommentNode = NodeCreator.CreateNode(false);
+		CommentNode->NodeComment = FString::Printf(TEXT("Comment %d"), Graph->Nodes.Num());
+		CommentNode->NodeWidth = 2 * NodeSpacing;
+		CommentNode->NodeHeight = NodeSpacing;
+		NodeCreator.Finalize();
+		NewNode = CommentNode;
+		break;
+	}
+	}
+
+	NewNode->NodePosX = PosX;
+	NewNode->NodePosY = PosY;
+	return NewNode;
+}
+
+void FSyntheticGraphGenerator::GatherPins(UEdGraph* Graph)
+{
+	InputPins.Empty();
+	OutputPins.Empty();
+
+	for (UEdGraphNode* Node : Graph->Nodes)
+	{
+		AddPins(Node->Pins.FilterByPredicate(IsLinkablePin));
+	}
+}
+
+void FSyntheticGraphGenerator::AddPins(const TArray<UEdGraphPin*>& Pins)
+{
+	for (UEdGraphPin* Pin : Pins)
+	{
+		auto& PinMap = Pin->Direction == EGPD_Input ? InputPins : OutputPins;
+		PinMap.FindOrAdd(Pin->PinType.PinCategory).Add(Pin);
+	}
+}
+
+bool FSyntheticGraphGenerator::LinkRandomPin(UEdGraphPin* Pin)
+{
+	if (!CanAcceptLink(Pin)) return false;
+
+	const auto& PinMap = Pin->Direction == EGPD_Input ? OutputPins : InputPins;
+	const TArray<UEdGraphPin*>* Candidates = PinMap.Find(Pin->PinType.PinCategory);
+	if (!Candidates || !Candidates->Num()) return false;
+
+	// Most of the pins can accept a link, so a couple of random picks is enough to find one
+	for (int32 Attempt = 0; Attempt < 8; ++Attempt)
+	{
+		UEdGraphPin* Other = (*Candidates)[Random.RandHelper(Candidates->Num())];
+		if (Other->GetOwningNode() == Pin->GetOwningNode()) continue;
+		if (!CanAcceptLink(Other) || Pin->LinkedTo.Contains(Other)) continue;
+
+		Pin->MakeLinkTo(Other);
+		return true;
+	}
+
+	return false;
+}
+
+void FSyntheticGraphGenerator::LinkRandomPins(int32 NumLinks)
+{
+	const TArray<UEdGraphPin*>* Outputs[] = {
+		OutputPins.Find(UEdGraphSchema_K2::PC_Exec),
+		OutputPins.Find(UEdGraphSchema_K2::PC_Boolean),
+		OutputPins.Find(UEdGraphSchema_K2::PC_Int),
+		OutputPins.Find(UEdGraphSchema_K2::PC_Float),
+		OutputPins.Find(UEdGraphSchema_K2::PC_String),
+	};
+
+	TArray<UEdGraphPin*> Candidates;
+	for (const TArray<UEdGraphPin*>* Pins : Outputs)
+	{
+		if (Pins) Candidates.Append(*Pins);
+	}
+
+	if (!Candidates.Num()) return;
+
+	// Give up after a while, in case the graph can not fit the requested number of links
+	for (int32 Attempt = 0; NumLinks > 0 && Attempt < 4 * NumLinks; ++Attempt)
+	{
+		if (LinkRandomPin(Candidates[Random.RandHelper(Candidates.Num())])) --NumLinks;
+	}
+}
+
+UBlueprint* FSyntheticGraphGenerator::CreateBlueprint()
+{
+	const FName Name = MakeUniqueObjectName(GetTransientPackage(), UBlueprint::StaticClass(), TEXT("SyntheticBlueprint"));
+
+	return FKismetEditorUtilities::CreateBlueprint(UObject::StaticClass(), GetTransientPackage(), Name,
+		BPTYPE_Normal, UBlueprint::StaticClass(), UBlueprintGeneratedClass::StaticClass());
+}
+
+UEdGraph* FSyntheticGraphGenerator::CreateGraph(UBlueprint* Blueprint)
+{
+	UEdGraph* Graph = FBlueprintEditorUtils::CreateNewGraph(Blueprint, SyntheticGraphName, UEdGraph::StaticClass(), UEdGraphSchema_K2::StaticClass());
+	FBlueprintEditorUtils::AddUbergraphPage(Blueprint, Graph);
+	return Graph;
+}
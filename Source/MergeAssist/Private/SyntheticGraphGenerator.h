@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+
+class UBlueprint;
+class UEdGraph;
+class UEdGraphNode;
+class UEdGraphPin;
+class UFunction;
+
+struct FSyntheticGraphSettings
+{
+	int32 NumNodes = 1000;
+	int32 Seed = 0;
+
+	// Relative weights of the different node types in the generated graphs
+	float BranchWeight = 1.0f;
+	float SequenceWeight = 1.0f;
+	float PureFunctionWeight = 4.0f;
+	float ImpureFunctionWeight = 2.0f;
+	float CommentWeight = 0.25f;
+
+	// Average number of links for each node in the base graph
+	float LinkDensity = 1.5f;
+
+	// Fraction of the base nodes affected by each mutation, in both the remote and local graphs
+	float AddRate = 0.02f;
+	float RemoveRate = 0.02f;
+	float MoveRate = 0.05f;
+	float DefaultEditRate = 0.02f;
+	float RewireRate = 0.02f;
+};
+
+// The graphs of a generated merge, each graph lives in its own transient blueprint
+struct FSyntheticMergeGraphs
+{
+	UBlueprint* RemoteBlueprint = nullptr;
+	UBlueprint* BaseBlueprint = nullptr;
+	UBlueprint* LocalBlueprint = nullptr;
+	UBlueprint* TargetBlueprint = nullptr;
+
+	UEdGraph* RemoteGraph = nullptr;
+	UEdGraph* BaseGraph = nullptr;
+	UEdGraph* LocalGraph = nullptr;
+	UEdGraph* TargetGraph = nullptr;
+};
+
+// Procedurally generates blueprint graphs to test and benchmark the merge code
+// with. The remote and local graphs are clones of the base graph, on which a
+// random set of mutations is applied. Generation is deterministic for a seed
+class FSyntheticGraphGenerator
+{
+public:
+	FSyntheticGraphGenerator(const FSyntheticGraphSettings& Settings);
+
+	FSyntheticMergeGraphs Generate();
+
+	// Adds NumNodes random nodes to the graph, and links them together based on the LinkDensity
+	void PopulateGraph(UEdGraph* Graph, int32 NumNodes);
+
+	// Applies the add, remove, move, default edit and rewire mutations to the graph
+	void MutateGraph(UEdGraph* Graph, int32 NumBaseNodes);
+
+private:
+	UEdGraphNode* CreateRandomNode(UEdGraph* Graph);
+
+	// Links the pin to a random compatible pin from the gathered pins
+	bool LinkRandomPin(UEdGraphPin* Pin);
+	void LinkRandomPins(int32 NumLinks);
+
+	void GatherPins(UEdGraph* Graph);
+	void AddPins(const TArray<UEdGraphPin*>& Pins);
+
+	static UBlueprint* CreateBlueprint();
+	static UEdGraph* CreateGraph(UBlueprint* Blueprint);
+
+	FSyntheticGraphSettings Settings;
+	FRandomStream Random;
+
+	TArray<UFunction*> PureFunctions;
+	TArray<UFunction*> ImpureFunctions;
+
+	// Linkable pins of the graph that is being generated, by pin category
+	TMap<FName, TArray<UEdGraphPin*>> InputPins;
+	TMap<FName, TArray<UEdGraphPin*>> OutputPins;
+};
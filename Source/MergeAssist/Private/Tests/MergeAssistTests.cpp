@@ -0,0 +1,1396 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/ConfigCacheIni.h"
+#include "HAL/PlatformTime.h"
+#include "Async/ParallelFor.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/NameAsStringProxyArchive.h"
+#include "UObject/UObjectGlobals.h"
+#include "Engine/Blueprint.h"
+#include "EdGraphUtilities.h"
+#include "EdGraphSchema_K2.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "K2Node_Composite.h"
+#include "K2Node_IfThenElse.h"
+#include "Editor.h"
+#include "Editor/Transactor.h"
+
+#include "SyntheticGraphGenerator.h"
+#include "GraphMergeHelper.h"
+#include "BlueprintMergeHelper.h"
+#include "MergeSession.h"
+#include "MergeAssistSettings.h"
+#include "FDiffHelper.h"
+#include "GraphSnapshot.h"
+#include "GraphSnapshotDiff.h"
+#include "NodeSpatialIndex.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+static const int32 TestFlags = EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter;
+
+// Budgets can be overridden in the [MergeAssist.PerformanceBudgets] section of the engine ini
+static const TCHAR* PerformanceBudgetSection = TEXT("MergeAssist.PerformanceBudgets");
+
+static int32 GetBudget(const TCHAR* Key, int32 DefaultValue)
+{
+	int32 Value = DefaultValue;
+	GConfig->GetInt(PerformanceBudgetSection, Key, Value, GEngineIni);
+	return Value;
+}
+
+// Keeps the generated blueprints alive for the duration of a test
+struct FScopedSyntheticMerge
+{
+	FScopedSyntheticMerge(int32 NumNodes)
+	{
+		FSyntheticGraphSettings Settings;
+		Settings.NumNodes = NumNodes;
+
+		Graphs = FSyntheticGraphGenerator(Settings).Generate();
+		for (UBlueprint* Blueprint : { Graphs.RemoteBlueprint, Graphs.BaseBlueprint, Graphs.LocalBlueprint, Graphs.TargetBlueprint })
+		{
+			Blueprint->AddToRoot();
+		}
+	}
+
+	~FScopedSyntheticMerge()
+	{
+		for (UBlueprint* Blueprint : { Graphs.RemoteBlueprint, Graphs.BaseBlueprint, Graphs.LocalBlueprint, Graphs.TargetBlueprint })
+		{
+			Blueprint->RemoveFromRoot();
+		}
+	}
+
+	FSyntheticMergeGraphs Graphs;
+};
+
+// Changes can depend on each other, e.g. a link to a node that is added by another change. So keep
+// going over the changes until none of the remaining ones can be performed
+template<typename FunctionType>
+static void ForEachChangeUntilDone(GraphMergeHelper& MergeHelper, FunctionType&& Function)
+{
+	TArray<TSharedPtr<MergeGraphChange>> Remaining = MergeHelper.ChangeList;
+
+	int32 NumRemaining;
+	do
+	{
+		NumRemaining = Remaining.Num();
+		Remaining.RemoveAll([&Function](const TSharedPtr<MergeGraphChange>& Change) { return Function(*Change); });
+	}
+	while (Remaining.Num() && Remaining.Num() != NumRemaining);
+}
+
+static int32 CountDiffs(UEdGraph* OldGraph, UEdGraph* NewGraph)
+{
+	FMergeDiffCounter Diffs;
+	FDiffHelper::DiffGraphs(OldGraph, NewGraph, Diffs);
+	return Diffs.NumFound();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMergeAssistApplyAllRemoteTest, "MergeAssist.Correctness.ApplyAllRemote", TestFlags)
+bool FMergeAssistApplyAllRemoteTest::RunTest(const FString& Parameters)
+{
+	FScopedSyntheticMerge Merge(500);
+	const FSyntheticMergeGraphs& Graphs = Merge.Graphs;
+
+	GraphMergeHelper MergeHelper(Graphs.RemoteGraph, Graphs.BaseGraph, Graphs.LocalGraph, Graphs.TargetGraph);
+	TestTrue(TEXT("Generated graphs have changes"), MergeHelper.ChangeList.Num() > 0);
+
+	ForEachChangeUntilDone(MergeHelper, [&MergeHelper](MergeGraphChange& Change)
+	{
+		if (Change.RemoteDiff.Type == EMergeDiffType::NO_DIFFERENCE) return true;
+		return MergeHelper.ApplyRemoteChange(Change);
+	});
+
+	TestEqual(TEXT("Diffs between the remote and target graph"), CountDiffs(Graphs.RemoteGraph, Graphs.TargetGraph), 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMergeAssistRevertAllTest, "MergeAssist.Correctness.RevertAll", TestFlags)
+bool FMergeAssistRevertAllTest::RunTest(const FString& Parameters)
+{
+	FScopedSyntheticMerge Merge(500);
+	const FSyntheticMergeGraphs& Graphs = Merge.Graphs;
+
+	GraphMergeHelper MergeHelper(Graphs.RemoteGraph, Graphs.BaseGraph, Graphs.LocalGraph, Graphs.TargetGraph);
+
+	// Apply a mix of remote and local changes, conflicts take the local side
+	ForEachChangeUntilDone(MergeHelper, [&MergeHelper](MergeGraphChange& Change)
+	{
+		return Change.LocalDiff.Type != EMergeDiffType::NO_DIFFERENCE
+			? MergeHelper.ApplyLocalChange(Change)
+			: MergeHelper.ApplyRemoteChange(Change);
+	});
+
+	ForEachChangeUntilDone(MergeHelper, [&MergeHelper](MergeGraphChange& Change)
+	{
+		return MergeHelper.RevertChange(Change);
+	});
+
+	for (const auto& Change : MergeHelper.ChangeList)
+	{
+		TestTrue(*FString::Printf(TEXT("Change '%s' is reverted"), *Change->Label.ToString()), Change->MergeState == EMergeState::Base);
+	}
+
+	TestEqual(TEXT("Diffs between the base and target graph"), CountDiffs(Graphs.BaseGraph, Graphs.TargetGraph), 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMergeAssistDiffSinksTest, "MergeAssist.Correctness.DiffSinks", TestFlags)
+bool FMergeAssistDiffSinksTest::RunTest(const FString& Parameters)
+{
+	FScopedSyntheticMerge Merge(500);
+	const FSyntheticMergeGraphs& Graphs = Merge.Graphs;
+
+	const int32 NumDiffs = CountDiffs(Graphs.BaseGraph, Graphs.RemoteGraph);
+	TestTrue(TEXT("Generated graphs have diffs"), NumDiffs > 1);
+
+	FMergeDiffHistogram Histogram;
+	FDiffHelper::DiffGraphs(Graphs.BaseGraph, Graphs.RemoteGraph, Histogram);
+
+	int32 NumDiffsOfAnyType = 0;
+	for (int32 Type = 0; Type <= static_cast<int32>(EMergeDiffType::NODE_COMMENT); ++Type)
+	{
+		NumDiffsOfAnyType += Histogram.GetCount(static_cast<EMergeDiffType>(Type));
+	}
+
+	TestEqual(TEXT("Diffs in the histogram"), NumDiffsOfAnyType, NumDiffs);
+
+	// Sinks which are done stop the diff
+	FMergeDiffAnyDifference AnyDifference;
+	FDiffHelper::DiffGraphs(Graphs.BaseGraph, Graphs.RemoteGraph, AnyDifference);
+	TestTrue(TEXT("Found a difference"), AnyDifference.HasFoundDiffs());
+	TestTrue(TEXT("Diff stopped at the first difference"), AnyDifference.NumFound() < NumDiffs);
+
+	TArray<FMergeDiffResult> FirstDiffs;
+	FMergeDiffCollector FirstDiffsCollector(FirstDiffs, 10);
+	FDiffHelper::DiffGraphs(Graphs.BaseGraph, Graphs.RemoteGraph, FirstDiffsCollector);
+	TestEqual(TEXT("Diffs collected"), FirstDiffs.Num(), FMath::Min(NumDiffs, 10));
+
+	FMergeDiffAnyDifference NoDifference;
+	FDiffHelper::DiffGraphs(Graphs.BaseGraph, Graphs.BaseGraph, NoDifference);
+	TestFalse(TEXT("Graph is different from itself"), NoDifference.HasFoundDiffs());
+	return true;
+}
+
+// Whether both diffs matched the same nodes and found the same diffs, in any order
+static bool HaveSameResults(const TArray<FNodeMatch>& MatchesA, const TArray<FMergeDiffResult>& DiffsA, const TArray<FNodeMatch>& MatchesB, const TArray<FMergeDiffResult>& DiffsB)
+{
+	if (MatchesA.Num() != MatchesB.Num() || DiffsA.Num() != DiffsB.Num()) return false;
+
+	const auto GetMatchKey = [](const FNodeMatch& Match)
+	{
+		return FString::Printf(TEXT("%p %p"), Match.OldNode, Match.NewNode);
+	};
+
+	const auto GetDiffKey = [](const FMergeDiffResult& Diff)
+	{
+		return FString::Printf(TEXT("%d %p %p %p %p %p %p"), static_cast<int32>(Diff.Type),
+			Diff.NodeOld, Diff.NodeNew, Diff.PinOld, Diff.PinNew, Diff.LinkTargetOld, Diff.LinkTargetNew);
+	};
+
+	// Counts each key up for the first diff and down for the second one, so they are the same if every count ends up at zero
+	TMap<FString, int32> Counts;
+	for (const FNodeMatch& Match : MatchesA) ++Counts.FindOrAdd(TEXT("Match ") + GetMatchKey(Match));
+	for (const FNodeMatch& Match : MatchesB) --Counts.FindOrAdd(TEXT("Match ") + GetMatchKey(Match));
+	for (const FMergeDiffResult& Diff : DiffsA) ++Counts.FindOrAdd(TEXT("Diff ") + GetDiffKey(Diff));
+	for (const FMergeDiffResult& Diff : DiffsB) --Counts.FindOrAdd(TEXT("Diff ") + GetDiffKey(Diff));
+
+	for (const auto& Pair : Counts)
+	{
+		if (Pair.Value != 0) return false;
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMergeAssistIncrementalDiffTest, "MergeAssist.Correctness.IncrementalDiff", TestFlags)
+bool FMergeAssistIncrementalDiffTest::RunTest(const FString& Parameters)
+{
+	FScopedSyntheticMerge Merge(500);
+	const FSyntheticMergeGraphs& Graphs = Merge.Graphs;
+
+	TArray<FNodeMatch> NodeMatches;
+	TArray<FMergeDiffResult> Results;
+	FMergeDiffCollector Diffs(Results);
+	FDiffHelper::DiffGraphs(Graphs.BaseGraph, Graphs.RemoteGraph, Diffs, ENodeMatchStrategy::ALL, &NodeMatches);
+
+	// A deadline in the past only lets each step process a single node or bucket
+	FIncrementalGraphDiff IncrementalDiff(Graphs.BaseGraph, Graphs.RemoteGraph);
+
+	int32 NumSteps = 0;
+	while (!IncrementalDiff.Step(0.0)) ++NumSteps;
+
+	TestTrue(TEXT("Diff took multiple steps"), NumSteps > 1);
+	TestEqual(TEXT("Number of node matches"), IncrementalDiff.NodeMatches.Num(), NodeMatches.Num());
+	TestEqual(TEXT("Number of diffs"), IncrementalDiff.Diffs.Num(), Results.Num());
+	TestTrue(TEXT("Incremental diff has the same results as DiffGraphs"), HaveSameResults(NodeMatches, Results, IncrementalDiff.NodeMatches, IncrementalDiff.Diffs));
+	return true;
+}
+
+// Visits the changes which are not composite, including the sub changes of composite changes
+template<typename FunctionType>
+static void ForEachLeafChange(const TArray<TSharedPtr<MergeGraphChange>>& ChangeList, FunctionType&& Function)
+{
+	for (const auto& Change : ChangeList)
+	{
+		if (!Change->SubChanges.Num()) Function(Change);
+		for (const auto& SubChange : Change->SubChanges) Function(SubChange);
+	}
+}
+
+static int32 CountLeafChanges(const TArray<TSharedPtr<MergeGraphChange>>& ChangeList, bool bRemote)
+{
+	int32 NumChanges = 0;
+	ForEachLeafChange(ChangeList, [&NumChanges, bRemote](const TSharedPtr<MergeGraphChange>& Change)
+	{
+		const FMergeDiffResult& Diff = bRemote ? Change->RemoteDiff : Change->LocalDiff;
+		if (Diff.Type != EMergeDiffType::NO_DIFFERENCE) ++NumChanges;
+	});
+	return NumChanges;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMergeAssistGraphEditsTest, "MergeAssist.Correctness.GraphEdits", TestFlags)
+bool FMergeAssistGraphEditsTest::RunTest(const FString& Parameters)
+{
+	FScopedSyntheticMerge Merge(500);
+	const FSyntheticMergeGraphs& Graphs = Merge.Graphs;
+
+	// Modified nodes are routed to the merge helper of their graph by the blueprint merge
+	const FBlueprintMergeData Data(
+		Graphs.LocalBlueprint,
+		Graphs.BaseBlueprint, FRevisionInfo::InvalidRevision(),
+		Graphs.RemoteBlueprint, FRevisionInfo::InvalidRevision(),
+		Graphs.TargetBlueprint);
+
+	BlueprintMergeHelper BlueprintMerge(Data);
+	const TSharedPtr<GraphMergeHelper> MergeHelperPtr = BlueprintMerge.FindGraphMergeHelper(Graphs.BaseGraph->GetFName());
+	if (!TestTrue(TEXT("Graph has a merge helper"), MergeHelperPtr.IsValid())) return false;
+
+	GraphMergeHelper& MergeHelper = *MergeHelperPtr;
+
+	TSharedPtr<MergeGraphChange> AppliedChange;
+	for (const auto& Change : MergeHelper.ChangeList)
+	{
+		if (Change->bHasConflicts || Change->RemoteDiff.Type == EMergeDiffType::NO_DIFFERENCE) continue;
+		if (MergeHelper.ApplyRemoteChange(*Change))
+		{
+			AppliedChange = Change;
+			break;
+		}
+	}
+
+	if (!TestTrue(TEXT("Applied a remote change"), AppliedChange.IsValid())) return false;
+
+	// Edit remote nodes which are not touched by the applied change, nor linked to a node that is
+	TArray<TSharedPtr<MergeGraphChange>> AppliedLeaves;
+	TSet<UEdGraphNode*> TouchedNodes;
+	ForEachLeafChange({ AppliedChange }, [&AppliedLeaves, &TouchedNodes](const TSharedPtr<MergeGraphChange>& Change)
+	{
+		const FMergeDiffResult& Diff = Change->RemoteDiff;
+		if (Diff.NodeNew) TouchedNodes.Add(Diff.NodeNew);
+		if (Diff.PinNew) TouchedNodes.Add(Diff.PinNew->GetOwningNode());
+		if (Diff.LinkTargetNew) TouchedNodes.Add(Diff.LinkTargetNew->GetOwningNode());
+
+		AppliedLeaves.Add(Change);
+	});
+
+	for (UEdGraphNode* Node : TouchedNodes.Array())
+	{
+		for (UEdGraphPin* Pin : Node->Pins)
+		{
+			for (UEdGraphPin* LinkedPin : Pin->LinkedTo) TouchedNodes.Add(LinkedPin->GetOwningNode());
+		}
+	}
+
+	TArray<UEdGraphNode*> EditedNodes;
+	for (UEdGraphNode* Node : Graphs.RemoteGraph->Nodes)
+	{
+		if (!TouchedNodes.Contains(Node)) EditedNodes.Add(Node);
+		if (EditedNodes.Num() == 2) break;
+	}
+
+	if (!TestEqual(TEXT("Nodes to edit"), EditedNodes.Num(), 2)) return false;
+
+	EditedNodes[0]->Modify();
+	EditedNodes[0]->NodePosX += 12345;
+	Graphs.RemoteGraph->RemoveNode(EditedNodes[1]);
+
+	TestTrue(TEXT("Edits are picked up"), MergeHelper.FlushGraphEdits());
+	TestFalse(TEXT("Edits are only processed once"), MergeHelper.FlushGraphEdits());
+
+	// Only the edited nodes were diffed again, which should find the same changes as diffing everything
+	const FGraphMergeDiffs FullDiffs = FGraphMergeDiffs::Generate(Graphs.RemoteGraph, Graphs.BaseGraph, Graphs.LocalGraph);
+	TestEqual(TEXT("Remote changes"), CountLeafChanges(MergeHelper.ChangeList, true), CountLeafChanges(FullDiffs.ChangeList, true));
+	TestEqual(TEXT("Local changes"), CountLeafChanges(MergeHelper.ChangeList, false), CountLeafChanges(FullDiffs.ChangeList, false));
+
+	TSet<MergeGraphChange*> Changes;
+	ForEachLeafChange(MergeHelper.ChangeList, [&Changes](const TSharedPtr<MergeGraphChange>& Change) { Changes.Add(Change.Get()); });
+
+	for (const auto& Change : AppliedLeaves)
+	{
+		TestTrue(TEXT("Applied change is kept"), Changes.Contains(Change.Get()) && Change->MergeState == EMergeState::Remote);
+	}
+
+	ForEachChangeUntilDone(MergeHelper, [&MergeHelper](MergeGraphChange& Change)
+	{
+		if (Change.RemoteDiff.Type == EMergeDiffType::NO_DIFFERENCE) return true;
+		return MergeHelper.ApplyRemoteChange(Change);
+	});
+
+	TestEqual(TEXT("Diffs between the edited remote and target graph"), CountDiffs(Graphs.RemoteGraph, Graphs.TargetGraph), 0);
+
+	// Removing a node by hand makes the changes which edited it unapplied, not only the change which added it
+	TSharedPtr<MergeGraphChange> MoveChange;
+	ForEachLeafChange(MergeHelper.ChangeList, [&MoveChange](const TSharedPtr<MergeGraphChange>& Change)
+	{
+		if (!MoveChange && Change->MergeState == EMergeState::Remote && Change->RemoteDiff.Type == EMergeDiffType::NODE_MOVED) MoveChange = Change;
+	});
+	if (!TestTrue(TEXT("Applied a node move"), MoveChange.IsValid())) return false;
+
+	UEdGraphNode* MovedNode = MergeHelper.FindNodeInTargetGraph(MoveChange->RemoteDiff.NodeOld);
+	if (!TestNotNull(TEXT("Moved node in the target graph"), MovedNode)) return false;
+
+	MovedNode->BreakAllNodeLinks();
+	Graphs.TargetGraph->RemoveNode(MovedNode);
+
+	TestTrue(TEXT("Removed target node is picked up"), MergeHelper.FlushGraphEdits());
+	TestTrue(TEXT("Move of the removed node is no longer applied"), MoveChange->MergeState == EMergeState::Base);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMergeAssistConflictGroupsTest, "MergeAssist.Correctness.ConflictGroups", TestFlags)
+bool FMergeAssistConflictGroupsTest::RunTest(const FString& Parameters)
+{
+	FScopedSyntheticMerge Merge(500);
+	const FSyntheticMergeGraphs& Graphs = Merge.Graphs;
+
+	GraphMergeHelper MergeHelper(Graphs.RemoteGraph, Graphs.BaseGraph, Graphs.LocalGraph, Graphs.TargetGraph);
+
+	TArray<TSharedPtr<MergeGraphChange>> Groups;
+	int32 NumConflicts = 0;
+	for (const auto& Change : MergeHelper.ChangeList)
+	{
+		if (!Change->bHasConflicts) continue;
+
+		Groups.Add(Change);
+		NumConflicts += FMath::Max(Change->SubChanges.Num(), 1);
+	}
+
+	if (!TestTrue(TEXT("Generated graphs have conflicts"), Groups.Num() > 0)) return false;
+
+	const FMergeConflictCounts& Counts = MergeHelper.GetConflictCounts();
+	TestEqual(TEXT("Number of conflicts"), Counts.NumConflicts, NumConflicts);
+	TestEqual(TEXT("Number of groups"), Counts.NumGroups, Groups.Num());
+	TestEqual(TEXT("Number of unresolved groups"), Counts.NumUnresolvedGroups, Groups.Num());
+
+	// Groups are connected components, so no two of them touch the same base node
+	TMap<UEdGraphNode*, MergeGraphChange*> NodeGroups;
+	for (const auto& Group : Groups)
+	{
+		ForEachLeafChange({ Group }, [this, &Group, &NodeGroups](const TSharedPtr<MergeGraphChange>& Change)
+		{
+			TestTrue(TEXT("Grouped change is a conflict"), Change->bHasConflicts);
+
+			for (const FMergeDiffResult* Diff : { &Change->RemoteDiff, &Change->LocalDiff })
+			{
+				UEdGraphNode* Node = Diff->NodeOld ? Diff->NodeOld : (Diff->PinOld ? Diff->PinOld->GetOwningNode() : nullptr);
+				if (!Node) continue;
+
+				MergeGraphChange*& NodeGroup = NodeGroups.FindOrAdd(Node);
+				if (!NodeGroup) NodeGroup = Group.Get();
+				TestTrue(TEXT("Node belongs to a single group"), NodeGroup == Group.Get());
+			}
+		});
+	}
+
+	// Picking a side for a group picks it for all of its conflicts, and groups can switch sides
+	int32 NumResolved = 0;
+	for (const auto& Group : Groups)
+	{
+		if (!MergeHelper.ApplyRemoteChange(*Group)) continue;
+		++NumResolved;
+
+		if (!MergeHelper.ApplyLocalChange(*Group))
+		{
+			TestTrue(TEXT("Group stays remote when switching sides fails"), Group->MergeState == EMergeState::Remote);
+			continue;
+		}
+
+		ForEachLeafChange({ Group }, [this](const TSharedPtr<MergeGraphChange>& Change)
+		{
+			const EMergeState Expected = Change->LocalDiff.Type != EMergeDiffType::NO_DIFFERENCE ? EMergeState::Local : EMergeState::Base;
+			TestTrue(TEXT("Conflict takes the side of its group"), Change->MergeState == Expected);
+		});
+	}
+
+	TestTrue(TEXT("Resolved a conflict group"), NumResolved > 0);
+	TestEqual(TEXT("Number of unresolved groups after resolving"), MergeHelper.GetConflictCounts().NumUnresolvedGroups, Groups.Num() - NumResolved);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMergeAssistRigidMovesTest, "MergeAssist.Correctness.RigidMoves", TestFlags)
+bool FMergeAssistRigidMovesTest::RunTest(const FString& Parameters)
+{
+	FScopedSyntheticMerge Merge(500);
+	const FSyntheticMergeGraphs& Graphs = Merge.Graphs;
+
+	// Nodes which neither side changed, so moving them only results in a move
+	TSet<FGuid> TouchedGuids;
+	{
+		GraphMergeHelper MergeHelper(Graphs.RemoteGraph, Graphs.BaseGraph, Graphs.LocalGraph, Graphs.TargetGraph);
+		ForEachLeafChange(MergeHelper.ChangeList, [&TouchedGuids](const TSharedPtr<MergeGraphChange>& Change)
+		{
+			for (const FMergeDiffResult* Diff : { &Change->RemoteDiff, &Change->LocalDiff })
+			{
+				if (Diff->NodeOld) TouchedGuids.Add(Diff->NodeOld->NodeGuid);
+				if (Diff->NodeNew) TouchedGuids.Add(Diff->NodeNew->NodeGuid);
+				if (Diff->PinOld) TouchedGuids.Add(Diff->PinOld->GetOwningNode()->NodeGuid);
+				if (Diff->PinNew) TouchedGuids.Add(Diff->PinNew->GetOwningNode()->NodeGuid);
+				if (Diff->LinkTargetOld) TouchedGuids.Add(Diff->LinkTargetOld->GetOwningNode()->NodeGuid);
+				if (Diff->LinkTargetNew) TouchedGuids.Add(Diff->LinkTargetNew->GetOwningNode()->NodeGuid);
+			}
+		});
+	}
+
+	TArray<UEdGraphNode*> MovedNodes;
+	for (UEdGraphNode* Node : Graphs.RemoteGraph->Nodes)
+	{
+		const bool bInBase = Graphs.BaseGraph->Nodes.ContainsByPredicate([Node](const UEdGraphNode* BaseNode) { return BaseNode->NodeGuid == Node->NodeGuid; });
+		if (bInBase && !TouchedGuids.Contains(Node->NodeGuid)) MovedNodes.Add(Node);
+		if (MovedNodes.Num() == 4) break;
+	}
+
+	if (!TestEqual(TEXT("Nodes to move"), MovedNodes.Num(), 4)) return false;
+
+	// Three nodes are moved as a block, further than the synthetic graphs ever move a node, and one is nudged
+	for (int32 i = 0; i < 3; ++i)
+	{
+		MovedNodes[i]->NodePosX += 5000;
+		MovedNodes[i]->NodePosY += 3000;
+	}
+
+	UEdGraphNode* NudgedNode = MovedNodes[3];
+	NudgedNode->NodePosX += 4;
+	MovedNodes.SetNum(3);
+
+	UMergeAssistSettings* Settings = GetMutableDefault<UMergeAssistSettings>();
+	TGuardValue<bool> DetectRigidMoves(Settings->bDetectRigidMoves, true);
+	TGuardValue<int32> MinRigidMoveNodes(Settings->MinRigidMoveNodes, 3);
+	TGuardValue<float> MinMoveDistance(Settings->MinMoveDistance, 10.0f);
+
+	const auto FindMoves = [](const GraphMergeHelper& MergeHelper, UEdGraphNode* Node, TSharedPtr<MergeGraphChange>& OutParent)
+	{
+		int32 NumMoves = 0;
+		for (const auto& Change : MergeHelper.ChangeList)
+		{
+			if (!Change->SubChanges.Num() && Change->RemoteDiff.Type == EMergeDiffType::NODE_MOVED && Change->RemoteDiff.NodeNew == Node)
+			{
+				OutParent = nullptr;
+				++NumMoves;
+			}
+
+			for (const auto& SubChange : Change->SubChanges)
+			{
+				if (SubChange->RemoteDiff.Type == EMergeDiffType::NODE_MOVED && SubChange->RemoteDiff.NodeNew == Node)
+				{
+					OutParent = Change;
+					++NumMoves;
+				}
+			}
+		}
+		return NumMoves;
+	};
+
+	{
+		GraphMergeHelper MergeHelper(Graphs.RemoteGraph, Graphs.BaseGraph, Graphs.LocalGraph, Graphs.TargetGraph);
+
+		TSharedPtr<MergeGraphChange> Group;
+		TestEqual(TEXT("Block move is found"), FindMoves(MergeHelper, MovedNodes[0], Group), 1);
+		if (!TestTrue(TEXT("Block move is grouped"), Group.IsValid())) return false;
+		TestEqual(TEXT("Group contains the moves of the block"), Group->SubChanges.Num(), 3);
+
+		for (UEdGraphNode* Node : MovedNodes)
+		{
+			TSharedPtr<MergeGraphChange> Parent;
+			TestEqual(TEXT("Move of the node is found once"), FindMoves(MergeHelper, Node, Parent), 1);
+			TestTrue(TEXT("Nodes moved by the same offset are in the same group"), Parent == Group);
+		}
+
+		TSharedPtr<MergeGraphChange> Parent;
+		TestEqual(TEXT("Move shorter than the minimum distance is ignored"), FindMoves(MergeHelper, NudgedNode, Parent), 0);
+	}
+
+	// Without a minimum distance the short move is shown, and blocks smaller than the minimum are not grouped
+	Settings->MinMoveDistance = 0.0f;
+	Settings->MinRigidMoveNodes = 4;
+	{
+		GraphMergeHelper MergeHelper(Graphs.RemoteGraph, Graphs.BaseGraph, Graphs.LocalGraph, Graphs.TargetGraph);
+
+		TSharedPtr<MergeGraphChange> Parent;
+		TestEqual(TEXT("Short move is found without a minimum distance"), FindMoves(MergeHelper, NudgedNode, Parent), 1);
+
+		for (UEdGraphNode* Node : MovedNodes)
+		{
+			TestEqual(TEXT("Move of the node is found once"), FindMoves(MergeHelper, Node, Parent), 1);
+			TestFalse(TEXT("Blocks smaller than the minimum are not grouped"), Parent.IsValid());
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMergeAssistAutoResolveTest, "MergeAssist.Correctness.AutoResolve", TestFlags)
+bool FMergeAssistAutoResolveTest::RunTest(const FString& Parameters)
+{
+	FScopedSyntheticMerge Merge(500);
+	const FSyntheticMergeGraphs& Graphs = Merge.Graphs;
+
+	// Make the local graph change a pin default exactly like the remote graph does
+	UEdGraphPin* SameDefaultPin = nullptr;
+	{
+		const FGraphMergeDiffs Diffs = FGraphMergeDiffs::Generate(Graphs.RemoteGraph, Graphs.BaseGraph, Graphs.LocalGraph);
+
+		for (const auto& Change : Diffs.ChangeList)
+		{
+			const FMergeDiffResult& Diff = Change->RemoteDiff;
+			if (Change->bHasConflicts || Change->SubChanges.Num() || Diff.Type != EMergeDiffType::PIN_DEFAULT_VALUE) continue;
+
+			for (const auto& Pair : Diffs.LocalToBaseNodeMap)
+			{
+				if (Pair.Value != Diff.PinOld->GetOwningNode()) continue;
+
+				UEdGraphPin* LocalPin = Pair.Key->FindPin(Diff.PinOld->PinName, Diff.PinOld->Direction);
+				if (!LocalPin || LocalPin->LinkedTo.Num()) break;
+
+				LocalPin->DefaultValue = Diff.PinNew->DefaultValue;
+				LocalPin->DefaultObject = Diff.PinNew->DefaultObject;
+				LocalPin->DefaultTextValue = Diff.PinNew->DefaultTextValue;
+				SameDefaultPin = Diff.PinOld;
+				break;
+			}
+
+			if (SameDefaultPin) break;
+		}
+	}
+
+	if (!TestNotNull(TEXT("Changed a local pin default"), SameDefaultPin)) return false;
+
+	GraphMergeHelper MergeHelper(Graphs.RemoteGraph, Graphs.BaseGraph, Graphs.LocalGraph, Graphs.TargetGraph);
+
+	// Identical changes are not a conflict, and only the remote change is kept
+	int32 NumSameDefaultChanges = 0;
+	ForEachLeafChange(MergeHelper.ChangeList, [&NumSameDefaultChanges, SameDefaultPin](const TSharedPtr<MergeGraphChange>& Change)
+	{
+		if (Change->RemoteDiff.PinOld == SameDefaultPin || Change->LocalDiff.PinOld == SameDefaultPin) ++NumSameDefaultChanges;
+	});
+
+	TestEqual(TEXT("Changes to the pin with the same default"), NumSameDefaultChanges, 1);
+
+	// Take the local version of every conflict
+	FMergeAutoResolveRule Rule;
+	Rule.RemoteChange = EMergeRuleChangeType::Any;
+	Rule.LocalChange = EMergeRuleChangeType::Any;
+	Rule.bOnlyConflicts = true;
+	Rule.Resolution = EMergeRuleResolution::TakeLocal;
+
+	const int32 NumGroups = MergeHelper.GetConflictCounts().NumGroups;
+	const int32 NumResolved = MergeHelper.ApplyAutoResolveRules({ Rule });
+
+	TestTrue(TEXT("Resolved conflicts"), NumResolved > 0);
+	TestEqual(TEXT("Unresolved conflict groups"), MergeHelper.GetConflictCounts().NumUnresolvedGroups, NumGroups - NumResolved);
+
+	for (const auto& Change : MergeHelper.ChangeList)
+	{
+		if (!Change->bHasConflicts) TestTrue(TEXT("Changes which do not conflict are left alone"), Change->MergeState == EMergeState::Base);
+		else if (Change->MergeState != EMergeState::Base) TestTrue(TEXT("Conflict takes the local version"), Change->MergeState == EMergeState::Local);
+	}
+
+	TestEqual(TEXT("Resolved changes are not resolved again"), MergeHelper.ApplyAutoResolveRules({ Rule }), 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMergeAssistMergeSessionTest, "MergeAssist.Correctness.MergeSession", TestFlags)
+bool FMergeAssistMergeSessionTest::RunTest(const FString& Parameters)
+{
+	FScopedSyntheticMerge Merge(500);
+	const FSyntheticMergeGraphs& Graphs = Merge.Graphs;
+
+	const FBlueprintMergeData Data(
+		Graphs.LocalBlueprint,
+		Graphs.BaseBlueprint, FRevisionInfo::InvalidRevision(),
+		Graphs.RemoteBlueprint, FRevisionInfo::InvalidRevision(),
+		Graphs.TargetBlueprint);
+
+	const FName GraphName = Graphs.BaseGraph->GetFName();
+
+	FMergeAutoResolveRule Rule;
+	Rule.Resolution = EMergeRuleResolution::TakeLocal;
+
+	// Pick a version for the changes, and save the session
+	TArray<uint8> SavedSession;
+	TArray<EMergeState> SavedStates;
+	UEdGraph* MergedGraph = nullptr;
+	{
+		BlueprintMergeHelper BlueprintMerge(Data);
+		BlueprintMerge.ApplyNonConflictingChanges();
+
+		const TSharedPtr<GraphMergeHelper> MergeHelper = BlueprintMerge.FindGraphMergeHelper(GraphName);
+		if (!TestTrue(TEXT("Merged the generated graph"), MergeHelper.IsValid())) return false;
+
+		MergeHelper->ApplyAutoResolveRules({ Rule });
+		for (const auto& Change : MergeHelper->ChangeList) SavedStates.Add(Change->MergeState);
+
+		MergedGraph = FEdGraphUtilities::CloneGraph(BlueprintMerge.FindTargetGraph(GraphName), nullptr);
+
+		FMergeSession Session = FMergeSession::Capture(BlueprintMerge);
+		FMemoryWriter Writer(SavedSession);
+		FNameAsStringProxyArchive Ar(Writer);
+		Ar << Session;
+	}
+
+	FMergeSession Session;
+	FMemoryReader Reader(SavedSession);
+	FNameAsStringProxyArchive Ar(Reader);
+	Ar << Session;
+
+	TestFalse(TEXT("Session is read back"), Ar.IsError());
+	TestTrue(TEXT("Session belongs to the merge"), Session.IsSessionFor(Data));
+
+	// None of the graphs changed, so all of them use the saved diffs
+	int32 NumReusedGraphs = 0;
+	BlueprintMergeHelper BlueprintMerge(Data, Session.GenerateDiffs(Data, &NumReusedGraphs));
+	TestEqual(TEXT("Graphs which reused the saved diffs"), NumReusedGraphs, BlueprintMerge.GraphNames.Num());
+
+	const int32 NumPicked = SavedStates.FilterByPredicate([](EMergeState State) { return State != EMergeState::Base; }).Num();
+	TestTrue(TEXT("Picked versions before saving"), NumPicked > 0);
+	TestEqual(TEXT("Restored changes"), Session.Restore(BlueprintMerge), NumPicked);
+
+	const TSharedPtr<GraphMergeHelper> MergeHelper = BlueprintMerge.FindGraphMergeHelper(GraphName);
+	TestEqual(TEXT("Number of changes"), MergeHelper->ChangeList.Num(), SavedStates.Num());
+
+	for (int32 Index = 0; Index < FMath::Min(MergeHelper->ChangeList.Num(), SavedStates.Num()); ++Index)
+	{
+		const MergeGraphChange& Change = *MergeHelper->ChangeList[Index];
+		TestTrue(*FString::Printf(TEXT("Change '%s' has its saved state"), *Change.Label.ToString()), Change.MergeState == SavedStates[Index]);
+	}
+
+	TestEqual(TEXT("Diffs between the saved and restored target graph"), CountDiffs(MergedGraph, BlueprintMerge.FindTargetGraph(GraphName)), 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMergeAssistUndoTest, "MergeAssist.Correctness.Undo", TestFlags)
+bool FMergeAssistUndoTest::RunTest(const FString& Parameters)
+{
+	if (!TestTrue(TEXT("Editor can undo"), GEditor && GEditor->Trans)) return false;
+
+	FScopedSyntheticMerge Merge(500);
+	const FSyntheticMergeGraphs& Graphs = Merge.Graphs;
+
+	GraphMergeHelper MergeHelper(Graphs.RemoteGraph, Graphs.BaseGraph, Graphs.LocalGraph, Graphs.TargetGraph);
+
+	// Apply every remote change in a single bulk operation
+	const int32 QueueLength = GEditor->Trans->GetQueueLength();
+	const int32 NumApplied = MergeHelper.ApplyMergeStates([](const MergeGraphChange& Change)
+	{
+		return Change.RemoteDiff.Type != EMergeDiffType::NO_DIFFERENCE ? EMergeState::Remote : EMergeState::Base;
+	});
+
+	TestTrue(TEXT("Applied remote changes"), NumApplied > 0);
+	TestEqual(TEXT("Transactions of the bulk apply"), GEditor->Trans->GetQueueLength() - QueueLength, 1);
+	TestEqual(TEXT("Diffs between the remote and target graph"), CountDiffs(Graphs.RemoteGraph, Graphs.TargetGraph), 0);
+
+	// A single undo puts back the base graph, together with the state of the changes
+	TestTrue(TEXT("Undo the bulk apply"), GEditor->UndoTransaction());
+	TestEqual(TEXT("Diffs between the base and target graph after undo"), CountDiffs(Graphs.BaseGraph, Graphs.TargetGraph), 0);
+
+	for (const auto& Change : MergeHelper.ChangeList)
+	{
+		TestTrue(*FString::Printf(TEXT("Change '%s' is undone"), *Change->Label.ToString()), Change->MergeState == EMergeState::Base);
+	}
+
+	TestTrue(TEXT("Redo the bulk apply"), GEditor->RedoTransaction());
+	TestEqual(TEXT("Diffs between the remote and target graph after redo"), CountDiffs(Graphs.RemoteGraph, Graphs.TargetGraph), 0);
+
+	// The restored node mappings allow reverting the changes again
+	ForEachChangeUntilDone(MergeHelper, [&MergeHelper](MergeGraphChange& Change)
+	{
+		return MergeHelper.RevertChange(Change);
+	});
+
+	TestEqual(TEXT("Diffs between the base and target graph after reverting"), CountDiffs(Graphs.BaseGraph, Graphs.TargetGraph), 0);
+
+	// Applying the non conflicting changes is a single transaction as well, which only records the states that changed
+	const int32 QueueLengthBeforeApply = GEditor->Trans->GetQueueLength();
+	MergeHelper.ApplyNonConflictingChanges();
+
+	TestEqual(TEXT("Transactions of applying the non conflicting changes"), GEditor->Trans->GetQueueLength() - QueueLengthBeforeApply, 1);
+	TestTrue(TEXT("Non conflicting changes are applied"), MergeHelper.ChangeList.ContainsByPredicate([](const TSharedPtr<MergeGraphChange>& Change)
+	{
+		return Change->MergeState != EMergeState::Base;
+	}));
+
+	TestTrue(TEXT("Undo applying the non conflicting changes"), GEditor->UndoTransaction());
+	TestEqual(TEXT("Diffs between the base and target graph after undoing the non conflicting changes"), CountDiffs(Graphs.BaseGraph, Graphs.TargetGraph), 0);
+	TestFalse(TEXT("Changes are in the base state after undo"), MergeHelper.ChangeList.ContainsByPredicate([](const TSharedPtr<MergeGraphChange>& Change)
+	{
+		return Change->MergeState != EMergeState::Base;
+	}));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMergeAssistCrossGraphMoveTest, "MergeAssist.Correctness.CrossGraphMove", TestFlags)
+bool FMergeAssistCrossGraphMoveTest::RunTest(const FString& Parameters)
+{
+	FScopedSyntheticMerge Merge(500);
+	const FSyntheticMergeGraphs& Graphs = Merge.Graphs;
+
+	// A function which exists in the base, remote and local blueprint, but not yet in the target blueprint
+	const FName FunctionName(TEXT("MovedNodes"));
+	UBlueprint* const SourceBlueprints[] = { Graphs.RemoteBlueprint, Graphs.BaseBlueprint, Graphs.LocalBlueprint };
+	for (UBlueprint* Blueprint : SourceBlueprints)
+	{
+		Blueprint->FunctionGraphs.Add(FBlueprintEditorUtils::CreateNewGraph(Blueprint, FunctionName, UEdGraph::StaticClass(), UEdGraphSchema_K2::StaticClass()));
+	}
+
+	// Cut a node which also exists in the base graph from the remote graph, and paste it into the remote function
+	UEdGraph* RemoteFunction = Graphs.RemoteBlueprint->FunctionGraphs.Last();
+	UEdGraphNode* const* MovedNodePtr = Graphs.RemoteGraph->Nodes.FindByPredicate([&Graphs](const UEdGraphNode* Node)
+	{
+		return Graphs.BaseGraph->Nodes.ContainsByPredicate([Node](const UEdGraphNode* BaseNode) { return BaseNode->NodeGuid == Node->NodeGuid; });
+	});
+	if (!TestNotNull(TEXT("Remote node which exists in the base graph"), MovedNodePtr)) return false;
+
+	UEdGraphNode* MovedNode = *MovedNodePtr;
+	MovedNode->BreakAllNodeLinks();
+	Graphs.RemoteGraph->RemoveNode(MovedNode);
+	MovedNode->Rename(nullptr, RemoteFunction);
+	RemoteFunction->AddNode(MovedNode, false, false);
+
+	const FBlueprintMergeData Data(
+		Graphs.LocalBlueprint,
+		Graphs.BaseBlueprint, FRevisionInfo::InvalidRevision(),
+		Graphs.RemoteBlueprint, FRevisionInfo::InvalidRevision(),
+		Graphs.TargetBlueprint);
+
+	BlueprintMergeHelper BlueprintMerge(Data);
+	TestTrue(TEXT("Function graph is merged"), BlueprintMerge.GraphNames.Contains(FunctionName));
+	TestTrue(TEXT("Function graph is added to the target functions"), Graphs.TargetBlueprint->FunctionGraphs.Contains(BlueprintMerge.FindTargetGraph(FunctionName)));
+
+	const FMergeNodeMove* Move = BlueprintMerge.GetNodeMoves().FindByPredicate([MovedNode](const FMergeNodeMove& NodeMove)
+	{
+		return NodeMove.NodeGuid == MovedNode->NodeGuid;
+	});
+	if (!TestNotNull(TEXT("Move of the node"), Move)) return false;
+
+	TestTrue(TEXT("Graph the node was moved from"), Move->FromGraph == Graphs.BaseGraph->GetFName());
+	TestTrue(TEXT("Graph the node was moved to"), Move->ToGraph == FunctionName);
+	TestTrue(TEXT("Node was moved by the remote blueprint"), Move->bRemote);
+
+	const TSharedPtr<GraphMergeHelper> FunctionHelper = BlueprintMerge.FindGraphMergeHelper(FunctionName);
+	if (!TestTrue(TEXT("Function graph has a merge helper"), FunctionHelper.IsValid())) return false;
+
+	const auto FindMoveChange = [&FunctionHelper, MovedNode]()
+	{
+		TSharedPtr<MergeGraphChange> MoveChange;
+		ForEachLeafChange(FunctionHelper->ChangeList, [&MoveChange, MovedNode](const TSharedPtr<MergeGraphChange>& Change)
+		{
+			if (Change->RemoteDiff.Type == EMergeDiffType::NODE_ADDED && Change->RemoteDiff.NodeNew == MovedNode) MoveChange = Change;
+		});
+		return MoveChange;
+	};
+
+	TSharedPtr<MergeGraphChange> MoveChange = FindMoveChange();
+	if (!TestTrue(TEXT("Change of the moved node"), MoveChange.IsValid())) return false;
+	TestTrue(TEXT("Change is labeled as a move"), MoveChange->bIsLabeledAsMove);
+
+	// Editing the moved node generates the changes of the function again, which keeps the move label
+	MovedNode->Modify();
+	MovedNode->NodePosX += 12345;
+	TestTrue(TEXT("Edit is picked up"), FunctionHelper->FlushGraphEdits());
+
+	MoveChange = FindMoveChange();
+	if (!TestTrue(TEXT("Change of the moved node after the edit"), MoveChange.IsValid())) return false;
+	TestTrue(TEXT("Change is still labeled as a move"), MoveChange->bIsLabeledAsMove);
+	TestTrue(TEXT("Label names the graph the node was moved from"), MoveChange->Label.ToString().Contains(Graphs.BaseGraph->GetName()));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMergeAssistPastedNodeMoveTest, "MergeAssist.Correctness.PastedNodeMove", TestFlags)
+bool FMergeAssistPastedNodeMoveTest::RunTest(const FString& Parameters)
+{
+	FScopedSyntheticMerge Merge(500);
+	const FSyntheticMergeGraphs& Graphs = Merge.Graphs;
+
+	const FName FunctionName(TEXT("PastedNodes"));
+	UBlueprint* const SourceBlueprints[] = { Graphs.RemoteBlueprint, Graphs.BaseBlueprint, Graphs.LocalBlueprint };
+	for (UBlueprint* Blueprint : SourceBlueprints)
+	{
+		Blueprint->FunctionGraphs.Add(FBlueprintEditorUtils::CreateNewGraph(Blueprint, FunctionName, UEdGraph::StaticClass(), UEdGraphSchema_K2::StaticClass()));
+	}
+
+	// A remote node which still has the same pins and defaults as in the base graph
+	const auto FindBaseNode = [&Graphs](const UEdGraphNode* Node) -> UEdGraphNode*
+	{
+		UEdGraphNode* const* BaseNode = Graphs.BaseGraph->Nodes.FindByPredicate([Node](const UEdGraphNode* Candidate) { return Candidate->NodeGuid == Node->NodeGuid; });
+		return BaseNode ? *BaseNode : nullptr;
+	};
+
+	UEdGraphNode* const* MovedNodePtr = Graphs.RemoteGraph->Nodes.FindByPredicate([&FindBaseNode](const UEdGraphNode* Node)
+	{
+		const UEdGraphNode* BaseNode = FindBaseNode(Node);
+		if (!BaseNode || BaseNode->Pins.Num() != Node->Pins.Num()) return false;
+
+		for (int32 PinIndex = 0; PinIndex < Node->Pins.Num(); ++PinIndex)
+		{
+			if (BaseNode->Pins[PinIndex]->PinName != Node->Pins[PinIndex]->PinName) return false;
+			if (BaseNode->Pins[PinIndex]->DefaultValue != Node->Pins[PinIndex]->DefaultValue) return false;
+		}
+		return true;
+	});
+	if (!TestNotNull(TEXT("Remote node which is unchanged from the base graph"), MovedNodePtr)) return false;
+
+	// The comment is part of what is matched, and keeps the node from matching other nodes of the same type
+	UEdGraphNode* MovedNode = *MovedNodePtr;
+	UEdGraphNode* BaseNode = FindBaseNode(MovedNode);
+	MovedNode->NodeComment = BaseNode->NodeComment = TEXT("Pasted into a function");
+
+	// Cut the node from the remote graph, and paste it into the remote function, which gives it a new guid
+	const FGuid BaseGuid = MovedNode->NodeGuid;
+	MovedNode->BreakAllNodeLinks();
+	Graphs.RemoteGraph->RemoveNode(MovedNode);
+
+	UEdGraph* RemoteFunction = Graphs.RemoteBlueprint->FunctionGraphs.Last();
+	MovedNode->Rename(nullptr, RemoteFunction);
+	MovedNode->CreateNewGuid();
+	RemoteFunction->AddNode(MovedNode, false, false);
+
+	const FBlueprintMergeData Data(
+		Graphs.LocalBlueprint,
+		Graphs.BaseBlueprint, FRevisionInfo::InvalidRevision(),
+		Graphs.RemoteBlueprint, FRevisionInfo::InvalidRevision(),
+		Graphs.TargetBlueprint);
+
+	BlueprintMergeHelper BlueprintMerge(Data);
+
+	const FMergeNodeMove* Move = BlueprintMerge.GetNodeMoves().FindByPredicate([BaseGuid](const FMergeNodeMove& NodeMove)
+	{
+		return NodeMove.NodeGuid == BaseGuid;
+	});
+	if (!TestNotNull(TEXT("Move of the pasted node"), Move)) return false;
+
+	TestTrue(TEXT("Guid of the pasted node"), Move->NewNodeGuid == MovedNode->NodeGuid);
+	TestTrue(TEXT("Graph the node was moved from"), Move->FromGraph == Graphs.BaseGraph->GetFName());
+	TestTrue(TEXT("Graph the node was moved to"), Move->ToGraph == FunctionName);
+	TestTrue(TEXT("Node was moved by the remote blueprint"), Move->bRemote);
+
+	// Both the removal and the addition are labeled as a move
+	int32 NumLabeled = 0;
+	for (const auto& MergeHelper : BlueprintMerge.GraphMergeHelpers)
+	{
+		ForEachLeafChange(MergeHelper->ChangeList, [&NumLabeled, BaseNode, MovedNode](const TSharedPtr<MergeGraphChange>& Change)
+		{
+			const FMergeDiffResult& Diff = Change->RemoteDiff;
+			const bool bIsMovedNode = (Diff.Type == EMergeDiffType::NODE_REMOVED && Diff.NodeOld == BaseNode)
+				|| (Diff.Type == EMergeDiffType::NODE_ADDED && Diff.NodeNew == MovedNode);
+			if (bIsMovedNode && Change->bIsLabeledAsMove) ++NumLabeled;
+		});
+	}
+
+	TestEqual(TEXT("Changes labeled as a move"), NumLabeled, 2);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMergeAssistGraphChangesTest, "MergeAssist.Correctness.GraphChanges", TestFlags)
+bool FMergeAssistGraphChangesTest::RunTest(const FString& Parameters)
+{
+	FScopedSyntheticMerge Merge(100);
+	const FSyntheticMergeGraphs& Graphs = Merge.Graphs;
+
+	const auto AddFunction = [](UBlueprint* Blueprint, FName FunctionName, UEdGraph* SourceGraph)
+	{
+		UEdGraph* Function = FEdGraphUtilities::CloneGraph(SourceGraph, Blueprint);
+		Function->Rename(*FunctionName.ToString(), Blueprint);
+		Blueprint->FunctionGraphs.Add(Function);
+		return Function;
+	};
+
+	// A function added by the remote blueprint, one removed by the local blueprint, and one added by both with different nodes
+	const FName AddedName(TEXT("AddedFunction"));
+	const FName RemovedName(TEXT("RemovedFunction"));
+	const FName ConflictName(TEXT("ConflictingFunction"));
+
+	UEdGraph* AddedFunction = AddFunction(Graphs.RemoteBlueprint, AddedName, Graphs.RemoteGraph);
+	AddFunction(Graphs.BaseBlueprint, RemovedName, Graphs.BaseGraph);
+	AddFunction(Graphs.RemoteBlueprint, RemovedName, Graphs.BaseGraph);
+	AddFunction(Graphs.RemoteBlueprint, ConflictName, Graphs.RemoteGraph);
+	UEdGraph* LocalConflictFunction = AddFunction(Graphs.LocalBlueprint, ConflictName, Graphs.LocalGraph);
+
+	const FBlueprintMergeData Data(
+		Graphs.LocalBlueprint,
+		Graphs.BaseBlueprint, FRevisionInfo::InvalidRevision(),
+		Graphs.RemoteBlueprint, FRevisionInfo::InvalidRevision(),
+		Graphs.TargetBlueprint);
+
+	BlueprintMergeHelper BlueprintMerge(Data);
+
+	const TSharedPtr<GraphMergeHelper> AddedHelper = BlueprintMerge.FindGraphMergeHelper(AddedName);
+	const TSharedPtr<GraphMergeHelper> RemovedHelper = BlueprintMerge.FindGraphMergeHelper(RemovedName);
+	const TSharedPtr<GraphMergeHelper> ConflictHelper = BlueprintMerge.FindGraphMergeHelper(ConflictName);
+	if (!TestTrue(TEXT("Functions are merged"), AddedHelper.IsValid() && RemovedHelper.IsValid() && ConflictHelper.IsValid())) return false;
+	if (!TestTrue(TEXT("Functions have changes"), AddedHelper->ChangeList.Num() && RemovedHelper->ChangeList.Num() && ConflictHelper->ChangeList.Num())) return false;
+
+	const auto IsListed = [&Graphs, &BlueprintMerge](FName FunctionName)
+	{
+		return Graphs.TargetBlueprint->FunctionGraphs.Contains(BlueprintMerge.FindTargetGraph(FunctionName));
+	};
+
+	// Added graphs are only part of the target blueprint once their change is applied
+	MergeGraphChange& Added = *AddedHelper->ChangeList[0];
+	TestTrue(TEXT("Added function is a remote change"), Added.RemoteDiff.Type == EMergeDiffType::GRAPH_ADDED && Added.LocalDiff.Type == EMergeDiffType::NO_DIFFERENCE);
+	TestFalse(TEXT("Added function is not part of the target before it is applied"), IsListed(AddedName));
+
+	TestTrue(TEXT("Apply the added function"), AddedHelper->ApplyRemoteChange(Added));
+	TestTrue(TEXT("Applied function is part of the target"), IsListed(AddedName));
+	TestEqual(TEXT("Diffs between the remote and target function"), CountDiffs(AddedFunction, BlueprintMerge.FindTargetGraph(AddedName)), 0);
+
+	TestTrue(TEXT("Revert the added function"), AddedHelper->RevertChange(Added));
+	TestFalse(TEXT("Reverted function is not part of the target"), IsListed(AddedName));
+	TestEqual(TEXT("Nodes of the reverted function"), BlueprintMerge.FindTargetGraph(AddedName)->Nodes.Num(), 0);
+
+	// The removed function was not changed by the remote blueprint, so its removal does not conflict
+	MergeGraphChange& Removed = *RemovedHelper->ChangeList[0];
+	TestTrue(TEXT("Removed function is a local change"), Removed.LocalDiff.Type == EMergeDiffType::GRAPH_REMOVED && !Removed.bHasConflicts);
+	TestTrue(TEXT("Removed function is part of the target before it is applied"), IsListed(RemovedName));
+	TestTrue(TEXT("Apply the removed function"), RemovedHelper->ApplyLocalChange(Removed));
+	TestFalse(TEXT("Applied removal is not part of the target"), IsListed(RemovedName));
+
+	// Adding the same function on both sides conflicts, and is counted as a conflict of the merge
+	MergeGraphChange& Conflict = *ConflictHelper->ChangeList[0];
+	TestTrue(TEXT("Function added by both sides conflicts"), Conflict.bHasConflicts
+		&& Conflict.RemoteDiff.Type == EMergeDiffType::GRAPH_ADDED && Conflict.LocalDiff.Type == EMergeDiffType::GRAPH_ADDED);
+	TestTrue(TEXT("Conflicting function is counted"), ConflictHelper->GetConflictCounts().NumUnresolvedGroups > 0);
+
+	BlueprintMerge.ApplyNonConflictingChanges();
+	TestFalse(TEXT("Conflicting function is not applied with the non conflicting changes"), IsListed(ConflictName));
+
+	TestTrue(TEXT("Pick the local function"), ConflictHelper->ApplyLocalChange(Conflict));
+	TestEqual(TEXT("Diffs between the local and target function"), CountDiffs(LocalConflictFunction, BlueprintMerge.FindTargetGraph(ConflictName)), 0);
+	return true;
+}
+
+// Whether any pin of the graph links to a node which is not part of the graph
+static bool HasLinksOutsideGraph(const UEdGraph* Graph)
+{
+	for (const UEdGraphNode* Node : Graph->Nodes)
+	{
+		for (const UEdGraphPin* Pin : Node->Pins)
+		{
+			for (const UEdGraphPin* LinkedPin : Pin->LinkedTo)
+			{
+				if (LinkedPin && LinkedPin->GetOwningNode()->GetGraph() != Graph) return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMergeAssistDuplicatedNodesTest, "MergeAssist.Correctness.DuplicatedNodes", TestFlags)
+bool FMergeAssistDuplicatedNodesTest::RunTest(const FString& Parameters)
+{
+	FScopedSyntheticMerge Merge(100);
+	const FSyntheticMergeGraphs& Graphs = Merge.Graphs;
+
+	// A function which is empty in the base and local blueprint, the remote blueprint adds its entry node, which can not
+	// be copied by the user, and links it to a branch
+	const FName FunctionName(TEXT("DuplicatedNodes"));
+	UEdGraph* RemoteFunction = nullptr;
+	for (UBlueprint* Blueprint : { Graphs.RemoteBlueprint, Graphs.BaseBlueprint, Graphs.LocalBlueprint })
+	{
+		UEdGraph* Function = FBlueprintEditorUtils::CreateNewGraph(Blueprint, FunctionName, UEdGraph::StaticClass(), UEdGraphSchema_K2::StaticClass());
+		if (Blueprint == Graphs.RemoteBlueprint)
+		{
+			FBlueprintEditorUtils::AddFunctionGraph<UClass>(Blueprint, Function, true, nullptr);
+			RemoteFunction = Function;
+		}
+		else
+		{
+			Blueprint->FunctionGraphs.Add(Function);
+		}
+	}
+
+	UEdGraphNode* const* EntryNode = RemoteFunction->Nodes.FindByPredicate([](const UEdGraphNode* Node) { return !Node->CanDuplicateNode(); });
+	if (!TestNotNull(TEXT("Function entry node"), EntryNode)) return false;
+
+	FGraphNodeCreator<UK2Node_IfThenElse> BranchCreator(*RemoteFunction);
+	UK2Node_IfThenElse* Branch = BranchCreator.CreateNode(false);
+	BranchCreator.Finalize();
+	(*EntryNode)->FindPinChecked(UEdGraphSchema_K2::PN_Then)->MakeLinkTo(Branch->GetExecPin());
+
+	// A collapsed graph added to the remote graph, its nodes are copied together with the composite node
+	FGraphNodeCreator<UK2Node_Composite> CompositeCreator(*Graphs.RemoteGraph);
+	UK2Node_Composite* Composite = CompositeCreator.CreateNode(false);
+	CompositeCreator.Finalize();
+	if (!TestNotNull(TEXT("Collapsed graph"), Composite->BoundGraph)) return false;
+
+	// Copies of the source graphs, to make sure merging does not change them
+	UEdGraph* const SourceGraphs[] = { RemoteFunction, Graphs.RemoteGraph, Composite->BoundGraph };
+	TArray<UEdGraph*> SourceCopies;
+	for (UEdGraph* SourceGraph : SourceGraphs) SourceCopies.Add(FEdGraphUtilities::CloneGraph(SourceGraph, nullptr));
+
+	const FBlueprintMergeData Data(
+		Graphs.LocalBlueprint,
+		Graphs.BaseBlueprint, FRevisionInfo::InvalidRevision(),
+		Graphs.RemoteBlueprint, FRevisionInfo::InvalidRevision(),
+		Graphs.TargetBlueprint);
+
+	BlueprintMergeHelper BlueprintMerge(Data);
+	BlueprintMerge.ApplyNonConflictingChanges();
+
+	TestEqual(TEXT("Diffs between the remote and target function"), CountDiffs(RemoteFunction, BlueprintMerge.FindTargetGraph(FunctionName)), 0);
+
+	const TSharedPtr<GraphMergeHelper> MergeHelper = BlueprintMerge.FindGraphMergeHelper(Graphs.RemoteGraph->GetFName());
+	const UK2Node_Composite* TargetComposite = MergeHelper ? Cast<UK2Node_Composite>(MergeHelper->FindNodeInTargetGraph(Composite)) : nullptr;
+	if (TestNotNull(TEXT("Collapsed graph in the target graph"), TargetComposite) && TestNotNull(TEXT("Target collapsed graph"), TargetComposite->BoundGraph))
+	{
+		TestEqual(TEXT("Diffs between the remote and target collapsed graph"), CountDiffs(Composite->BoundGraph, TargetComposite->BoundGraph), 0);
+	}
+
+	for (int32 i = 0; i < ARRAY_COUNT(SourceGraphs); ++i)
+	{
+		const FString GraphName = SourceGraphs[i]->GetName();
+		TestEqual(*FString::Printf(TEXT("Diffs in source graph '%s' after merging"), *GraphName), CountDiffs(SourceCopies[i], SourceGraphs[i]), 0);
+		TestFalse(*FString::Printf(TEXT("Source graph '%s' links to the target graph"), *GraphName), HasLinksOutsideGraph(SourceGraphs[i]));
+	}
+
+	return true;
+}
+
+static bool HaveSameResults(const FGraphSnapshotDiff& A, const FGraphSnapshotDiff& B)
+{
+	if (A.NodeMatches.Num() != B.NodeMatches.Num() || A.Diffs.Num() != B.Diffs.Num()) return false;
+
+	for (int32 i = 0; i < A.NodeMatches.Num(); ++i)
+	{
+		if (A.NodeMatches[i].OldNode != B.NodeMatches[i].OldNode || A.NodeMatches[i].NewNode != B.NodeMatches[i].NewNode) return false;
+	}
+
+	for (int32 i = 0; i < A.Diffs.Num(); ++i)
+	{
+		const FSnapshotDiffResult& DiffA = A.Diffs[i];
+		const FSnapshotDiffResult& DiffB = B.Diffs[i];
+
+		if (DiffA.Type != DiffB.Type || DiffA.NodeOld != DiffB.NodeOld || DiffA.NodeNew != DiffB.NodeNew
+			|| DiffA.PinOld != DiffB.PinOld || DiffA.PinNew != DiffB.PinNew
+			|| DiffA.LinkTargetOld != DiffB.LinkTargetOld || DiffA.LinkTargetNew != DiffB.LinkTargetNew)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMergeAssistPropagateMatchingTest, "MergeAssist.Correctness.PropagateMatching", TestFlags)
+bool FMergeAssistPropagateMatchingTest::RunTest(const FString& Parameters)
+{
+	FScopedSyntheticMerge Merge(500);
+	const FSyntheticMergeGraphs& Graphs = Merge.Graphs;
+
+	// Give most remote nodes a new guid, and the graph a new guid so nodes are not matched by name either.
+	// Only every tenth node can still be matched exactly, the others have to be found through their links
+	TMap<UEdGraphNode*, FGuid> OriginalGuids;
+	for (int32 i = 0; i < Graphs.RemoteGraph->Nodes.Num(); ++i)
+	{
+		UEdGraphNode* Node = Graphs.RemoteGraph->Nodes[i];
+		OriginalGuids.Add(Node, Node->NodeGuid);
+
+		if (i % 10 != 0) Node->NodeGuid = FGuid::NewGuid();
+	}
+
+	Graphs.RemoteGraph->GraphGuid = FGuid::NewGuid();
+
+	const TArray<FNodeMatch> ExactMatches = FDiffHelper::FindNodeMatches(Graphs.BaseGraph, Graphs.RemoteGraph, ENodeMatchStrategy::EXACT);
+	const TArray<FNodeMatch> Matches = FDiffHelper::FindNodeMatches(Graphs.BaseGraph, Graphs.RemoteGraph,
+		static_cast<ENodeMatchStrategy>(static_cast<int>(ENodeMatchStrategy::EXACT) | static_cast<int>(ENodeMatchStrategy::PROPAGATE)));
+
+	int32 NumCorrect = 0;
+	for (const FNodeMatch& Match : Matches)
+	{
+		if (Match.OldNode->NodeGuid == OriginalGuids.FindChecked(Match.NewNode)) ++NumCorrect;
+	}
+
+	AddInfo(FString::Printf(TEXT("%d exact matches, %d matches after propagation, %d correct"), ExactMatches.Num(), Matches.Num(), NumCorrect));
+
+	TestTrue(TEXT("Propagation found most of the nodes"), Matches.Num() > Graphs.RemoteGraph->Nodes.Num() / 2);
+	TestTrue(TEXT("Propagated matches are correct"), NumCorrect >= Matches.Num() * 95 / 100);
+	return true;
+}
+
+// Positions on a coarse grid, so there are nodes at the same distance, with a few far outliers which stretch the cells
+static void GenerateNodePositions(FRandomStream& Random, int32 NumNodes, TArray<int32>& PositionsX, TArray<int32>& PositionsY)
+{
+	PositionsX.Reset(NumNodes);
+	PositionsY.Reset(NumNodes);
+	for (int32 i = 0; i < NumNodes; ++i)
+	{
+		const bool bIsOutlier = Random.RandHelper(20) == 0;
+		PositionsX.Add(bIsOutlier ? Random.RandRange(-100000, 100000) : Random.RandRange(-64, 64) * 16);
+		PositionsY.Add(bIsOutlier ? Random.RandRange(-100000, 100000) : Random.RandRange(-32, 32) * 16);
+	}
+}
+
+static void FindNearestBruteForce(const TArray<int32>& PositionsX, const TArray<int32>& PositionsY, int32 X, int32 Y, int32 MaxResults, TArray<int32>& IndicesOut)
+{
+	TArray<TPair<int64, int32>> Distances;
+	for (int32 i = 0; i < PositionsX.Num(); ++i)
+	{
+		const int64 DeltaX = int64(PositionsX[i]) - X;
+		const int64 DeltaY = int64(PositionsY[i]) - Y;
+		Distances.Add(TPair<int64, int32>(DeltaX * DeltaX + DeltaY * DeltaY, i));
+	}
+
+	Distances.Sort([](const TPair<int64, int32>& A, const TPair<int64, int32>& B)
+	{
+		return A.Key != B.Key ? A.Key < B.Key : A.Value < B.Value;
+	});
+
+	IndicesOut.Reset();
+	for (int32 i = 0; i < FMath::Min(MaxResults, Distances.Num()); ++i) IndicesOut.Add(Distances[i].Value);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMergeAssistSpatialIndexTest, "MergeAssist.Correctness.SpatialIndex", TestFlags)
+bool FMergeAssistSpatialIndexTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(1234);
+
+	TArray<int32> PositionsX;
+	TArray<int32> PositionsY;
+	TArray<int32> Expected;
+	TArray<int32> Found;
+
+	for (const int32 NumNodes : { 1, 7, 100, 2000 })
+	{
+		GenerateNodePositions(Random, NumNodes, PositionsX, PositionsY);
+		const FNodeSpatialIndex Index(PositionsX, PositionsY);
+
+		// Positions both inside and far outside the bounds of the nodes, with more results than there are nodes
+		for (int32 Query = 0; Query < 200; ++Query)
+		{
+			const int32 X = Query % 10 == 0 ? Random.RandRange(-500000, 500000) : Random.RandRange(-1100, 1100);
+			const int32 Y = Query % 10 == 0 ? Random.RandRange(-500000, 500000) : Random.RandRange(-600, 600);
+			const int32 MaxResults = Random.RandRange(1, 12);
+
+			FindNearestBruteForce(PositionsX, PositionsY, X, Y, MaxResults, Expected);
+			Index.FindNearest(X, Y, MaxResults, Found);
+
+			if (Found != Expected)
+			{
+				AddError(FString::Printf(TEXT("Nearest %d of %d nodes to (%d, %d) differ from brute force"), MaxResults, NumNodes, X, Y));
+				return false;
+			}
+		}
+	}
+
+	// Both the exhaustive pairs of small sets, and the nearest pairs of sets with more than MaxExhaustivePairs pairs
+	TArray<int32> OldPositionsX;
+	TArray<int32> OldPositionsY;
+	TArray<int32> NewPositionsX;
+	TArray<int32> NewPositionsY;
+	for (const int32 NumNodes : { 20, 64, 65, 300 })
+	{
+		GenerateNodePositions(Random, NumNodes, OldPositionsX, OldPositionsY);
+		GenerateNodePositions(Random, NumNodes + 3, NewPositionsX, NewPositionsY);
+
+		TArray<TPair<int32, int32>> ExpectedPairs;
+		if (NumNodes * (NumNodes + 3) <= FNodeSpatialIndex::MaxExhaustivePairs)
+		{
+			for (int32 Old = 0; Old < NumNodes; ++Old)
+			{
+				for (int32 New = 0; New < NumNodes + 3; ++New) ExpectedPairs.Add(TPair<int32, int32>(Old, New));
+			}
+		}
+		else
+		{
+			TSet<TPair<int32, int32>> NearestPairs;
+			for (int32 Old = 0; Old < NumNodes; ++Old)
+			{
+				FindNearestBruteForce(NewPositionsX, NewPositionsY, OldPositionsX[Old], OldPositionsY[Old], FNodeSpatialIndex::NumNearestCandidates, Expected);
+				for (const int32 New : Expected) NearestPairs.Add(TPair<int32, int32>(Old, New));
+			}
+
+			for (int32 New = 0; New < NumNodes + 3; ++New)
+			{
+				FindNearestBruteForce(OldPositionsX, OldPositionsY, NewPositionsX[New], NewPositionsY[New], FNodeSpatialIndex::NumNearestCandidates, Expected);
+				for (const int32 Old : Expected) NearestPairs.Add(TPair<int32, int32>(Old, New));
+			}
+
+			ExpectedPairs = NearestPairs.Array();
+			ExpectedPairs.Sort([](const TPair<int32, int32>& A, const TPair<int32, int32>& B)
+			{
+				return A.Key != B.Key ? A.Key < B.Key : A.Value < B.Value;
+			});
+		}
+
+		TArray<TPair<int32, int32>> Pairs;
+		FNodeSpatialIndex::FindCandidatePairs(OldPositionsX, OldPositionsY, NewPositionsX, NewPositionsY, Pairs);
+		TestTrue(FString::Printf(TEXT("Candidate pairs of %d and %d nodes match brute force"), NumNodes, NumNodes + 3), Pairs == ExpectedPairs);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMergeAssistSnapshotDiffTest, "MergeAssist.Correctness.SnapshotDiff", TestFlags)
+bool FMergeAssistSnapshotDiffTest::RunTest(const FString& Parameters)
+{
+	FScopedSyntheticMerge Merge(500);
+	const FSyntheticMergeGraphs& Graphs = Merge.Graphs;
+
+	TArray<FNodeMatch> NodeMatches;
+	TArray<FMergeDiffResult> Results;
+	FMergeDiffCollector Diffs(Results);
+	FDiffHelper::DiffGraphs(Graphs.BaseGraph, Graphs.RemoteGraph, Diffs, ENodeMatchStrategy::ALL, &NodeMatches);
+
+	// Round trip the snapshots through an archive, so the diff runs on the loaded snapshots
+	TArray<uint8> Bytes;
+	{
+		FGraphSnapshot BaseSnapshot = FGraphSnapshot::Capture(Graphs.BaseGraph);
+		FGraphSnapshot RemoteSnapshot = FGraphSnapshot::Capture(Graphs.RemoteGraph);
+
+		FMemoryWriter Writer(Bytes);
+		Writer << BaseSnapshot << RemoteSnapshot;
+	}
+
+	FGraphSnapshot BaseSnapshot;
+	FGraphSnapshot RemoteSnapshot;
+
+	FMemoryReader Reader(Bytes);
+	Reader << BaseSnapshot << RemoteSnapshot;
+
+	TestFalse(TEXT("Snapshots were read back"), Reader.IsError());
+	TestEqual(TEXT("Nodes in the base snapshot"), BaseSnapshot.NumNodes(), Graphs.BaseGraph->Nodes.Num());
+
+	FGraphSnapshotDiff SnapshotDiff(BaseSnapshot, RemoteSnapshot);
+	SnapshotDiff.Diff();
+
+	TestEqual(TEXT("Number of node matches"), SnapshotDiff.NodeMatches.Num(), NodeMatches.Num());
+	TestEqual(TEXT("Number of diffs"), SnapshotDiff.Diffs.Num(), Results.Num());
+
+	// Every diff should resolve to the nodes and pins of the graphs
+	for (const FSnapshotDiffResult& Diff : SnapshotDiff.Diffs)
+	{
+		const FMergeDiffResult Result = SnapshotDiff.Resolve(Diff, Graphs.BaseGraph, Graphs.RemoteGraph);
+		const bool bResolved = (Diff.NodeOld == INDEX_NONE || Result.NodeOld) && (Diff.NodeNew == INDEX_NONE || Result.NodeNew)
+			&& (Diff.PinOld == INDEX_NONE || Result.PinOld) && (Diff.PinNew == INDEX_NONE || Result.PinNew);
+
+		if (!bResolved)
+		{
+			AddError(FString::Printf(TEXT("Diff '%s' did not resolve"), *Result.DisplayString.ToString()));
+			break;
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMergeAssistParallelSnapshotDiffTest, "MergeAssist.Correctness.ParallelSnapshotDiff", TestFlags)
+bool FMergeAssistParallelSnapshotDiffTest::RunTest(const FString& Parameters)
+{
+	FScopedSyntheticMerge Merge(2000);
+	const FSyntheticMergeGraphs& Graphs = Merge.Graphs;
+
+	// Without guids and names every node has to be matched approximately, which gives large sets of nodes of the same type
+	for (UEdGraphNode* Node : Graphs.RemoteGraph->Nodes) Node->NodeGuid = FGuid::NewGuid();
+	Graphs.RemoteGraph->GraphGuid = FGuid::NewGuid();
+
+	const FGraphSnapshot BaseSnapshot = FGraphSnapshot::Capture(Graphs.BaseGraph);
+	const FGraphSnapshot RemoteSnapshot = FGraphSnapshot::Capture(Graphs.RemoteGraph);
+
+	const ENodeMatchStrategy MatchStrategy = static_cast<ENodeMatchStrategy>(
+		static_cast<int>(ENodeMatchStrategy::EXACT) | static_cast<int>(ENodeMatchStrategy::APPROXIMATE));
+
+	FGraphSnapshotDiff SerialDiff(BaseSnapshot, RemoteSnapshot);
+	SerialDiff.Diff(MatchStrategy, false);
+
+	FGraphSnapshotDiff ParallelDiff(BaseSnapshot, RemoteSnapshot);
+	ParallelDiff.Diff(MatchStrategy, true);
+
+	TestTrue(TEXT("Nodes were matched approximately"), SerialDiff.NodeMatches.Num() > 0);
+	TestTrue(TEXT("Parallel diff has the same results as the serial diff"), HaveSameResults(SerialDiff, ParallelDiff));
+
+	// Several diffs reading the same snapshots at the same time, each of which also runs its own tasks
+	const int32 NumConcurrentDiffs = 4;
+	TArray<TUniquePtr<FGraphSnapshotDiff>> ConcurrentDiffs;
+	for (int32 i = 0; i < NumConcurrentDiffs; ++i)
+	{
+		ConcurrentDiffs.Emplace(new FGraphSnapshotDiff(BaseSnapshot, RemoteSnapshot));
+	}
+
+	ParallelFor(NumConcurrentDiffs, [&ConcurrentDiffs, MatchStrategy](int32 Index)
+	{
+		ConcurrentDiffs[Index]->Diff(MatchStrategy, true);
+	});
+
+	for (int32 i = 0; i < NumConcurrentDiffs; ++i)
+	{
+		TestTrue(*FString::Printf(TEXT("Concurrent diff %d has the same results as the serial diff"), i), HaveSameResults(SerialDiff, *ConcurrentDiffs[i]));
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMergeAssistDiffGraphsBudgetTest, "MergeAssist.Performance.DiffGraphs", TestFlags)
+bool FMergeAssistDiffGraphsBudgetTest::RunTest(const FString& Parameters)
+{
+	const int32 NumNodes = GetBudget(TEXT("DiffGraphsNumNodes"), 5000);
+	const int32 MaxMilliseconds = GetBudget(TEXT("DiffGraphsMilliseconds"), 2000);
+
+	FScopedSyntheticMerge Merge(NumNodes);
+
+	double Milliseconds = 0.0;
+	{
+		FMergeDiffCounter Diffs;
+		const double StartTime = FPlatformTime::Seconds();
+
+		FDiffHelper::DiffGraphs(Merge.Graphs.BaseGraph, Merge.Graphs.RemoteGraph, Diffs);
+
+		Milliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	}
+
+	AddInfo(FString::Printf(TEXT("DiffGraphs on %d nodes took %.2fms"), NumNodes, Milliseconds));
+
+	TestTrue(*FString::Printf(TEXT("DiffGraphs took %.2fms, budget is %dms"), Milliseconds, MaxMilliseconds), Milliseconds <= MaxMilliseconds);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMergeAssistMergeBudgetTest, "MergeAssist.Performance.Merge", TestFlags)
+bool FMergeAssistMergeBudgetTest::RunTest(const FString& Parameters)
+{
+	const int32 NumNodes = GetBudget(TEXT("MergeNumNodes"), 5000);
+	const int32 MaxMilliseconds = GetBudget(TEXT("MergeMilliseconds"), 5000);
+
+	FScopedSyntheticMerge Merge(NumNodes);
+	const FSyntheticMergeGraphs& Graphs = Merge.Graphs;
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	GraphMergeHelper MergeHelper(Graphs.RemoteGraph, Graphs.BaseGraph, Graphs.LocalGraph, Graphs.TargetGraph);
+	for (const auto& Change : MergeHelper.ChangeList)
+	{
+		if (Change->RemoteDiff.Type != EMergeDiffType::NO_DIFFERENCE) MergeHelper.ApplyRemoteChange(*Change);
+		else MergeHelper.ApplyLocalChange(*Change);
+	}
+
+	const double Milliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	AddInfo(FString::Printf(TEXT("Merging %d changes on %d nodes took %.2fms"), MergeHelper.ChangeList.Num(), NumNodes, Milliseconds));
+	TestTrue(*FString::Printf(TEXT("Merge took %.2fms, budget is %dms"), Milliseconds, MaxMilliseconds), Milliseconds <= MaxMilliseconds);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TimeSlicedMergeDiff.h"
+#include "HAL/PlatformTime.h"
+#include "Stats/Stats.h"
+
+FTimeSlicedMergeDiff::FTimeSlicedMergeDiff(const FBlueprintMergeData& Data, float FrameBudgetMilliseconds)
+	: GraphNames(BlueprintMergeHelper::EnumerateGraphNames(Data))
+	, RemoteGraphs(Data.BlueprintRemote)
+	, BaseGraphs(Data.BlueprintBase)
+	, LocalGraphs(Data.BlueprintLocal)
+	, FrameBudgetSeconds(FMath::Max(FrameBudgetMilliseconds, 0.0f) / 1000.0)
+{
+}
+
+void FTimeSlicedMergeDiff::Tick(float DeltaTime)
+{
+	Step(FPlatformTime::Seconds() + FrameBudgetSeconds);
+}
+
+TStatId FTimeSlicedMergeDiff::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(FTimeSlicedMergeDiff, STATGROUP_Tickables);
+}
+
+void FTimeSlicedMergeDiff::Flush()
+{
+	while (!IsDone())
+	{
+		Step(TNumericLimits<double>::Max());
+	}
+}
+
+void FTimeSlicedMergeDiff::Step(double Deadline)
+{
+	if (IsDone()) return;
+
+	do
+	{
+		const FName GraphName = GraphNames[GraphIndex];
+
+		if (!CurrentDiff)
+		{
+			CurrentDiff.Reset(new FIncrementalGraphMergeDiffs(
+				RemoteGraphs.Find(GraphName),
+				BaseGraphs.Find(GraphName),
+				LocalGraphs.Find(GraphName)));
+		}
+
+		if (!CurrentDiff->Step(Deadline)) break;
+
+		FGraphMergeDiffs Diffs = CurrentDiff->Finish();
+		CurrentDiff.Reset();
+		++GraphIndex;
+
+		OnGraphDiffsGenerated.ExecuteIfBound(GraphName, Diffs);
+	}
+	while (!IsDone() && FPlatformTime::Seconds() < Deadline);
+}
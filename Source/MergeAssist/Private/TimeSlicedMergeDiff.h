@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TickableEditorObject.h"
+#include "BlueprintMergeData.h"
+#include "BlueprintMergeHelper.h"
+#include "GraphMergeHelper.h"
+
+// Diffs all the graphs of a blueprint merge on the game thread, spread over multiple frames. Each
+// frame only spends a fixed budget on diffing, so the editor stays responsive while diffing huge
+// graphs. This is used instead of diffing on a worker thread when the graphs can not be touched
+// from other threads, e.g. because they are shown in the editor
+class FTimeSlicedMergeDiff : public FTickableEditorObject
+{
+public:
+	DECLARE_DELEGATE_TwoParams(FOnGraphDiffsGenerated, FName /*GraphName*/, FGraphMergeDiffs& /*Diffs*/);
+
+	FTimeSlicedMergeDiff(const FBlueprintMergeData& Data, float FrameBudgetMilliseconds);
+
+	// FTickableEditorObject interface
+	void Tick(float DeltaTime) override;
+	bool IsTickable() const override { return !IsDone(); }
+	TStatId GetStatId() const override;
+
+	// Diffs the remaining graphs right away, without a budget
+	void Flush();
+
+	bool IsDone() const { return GraphIndex >= GraphNames.Num(); }
+	int32 NumGraphsDone() const { return GraphIndex; }
+	int32 NumGraphs() const { return GraphNames.Num(); }
+
+	// Called once the diffs of a graph are generated, in the order of BlueprintMergeHelper::EnumerateGraphNames
+	FOnGraphDiffsGenerated OnGraphDiffsGenerated;
+
+private:
+	void Step(double Deadline);
+
+	const TArray<FName> GraphNames;
+	int32 GraphIndex = 0;
+
+	// Diff of the graph at GraphIndex, created when the graph is first stepped
+	TUniquePtr<FIncrementalGraphMergeDiffs> CurrentDiff;
+
+	const FBlueprintGraphIndex RemoteGraphs;
+	const FBlueprintGraphIndex BaseGraphs;
+	const FBlueprintGraphIndex LocalGraphs;
+
+	const double FrameBudgetSeconds;
+};
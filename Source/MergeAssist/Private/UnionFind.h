@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Disjoint sets over the indices [0, Num), using path compression and union by size
+struct FUnionFind
+{
+	explicit FUnionFind(int32 Num)
+	{
+		Parents.SetNumUninitialized(Num);
+		Sizes.Init(1, Num);
+
+		for (int32 i = 0; i < Num; ++i) Parents[i] = i;
+	}
+
+	int32 Find(int32 Index)
+	{
+		int32 Root = Index;
+		while (Parents[Root] != Root) Root = Parents[Root];
+
+		// Point everything on the path directly at the root
+		while (Parents[Index] != Root)
+		{
+			const int32 Next = Parents[Index];
+			Parents[Index] = Root;
+			Index = Next;
+		}
+
+		return Root;
+	}
+
+	// Returns false if both were already in the same set
+	bool Union(int32 A, int32 B)
+	{
+		int32 RootA = Find(A);
+		int32 RootB = Find(B);
+		if (RootA == RootB) return false;
+
+		if (Sizes[RootA] < Sizes[RootB]) Swap(RootA, RootB);
+
+		Parents[RootB] = RootA;
+		Sizes[RootA] += Sizes[RootB];
+		return true;
+	}
+
+	int32 GetSize(int32 Index) { return Sizes[Find(Index)]; }
+
+private:
+	TArray<int32> Parents;
+	TArray<int32> Sizes;
+};
@@ -4,6 +4,8 @@
 
 class UBlueprint;
 
+DECLARE_LOG_CATEGORY_EXTERN(LogMergeAssist, Log, All);
+
 class IMergeAssistModule : public IModuleInterface
 {
 public: